@@ -719,6 +719,12 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
             ));
         }
 
+        // the largest index, used to size the flat dispatch tables
+        api_index_h->add_preprocess(std::format(
+            "#define PosApiIndex_Max {}",
+            support_api_meta_list.size() > 0 ? support_api_meta_list.back()->index : 0
+        ));
+
         api_index_h->archive();
     };
 
@@ -730,9 +736,11 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         
         POSCodeGen_CppSourceFile *api_context_h;
 
+        POSCodeGen_CppBlock *array_pos_api_metas;
         POSCodeGen_CppBlock *class_POSApiManager_TARGET;
         POSCodeGen_CppBlock *class_POSApiManager_TARGET_function_init;
         POSCodeGen_CppBlock *func_declare_pos_is_hijacked;
+        std::string api_meta_list, api_meta_table_list;
 
 
         auto ____get_pos_api_type_string = [](pos_api_type_t api_type) -> std::string {
@@ -755,6 +763,19 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
             }
         };
 
+        auto ____get_pos_library_id_string = [](std::string& library_name) -> std::string {
+            if(library_name == "cuda_runtime"){
+                return "kPOS_CUDA_Library_Id_Runtime";
+            } else if(library_name == "cuda_driver"){
+                return "kPOS_CUDA_Library_Id_Driver";
+            } else if(library_name.rfind("cublas", 0) == 0){
+                return "kPOS_CUDA_Library_Id_cuBLAS";
+            } else {
+                POS_WARN("no library id for library %s, use runtime as default", library_name.c_str());
+                return "kPOS_CUDA_Library_Id_Runtime";
+            }
+        };
+
 
         api_context_h = new POSCodeGen_CppSourceFile(
             this->gen_directory
@@ -767,6 +788,7 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         api_context_h->add_preprocess("#pragma once");
         api_context_h->add_preprocess("#include <iostream>");
         api_context_h->add_preprocess("#include <vector>");
+        api_context_h->add_preprocess("#include <utility>");
         for(i=0; i<vendor_header_file_meta_list.size(); i++){
             api_context_h->add_preprocess(std::format(
                 "#include <{}>",
@@ -775,9 +797,59 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         }
         api_context_h->add_preprocess("#include \"pos/include/common.h\"");
         api_context_h->add_preprocess("#include \"pos/include/api_context.h\"");
+        api_context_h->add_preprocess("#include \"pos/include/utils/dispatch_table.h\"");
         api_context_h->add_preprocess(std::format(
             "#include \"pos/{}_impl/api_index.h\"", this->target
         ));
+        api_context_h->add_preprocess(std::format(
+            "#include \"pos/{}_impl/api_library.h\"", this->target
+        ));
+
+        // declare constexpr metadata list and flat metadata table (api_id -> metadata)
+        for(i=0; i<support_api_meta_list.size(); i++){
+            POS_CHECK_POINTER(api_meta = support_api_meta_list[i]);
+            api_meta_list += std::format(
+                "    {{ PosApiIndex_{}, {{ /* is_sync */ {}, /* api_type */ {}, /* library_id */ {}, /* api_name */ \"{}\" }} }}{}\n",
+                api_meta->name,
+                api_meta->is_sync ? "true" : "false",
+                ____get_pos_api_type_string(api_meta->api_type),
+                ____get_pos_library_id_string(api_meta->library_name),
+                api_meta->name,
+                i < support_api_meta_list.size()-1 ? "," : ""
+            );
+            api_meta_table_list += std::format(
+                "    {{ PosApiIndex_{}, &pos_api_meta_list[{}].second }}{}\n",
+                api_meta->name,
+                i,
+                i < support_api_meta_list.size()-1 ? "," : ""
+            );
+        }
+        array_pos_api_metas = new POSCodeGen_CppBlock(
+            /* field name */ "",
+            /* need_braces */ false,
+            /* foot_comment */ "",
+            /* need_ended_semicolon */ false,
+            /* level */ 0
+        );
+        POS_CHECK_POINTER(array_pos_api_metas);
+        api_context_h->add_block(array_pos_api_metas);
+        array_pos_api_metas->append_content(
+            "inline constexpr std::pair<uint64_t, POSAPIMeta_t> pos_api_meta_list[] = {\n"
+            + api_meta_list
+            + "};",
+            -4
+        );
+        array_pos_api_metas->append_content(
+            "inline constexpr std::pair<uint64_t, const POSAPIMeta_t*> pos_api_meta_table_list[] = {\n"
+            + api_meta_table_list
+            + "};",
+            -4
+        );
+        array_pos_api_metas->append_content(
+            "inline constexpr auto pos_api_meta_table\n"
+            "    = pos_make_dispatch_array<const POSAPIMeta_t*, PosApiIndex_Max+1>(pos_api_meta_table_list);",
+            -4
+        );
 
         // declare POSApiManager_TARGET class
         target_uppercase = this->target;
@@ -818,30 +890,13 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         }
         POS_CHECK_POINTER(class_POSApiManager_TARGET_function_init);
 
-        class_POSApiManager_TARGET_function_init->append_content("this->api_metas.insert({");
-        for(i=0; i<support_api_meta_list.size(); i++){
-            POS_CHECK_POINTER(api_meta = support_api_meta_list[i]);
-            class_POSApiManager_TARGET_function_init->append_content(
-                /* content */ std::format(
-                    "{{\n"
-                    "    /* api_id */ PosApiIndex_{},\n"
-                    "    {{\n"
-                    "        /* is_sync */  {},\n"
-                    "        /* api_type */ {},\n"
-                    "        /* api_name */ \"{}\",\n"
-                    "    }}\n"
-                    "}}{}"
-                    ,
-                    api_meta->name,
-                    api_meta->is_sync ? "true" : "false",
-                    ____get_pos_api_type_string(api_meta->api_type),
-                    api_meta->name,
-                    i < support_api_meta_list.size()-1 ? "," : ""
-                ),
-                /* char_offset */ 4
-            );
-        }
-        class_POSApiManager_TARGET_function_init->append_content("});");
+        class_POSApiManager_TARGET_function_init->append_content(
+            "uint64_t i;\n"
+            "for(i=0; i<sizeof(pos_api_meta_list)/sizeof(pos_api_meta_list[0]); i++){\n"
+            "    this->api_metas.insert(pos_api_meta_list[i]);\n"
+            "}\n"
+            "this->_api_meta_table.bind(pos_api_meta_table.data(), pos_api_meta_table.size());"
+        );
 
         // declare pos_is_hijacked function
         func_declare_pos_is_hijacked = new POSCodeGen_CppBlock(
@@ -1008,6 +1063,8 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         POSCodeGen_CppSourceFile *parser_functions_cpp;
         POSCodeGen_CppBlock *namespace_ps_functions;
         POSCodeGen_CppBlock *class_POSParser_TARGET_function_init_ps_functions;
+        POSCodeGen_CppBlock *array_ps_functions;
+        std::string ps_function_list;
         
         parser_functions_cpp = new POSCodeGen_CppSourceFile(
             this->gen_directory 
@@ -1021,6 +1078,7 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         parser_functions_cpp->add_preprocess("#include \"pos/include/common.h\"");
         parser_functions_cpp->add_preprocess("#include \"pos/include/parser.h\"");
         parser_functions_cpp->add_preprocess("#include \"pos/include/api_context.h\"");
+        parser_functions_cpp->add_preprocess("#include \"pos/include/utils/dispatch_table.h\"");
         parser_functions_cpp->add_preprocess(std::format(
             "#include \"pos/{}_impl/api_index.h\"", this->target
         ));
@@ -1028,6 +1086,38 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
             "#include \"pos/{}_impl/parser_functions.h\"", this->target
         ));
 
+        // declare constexpr parser function list and flat parser function table (api_id -> function)
+        for(i=0; i<support_api_meta_list.size(); i++){
+            POS_CHECK_POINTER(api_meta = support_api_meta_list[i]);
+            api_snake_name = posautogen_utils_camel2snake(api_meta->name);
+            ps_function_list += std::format(
+                "    {{ PosApiIndex_{}, ps_functions::{}::parse }}{}\n",
+                api_meta->name,
+                api_snake_name,
+                i == support_api_meta_list.size()-1 ? "" : ","
+            );
+        }
+        array_ps_functions = new POSCodeGen_CppBlock(
+            /* field name */ "",
+            /* need_braces */ false,
+            /* foot_comment */ "",
+            /* need_ended_semicolon */ false,
+            /* level */ 0
+        );
+        POS_CHECK_POINTER(array_ps_functions);
+        parser_functions_cpp->add_block(array_ps_functions);
+        array_ps_functions->append_content(
+            "static constexpr std::pair<uint64_t, pos_runtime_parser_function_t> ps_function_list[] = {\n"
+            + ps_function_list
+            + "};",
+            -4
+        );
+        array_ps_functions->append_content(
+            "static constexpr auto ps_function_table\n"
+            "    = pos_make_dispatch_array<pos_runtime_parser_function_t, PosApiIndex_Max+1>(ps_function_list);",
+            -4
+        );
+
         // declare function POSParser_TARGET::init_ps_functions
         target_uppercase = this->target;
         std::transform(target_uppercase.begin(), target_uppercase.end(), target_uppercase.begin(), ::toupper);
@@ -1047,23 +1137,13 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         POS_CHECK_POINTER(class_POSParser_TARGET_function_init_ps_functions);
         parser_functions_cpp->add_block(class_POSParser_TARGET_function_init_ps_functions);
 
-        class_POSParser_TARGET_function_init_ps_functions->append_content("this->_parser_functions.insert({");
-        for(i=0; i<support_api_meta_list.size(); i++){
-            POS_CHECK_POINTER(api_meta = support_api_meta_list[i]);
-
-            api_snake_name = posautogen_utils_camel2snake(api_meta->name);
-
-            class_POSParser_TARGET_function_init_ps_functions->append_content(
-                std::format(
-                    "{{   PosApiIndex_{}, ps_functions::{}::parse }}{}",
-                    api_meta->name,
-                    api_snake_name,
-                    i == support_api_meta_list.size()-1 ? "" : ","
-                ),
-                4
-            );
-        }
-        class_POSParser_TARGET_function_init_ps_functions->append_content("});");
+        class_POSParser_TARGET_function_init_ps_functions->append_content(
+            "uint64_t i;\n"
+            "for(i=0; i<sizeof(ps_function_list)/sizeof(ps_function_list[0]); i++){\n"
+            "    this->_parser_functions.insert(ps_function_list[i]);\n"
+            "}\n"
+            "this->_parser_function_table.bind(ps_function_table.data(), ps_function_table.size());"
+        );
         class_POSParser_TARGET_function_init_ps_functions->append_content("return POS_SUCCESS;");
 
         parser_functions_cpp->archive();
@@ -1134,6 +1214,8 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         POSCodeGen_CppSourceFile *worker_functions_cpp;
         POSCodeGen_CppBlock *namespace_wk_functions;
         POSCodeGen_CppBlock *class_POSWorker_TARGET_function_init_wk_functions;
+        POSCodeGen_CppBlock *array_wk_functions;
+        std::string wk_function_list;
         
         worker_functions_cpp = new POSCodeGen_CppSourceFile(
             this->gen_directory 
@@ -1147,6 +1229,7 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         worker_functions_cpp->add_preprocess("#include \"pos/include/common.h\"");
         worker_functions_cpp->add_preprocess("#include \"pos/include/worker.h\"");
         worker_functions_cpp->add_preprocess("#include \"pos/include/api_context.h\"");
+        worker_functions_cpp->add_preprocess("#include \"pos/include/utils/dispatch_table.h\"");
         worker_functions_cpp->add_preprocess(std::format(
             "#include \"pos/{}_impl/api_index.h\"", this->target
         ));
@@ -1154,6 +1237,38 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
             "#include \"pos/{}_impl/worker_functions.h\"", this->target
         ));
 
+        // declare constexpr worker function list and flat worker function table (api_id -> function)
+        for(i=0; i<support_api_meta_list.size(); i++){
+            POS_CHECK_POINTER(api_meta = support_api_meta_list[i]);
+            api_snake_name = posautogen_utils_camel2snake(api_meta->name);
+            wk_function_list += std::format(
+                "    {{ PosApiIndex_{}, wk_functions::{}::launch }}{}\n",
+                api_meta->name,
+                api_snake_name,
+                i == support_api_meta_list.size()-1 ? "" : ","
+            );
+        }
+        array_wk_functions = new POSCodeGen_CppBlock(
+            /* field name */ "",
+            /* need_braces */ false,
+            /* foot_comment */ "",
+            /* need_ended_semicolon */ false,
+            /* level */ 0
+        );
+        POS_CHECK_POINTER(array_wk_functions);
+        worker_functions_cpp->add_block(array_wk_functions);
+        array_wk_functions->append_content(
+            "static constexpr std::pair<uint64_t, pos_worker_launch_function_t> wk_function_list[] = {\n"
+            + wk_function_list
+            + "};",
+            -4
+        );
+        array_wk_functions->append_content(
+            "static constexpr auto wk_function_table\n"
+            "    = pos_make_dispatch_array<pos_worker_launch_function_t, PosApiIndex_Max+1>(wk_function_list);",
+            -4
+        );
+
         // declare function POSParser_TARGET::init_wk_functions
         target_uppercase = this->target;
         std::transform(target_uppercase.begin(), target_uppercase.end(), target_uppercase.begin(), ::toupper);
@@ -1173,23 +1288,13 @@ pos_retval_t POSAutogener::__generate_auxiliary_files(
         POS_CHECK_POINTER(class_POSWorker_TARGET_function_init_wk_functions);
         worker_functions_cpp->add_block(class_POSWorker_TARGET_function_init_wk_functions);
 
-        class_POSWorker_TARGET_function_init_wk_functions->append_content("this->_launch_functions.insert({");
-        for(i=0; i<support_api_meta_list.size(); i++){
-            POS_CHECK_POINTER(api_meta = support_api_meta_list[i]);
-
-            api_snake_name = posautogen_utils_camel2snake(api_meta->name);
-
-            class_POSWorker_TARGET_function_init_wk_functions->append_content(
-                std::format(
-                    "{{   PosApiIndex_{}, wk_functions::{}::launch }}{}",
-                    api_meta->name,
-                    api_snake_name,
-                    i == support_api_meta_list.size()-1 ? "" : ","
-                ),
-                4
-            );
-        }
-        class_POSWorker_TARGET_function_init_wk_functions->append_content("});");
+        class_POSWorker_TARGET_function_init_wk_functions->append_content(
+            "uint64_t i;\n"
+            "for(i=0; i<sizeof(wk_function_list)/sizeof(wk_function_list[0]); i++){\n"
+            "    this->_launch_functions.insert(wk_function_list[i]);\n"
+            "}\n"
+            "this->_launch_function_table.bind(wk_function_table.data(), wk_function_table.size());"
+        );
         class_POSWorker_TARGET_function_init_wk_functions->append_content("return POS_SUCCESS;");
 
         worker_functions_cpp->archive();
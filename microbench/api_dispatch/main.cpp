@@ -0,0 +1,154 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+#include "pos/include/api_context.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/dispatch_table.h"
+#include "pos/cuda_impl/api_index.h"
+
+constexpr uint64_t kNbWQEs = 10000000;
+
+/*!
+ *  \brief  previous layout of the API metadata, which carries the API name in std::string
+ */
+typedef struct legacy_api_meta {
+    bool is_sync;
+    pos_api_type_t api_type;
+    uint8_t library_id;
+    std::string api_name;
+} legacy_api_meta_t;
+
+using dispatch_function_t = uint64_t(*)(uint64_t);
+
+static __attribute__((noinline)) uint64_t dummy_function(uint64_t api_id){ return api_id & 1; }
+
+/*!
+ *  \brief  APIs registered in the CUDA runtime
+ */
+static const std::vector<std::pair<uint64_t, const char*>> registered_apis = {
+    { CUDA_MALLOC, "cudaMalloc" }, { CUDA_FREE, "cudaFree" }, { CUDA_LAUNCH_KERNEL, "cudaLaunchKernel" },
+    { CUDA_MEMCPY_HTOD, "cudaMemcpyH2D" }, { CUDA_MEMCPY_DTOH, "cudaMemcpyD2H" }, { CUDA_MEMCPY_DTOD, "cudaMemcpyD2D" },
+    { CUDA_MEMCPY_HTOD_ASYNC, "cudaMemcpyH2DAsync" }, { CUDA_MEMCPY_DTOH_ASYNC, "cudaMemcpyD2HAsync" },
+    { CUDA_MEMCPY_DTOD_ASYNC, "cudaMemcpyD2DAsync" }, { CUDA_MEMSET_ASYNC, "cudaMemsetAsync" },
+    { CUDA_SET_DEVICE, "cudaSetDevice" }, { CUDA_GET_LAST_ERROR, "cudaGetLastError" },
+    { CUDA_GET_ERROR_STRING, "cudaGetErrorString" }, { CUDA_PEEK_AT_LAST_ERROR, "cudaPeekAtLastError" },
+    { CUDA_GET_DEVICE_COUNT, "cudaGetDeviceCount" }, { CUDA_GET_DEVICE_PROPERTIES, "cudaGetDeviceProperties" },
+    { CUDA_DEVICE_GET_ATTRIBUTE, "cudaDeviceGetAttribute" }, { CUDA_GET_DEVICE, "cudaGetDevice" },
+    { CUDA_FUNC_GET_ATTRIBUTES, "cudaFuncGetAttributes" },
+    { CUDA_OCCUPANCY_MAX_ACTIVE_BPM_WITH_FLAGS, "cudaOccupancyMaxActiveBlocksPerMultiprocessorWithFlags" },
+    { CUDA_STREAM_SYNCHRONIZE, "cudaStreamSynchronize" }, { CUDA_STREAM_IS_CAPTURING, "cudaStreamIsCapturing" },
+    { CUDA_EVENT_CREATE_WITH_FLAGS, "cudaEventCreateWithFlags" }, { CUDA_EVENT_DESTROY, "cudaEventDestroy" },
+    { CUDA_EVENT_RECORD, "cudaEventRecord" }, { CUDA_EVENT_QUERY, "cudaEventQuery" },
+    { rpc_cuModuleLoad, "cuModuleLoad" }, { rpc_cuModuleLoadData, "cuModuleLoadData" },
+    { rpc_register_function, "__cudaRegisterFunction" }, { rpc_cuModuleGetFunction, "cuModuleGetFunction" },
+    { rpc_register_var, "__cudaRegisterVar" }, { rpc_cuCtxGetCurrent, "cuCtxGetCurrent" },
+    { rpc_cuDevicePrimaryCtxGetState, "cuDevicePrimaryCtxGetState" }, { rpc_cuLaunchKernel, "cuLaunchKernel" },
+    { rpc_cuGetErrorString, "cuGetErrorString" }, { rpc_cublasCreate, "cublasCreate" },
+    { rpc_cublasSetStream, "cublasSetStream" }, { rpc_cublasSetMathMode, "cublasSetMathMode" },
+    { rpc_cublasSgemm, "cublasSgemm" }, { rpc_cublasSgemmStridedBatched, "cublasSgemmStridedBatched" },
+    { rpc_deinit, "deinit" }
+};
+
+/*!
+ *  \brief  mimic the API trace of a training iteration, which is dominated by kernel launches
+ */
+static void generate_trace(std::vector<uint64_t>& trace){
+    std::mt19937_64 rng(0);
+    std::uniform_int_distribution<uint64_t> dist(0, 99);
+    uint64_t i, r;
+
+    trace.resize(kNbWQEs);
+    for(i=0; i<kNbWQEs; i++){
+        r = dist(rng);
+        if(r < 70){         trace[i] = CUDA_LAUNCH_KERNEL; }
+        else if(r < 80){    trace[i] = rpc_cublasSgemm; }
+        else if(r < 88){    trace[i] = CUDA_MEMCPY_HTOD_ASYNC; }
+        else if(r < 94){    trace[i] = CUDA_MEMCPY_DTOH_ASYNC; }
+        else if(r < 97){    trace[i] = CUDA_EVENT_RECORD; }
+        else {              trace[i] = CUDA_STREAM_SYNCHRONIZE; }
+    }
+}
+
+int main(){
+    uint64_t i, api_id, s_tick, e_tick, checksum;
+    std::vector<uint64_t> trace;
+    POSUtilTscTimer tsc_timer;
+
+    // before: std::map lookups, with the metadata copied by value
+    std::map<uint64_t, legacy_api_meta_t> legacy_api_metas;
+    std::map<uint64_t, dispatch_function_t> parser_functions, launch_functions;
+    legacy_api_meta_t legacy_api_meta;
+
+    // after: flat tables indexed by api_id
+    std::map<uint64_t, POSAPIMeta_t> api_metas;
+    POSDispatchTable<const POSAPIMeta_t*> api_meta_table;
+    POSDispatchTable<dispatch_function_t> parser_function_table, launch_function_table;
+    const POSAPIMeta_t *api_meta;
+
+    for(auto& [id, name] : registered_apis){
+        legacy_api_metas[id] = { false, kPOS_API_Type_Set_Resource, 0, name };
+        api_metas[id] = { false, kPOS_API_Type_Set_Resource, 0, name };
+        parser_functions[id] = dummy_function;
+        launch_functions[id] = dummy_function;
+    }
+    api_meta_table.build(api_metas, [](const POSAPIMeta_t& meta) -> const POSAPIMeta_t* { return &meta; });
+    parser_function_table.build(parser_functions);
+    launch_function_table.build(launch_functions);
+
+    generate_trace(trace);
+
+    // each WQE looks up the metadata and the function once in parser, and once in worker
+    checksum = 0;
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(i=0; i<kNbWQEs; i++){
+        api_id = trace[i];
+        legacy_api_meta = legacy_api_metas[api_id];
+        checksum += (*(parser_functions[api_id]))(api_id) + legacy_api_meta.library_id;
+        legacy_api_meta = legacy_api_metas[api_id];
+        checksum += (*(launch_functions[api_id]))(api_id) + legacy_api_meta.library_id;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    printf(
+        "[map  ] %6.2f ns/WQE (checksum: %lu)\n",
+        tsc_timer.tick_to_us(e_tick - s_tick) * 1000.0 / kNbWQEs, checksum
+    );
+
+    checksum = 0;
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(i=0; i<kNbWQEs; i++){
+        api_id = trace[i];
+        api_meta = api_meta_table.get(api_id);
+        checksum += (*(parser_function_table.get(api_id)))(api_id) + api_meta->library_id;
+        api_meta = api_meta_table.get(api_id);
+        checksum += (*(launch_function_table.get(api_id)))(api_id) + api_meta->library_id;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    printf(
+        "[table] %6.2f ns/WQE (checksum: %lu)\n",
+        tsc_timer.tick_to_us(e_tick - s_tick) * 1000.0 / kNbWQEs, checksum
+    );
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pos/include/common.h"
+#include "pos/include/api_context.h"
+
+/*!
+ *  \brief  count every malloc issued by the process (operator new also goes here)
+ */
+static std::atomic<uint64_t> nb_mallocs(0);
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* malloc(size_t size){
+    nb_mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+constexpr uint64_t kNbCalls = 2000000;
+constexpr uint64_t kApiId = 200;    // arbitrary api id, not dispatched in this benchmark
+
+/*!
+ *  \brief  mimic the parameter list of cudaLaunchKernel
+ *          (function, gridDim, blockDim, args, sharedMem, stream)
+ */
+struct launch_params {
+    uint64_t func;
+    uint32_t grid_dim[3];
+    uint32_t block_dim[3];
+    uint8_t args[256];
+    uint64_t shared_mem;
+    uint64_t stream;
+};
+
+static void fill_desps(launch_params& p, uint64_t args_size, std::vector<POSAPIParamDesp_t>& desps){
+    desps.clear();
+    desps.push_back({ .value = &p.func, .size = sizeof(p.func) });
+    desps.push_back({ .value = p.grid_dim, .size = sizeof(p.grid_dim) });
+    desps.push_back({ .value = p.block_dim, .size = sizeof(p.block_dim) });
+    desps.push_back({ .value = p.args, .size = args_size });
+    desps.push_back({ .value = &p.shared_mem, .size = sizeof(p.shared_mem) });
+    desps.push_back({ .value = &p.stream, .size = sizeof(p.stream) });
+}
+
+/*!
+ *  \brief  per-call heap path: a new WQE (and its context / parameters) for each call
+ */
+static void run_heap(POSClient *client, std::vector<POSAPIParamDesp_t>& desps, uint64_t args_size){
+    uint64_t i, s_mallocs, e_mallocs;
+    POSAPIContext_QE *wqe;
+
+    s_mallocs = nb_mallocs.load();
+    auto s_time = std::chrono::steady_clock::now();
+    for(i=0; i<kNbCalls; i++){
+        wqe = new POSAPIContext_QE(kApiId, 0, desps, i, nullptr, 0, client);
+        wqe->put_ref();     // heap-allocated wqe would be deleted
+    }
+    auto e_time = std::chrono::steady_clock::now();
+    e_mallocs = nb_mallocs.load();
+
+    double duration_s = std::chrono::duration<double>(e_time - s_time).count();
+    printf(
+        "[heap ] args_size(%4lu): %8.2f Mcalls/s, %6.2f allocations/call\n",
+        args_size, (double)kNbCalls / duration_s / 1e6, (double)(e_mallocs - s_mallocs) / (double)kNbCalls
+    );
+}
+
+/*!
+ *  \brief  arena path: acquire WQE from the client arena and recycle it once retired
+ */
+static void run_arena(POSClient *client, std::vector<POSAPIParamDesp_t>& desps, uint64_t args_size){
+    uint64_t i, s_mallocs, e_mallocs;
+    POSAPIContext_QE *wqe;
+    POSAPIContextArena arena;
+
+    s_mallocs = nb_mallocs.load();
+    auto s_time = std::chrono::steady_clock::now();
+    for(i=0; i<kNbCalls; i++){
+        wqe = arena.acquire();
+        wqe->load(kApiId, 0, desps.data(), desps.size(), i, nullptr, 0, client);
+        wqe->put_ref();     // retired, back to the arena
+    }
+    auto e_time = std::chrono::steady_clock::now();
+    e_mallocs = nb_mallocs.load();
+
+    double duration_s = std::chrono::duration<double>(e_time - s_time).count();
+    printf(
+        "[arena] args_size(%4lu): %8.2f Mcalls/s, %6.2f allocations/call (slabs: %lu, live: %lu)\n",
+        args_size, (double)kNbCalls / duration_s / 1e6, (double)(e_mallocs - s_mallocs) / (double)kNbCalls,
+        arena.nb_slabs, arena.get_nb_live()
+    );
+}
+
+/*!
+ *  \brief  arena path with a window of in-flight WQEs, which are retired by another thread
+ *          (e.g., the RPC thread of an async-heavy client); the arena should stay bounded by
+ *          the window, and the live accounting should drop back to zero once all are retired
+ */
+static void run_arena_window(POSClient *client, std::vector<POSAPIParamDesp_t>& desps, uint64_t window){
+    uint64_t i, peak_live = 0, peak_live_bytes = 0;
+    POSAPIContext_QE *wqe;
+    POSAPIContextArena arena;
+    std::vector<POSAPIContext_QE*> inflight;
+
+    inflight.reserve(window);
+    for(i=0; i<kNbCalls; i++){
+        wqe = arena.acquire();
+        wqe->load(kApiId, 0, desps.data(), desps.size(), i, nullptr, 0, client);
+        inflight.push_back(wqe);
+
+        if(inflight.size() == window){
+            peak_live = std::max(peak_live, arena.get_nb_live());
+            peak_live_bytes = std::max(peak_live_bytes, arena.get_nb_live_bytes());
+            std::thread retirer([&](){
+                for(auto inflight_wqe : inflight){ inflight_wqe->put_ref(); }
+            });
+            retirer.join();
+            inflight.clear();
+        }
+    }
+    for(auto inflight_wqe : inflight){ inflight_wqe->put_ref(); }
+
+    printf(
+        "[window] window(%5lu): slabs %3lu, arena %8lu bytes, peak live %5lu (%8lu bytes), final live %lu (%lu bytes)\n",
+        window, arena.nb_slabs, arena.get_nb_reserved_bytes(), peak_live, peak_live_bytes,
+        arena.get_nb_live(), arena.get_nb_live_bytes()
+    );
+}
+
+int main(){
+    launch_params params;
+    std::vector<POSAPIParamDesp_t> desps;
+    std::vector<uint64_t> args_sizes({ 16, 48, 256 });
+
+    // the WQE only records the client pointer, no client method is invoked here
+    alignas(64) static uint8_t dummy_client[64];
+    POSClient *client = reinterpret_cast<POSClient*>(dummy_client);
+
+    memset(&params, 0, sizeof(params));
+    desps.reserve(8);
+
+    for(uint64_t args_size : args_sizes){
+        fill_desps(params, args_size, desps);
+        run_heap(client, desps, args_size);
+        run_arena(client, desps, args_size);
+    }
+
+    fill_desps(params, 48, desps);
+    for(uint64_t window : { 256ul, 1024ul, 4096ul }){
+        run_arena_window(client, desps, window);
+    }
+
+    return 0;
+}
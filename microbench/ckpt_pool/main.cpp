@@ -0,0 +1,107 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "pos/include/common.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/size_class_pool.h"
+
+constexpr uint64_t kNbHandles = 64;         // number of memory handles being checkpointed
+constexpr uint64_t kNbRounds = 50;          // number of checkpoint rounds
+constexpr uint64_t kMinSize = 64ul << 10;   // minimum size of memory handles
+constexpr uint64_t kMaxSize = 4ul << 20;    // maximum size of memory handles
+
+static POSUtilTscTimer tsc_timer;
+
+
+/*!
+ *  \brief  mmap backend, pages are populated on allocation to emulate the cost of pinning
+ */
+static void* mmap_alloc(uint64_t size){
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+static void mmap_free(void* ptr, uint64_t size){
+    POS_ASSERT(0 == munmap(ptr, size));
+}
+
+
+/*!
+ *  \brief  emulate checkpoint rounds over all handles: each round applies a new slot for every
+ *          handle and invalidates the slot of the previous version, while a fraction of handles
+ *          is freed and re-allocated with a different size (e.g., by the caching allocator of
+ *          the framework)
+ *  \param  use_pool    whether to serve slots from the size-class pool
+ *  \param  churn_pct   percentage of handles re-allocated in each round
+ */
+static void run(bool use_pool, uint64_t churn_pct){
+    std::mt19937_64 rng(churn_pct);
+    std::uniform_int_distribution<uint64_t> size_dist(kMinSize, kMaxSize), pct_dist(0, 99);
+    std::vector<uint64_t> sizes(kNbHandles);
+    std::vector<void*> slots(kNbHandles, nullptr);
+    POSUtilSizeClassPool pool(mmap_alloc, mmap_free, /* max_cached_bytes */ 1ul << 30);
+    uint64_t i, r, s_tick, e_tick, nb_allocs = 0;
+    void *ptr;
+
+    for(i=0; i<kNbHandles; i++){ sizes[i] = size_dist(rng); }
+
+    auto __allocate = [&](uint64_t size) -> void* {
+        return use_pool ? pool.allocate(size) : mmap_alloc(size);
+    };
+    auto __deallocate = [&](void* ptr, uint64_t size){
+        if(use_pool){ POS_ASSERT(POS_SUCCESS == pool.deallocate(ptr)); } else { mmap_free(ptr, size); }
+    };
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(r=0; r<kNbRounds; r++){
+        for(i=0; i<kNbHandles; i++){
+            if(r > 0 && pct_dist(rng) < churn_pct){
+                __deallocate(slots[i], sizes[i]);
+                slots[i] = nullptr;
+                sizes[i] = size_dist(rng);
+            }
+            POS_CHECK_POINTER(ptr = __allocate(sizes[i]));
+            ((uint8_t*)ptr)[sizes[i] - 1] = (uint8_t)r;
+            if(slots[i] != nullptr){ __deallocate(slots[i], sizes[i]); }
+            slots[i] = ptr;
+            nb_allocs += 1;
+        }
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+
+    printf(
+        "[%s] churn(%3lu%%): %8.2f us per slot, #hits(%5lu), #misses(%5lu), cached %6.1f MB\n",
+        use_pool ? "pool" : "mmap", churn_pct, tsc_timer.tick_to_us(e_tick - s_tick) / nb_allocs,
+        pool.get_nb_hits(), pool.get_nb_misses(), (double)pool.get_cached_bytes() / (1 << 20)
+    );
+
+    for(i=0; i<kNbHandles; i++){ __deallocate(slots[i], sizes[i]); }
+}
+
+int main(){
+    for(uint64_t churn_pct : { 0ul, 10ul, 50ul }){
+        run(/* use_pool */ false, churn_pct);
+        run(/* use_pool */ true, churn_pct);
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/range_index.h"
+
+constexpr uint64_t kNbLayers = 96;              // number of layers of the emulated model
+constexpr uint64_t kNbKernelsPerLayer = 24;     // number of kernels launched per layer
+constexpr uint64_t kNbArgsPerKernel = 4;        // number of pointer arguments per kernel
+constexpr uint64_t kNbTensorsPerLayer = 12;     // working set of a layer (weights, activations, grads)
+constexpr uint64_t kNbSteps = 50;               // number of training steps
+constexpr uint64_t kNbChurnOps = 200000;        // number of cudaFree + cudaMalloc pairs
+
+static POSUtilTscTimer tsc_timer;
+
+/*!
+ *  \brief  emulated handle, only those fields touched by the lookup
+ */
+struct handle_t {
+    uint64_t client_addr;
+    uint64_t size;
+    uint64_t status;
+};
+
+/*!
+ *  \brief  previous lookup of POSHandleManager: count + operator[] for the base address,
+ *          then lower_bound for the covering range
+ */
+static inline handle_t* map_lookup(std::map<uint64_t, handle_t*>& map, uint64_t addr, uint64_t* offset){
+    handle_t *handle;
+
+    if(unlikely(map.count(addr) > 0)){
+        handle = map[addr];
+        *offset = 0;
+        return handle;
+    }
+
+    auto iter = map.lower_bound(addr);
+    if(iter != map.begin()){
+        iter--;
+        handle = iter->second;
+        if(likely(handle->client_addr <= addr && addr < handle->client_addr + handle->size)){
+            *offset = addr - handle->client_addr;
+            return handle;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+ *  \brief  segments allocated by the caching allocator of PyTorch: most are 2 MB blocks of
+ *          the small pool, the others are large blocks rounded up to 2 MB; the device
+ *          addresses grow with gaps left by freed segments
+ */
+static void generate_segments(uint64_t nb_segments, std::mt19937_64& rng, std::vector<handle_t*>& handles){
+    std::uniform_int_distribution<uint64_t> pool_dist(0, 9), large_dist(10, 100), gap_dist(0, 3);
+    uint64_t addr = 0x7f0000000000ul, size;
+
+    for(uint64_t i=0; i<nb_segments; i++){
+        size = pool_dist(rng) < 7 ? (2ul << 20) : large_dist(rng) * (2ul << 20);
+        handles.push_back(new handle_t({ addr, size, 0 }));
+        addr += size + gap_dist(rng) * (2ul << 20);
+    }
+}
+
+/*!
+ *  \brief  pointer arguments of kernels during training: each layer works on a small set of
+ *          tensors (sub-allocated inside the segments), which are referenced by its kernels
+ */
+static void generate_args(const std::vector<handle_t*>& handles, std::mt19937_64& rng, std::vector<uint64_t>& args){
+    std::uniform_int_distribution<uint64_t> segment_dist(0, handles.size() - 1);
+    std::uniform_int_distribution<uint64_t> pick_dist(0, kNbTensorsPerLayer - 1);
+    std::vector<std::vector<uint64_t>> layer_tensors(kNbLayers);
+    uint64_t layer, step, kernel, arg, segment;
+
+    for(layer=0; layer<kNbLayers; layer++){
+        for(arg=0; arg<kNbTensorsPerLayer; arg++){
+            segment = segment_dist(rng);
+            std::uniform_int_distribution<uint64_t> offset_dist(0, handles[segment]->size / 512 - 1);
+            layer_tensors[layer].push_back(handles[segment]->client_addr + offset_dist(rng) * 512);
+        }
+    }
+
+    for(step=0; step<kNbSteps; step++){
+        for(layer=0; layer<kNbLayers; layer++){
+            for(kernel=0; kernel<kNbKernelsPerLayer; kernel++){
+                for(arg=0; arg<kNbArgsPerKernel; arg++){
+                    args.push_back(layer_tensors[layer][pick_dist(rng)]);
+                }
+            }
+        }
+    }
+}
+
+static void run_lookup(uint64_t nb_segments){
+    std::mt19937_64 rng(nb_segments);
+    std::vector<handle_t*> handles;
+    std::vector<uint64_t> args;
+    std::map<uint64_t, handle_t*> map;
+    POSUtilRangeIndex<handle_t*> index;
+    uint64_t s_tick, e_tick, offset, nb_misses = 0, checksum_map = 0, checksum_index = 0;
+    handle_t *handle;
+    double map_ns, index_ns;
+
+    generate_segments(nb_segments, rng, handles);
+    generate_args(handles, rng, args);
+    for(auto h : handles){
+        map[h->client_addr] = h;
+        index.insert(h->client_addr, h->size, h);
+    }
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(uint64_t addr : args){
+        handle = map_lookup(map, addr, &offset);
+        if(unlikely(handle == nullptr)){ nb_misses += 1; continue; }
+        checksum_map += (uint64_t)(handle) + offset;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    map_ns = tsc_timer.tick_to_us(e_tick - s_tick) * 1000 / args.size();
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(uint64_t addr : args){
+        if(unlikely(POS_SUCCESS != index.lookup(addr, &handle, &offset))){ nb_misses += 1; continue; }
+        checksum_index += (uint64_t)(handle) + offset;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    index_ns = tsc_timer.tick_to_us(e_tick - s_tick) * 1000 / args.size();
+
+    printf(
+        "[lookup] #buffers(%5lu): map %6.2f ns, index %6.2f ns, speedup %5.2fx, #misses %lu, %s\n",
+        nb_segments, map_ns, index_ns, map_ns / index_ns, nb_misses,
+        checksum_map == checksum_index ? "consistent" : "INCONSISTENT"
+    );
+
+    for(auto h : handles){ delete h; }
+}
+
+/*!
+ *  \brief  cudaFree a random buffer and cudaMalloc a new one, which is mostly placed at
+ *          the end of the address space, or occasionally reuses a freed hole
+ */
+static void run_churn(uint64_t nb_segments){
+    std::mt19937_64 rng(nb_segments);
+    std::vector<handle_t*> handles;
+    std::map<uint64_t, handle_t*> map;
+    POSUtilRangeIndex<handle_t*> index;
+    std::vector<std::pair<uint64_t, uint64_t>> ops;
+    uint64_t i, s_tick, e_tick, victim, next_addr;
+    std::uniform_int_distribution<uint64_t> victim_dist(0, nb_segments - 1), reuse_dist(0, 9);
+    handle_t *removed;
+    double map_ns, index_ns;
+
+    generate_segments(nb_segments, rng, handles);
+    for(auto h : handles){
+        map[h->client_addr] = h;
+        index.insert(h->client_addr, h->size, h);
+    }
+
+    // precompute the freed / allocated addresses, so both structures replay the same trace
+    next_addr = handles.back()->client_addr + handles.back()->size;
+    for(i=0; i<kNbChurnOps; i++){
+        victim = victim_dist(rng);
+        ops.push_back({ handles[victim]->client_addr, 0 });
+        if(reuse_dist(rng) < 3){
+            ops.back().second = handles[victim]->client_addr;   // reuse the hole
+        } else {
+            ops.back().second = next_addr;
+            next_addr += handles[victim]->size;
+        }
+        handles[victim]->client_addr = ops.back().second;
+    }
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(auto& op : ops){
+        auto iter = map.find(op.first);
+        POS_ASSERT(iter != map.end());
+        removed = iter->second;
+        map.erase(iter);
+        map[op.second] = removed;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    map_ns = tsc_timer.tick_to_us(e_tick - s_tick) * 1000 / kNbChurnOps;
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(auto& op : ops){
+        POS_ASSERT(POS_SUCCESS == index.erase(op.first, &removed));
+        index.insert(op.second, removed->size, removed);
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    index_ns = tsc_timer.tick_to_us(e_tick - s_tick) * 1000 / kNbChurnOps;
+
+    printf(
+        "[churn ] #buffers(%5lu): map %6.2f ns, index %6.2f ns per free + malloc\n",
+        nb_segments, map_ns, index_ns
+    );
+
+    for(auto h : handles){ delete h; }
+}
+
+int main(){
+    for(uint64_t nb_segments : { 1000ul, 4000ul, 16000ul }){
+        run_lookup(nb_segments);
+    }
+    for(uint64_t nb_segments : { 1000ul, 4000ul, 16000ul }){
+        run_churn(nb_segments);
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include <stdint.h>
+#include <malloc.h>
+
+#include "pos/include/common.h"
+#include "pos/include/handle.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/range_index.h"
+
+constexpr uint64_t kNbLookups = 2000000;    // number of lookups
+constexpr uint64_t kBufferSize = 1 << 16;   // size of each buffer
+
+static POSUtilTscTimer tsc_timer;
+
+
+/*!
+ *  \brief  minimal handle type, the same way as those platform-specific handles
+ */
+class POSHandle_Bench final : public POSHandle {
+ public:
+    POSHandle_Bench(void *client_addr_, size_t size_, void* hm, pos_u64id_t id_, size_t state_size_)
+        : POSHandle(client_addr_, size_, hm, id_, state_size_) {}
+    POSHandle_Bench(size_t size_, void* hm, pos_u64id_t id_, size_t state_size_=0)
+        : POSHandle(size_, hm, id_, state_size_) {}
+    POSHandle_Bench(void* hm) : POSHandle(hm) {}
+
+    std::string get_resource_name(){ return std::string("Bench"); }
+
+ protected:
+    friend class POSHandleManager<POSHandle_Bench>;
+    pos_retval_t __restore() override { return POS_SUCCESS; }
+};
+
+
+class POSHandleManager_Bench : public POSHandleManager<POSHandle_Bench> {
+ public:
+    POSHandleManager_Bench() : POSHandleManager<POSHandle_Bench>(/* passthrough */ false) {}
+};
+
+
+static inline uint64_t get_heap_bytes(){
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+
+static void run(uint64_t nb_handles){
+    std::mt19937_64 rng(nb_handles);
+    std::uniform_int_distribution<uint64_t> handle_dist(0, nb_handles - 1), offset_dist(0, kBufferSize - 1);
+    std::vector<POSHandle_Bench*> heap_handles;
+    std::vector<uint64_t> addrs;
+    POSUtilRangeIndex<POSHandle_Bench*> heap_index;
+    POSHandleManager_Bench *hm;
+    POSHandle_Bench *handle;
+    uint64_t i, s_bytes, heap_bytes, slab_bytes, s_tick, e_tick, offset, checksum_heap = 0, checksum_slab = 0;
+    double heap_ns, slab_ns;
+
+    // previous: handles are individually allocated, and the index points to the handle objects
+    s_bytes = get_heap_bytes();
+    for(i=0; i<nb_handles; i++){
+        POS_CHECK_POINTER(handle = new POSHandle_Bench(
+            /* client_addr */ (void*)(kPOS_ResourceBaseAddr + i * kBufferSize), kBufferSize, nullptr, i, kBufferSize
+        ));
+        handle->status = kPOS_HandleStatus_Active;
+        heap_handles.push_back(handle);
+    }
+    for(auto h : heap_handles){ heap_index.insert((uint64_t)(h->client_addr), h->size, h); }
+    heap_bytes = get_heap_bytes() - s_bytes;
+
+    // now: handles are created from the slab of the handle manager, with hot metadata mirrored
+    s_bytes = get_heap_bytes();
+    POS_CHECK_POINTER(hm = new POSHandleManager_Bench());
+    for(i=0; i<nb_handles; i++){
+        POS_ASSERT(POS_SUCCESS == hm->allocate_mocked_resource(&handle, {}, kBufferSize));
+        hm->mark_handle_status(handle, kPOS_HandleStatus_Active);
+    }
+    slab_bytes = get_heap_bytes() - s_bytes;
+
+    // random lookups over all handles, as a large working set defeats the recent-hit cache
+    for(i=0; i<kNbLookups; i++){
+        addrs.push_back(kPOS_ResourceBaseAddr + handle_dist(rng) * kBufferSize + offset_dist(rng));
+    }
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(uint64_t addr : addrs){
+        POS_ASSERT(POS_SUCCESS == heap_index.lookup(addr, &handle, &offset));
+        POS_ASSERT(handle->status != kPOS_HandleStatus_Deleted && handle->status != kPOS_HandleStatus_Delete_Pending);
+        checksum_heap += offset;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    heap_ns = tsc_timer.tick_to_us(e_tick - s_tick) * 1000 / kNbLookups;
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    for(uint64_t addr : addrs){
+        POS_ASSERT(POS_SUCCESS == hm->get_handle_by_client_addr((void*)addr, &handle, &offset));
+        checksum_slab += offset;
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+    slab_ns = tsc_timer.tick_to_us(e_tick - s_tick) * 1000 / kNbLookups;
+
+    // both paths should resolve the same handle
+    for(i=0; i<kNbLookups; i+=97){
+        POS_ASSERT(POS_SUCCESS == heap_index.lookup(addrs[i], &handle));
+        checksum_heap += handle->id;
+        POS_ASSERT(POS_SUCCESS == hm->get_handle_by_client_addr((void*)(addrs[i]), &handle));
+        checksum_slab += handle->id;
+    }
+
+    printf(
+        "[memory] #handles(%6lu): sizeof(handle) %lu bytes, heap + index %6.1f bytes/handle, slab + hot metadata + index %6.1f bytes/handle\n",
+        nb_handles, sizeof(POSHandle_Bench), (double)heap_bytes / nb_handles, (double)slab_bytes / nb_handles
+    );
+    printf(
+        "[lookup] #handles(%6lu): heap %6.2f ns (%5.2f Mlookups/s), slab + hot metadata %6.2f ns (%5.2f Mlookups/s), %s\n",
+        nb_handles, heap_ns, 1000.0 / heap_ns, slab_ns, 1000.0 / slab_ns,
+        checksum_heap == checksum_slab ? "consistent" : "INCONSISTENT"
+    );
+
+    for(auto h : heap_handles){ delete h; }
+    delete hm;
+}
+
+int main(){
+    for(uint64_t nb_handles : { 100000ul, 400000ul }){
+        run(nb_handles);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <stdint.h>
+#include <sched.h>
+
+#include "pos/include/common.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/futex.h"
+#include "pos/include/utils/lockfree_queue.h"
+
+constexpr uint64_t kNbElements = 10000000;     // number of elements passed from parser to worker
+constexpr uint64_t kBoundedLen = 4096;         // capacity of the bounded queue
+
+struct wqe_t {
+    uint64_t seq;
+};
+
+static POSUtilTscTimer tsc_timer;
+
+static void producer_func(POSLockFreeQueue<wqe_t*> *q, wqe_t *wqes, uint64_t *nb_full){
+    uint64_t i;
+    for(i=0; i<kNbElements; i++){
+        // the bounded queue back-pressures the producer once it's full, as POSWorkspace::__submit_wqe does
+        while(q->push(&wqes[i]) == POS_FAILED_NOT_READY){
+            *nb_full += 1;
+            sched_yield();
+        }
+    }
+}
+
+/*!
+ *  \brief  pass elements from the producer (parser) to the consumer (worker)
+ *  \param  batch       maximum number of elements per dequeue, 0 for dequeuing one-by-one into a
+ *                      std::vector (i.e., the previous POSClient::poll_q)
+ *  \param  capacity    capacity of the queue, 0 for unbounded
+ */
+static void run(uint64_t batch, uint64_t capacity){
+    uint64_t i, nb, nb_consumed = 0, nb_polls = 0, nb_full = 0, nb_disorders = 0, s_tick, e_tick;
+    wqe_t *wqes, *wqe;
+    POSLockFreeQueue<wqe_t*> q(capacity);
+    std::vector<wqe_t*> vec;
+    wqe_t* arr[256];
+
+    POS_CHECK_POINTER(wqes = new wqe_t[kNbElements]);
+    for(i=0; i<kNbElements; i++){ wqes[i].seq = i; }
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    std::thread producer(producer_func, &q, wqes, &nb_full);
+
+    while(nb_consumed < kNbElements){
+        if(batch == 0){
+            vec.clear();
+            while(q.dequeue(wqe) == POS_SUCCESS){ vec.push_back(wqe); }
+            nb = vec.size();
+            for(i=0; i<nb; i++){
+                if(unlikely(vec[i]->seq != nb_consumed + i)){ nb_disorders++; }
+            }
+        } else {
+            nb = q.dequeue_bulk(arr, batch);
+            for(i=0; i<nb; i++){
+                if(unlikely(arr[i]->seq != nb_consumed + i)){ nb_disorders++; }
+            }
+        }
+        nb_consumed += nb;
+        nb_polls += (nb > 0);
+
+        // hand the CPU to the producer while the queue is empty
+        if(nb == 0){ sched_yield(); }
+    }
+
+    producer.join();
+    e_tick = POSUtilTscTimer::get_tsc();
+
+    printf(
+        "[%-9s] batch(%3lu): throughput %7.2f Mops, elements/poll %7.2f, #full %9lu, #disorders %lu\n",
+        capacity > 0 ? "bounded" : "unbounded",
+        batch,
+        (double)kNbElements / tsc_timer.tick_to_us(e_tick - s_tick),
+        nb_polls > 0 ? (double)kNbElements / nb_polls : 0,
+        nb_full,
+        nb_disorders
+    );
+
+    delete[] wqes;
+}
+
+int main(){
+    for(uint64_t capacity : { (uint64_t)0, kBoundedLen }){
+        run(0, capacity);
+        for(uint64_t batch : { 1ul, 8ul, 32ul, 64ul, 256ul }){
+            run(batch, capacity);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <thread>
+#include <filesystem>
+#include <system_error>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+#include "pos/include/handle.h"
+#include "pos/include/persist_pool.h"
+#include "pos/include/checkpoint.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/proto/handle.pb.h"
+
+constexpr uint64_t kNbLargeHandles = 16;        // number of large handles (e.g., weights / activations)
+constexpr uint64_t kMinSmallSize = 64;          // minimum state size of small handles
+constexpr uint64_t kMaxSmallSize = 4ul << 10;   // maximum state size of small handles
+constexpr uint64_t kMinLargeSize = 4ul << 20;   // minimum state size of large handles
+constexpr uint64_t kMaxLargeSize = 16ul << 20;  // maximum state size of large handles
+
+static POSUtilTscTimer tsc_timer;
+
+
+/*!
+ *  \brief  synthetic handle with a host-side checkpoint slot, persisted the same way as
+ *          those platform-specific handles
+ */
+class POSHandle_Bench final : public POSHandle {
+ public:
+    POSHandle_Bench(size_t size_, void* hm, pos_u64id_t id_, size_t state_size_)
+        : POSHandle(size_, hm, id_, state_size_), _ckpt_slot(nullptr)
+    {
+        this->status = kPOS_HandleStatus_Active;
+        if(state_size_ > 0){
+            POS_CHECK_POINTER(this->_ckpt_slot = new POSCheckpointSlot(
+                state_size_, nullptr, nullptr, kPOS_CkptSlotPosition_Host, kPOS_CkptStateType_Host
+            ));
+            memset(this->_ckpt_slot->expose_pointer(), id_ & 0xff, state_size_);
+        }
+    }
+    ~POSHandle_Bench(){ if(this->_ckpt_slot != nullptr){ delete this->_ckpt_slot; } }
+
+    std::string get_resource_name(){ return std::string("Bench"); }
+
+ protected:
+    pos_retval_t __restore() override { return POS_SUCCESS; }
+
+    pos_retval_t __get_checkpoint_slot_for_persist(POSCheckpointSlot** ckpt_slot, uint64_t version_id) override {
+        *ckpt_slot = this->_ckpt_slot;
+        return this->_ckpt_slot != nullptr ? POS_SUCCESS : POS_FAILED_NOT_EXIST;
+    }
+
+    pos_retval_t __generate_protobuf_binary(google::protobuf::Message** binary, google::protobuf::Message** base_binary) override {
+        pos_protobuf::Bin_POSHandle *handle_binary;
+        POS_CHECK_POINTER(handle_binary = new pos_protobuf::Bin_POSHandle());
+        *binary = handle_binary;
+        *base_binary = handle_binary;
+        return POS_SUCCESS;
+    }
+
+ private:
+    POSCheckpointSlot *_ckpt_slot;
+};
+
+
+/*!
+ *  \brief  persist all handles into the given directory
+ *  \param  handles     handles to be persisted
+ *  \param  ckpt_dir    directory to store the checkpoint files
+ *  \param  pool        persist pool, nullptr for raising one thread per handle (previous approach)
+ *  \param  nb_failed   number of handles that failed to raise their threads
+ *  \return duration (ms)
+ */
+static double run(std::vector<POSHandle_Bench*>& handles, const std::string& ckpt_dir, POSPersistPool* pool, uint64_t& nb_failed){
+    std::vector<std::thread*> threads;
+    POSPersistGroup group;
+    uint64_t s_tick, e_tick;
+
+    nb_failed = 0;
+    std::filesystem::remove_all(ckpt_dir);
+    std::filesystem::create_directories(ckpt_dir);
+
+    s_tick = POSUtilTscTimer::get_tsc();
+    if(pool == nullptr){
+        for(POSHandle_Bench *handle : handles){
+            try {
+                threads.push_back(new std::thread([handle, &ckpt_dir](){
+                    POS_ASSERT(POS_SUCCESS == handle->checkpoint_persist_sync(ckpt_dir, /* with_state */ true, /* version_id */ 0));
+                }));
+            } catch (const std::system_error& e) {
+                // the process runs out of threads, as what the previous approach did on large models
+                nb_failed += 1;
+            }
+        }
+        for(std::thread *thread : threads){
+            thread->join();
+            delete thread;
+        }
+    } else {
+        for(POSHandle_Bench *handle : handles){
+            POS_ASSERT(POS_SUCCESS == handle->checkpoint_persist_async(
+                ckpt_dir, /* with_state */ true, /* version_id */ 0, pool, &group
+            ));
+        }
+        POS_ASSERT(POS_SUCCESS == group.wait());
+        POS_ASSERT(group.get_nb_done() == handles.size());
+        for(POSHandle_Bench *handle : handles){ POS_ASSERT(POS_SUCCESS == handle->sync_persist()); }
+    }
+    e_tick = POSUtilTscTimer::get_tsc();
+
+    return tsc_timer.tick_to_ms(e_tick - s_tick);
+}
+
+
+int main(){
+    POSPersistPool pool(POS_PERSIST_POOL_NB_THREADS);
+    std::string ckpt_dir = std::filesystem::temp_directory_path().string() + std::string("/pos_persist_pool_bench");
+    std::vector<POSHandle_Bench*> handles;
+    uint64_t i, nb_bytes, nb_thread_failed, nb_pool_failed;
+    double thread_ms, pool_ms;
+
+    for(uint64_t nb_handles : { 10000ul, 50000ul, 100000ul }){
+        std::mt19937_64 rng(nb_handles);
+        std::uniform_int_distribution<uint64_t> small_dist(kMinSmallSize, kMaxSmallSize), large_dist(kMinLargeSize, kMaxLargeSize);
+
+        nb_bytes = 0;
+        for(i=0; i<nb_handles; i++){
+            handles.push_back(new POSHandle_Bench(
+                /* size_ */ 0, /* hm */ nullptr, /* id_ */ i,
+                /* state_size_ */ i < kNbLargeHandles ? large_dist(rng) : small_dist(rng)
+            ));
+            nb_bytes += handles.back()->state_size;
+        }
+
+        thread_ms = run(handles, ckpt_dir, nullptr, nb_thread_failed);
+        pool_ms = run(handles, ckpt_dir, &pool, nb_pool_failed);
+        POS_ASSERT(nb_pool_failed == 0);
+
+        printf(
+            "#handles(%6lu), state %7.1f MB: thread-per-handle %9.2f ms (#failed spawns %6lu), pool(%u threads) %9.2f ms\n",
+            nb_handles, (double)nb_bytes / (1 << 20), thread_ms, nb_thread_failed, pool.get_nb_threads(), pool_ms
+        );
+
+        for(POSHandle_Bench *handle : handles){ delete handle; }
+        handles.clear();
+    }
+
+    std::filesystem::remove_all(ckpt_dir);
+    return 0;
+}
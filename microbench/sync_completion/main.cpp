@@ -0,0 +1,189 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include <stdint.h>
+#include <time.h>
+
+#include "pos/include/common.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/futex.h"
+#include "pos/include/utils/lockfree_queue.h"
+
+constexpr uint64_t kJobDurationUs = 20;     // emulated duration of a sync call (e.g., small D2H cudaMemcpy)
+constexpr uint64_t kRunDurationMs = 2000;   // duration of each test case
+constexpr uint64_t kSpinInitUs = 20;
+constexpr uint64_t kSpinMinUs = 2;
+constexpr uint64_t kSpinMaxUs = 200;
+
+enum wait_mode_t : uint8_t {
+    kWaitMode_Spin = 0,     // RPC thread spins on the completion queue (previous behaviour)
+    kWaitMode_SpinPark      // RPC thread spins for an adaptive budget on the WQE, then parks
+};
+
+struct job_t {
+    uint64_t id;
+    POSCompletion completion;
+};
+
+/*!
+ *  \brief  context of an emulated client, which contains a RPC thread and a worker thread
+ */
+struct client_t {
+    POSLockFreeQueue<job_t*> wq;
+    POSLockFreeQueue<job_t*> cq;
+
+    // doorbell of the worker, the worker parks on it when the wq is empty
+    std::atomic<uint32_t> doorbell;
+
+    std::atomic<bool> stop;
+
+    // statistics of the RPC thread
+    uint64_t nb_calls;
+    uint64_t nb_parks;
+    double sum_latency_us;
+    double cpu_us;
+    double wall_us;
+
+    client_t() : doorbell(0), stop(false), nb_calls(0), nb_parks(0), sum_latency_us(0), cpu_us(0), wall_us(0) {}
+};
+
+static POSUtilTscTimer tsc_timer;
+
+static inline double get_thread_cpu_us(){
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void worker_func(client_t *client, wait_mode_t mode){
+    job_t *job;
+    uint32_t doorbell;
+    struct timespec job_duration = { .tv_sec = 0, .tv_nsec = kJobDurationUs * 1000 };
+
+    while(client->stop.load(std::memory_order_relaxed) == false){
+        doorbell = client->doorbell.load(std::memory_order_acquire);
+        if(client->wq.dequeue(job) != POS_SUCCESS){
+            pos_futex_wait(&client->doorbell, doorbell);
+            continue;
+        }
+
+        // the device is executing the job, the worker doesn't occupy the CPU
+        nanosleep(&job_duration, nullptr);
+
+        if(mode == kWaitMode_Spin){
+            client->cq.push(job);
+        } else {
+            job->completion.complete();
+        }
+    }
+}
+
+static void rpc_func(client_t *client, wait_mode_t mode){
+    job_t job, *cqe;
+    uint64_t i, s_tick, e_tick, end_tick;
+    uint64_t spin_ticks, spin_min_ticks, spin_max_ticks;
+    double s_cpu_us;
+
+    spin_ticks = tsc_timer.us_to_tick(kSpinInitUs);
+    spin_min_ticks = tsc_timer.us_to_tick(kSpinMinUs);
+    spin_max_ticks = tsc_timer.us_to_tick(kSpinMaxUs);
+
+    s_cpu_us = get_thread_cpu_us();
+    s_tick = POSUtilTscTimer::get_tsc();
+    end_tick = s_tick + tsc_timer.ms_to_tick(kRunDurationMs);
+
+    for(i=0; POSUtilTscTimer::get_tsc() < end_tick; i++){
+        job.id = i;
+        job.completion.reset();
+
+        e_tick = POSUtilTscTimer::get_tsc();
+        client->wq.push(&job);
+        client->doorbell.fetch_add(1, std::memory_order_release);
+        pos_futex_wake(&client->doorbell, 1);
+
+        if(mode == kWaitMode_Spin){
+            // scan the completion queue until the issued job shows up
+            for(;;){
+                if(client->cq.dequeue(cqe) == POS_SUCCESS && cqe->id == i){ break; }
+                pos_cpu_relax();
+            }
+        } else {
+            if(job.completion.wait(spin_ticks, spin_min_ticks, spin_max_ticks)){
+                client->nb_parks += 1;
+            }
+        }
+
+        client->sum_latency_us += tsc_timer.tick_to_us(POSUtilTscTimer::get_tsc() - e_tick);
+        client->nb_calls += 1;
+    }
+
+    client->wall_us = tsc_timer.tick_to_us(POSUtilTscTimer::get_tsc() - s_tick);
+    client->cpu_us = get_thread_cpu_us() - s_cpu_us;
+
+    client->stop.store(true, std::memory_order_relaxed);
+    client->doorbell.fetch_add(1, std::memory_order_release);
+    pos_futex_wake(&client->doorbell, 1);
+}
+
+static void run(uint64_t nb_clients, wait_mode_t mode){
+    uint64_t i, nb_calls = 0, nb_parks = 0;
+    double sum_latency_us = 0, cpu_util = 0;
+    std::vector<client_t*> clients;
+    std::vector<std::thread> threads;
+
+    for(i=0; i<nb_clients; i++){
+        clients.push_back(new client_t());
+        POS_CHECK_POINTER(clients.back());
+    }
+    for(i=0; i<nb_clients; i++){
+        threads.emplace_back(worker_func, clients[i], mode);
+        threads.emplace_back(rpc_func, clients[i], mode);
+    }
+    for(auto& thread : threads){ thread.join(); }
+
+    for(i=0; i<nb_clients; i++){
+        nb_calls += clients[i]->nb_calls;
+        nb_parks += clients[i]->nb_parks;
+        sum_latency_us += clients[i]->sum_latency_us;
+        cpu_util += clients[i]->cpu_us / clients[i]->wall_us;
+        delete clients[i];
+    }
+
+    printf(
+        "[%-9s] clients(%2lu): latency %8.2f us, rpc cpu %6.2f%%/client, %6.2f cores in total, park ratio %6.2f%%\n",
+        mode == kWaitMode_Spin ? "spin" : "spin-park",
+        nb_clients,
+        nb_calls > 0 ? sum_latency_us / nb_calls : 0,
+        cpu_util / nb_clients * 100,
+        cpu_util,
+        nb_calls > 0 ? (double)nb_parks / nb_calls * 100 : 0
+    );
+}
+
+int main(){
+    for(uint64_t nb_clients : { 1ul, 8ul, 32ul }){
+        run(nb_clients, kWaitMode_Spin);
+        run(nb_clients, kWaitMode_SpinPark);
+    }
+
+    return 0;
+}
@@ -44,6 +44,7 @@ enum pos_cli_arg : int {
     kPOS_CliAction_PreRestore,
     kPOS_CliAction_Clean,
     kPOS_CliAction_TraceResource,
+    kPOS_CliAction_TracePerformance,
     kPOS_CliAction_Migrate,
     kPOS_CliAction_PLACEHOLDER,
 
@@ -93,6 +94,9 @@ static std::string pos_cli_action_name(pos_cli_arg action_type){
     case kPOS_CliAction_TraceResource:
         return "trace-resource";
 
+    case kPOS_CliAction_TracePerformance:
+        return "trace-performance";
+
     case kPOS_CliAction_Migrate:
         return "migrate";
 
@@ -123,6 +127,10 @@ typedef struct pos_cli_trace_resource_metas {
     char trace_dir[oob_functions::cli_trace_resource::kTraceFilePathMaxLen];
 } pos_cli_trace_resource_metas_t;
 
+typedef struct pos_cli_trace_performance_metas {
+    char trace_dir[oob_functions::cli_trace_performance::kTraceFilePathMaxLen];
+} pos_cli_trace_performance_metas_t;
+
 
 typedef struct pos_cli_migrate_metas {
     uint64_t pid;
@@ -152,6 +160,7 @@ typedef struct pos_cli_options {
         pos_cli_ckpt_metas_t ckpt;
         pos_cli_migrate_metas_t migrate;
         pos_cli_trace_resource_metas_t trace_resource;
+        pos_cli_trace_performance_metas_t trace_performance;
         pos_cli_start_metas_t start;
     } metas;
 
@@ -216,5 +225,6 @@ pos_retval_t handle_predump(pos_cli_options_t &clio);
 pos_retval_t handle_dump(pos_cli_options_t &clio);
 pos_retval_t handle_migrate(pos_cli_options_t &clio);
 pos_retval_t handle_trace(pos_cli_options_t &clio);
+pos_retval_t handle_trace_performance(pos_cli_options_t &clio);
 pos_retval_t handle_restore(pos_cli_options_t &clio);
 pos_retval_t handle_start(pos_cli_options_t &clio);
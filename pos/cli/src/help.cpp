@@ -118,7 +118,12 @@ pos_retval_t handle_help(pos_cli_options_t &clio){
         << "    --subaction <act>   subaction to control the trace behaviour, either 'start' or 'stop'"
         << "     --pid <pid>        PID of the process to be traced\n"
         << "\n"
-        << "     e.g., for starting trace, 'pos_cli --trace-resource --subaction=start --pid=23491'\n";
+        << "     e.g., for starting trace, 'pos_cli --trace-resource --subaction=start --pid=23491'\n"
+        << "\n"
+        << "--trace-performance:    dump per-API latency histograms (queueing / parse / worker / end-to-end) and live WQEs of all clients\n"
+        << "    --dir <dir>         directory to store the latency report\n"
+        << "\n"
+        << "     e.g., 'pos_cli --trace-performance --dir=./trace'\n";
 
     helper_message_shell    << "FORMAT: pos_cli --ACTION [--METADATA --VALUE]\n"
                             << "\n"
@@ -58,7 +58,7 @@ inline void __readin_raw_cli(int argc, char *argv[], pos_cli_options_t &clio){
 
     sprintf(
         short_opt,
-        /* action */    "%d%d%d%d%d%d%d%d%d"
+        /* action */    "%d%d%d%d%d%d%d%d%d%d"
         /* meta */      "%d:%d:%d:%d:%d:%d:%d:",
         kPOS_CliAction_Help,
         kPOS_CliAction_Start,
@@ -69,6 +69,7 @@ inline void __readin_raw_cli(int argc, char *argv[], pos_cli_options_t &clio){
         kPOS_CliAction_Clean,
         kPOS_CliAction_Migrate,
         kPOS_CliAction_TraceResource,
+        kPOS_CliAction_TracePerformance,
         kPOS_CliMeta_Target,
         kPOS_CliMeta_SkipTarget,
         kPOS_CliMeta_SubAction,
@@ -89,6 +90,7 @@ inline void __readin_raw_cli(int argc, char *argv[], pos_cli_options_t &clio){
         {"clean",           no_argument,        NULL,   kPOS_CliAction_Clean},
         {"migrate",         no_argument,        NULL,   kPOS_CliAction_Migrate},
         {"trace-resource",  no_argument,        NULL,   kPOS_CliAction_TraceResource},
+        {"trace-performance",   no_argument,    NULL,   kPOS_CliAction_TracePerformance},
 
         // metadatas (with param)
         {"target",      required_argument,  NULL,   kPOS_CliMeta_Target},
@@ -139,6 +141,9 @@ inline pos_retval_t __dispatch(pos_cli_options_t &clio){
     case kPOS_CliAction_TraceResource:
         return handle_trace(clio);
 
+    case kPOS_CliAction_TracePerformance:
+        return handle_trace_performance(clio);
+
     case kPOS_CliAction_Start:
         return handle_start(clio);
 
@@ -156,6 +161,7 @@ namespace oob_functions {
     POS_OOB_DECLARE_CLNT_FUNCTIONS(cli_ckpt_dump);
     POS_OOB_DECLARE_CLNT_FUNCTIONS(cli_restore);
     POS_OOB_DECLARE_CLNT_FUNCTIONS(cli_trace_resource);
+    POS_OOB_DECLARE_CLNT_FUNCTIONS(cli_trace_performance);
 }; // namespace oob_functions
 
 
@@ -171,6 +177,7 @@ int main(int argc, char *argv[]){
             {   kPOS_OOB_Msg_CLI_Ckpt_Dump,         oob_functions::cli_ckpt_dump::clnt          },
             {   kPOS_OOB_Msg_CLI_Restore,           oob_functions::cli_restore::clnt            },
             {   kPOS_OOB_Msg_CLI_Trace_Resource,    oob_functions::cli_trace_resource::clnt     },
+            {   kPOS_OOB_Msg_CLI_Trace_Performance, oob_functions::cli_trace_performance::clnt  },
         },
         /* local_port */ 10086,
         /* local_ip */ CLIENT_IP
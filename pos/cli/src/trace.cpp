@@ -107,3 +107,57 @@ pos_retval_t handle_trace(pos_cli_options_t &clio){
 
     return retval;
 }
+
+
+pos_retval_t handle_trace_performance(pos_cli_options_t &clio){
+    pos_retval_t retval = POS_SUCCESS;
+    oob_functions::cli_trace_performance::oob_call_data_t call_data;
+
+    validate_and_cast_args(
+        /* clio */ clio, 
+        /* rules */ {
+            {
+                /* meta_type */ kPOS_CliMeta_Dir,
+                /* meta_name */ "dir",
+                /* meta_desp */ "directory to store the latency report",
+                /* cast_func */ [](pos_cli_options_t &clio, std::string& meta_val) -> pos_retval_t {
+                    pos_retval_t retval = POS_SUCCESS;
+                    if(meta_val.size() >= oob_functions::cli_trace_performance::kTraceFilePathMaxLen){
+                        POS_WARN(
+                            "trace dir path too long: given(%lu), expected_max(%lu)",
+                            meta_val.size(),
+                            oob_functions::cli_trace_performance::kTraceFilePathMaxLen
+                        );
+                        retval = POS_FAILED_INVALID_INPUT;
+                        goto exit;
+                    }
+                    memset(clio.metas.trace_performance.trace_dir, 0, oob_functions::cli_trace_performance::kTraceFilePathMaxLen);
+                    memcpy(clio.metas.trace_performance.trace_dir, meta_val.c_str(), meta_val.size());
+                exit:
+                    return retval;
+                },
+                /* is_required */ true
+            }
+        },
+        /* collapse_rule */ [](pos_cli_options_t& clio) -> pos_retval_t {
+            pos_retval_t retval = POS_SUCCESS;
+            return retval;
+        }
+    );
+
+    // send dump latency request
+    memcpy(
+        call_data.trace_dir,
+        clio.metas.trace_performance.trace_dir,
+        oob_functions::cli_trace_performance::kTraceFilePathMaxLen
+    );
+
+    retval = clio.local_oob_client->call(kPOS_OOB_Msg_CLI_Trace_Performance, &call_data);
+    if(POS_SUCCESS != call_data.retval){
+        POS_WARN("dump api latency failed, %s", call_data.retmsg);
+    } else {
+        POS_LOG("dump api latency done: %s", call_data.retmsg);
+    }
+
+    return retval;
+}
@@ -28,13 +28,7 @@
 #include "pos/include/api_context.h"
 
 #include "pos/cuda_impl/api_index.h"
-
-enum pos_cuda_library_id_t : uint8_t {
-    kPOS_CUDA_Library_Id_Runtime = 0,
-    kPOS_CUDA_Library_Id_Driver,
-    kPOS_CUDA_Library_Id_cuBLAS,
-    kPOS_CUDA_Library_Id_Remoting
-};
+#include "pos/cuda_impl/api_library.h"
 
 /*!
  *  \brief  manager of CUDA APIs
@@ -434,6 +428,8 @@ class POSApiManager_CUDA : public POSApiManager {
      *  \param  pos_retval the POS retval to be translated
      *  \param  library_id  id of the destination library (e.g., cuda rt, driver, cublas)
      */
+    uint8_t get_default_library_id() override { return kPOS_CUDA_Library_Id_Runtime; }
+
     int cast_pos_retval(pos_retval_t pos_retval, uint8_t library_id) override {
         switch (pos_retval)
         {
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*!
+ *  \brief  id of the CUDA library that an API belongs to, shared by the hand-written and
+ *          the generated api_context.h
+ */
+enum pos_cuda_library_id_t : uint8_t {
+    kPOS_CUDA_Library_Id_Runtime = 0,
+    kPOS_CUDA_Library_Id_Driver,
+    kPOS_CUDA_Library_Id_cuBLAS,
+    kPOS_CUDA_Library_Id_Remoting
+};
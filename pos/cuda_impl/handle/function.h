@@ -18,6 +18,8 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <cstdlib>
 
 #include <sys/resource.h>
@@ -27,6 +29,7 @@
 
 #include "pos/include/common.h"
 #include "pos/include/handle.h"
+#include "pos/include/api_context.h"
 #include "pos/cuda_impl/handle.h"
 #include "pos/cuda_impl/utils/fatbin.h"
 
@@ -35,6 +38,39 @@
 class POSHandleManager_CUDA_Function;
 
 
+/*!
+ *  \brief  maximum number of memoized launches per function, all memos of the function are
+ *          dropped once exceeded (e.g., a kernel keeps being launched with fresh buffers)
+ */
+#define POS_CUDA_LAUNCH_MEMO_MAX_NB_ENTRIES     256
+
+
+/*!
+ *  \brief  memoized parsing result of a kernel launch, keyed by the hash of all pointer-valued
+ *          arguments (i.e., input / inout / output pointer parameters and confirmed suspicious
+ *          parameters) and the stream of the launch
+ *  \note   the memo is only valid while both the memory and stream handle managers stay at the
+ *          same address epoch, i.e., no handle was added to / removed from their address indices
+ */
+typedef struct pos_cuda_launch_memo {
+    // client-side address of the stream
+    uint64_t stream_addr;
+
+    // values of all pointer-valued arguments, to verify the hit against hash collision
+    std::vector<uint64_t> arg_values;
+
+    // address epochs of the memory / stream handle managers when the memo was built
+    uint64_t memory_epoch;
+    uint64_t stream_epoch;
+
+    // resolved handles of the launch
+    POSHandle *stream_handle;
+    std::vector<POSHandleView_t> input_handle_views;
+    std::vector<POSHandleView_t> inout_handle_views;
+    std::vector<POSHandleView_t> output_handle_views;
+} pos_cuda_launch_memo_t;
+
+
 /*!
  *  \brief  handle for cuda function
  */
@@ -120,6 +156,9 @@ class POSHandle_CUDA_Function final : public POSHandle_CUDA {
 
     // cbank parameter size (p.s., what is this?)
     uint64_t cbank_param_size;
+
+    // memoized launches of this function, indexed by the hash of the launch (see pos_cuda_launch_memo_t)
+    std::unordered_map<uint64_t, pos_cuda_launch_memo_t> launch_memos;
     /* ======================== handle specific fields ======================= */
 
 
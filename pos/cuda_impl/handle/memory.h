@@ -29,10 +29,20 @@
 
 #include "pos/include/common.h"
 #include "pos/include/handle.h"
+#include "pos/include/utils/size_class_pool.h"
 #include "pos/cuda_impl/handle.h"
 #include "pos/cuda_impl/handle/device.h"
 
 
+/*!
+ *  \brief  maximum number of bytes cached by the pinned host pool and by the pool of each device
+ *          for checkpoint slots, released blocks beyond which are returned to CUDA directly
+ *  \note   cached device blocks are invisible to the application, so we keep the device cap small
+ */
+#define POS_CKPT_HOST_POOL_MAX_CACHED_BYTES     (16ul << 30)
+#define POS_CKPT_DEV_POOL_MAX_CACHED_BYTES      (1ul << 30)
+
+
 // forward declaration
 class POSHandleManager_CUDA_Memory;
 
@@ -82,14 +92,31 @@ class POSHandle_CUDA_Memory final : public POSHandle_CUDA {
     pos_retval_t tear_down() override;
 
 
+    /*!
+     *  \brief  obtain the process-wide pool of pinned host memory for checkpoint slots
+     *  \note   the pool is shared by all memory handles of all clients, so that slots released
+     *          by one handle / version can be reused by others
+     *  \return pointer to the pool
+     */
+    static POSUtilSizeClassPool* get_checkpoint_host_pool();
+
+
+    /*!
+     *  \brief  obtain the process-wide pool of device memory for checkpoint slots on the given device
+     *  \param  device_id   index of the device
+     *  \return pointer to the pool
+     */
+    static POSUtilSizeClassPool* get_checkpoint_dev_pool(int device_id);
+
+
     /* ==================== checkpoint add/commit/persist ==================== */
  protected:
     /*!
      *  \brief  allocator of the host-side checkpoint memory
+     *  \note   slots are served by the process-wide pinned host pool, as cudaMallocHost is slow
      *  \param  state_size  size of the area to store checkpoint
      */
     static void* __checkpoint_allocator(uint64_t state_size) {
-        cudaError_t cuda_rt_retval;
         void *ptr;
 
         if(unlikely(state_size == 0)){
@@ -97,10 +124,8 @@ class POSHandle_CUDA_Memory final : public POSHandle_CUDA {
             return nullptr;
         }
 
-        cuda_rt_retval = cudaMallocHost(&ptr, state_size);
-        if(unlikely(cuda_rt_retval != cudaSuccess)){
-            POS_WARN_DETAIL("failed cudaMallocHost, error: %d", cuda_rt_retval);
-            return nullptr;
+        if(unlikely(nullptr == (ptr = get_checkpoint_host_pool()->allocate(state_size)))){
+            POS_WARN_DETAIL("failed to allocate host-side checkpoint memory: state_size(%lu)", state_size);
         }
 
         return ptr;
@@ -112,11 +137,9 @@ class POSHandle_CUDA_Memory final : public POSHandle_CUDA {
      *  \param  data    pointer of the buffer to be deallocated
      */
     static void __checkpoint_deallocator(void* data){
-        cudaError_t cuda_rt_retval;
         if(likely(data != nullptr)){
-            cuda_rt_retval = cudaFreeHost(data);
-            if(unlikely(cuda_rt_retval != cudaSuccess)){
-                POS_WARN_DETAIL("failed cudaFreeHost, error: %d", cuda_rt_retval);
+            if(unlikely(POS_SUCCESS != get_checkpoint_host_pool()->deallocate(data))){
+                POS_WARN_DETAIL("failed to return host-side checkpoint memory to pool, this is a bug: data(%p)", data);
             }
         }
     }
@@ -124,10 +147,12 @@ class POSHandle_CUDA_Memory final : public POSHandle_CUDA {
 
     /*!
      *  \brief  allocator of the device-side checkpoint memory
+     *  \note   slots are served by the pool of current device
      *  \param  state_size  size of the area to store checkpoint
      */
     static void* __checkpoint_dev_allocator(uint64_t state_size) {
         cudaError_t cuda_rt_retval;
+        int device_id;
         void *ptr;
 
         if(unlikely(state_size == 0)){
@@ -135,26 +160,39 @@ class POSHandle_CUDA_Memory final : public POSHandle_CUDA {
             return nullptr;
         }
 
-        cuda_rt_retval = cudaMalloc(&ptr, state_size);
+        cuda_rt_retval = cudaGetDevice(&device_id);
         if(unlikely(cuda_rt_retval != cudaSuccess)){
-            POS_WARN_DETAIL("failed cudaMalloc, error: %d", cuda_rt_retval);
+            POS_WARN_DETAIL("failed cudaGetDevice, error: %d", cuda_rt_retval);
             return nullptr;
         }
 
+        if(unlikely(nullptr == (ptr = get_checkpoint_dev_pool(device_id)->allocate(state_size)))){
+            POS_WARN_DETAIL(
+                "failed to allocate device-side checkpoint memory: device_id(%d), state_size(%lu)",
+                device_id, state_size
+            );
+        }
+
         return ptr;
     }
 
 
     /*!
-     *  \brief  deallocator of the host-side checkpoint memory
+     *  \brief  deallocator of the device-side checkpoint memory
      *  \param  data    pointer of the buffer to be deallocated
      */
     static void __checkpoint_dev_deallocator(void* data){
         cudaError_t cuda_rt_retval;
+        cudaPointerAttributes attributes;
+
         if(likely(data != nullptr)){
-            cuda_rt_retval = cudaFree(data);
+            cuda_rt_retval = cudaPointerGetAttributes(&attributes, data);
             if(unlikely(cuda_rt_retval != cudaSuccess)){
-                POS_WARN_DETAIL("failed cudaFree, error: %d", cuda_rt_retval);
+                POS_WARN_DETAIL("failed cudaPointerGetAttributes, error: %d", cuda_rt_retval);
+                return;
+            }
+            if(unlikely(POS_SUCCESS != get_checkpoint_dev_pool(attributes.device)->deallocate(data))){
+                POS_WARN_DETAIL("failed to return device-side checkpoint memory to pool, this is a bug: data(%p)", data);
             }
         }
     }
@@ -47,7 +47,9 @@ int pos_destory_workspace_cuda(POSWorkspace_CUDA* pos_cuda_ws);
  *  \brief  execution the callback function of API with specified api_id
  *  \param  pos_cuda_ws pointer to the CUDA workspace
  *  \param  api_id      id of the API to be executed
- *  \param  uuid        uuid of the client
+ *  \param  uuid        uuid of the client (see pos_agent_get_uuid), frontends that don't
+ *                      piggyback the uuid pass 0, which is routed to the earliest
+ *                      registered client that is still alive
  *  \param  param_desps parameter descriptions, specifiaclly in pairs:
  *                      { pointer to the param, param length }
  *  \param  param_num   number of parameters
@@ -62,4 +64,28 @@ int pos_process(
 );
 
 
+/*!
+ *  \brief  submit a batch of API calls of the same client
+ *  \param  pos_cuda_ws pointer to the CUDA workspace
+ *  \param  uuid        uuid of the client (see pos_agent_get_uuid), frontends that don't
+ *                      piggyback the uuid pass 0, which is routed to the earliest
+ *                      registered client that is still alive
+ *  \param  call_desps  call descriptions, all calls are contiguously packed, each in form of:
+ *                      { api_id, pointer to the returned data, length of the returned data,
+ *                        param_num, pointer to param 0, param 0 length, ... },
+ *                      the returned data is written once the call is finished (i.e., before
+ *                      this function returns for sync calls), pass 0 for calls without one
+ *  \param  call_num    number of calls
+ *  \param  retvals     per-call return codes, should be able to contain call_num elements
+ *  \return 0 for all calls are successfully submitted; else for failed
+ */
+int pos_process_batch(
+    POSWorkspace_CUDA *pos_cuda_ws,
+    uint64_t uuid,
+    uint64_t *call_desps,
+    int call_num,
+    int *retvals
+);
+
+
 } // extern "C"
@@ -54,8 +54,6 @@ POSClient_CUDA::~POSClient_CUDA(){}
 
 pos_retval_t POSClient_CUDA::init_handle_managers(bool is_restoring){
     pos_retval_t retval = POS_SUCCESS;
-    std::vector<POSHandle_CUDA_Device*> device_handles;
-    std::vector<POSHandle_CUDA_Context*> context_handles;
 
     POSHandleManager_CUDA_Device *device_mgr;
     POSHandleManager_CUDA_Context *ctx_mgr;
@@ -68,6 +66,8 @@ pos_retval_t POSClient_CUDA::init_handle_managers(bool is_restoring){
     POSHandleManager_CUDA_Memory *memory_mgr;
 
     std::map<uint64_t, std::vector<POSHandle*>> related_handles;
+    std::string prewarm_spec;
+    std::vector<std::pair<uint64_t, uint64_t>> prewarm_blocks;
 
     auto __cast_to_base_handle_list = [](auto handle_list) -> std::vector<POSHandle*> {
         std::vector<POSHandle*> ret_list;
@@ -104,8 +104,7 @@ pos_retval_t POSClient_CUDA::init_handle_managers(bool is_restoring){
 
     // CUDA context handle manager
     related_handles.clear();
-    device_handles = device_mgr->get_handles();
-    related_handles.insert({ kPOS_ResourceTypeId_CUDA_Device, __cast_to_base_handle_list(device_handles) });
+    related_handles.insert({ kPOS_ResourceTypeId_CUDA_Device, __cast_to_base_handle_list(device_mgr->get_handles()) });
     POS_CHECK_POINTER(ctx_mgr = new POSHandleManager_CUDA_Context());
     if(unlikely(POS_SUCCESS != (
         retval = ctx_mgr->init(related_handles, is_restoring)
@@ -117,8 +116,7 @@ pos_retval_t POSClient_CUDA::init_handle_managers(bool is_restoring){
 
     // CUDA stream handle manager
     related_handles.clear();
-    context_handles = ctx_mgr->get_handles();
-    related_handles.insert({ kPOS_ResourceTypeId_CUDA_Context, __cast_to_base_handle_list(context_handles) });
+    related_handles.insert({ kPOS_ResourceTypeId_CUDA_Context, __cast_to_base_handle_list(ctx_mgr->get_handles()) });
     POS_CHECK_POINTER(stream_mgr = new POSHandleManager_CUDA_Stream());
     if(unlikely(POS_SUCCESS != (
         retval = stream_mgr->init(related_handles, is_restoring)
@@ -196,8 +194,7 @@ pos_retval_t POSClient_CUDA::init_handle_managers(bool is_restoring){
 
     // CUDA memory handle manager
     related_handles.clear();
-    context_handles = ctx_mgr->get_handles();
-    related_handles.insert({ kPOS_ResourceTypeId_CUDA_Context, __cast_to_base_handle_list(context_handles) });
+    related_handles.insert({ kPOS_ResourceTypeId_CUDA_Context, __cast_to_base_handle_list(ctx_mgr->get_handles()) });
     POS_CHECK_POINTER(memory_mgr = new POSHandleManager_CUDA_Memory());
     if(unlikely(POS_SUCCESS != (
         retval = memory_mgr->init(related_handles, is_restoring)
@@ -207,6 +204,28 @@ pos_retval_t POSClient_CUDA::init_handle_managers(bool is_restoring){
     }
     this->handle_managers[kPOS_ResourceTypeId_CUDA_Memory] = (POSHandleManager<POSHandle>*)(memory_mgr);
 
+#if POS_CONF_EVAL_CkptOptLevel > 0 || POS_CONF_EVAL_MigrOptLevel > 0
+    // prewarm the pinned host pool for checkpoint slots, so that the first checkpoint of
+    // this client won't wait on cudaMallocHost; the pool is process-wide, so blocks already
+    // cached (e.g., by previous clients) are counted in
+    retval = this->_ws->ws_conf.get(POSWorkspaceConf::kRuntimeCkptPoolPrewarm, prewarm_spec);
+    POS_ASSERT(retval == POS_SUCCESS);
+    if(!prewarm_spec.empty()){
+        if(unlikely(POS_SUCCESS != POSUtilSizeClassPool::parse_prewarm_spec(prewarm_spec, prewarm_blocks))){
+            POS_WARN_C("failed to parse checkpoint pool prewarm specification, skip prewarming: spec(%s)", prewarm_spec.c_str());
+        }
+        for(auto& block : prewarm_blocks){
+            if(unlikely(POS_SUCCESS != POSHandle_CUDA_Memory::get_checkpoint_host_pool()->prewarm(block.first, block.second))){
+                POS_WARN_C(
+                    "failed to prewarm checkpoint pool, first checkpoint might be slower: block_size(%lu), nb_blocks(%lu)",
+                    block.first, block.second
+                );
+                break;
+            }
+        }
+    }
+#endif
+
 exit:
     return retval;
 }
@@ -284,6 +303,9 @@ pos_retval_t POSClient_CUDA::persist_handles(bool with_state){
     for(i=0; i<wqes.size(); i++){
         POS_CHECK_POINTER(wqe = wqes[i]);
         wqe->persist</* with_params */ false, /* type */ ApiCxt_TypeId_Unexecuted>(apicxt_dir);
+
+        // drop the reference held by the trace queue
+        wqe->put_ref();
     }
 
     // dumping resources
@@ -291,9 +313,11 @@ pos_retval_t POSClient_CUDA::persist_handles(bool with_state){
         POS_CHECK_POINTER(
             hm = pos_get_client_typed_hm(this, handle_id, POSHandleManager<POSHandle>)
         );
-        for(i=0; i<hm->get_nb_handles(); i++){
-            POS_CHECK_POINTER(handle = hm->get_handle_by_id(i));
+        // iterate over a snapshot, as the parser might allocate new handles concurrently
+        for(POSHandle *snapshot_handle : hm->get_handles()){
+            if(unlikely((handle = snapshot_handle) == nullptr)){ continue; }
             if(with_state){
+                handle->begin_checkpoint_round();
                 retval = handle->checkpoint_commit_sync(handle->latest_version, /* stream_id */ 0);
                 if(unlikely(POS_SUCCESS != retval)){
                     POS_WARN_C("failed to commit the status of handle: rname(%s), hid(%u)", handle->get_resource_name().c_str(), handle->id);
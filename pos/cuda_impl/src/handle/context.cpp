@@ -181,11 +181,11 @@ pos_retval_t POSHandleManager_CUDA_Context::init(std::map<uint64_t, std::vector<
             continue;
         }        
     }
-    this->latest_used_handle = this->_handles[0];
+    this->latest_used_handle = this->get_handle_by_id(0);
 
     // here we need to bind this context to real device context,
     // which we have alreay created by workspace
-    for(i=0; i<this->_handles.size(); i++){
+    for(i=0; i<this->get_nb_handles(); i++){
         POS_CHECK_POINTER(ctx_handle = this->get_handle_by_id(i));
         if(unlikely(POS_SUCCESS != (
             retval = ctx_handle->__restore()
@@ -143,7 +143,7 @@ pos_retval_t POSHandleManager_CUDA_Device::init(std::map<uint64_t, std::vector<P
         }
         device_handle->mark_status(kPOS_HandleStatus_Active);
     }
-    this->latest_used_handle = this->_handles[0];
+    this->latest_used_handle = this->get_handle_by_id(0);
 
 exit:
     return retval;
@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <map>
+#include <mutex>
 
 #include <cuda.h>
 #include <cuda_runtime_api.h>
@@ -34,6 +35,61 @@ bool                        POSHandleManager_CUDA_Memory::has_finshed_reserved;
 const uint64_t              POSHandleManager_CUDA_Memory::reserved_vm_base = 0x7facd0000000;
 
 
+POSUtilSizeClassPool* POSHandle_CUDA_Memory::get_checkpoint_host_pool(){
+    // the pool is never destructed, as releasing pinned memory at exit might race with CUDA teardown
+    static POSUtilSizeClassPool *pool = new POSUtilSizeClassPool(
+        /* alloc_func */ [](uint64_t size) -> void* {
+            void *ptr;
+            cudaError_t cuda_rt_retval = cudaMallocHost(&ptr, size);
+            if(unlikely(cuda_rt_retval != cudaSuccess)){
+                POS_WARN_DETAIL("failed cudaMallocHost, error: %d", cuda_rt_retval);
+                return nullptr;
+            }
+            return ptr;
+        },
+        /* free_func */ [](void* ptr, uint64_t size){
+            cudaError_t cuda_rt_retval = cudaFreeHost(ptr);
+            if(unlikely(cuda_rt_retval != cudaSuccess)){
+                POS_WARN_DETAIL("failed cudaFreeHost, error: %d", cuda_rt_retval);
+            }
+        },
+        /* max_cached_bytes */ POS_CKPT_HOST_POOL_MAX_CACHED_BYTES
+    );
+    return pool;
+}
+
+
+POSUtilSizeClassPool* POSHandle_CUDA_Memory::get_checkpoint_dev_pool(int device_id){
+    static std::mutex mutex;
+    static std::map<int, POSUtilSizeClassPool*> pools;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(unlikely(pools.count(device_id) == 0)){
+        // blocks are allocated on the current device, which is the one the caller asks for
+        pools[device_id] = new POSUtilSizeClassPool(
+            /* alloc_func */ [](uint64_t size) -> void* {
+                void *ptr;
+                cudaError_t cuda_rt_retval = cudaMalloc(&ptr, size);
+                if(unlikely(cuda_rt_retval != cudaSuccess)){
+                    POS_WARN_DETAIL("failed cudaMalloc, error: %d", cuda_rt_retval);
+                    return nullptr;
+                }
+                return ptr;
+            },
+            /* free_func */ [](void* ptr, uint64_t size){
+                cudaError_t cuda_rt_retval = cudaFree(ptr);
+                if(unlikely(cuda_rt_retval != cudaSuccess)){
+                    POS_WARN_DETAIL("failed cudaFree, error: %d", cuda_rt_retval);
+                }
+            },
+            /* max_cached_bytes */ POS_CKPT_DEV_POOL_MAX_CACHED_BYTES
+        );
+    }
+
+    return pools[device_id];
+}
+
+
 POSHandle_CUDA_Memory::POSHandle_CUDA_Memory(size_t size_, void* hm, pos_u64id_t id_, size_t state_size_)
     : POSHandle_CUDA(size_, hm, id_, state_size_)
 {
@@ -129,6 +185,11 @@ pos_retval_t POSHandle_CUDA_Memory::__init_ckpt_bag(){
         this->__checkpoint_dev_deallocator
     );
     POS_CHECK_POINTER(this->ckpt_bag);
+
+    // memory handles might be large blocks with multiple tensors, so we only copy dirty chunks
+    this->dirty_chunks = new POSCheckpointDirtyChunks(this->state_size);
+    POS_CHECK_POINTER(this->dirty_chunks);
+
     return POS_SUCCESS;
 }
 
@@ -152,6 +213,8 @@ pos_retval_t POSHandle_CUDA_Memory::__add(uint64_t version_id, uint64_t stream_i
         goto exit;
     }
 
+    // the whole state is preserved, as whether current round is partial is only known once the
+    // host-side slot to commit into is applied (see POSCheckpointDirtyChunks::prepare_slot)
     cuda_rt_retval = cudaMemcpyAsync(
         /* dst */ ckpt_slot->expose_pointer(), 
         /* src */ this->server_addr,
@@ -187,6 +250,7 @@ pos_retval_t POSHandle_CUDA_Memory::__commit(uint64_t version_id, uint64_t strea
     pos_retval_t retval = POS_SUCCESS;
     cudaError_t cuda_rt_retval;
     POSCheckpointSlot *ckpt_slot, *cow_ckpt_slot;
+    std::vector<pos_ckpt_chunk_range_t> ranges;
     
     // TODO: [zhuobin] why we have this call??
     cudaSetDevice(0);
@@ -207,22 +271,30 @@ pos_retval_t POSHandle_CUDA_Memory::__commit(uint64_t version_id, uint64_t strea
 
     POS_CHECK_POINTER(ckpt_slot);
 
+    // only those chunks modified since last commit are copied, on top of the state of last commit,
+    // unless the applied slot doesn't store the state of last commit
+    POS_CHECK_POINTER(this->dirty_chunks);
+    this->dirty_chunks->prepare_slot(ckpt_slot);
+    this->dirty_chunks->get_round_ranges(ranges);
+
     if(from_cache == false){
         // commit from origin buffer
-        cuda_rt_retval = cudaMemcpyAsync(
-            /* dst */ ckpt_slot->expose_pointer(), 
-            /* src */ this->server_addr,
-            /* size */ this->state_size,
-            /* kind */ cudaMemcpyDeviceToHost,
-            /* stream */ (cudaStream_t)(stream_id)
-        );
-        if(unlikely(cuda_rt_retval != cudaSuccess)){
-            POS_WARN_C(
-                "failed to checkpoint memory handle from origin buffer: server_addr(%p), retval(%d)",
-                this->server_addr, cuda_rt_retval
+        for(auto &range : ranges){
+            cuda_rt_retval = cudaMemcpyAsync(
+                /* dst */ (uint8_t*)(ckpt_slot->expose_pointer()) + range.offset,
+                /* src */ (uint8_t*)(this->server_addr) + range.offset,
+                /* size */ range.size,
+                /* kind */ cudaMemcpyDeviceToHost,
+                /* stream */ (cudaStream_t)(stream_id)
             );
-            retval = POS_FAILED;
-            goto exit;
+            if(unlikely(cuda_rt_retval != cudaSuccess)){
+                POS_WARN_C(
+                    "failed to checkpoint memory handle from origin buffer: server_addr(%p), offset(%lu), size(%lu), retval(%d)",
+                    this->server_addr, range.offset, range.size, cuda_rt_retval
+                );
+                retval = POS_FAILED;
+                goto exit;
+            }
         }
     } else {
         // commit from cache buffer
@@ -237,20 +309,22 @@ pos_retval_t POSHandle_CUDA_Memory::__commit(uint64_t version_id, uint64_t strea
                 version_id, this->server_addr
             );
         }
-        cuda_rt_retval = cudaMemcpyAsync(
-            /* dst */ ckpt_slot->expose_pointer(), 
-            /* src */ cow_ckpt_slot->expose_pointer(),
-            /* size */ this->state_size,
-            /* kind */ cudaMemcpyDeviceToHost,
-            /* stream */ (cudaStream_t)(stream_id)
-        );
-        if(unlikely(cuda_rt_retval != cudaSuccess)){
-            POS_WARN_C(
-                "failed to checkpoint memory handle from COW buffer: server_addr(%p), retval(%d)",
-                this->server_addr, cuda_rt_retval
+        for(auto &range : ranges){
+            cuda_rt_retval = cudaMemcpyAsync(
+                /* dst */ (uint8_t*)(ckpt_slot->expose_pointer()) + range.offset,
+                /* src */ (uint8_t*)(cow_ckpt_slot->expose_pointer()) + range.offset,
+                /* size */ range.size,
+                /* kind */ cudaMemcpyDeviceToHost,
+                /* stream */ (cudaStream_t)(stream_id)
             );
-            retval = POS_FAILED;
-            goto exit;
+            if(unlikely(cuda_rt_retval != cudaSuccess)){
+                POS_WARN_C(
+                    "failed to checkpoint memory handle from COW buffer: server_addr(%p), offset(%lu), size(%lu), retval(%d)",
+                    this->server_addr, range.offset, range.size, cuda_rt_retval
+                );
+                retval = POS_FAILED;
+                goto exit;
+            }
         }
     }
 
@@ -267,6 +341,16 @@ pos_retval_t POSHandle_CUDA_Memory::__commit(uint64_t version_id, uint64_t strea
     }
 
 exit:
+    if(this->dirty_chunks != nullptr){
+        if(likely(retval == POS_SUCCESS)){
+            // the committed slot becomes the base of the next round
+            this->dirty_chunks->finish_round(ckpt_slot);
+        } else {
+            // the slot might be partially written, copy the whole state in the next round
+            this->dirty_chunks->reset();
+        }
+    }
+
     return retval;
 }
 
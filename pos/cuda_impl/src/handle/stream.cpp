@@ -166,8 +166,8 @@ pos_retval_t POSHandleManager_CUDA_Stream::init(std::map<uint64_t, std::vector<P
     }
 
     // record in the manager
-    this->latest_used_handle = this->_handles[0];
-    this->default_handle = this->_handles[0];
+    this->latest_used_handle = this->get_handle_by_id(0);
+    this->default_handle = this->get_handle_by_id(0);
 
 exit:
     return retval;
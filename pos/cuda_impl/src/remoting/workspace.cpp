@@ -71,7 +71,10 @@ int pos_process(
     uint64_t *param_desps,
     int param_num
 ){
-    std::vector<POSAPIParamDesp_t> params(param_num);
+    // reused across calls of the RPC thread, to avoid allocation per call
+    static thread_local std::vector<POSAPIParamDesp_t> params;
+
+    params.resize(param_num);
     for (int i = 0; i < param_num; i++) {
         POS_CHECK_POINTER((void*)(param_desps[2*i]));
         params[i] = POSAPIParamDesp_t{
@@ -83,4 +86,55 @@ int pos_process(
 }
 
 
+int pos_process_batch(
+    POSWorkspace_CUDA *pos_cuda_ws,
+    uint64_t uuid,
+    uint64_t *call_desps,
+    int call_num,
+    int *retvals
+){
+    int i, j, param_num;
+    uint64_t offset = 0, nb_params = 0;
+    static thread_local std::vector<POSAPIParamDesp_t> params;
+    static thread_local std::vector<POSAPICallDesp_t> calls;
+
+    POS_CHECK_POINTER(pos_cuda_ws);
+    POS_CHECK_POINTER(call_desps);
+    POS_CHECK_POINTER(retvals);
+
+    // first pass: count parameters, so that params won't be reallocated while
+    // calls are pointing to it
+    for (i = 0; i < call_num; i++) {
+        param_num = call_desps[offset+3];
+        nb_params += param_num;
+        offset += 4 + 2 * param_num;
+    }
+    params.resize(nb_params);
+    calls.resize(call_num);
+
+    // second pass: form the call descriptors
+    offset = 0; nb_params = 0;
+    for (i = 0; i < call_num; i++) {
+        param_num = call_desps[offset+3];
+        calls[i].api_id = call_desps[offset];
+        calls[i].ret_data = (void*)call_desps[offset+1];
+        calls[i].ret_data_len = call_desps[offset+2];
+        calls[i].param_desps = params.data() + nb_params;
+        calls[i].nb_params = param_num;
+        offset += 4;
+        for (j = 0; j < param_num; j++) {
+            POS_CHECK_POINTER((void*)(call_desps[offset]));
+            params[nb_params+j] = POSAPIParamDesp_t{
+                (void*)call_desps[offset],
+                call_desps[offset+1]
+            };
+            offset += 2;
+        }
+        nb_params += param_num;
+    }
+
+    return pos_cuda_ws->pos_process_batch(uuid, calls.data(), call_num, retvals) == POS_SUCCESS ? 0 : 1;
+}
+
+
 } // extern "C"
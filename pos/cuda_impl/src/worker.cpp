@@ -60,7 +60,7 @@ pos_retval_t POSWorker_CUDA::sync(uint64_t stream_id){
 }
 
 
-pos_retval_t POSWorker_CUDA::daemon_init(){
+pos_retval_t POSWorker_CUDA::daemon_attach(){
     /*!
         *  \note   make sure the worker thread is bound to a CUDA context
         *          if we don't do this and use the driver API, it might be unintialized
@@ -69,12 +69,19 @@ pos_retval_t POSWorker_CUDA::daemon_init(){
         POS_WARN_C_DETAIL("worker thread failed to invoke cudaSetDevice");
         return POS_FAILED; 
     }
+    return POS_SUCCESS;
+}
+
+
+pos_retval_t POSWorker_CUDA::daemon_init(){
     cudaDeviceSynchronize();
     
 #if POS_CONF_EVAL_CkptOptLevel == 2
-    POS_ASSERT(
-        cudaSuccess == cudaStreamCreate((cudaStream_t*)(&this->_ckpt_stream_id))
-    );
+    for(auto& stream_id : this->_ckpt_stream_ids){
+        POS_ASSERT(
+            cudaSuccess == cudaStreamCreate((cudaStream_t*)(&stream_id))
+        );
+    }
 
     POS_ASSERT(
         cudaSuccess == cudaStreamCreate((cudaStream_t*)(&this->_cow_stream_id))
@@ -82,9 +89,11 @@ pos_retval_t POSWorker_CUDA::daemon_init(){
 #endif
 
 #if POS_CONF_EVAL_CkptOptLevel == 2 && POS_CONF_EVAL_CkptEnablePipeline == 1
-    POS_ASSERT(
-        cudaSuccess == cudaStreamCreate((cudaStream_t*)(&this->_ckpt_commit_stream_id))
-    );
+    for(auto& stream_id : this->_ckpt_commit_stream_ids){
+        POS_ASSERT(
+            cudaSuccess == cudaStreamCreate((cudaStream_t*)(&stream_id))
+        );
+    }
 #endif
 
 #if POS_CONF_EVAL_MigrOptLevel == 2
@@ -96,7 +96,7 @@ namespace cublas_set_stream {
 
         // confirm parent change
         POS_ASSERT(cublas_context_handle->parent_handles.size() == 1);
-        POS_CHECK_POINTER(cublas_context_handle->parent_handles[0] = stream_handle);
+        cublas_context_handle->replace_parent_handle(0, stream_handle);
 
         POSWorker::__done(ws, wqe);
 
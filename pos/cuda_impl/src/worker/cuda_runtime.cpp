@@ -302,8 +302,7 @@ namespace cuda_memcpy_h2d {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -311,7 +310,6 @@ namespace cuda_memcpy_h2d {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -322,10 +320,6 @@ namespace cuda_memcpy_h2d {
             /* kind */ cudaMemcpyHostToDevice
         );
 
-    #if POS_CONF_EVAL_CkptOptLevel == 2
-        ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
-    #endif
-
         if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
             POSWorker::__restore(ws, wqe);
         } else {
@@ -358,8 +352,7 @@ namespace cuda_memcpy_d2h {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -367,7 +360,6 @@ namespace cuda_memcpy_d2h {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -378,12 +370,6 @@ namespace cuda_memcpy_d2h {
             /* kind */ cudaMemcpyDeviceToHost
         );
 
-    #if POS_CONF_EVAL_CkptOptLevel == 2
-        if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
-        }
-    #endif
-
         if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
             POSWorker::__restore(ws, wqe);
         } else {
@@ -420,8 +406,7 @@ namespace cuda_memcpy_d2d {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -429,7 +414,6 @@ namespace cuda_memcpy_d2d {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -440,12 +424,6 @@ namespace cuda_memcpy_d2d {
             /* kind */ cudaMemcpyDeviceToDevice
         );
 
-    #if POS_CONF_EVAL_CkptOptLevel == 2
-        if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
-        }
-    #endif
-
         if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
             POSWorker::__restore(ws, wqe);
         } else {
@@ -482,8 +460,7 @@ namespace cuda_memcpy_h2d_async {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -491,7 +468,6 @@ namespace cuda_memcpy_h2d_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -509,7 +485,6 @@ namespace cuda_memcpy_h2d_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
         }
     #endif
 
@@ -549,8 +524,7 @@ namespace cuda_memcpy_d2h_async {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -558,7 +532,6 @@ namespace cuda_memcpy_d2h_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -575,10 +548,6 @@ namespace cuda_memcpy_d2h_async {
             (cudaStream_t)(stream_handle->server_addr)
         );
 
-    #if POS_CONF_EVAL_CkptOptLevel == 2
-        ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
-    #endif
-
         if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
             POSWorker::__restore(ws, wqe);
         } else {
@@ -618,8 +587,7 @@ namespace cuda_memcpy_d2d_async {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -627,7 +595,6 @@ namespace cuda_memcpy_d2d_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -645,7 +612,6 @@ namespace cuda_memcpy_d2d_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
         }
     #endif
 
@@ -683,8 +649,7 @@ namespace cuda_memset_async {
         /*!
          *  \note   if we enable overlapped checkpoint, we need to prevent
          *          the checkpoint memcpy conflict with the current memcpy,
-         *          so we raise the flag to notify overlapped checkpoint to
-         *          provisionally stop
+         *          so we drain the stream before issuing it
          */
     #if POS_CONF_EVAL_CkptOptLevel == 2
         if( ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.TH_actve == true ){
@@ -692,7 +657,6 @@ namespace cuda_memset_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = true;
         }
     #endif
 
@@ -709,7 +673,6 @@ namespace cuda_memset_async {
             if(unlikely(cudaSuccess != wqe->api_cxt->return_code)){ 
                 POS_WARN_DETAIL("failed to sync default stream to avoid ckpt conflict")
             }
-            ((POSClient*)(wqe->client))->worker->async_ckpt_cxt.membus_lock = false;
         }
     #endif
 
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "pos/include/utils/system.h"
 #include "pos/cuda_impl/workspace.h"
 
 
@@ -26,11 +27,15 @@ pos_retval_t POSWorkspace_CUDA::__init(){
     CUdevice cu_device;
     CUcontext cu_context;
     int device_count, i;
+    char pci_bus_id[32];
+    std::vector<uint32_t> local_cpus;
+    std::string daemon_cpu_list;
 
     // create the api manager
     this->api_mgnr = new POSApiManager_CUDA();
     POS_CHECK_POINTER(this->api_mgnr);
     this->api_mgnr->init();
+    this->api_mgnr->build_api_meta_table();
 
     // mark all stateful resources
     this->resource_type_idx.insert(
@@ -101,6 +106,21 @@ pos_retval_t POSWorkspace_CUDA::__init(){
                 retval = POS_FAILED_DRIVER;
                 goto exit;
             }
+
+            // by default, pin daemons of clients to CPUs that are NUMA-local to the default device
+            this->ws_conf.get(POSWorkspaceConf::ConfigType::kRuntimeDaemonCpuList, daemon_cpu_list);
+            if(daemon_cpu_list.size() == 0){
+                dr_retval = cuDeviceGetPCIBusId(pci_bus_id, sizeof(pci_bus_id), cu_device);
+                if(unlikely(dr_retval != CUDA_SUCCESS)){
+                    POS_WARN_C("failed to obtain PCIe bus id of device %d, daemons won't be pinned: dr_retval(%d)", i, dr_retval);
+                } else if(POS_SUCCESS == POSUtilSystem::get_pci_local_cpus(pci_bus_id, local_cpus)){
+                    daemon_cpu_list.clear();
+                    for(uint32_t cpu : local_cpus){
+                        daemon_cpu_list += (daemon_cpu_list.size() > 0 ? "," : "") + std::to_string(cpu);
+                    }
+                    this->ws_conf.set(POSWorkspaceConf::ConfigType::kRuntimeDaemonCpuList, daemon_cpu_list);
+                }
+            }
         }
         this->_cu_contexts.push_back(cu_context);
         POS_DEBUG_C("created CUDA context: device_id(%d)", i);
@@ -167,6 +187,8 @@ pos_retval_t POSWorkspace_CUDA::__create_client(pos_create_client_param_t& param
     client_cxt.cxt_base.job_name = param.job_name;
     client_cxt.cxt_base.pid = param.pid;
     client_cxt.cxt_base.resource_type_idx = this->resource_type_idx;
+    client_cxt.cxt_base.is_daemon_dedicated = param.is_daemon_dedicated;
+    client_cxt.cxt_base.daemon_weight = param.daemon_weight;
 
     retval = this->ws_conf.get(POSWorkspaceConf::ConfigType::kRuntimeTraceResourceEnabled, conf);
     if(unlikely(retval != POS_SUCCESS)){
@@ -182,6 +204,14 @@ pos_retval_t POSWorkspace_CUDA::__create_client(pos_create_client_param_t& param
     if(conf == "1"){ client_cxt.cxt_base.trace_performance = true; }
     else { client_cxt.cxt_base.trace_performance = false; }
 
+    retval = this->ws_conf.get(POSWorkspaceConf::ConfigType::kRuntimeDaemonCpuList, conf);
+    if(unlikely(retval != POS_SUCCESS)){
+        POS_ERROR_C("failed to obtain daemon CPU list in workspace configuration, this is a bug");
+    }
+    if(unlikely(POS_SUCCESS != POSUtilSystem::parse_cpu_list(conf, client_cxt.cxt_base.daemon_cpus))){
+        POS_WARN_C("failed to parse daemon CPU list, daemons of the client won't be pinned: cpu_list(%s)", conf.c_str());
+    }
+
     retval = this->ws_conf.get(POSWorkspaceConf::ConfigType::kRuntimeDaemonLogPath, runtime_daemon_log_path);
     if(unlikely(retval != POS_SUCCESS)){
         POS_WARN_C("failed to obtain runtime daemon log path");
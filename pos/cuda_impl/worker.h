@@ -100,8 +100,13 @@ class POSWorker_CUDA : public POSWorker {
 
  protected:    
     /*!
-     *  \brief      initialization of the worker daemon thread
-     *  \example    for CUDA, one need to call API e.g. cudaSetDevice first to setup the context for a thread
+     *  \brief      bind the thread that drives the worker to the CUDA context
+     *  \note       invoked whenever the worker is moved to another thread (e.g., within the daemon pool)
+     */
+    pos_retval_t daemon_attach() override;
+
+    /*!
+     *  \brief      initialization of the worker, which creates the streams used by checkpoint / migration
      */
     pos_retval_t daemon_init() override;
 
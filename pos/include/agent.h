@@ -25,6 +25,7 @@
 #include "pos/include/oob.h"
 #include "pos/include/oob/agent.h"
 #include "pos/include/api_context.h"
+#include "pos/include/daemon_pool.h"
 
 
 // forward declaration
@@ -74,6 +75,11 @@ class POSAgentConf {
     // name of the job
     std::string _job_name;
 
+    // whether the parser and worker of the client run on dedicated threads,
+    // and the weight of the client within the daemon pool of the server
+    bool _daemon_dedicated;
+    uint32_t _daemon_weight;
+
     // pid of the current process
     __pid_t _pid;
 };
@@ -116,6 +122,14 @@ class POSAgent {
      */
     inline void set_uuid(pos_client_uuid_t id){ _uuid = id; }
 
+    /*!
+     *  \brief  obtain the uuid of the client
+     *  \note   the remoting framework piggybacks the uuid in each API call, so that
+     *          the daemon can route the call to the corresponding client
+     *  \return uuid of the client
+     */
+    inline pos_client_uuid_t get_uuid() const { return _uuid; }
+
  private:
     // pointer to the out-of-band client
     POSOobClient *_pos_oob_client;
@@ -21,6 +21,9 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include <string.h>
 #include <stdint.h>
@@ -30,6 +33,8 @@
 #include "pos/include/log.h"
 #include "pos/include/handle.h"
 #include "pos/include/utils/timer.h"
+#include "pos/include/utils/futex.h"
+#include "pos/include/utils/dispatch_table.h"
 
 
 // forward declaration
@@ -80,7 +85,7 @@ typedef struct POSAPIMeta {
     uint8_t library_id;
 
     // name of the api
-    std::string api_name;
+    const char *api_name;
 } POSAPIMeta_t;
 
 
@@ -114,10 +119,37 @@ class POSApiManager {
      */
     virtual int cast_pos_retval(pos_retval_t pos_retval, uint8_t library_id){ return -1; };
 
+    /*!
+     *  \brief  obtain the library used to cast the retval of calls without recorded metadata
+     *  \return id of the default library
+     */
+    virtual uint8_t get_default_library_id(){ return 0; };
+
+    /*!
+     *  \brief  build the flat metadata table from the registered api_metas
+     *  \note   should be called after init(), and api_metas shouldn't be modified afterwards
+     */
+    inline void build_api_meta_table(){
+        this->_api_meta_table.build(
+            this->api_metas, [](const POSAPIMeta_t& api_meta) -> const POSAPIMeta_t* { return &api_meta; }
+        );
+    }
+
+    /*!
+     *  \brief  obtain the metadata of specified API
+     *  \param  api_id  id of the API
+     *  \return pointer to the metadata, nullptr for unregistered API
+     */
+    inline const POSAPIMeta_t* get_api_meta(uint64_t api_id) const {
+        return this->_api_meta_table.get(api_id);
+    }
+
     // map: api_id -> metadata of the api
     std::map<uint64_t, POSAPIMeta_t> api_metas;
 
  protected:
+    // flat table: api_id -> metadata of the api, points to the elements inside api_metas
+    POSDispatchTable<const POSAPIMeta_t*> _api_meta_table;
 };
 
 
@@ -133,6 +165,19 @@ enum pos_api_execute_status_t : uint8_t {
 };
 
 
+/*!
+ *  \brief  maximum size of a parameter that can be stored inline within
+ *          POSAPIParam, larger parameter would be stored on the heap
+ */
+#define POS_API_PARAM_INLINE_SIZE       64
+
+/*!
+ *  \brief  number of POSAPIParam embedded within POSAPIContext, parameters
+ *          beyond this number would be allocated on the heap
+ */
+#define POS_API_NB_EMBEDDED_PARAMS      8
+
+
 /*!
  *  \brief  descriptor of one parameter of an API call
  */
@@ -143,22 +188,59 @@ typedef struct POSAPIParam {
     // size of the parameter
     size_t param_size;
 
+    // inline storage of the payload, used when param_size <= POS_API_PARAM_INLINE_SIZE
+    uint8_t inline_value[POS_API_PARAM_INLINE_SIZE];
+
+    /*!
+     *  \brief  constructor
+     *  \note   this constructor is used for embedded parameters inside POSAPIContext
+     */
+    POSAPIParam() : param_value(nullptr), param_size(0) {}
+
     /*!
      *  \brief  constructor
      *  \param  src_value   pointer to the actual value of the parameter
      *  \param  size        size of the parameter
      */
-    POSAPIParam(void *src_value, size_t size) : param_size(size) {
-        POS_CHECK_POINTER(param_value = malloc(size));
-        memcpy(param_value, src_value, param_size);
+    POSAPIParam(const void *src_value, size_t size) : param_value(nullptr), param_size(0) {
+        this->load(src_value, size);
     }
 
+    // param_value might point to inline_value, so the parameter can't be copied
+    POSAPIParam(const POSAPIParam&) = delete;
+    POSAPIParam& operator=(const POSAPIParam&) = delete;
+
     /*!
-     *  \brief  deconstructor
+     *  \brief  load the value of the parameter
+     *  \param  src_value   pointer to the actual value of the parameter
+     *  \param  size        size of the parameter
      */
-    ~POSAPIParam(){
-        POS_CHECK_POINTER(param_value); free(param_value);
+    inline void load(const void *src_value, size_t size){
+        this->release();
+        if(likely(size <= POS_API_PARAM_INLINE_SIZE)){
+            this->param_value = this->inline_value;
+        } else {
+            POS_CHECK_POINTER(this->param_value = malloc(size));
+        }
+        this->param_size = size;
+        if(likely(size > 0)){ memcpy(this->param_value, src_value, size); }
+    }
+
+    /*!
+     *  \brief  release the payload of the parameter
+     */
+    inline void release(){
+        if(this->param_value != nullptr && this->param_value != this->inline_value){
+            free(this->param_value);
+        }
+        this->param_value = nullptr;
+        this->param_size = 0;
     }
+
+    /*!
+     *  \brief  deconstructor
+     */
+    ~POSAPIParam(){ this->release(); }
 } POSAPIParam_t;
 
 
@@ -182,6 +264,27 @@ typedef struct POSAPIParam {
 typedef struct POSAPIParamDesp { void *value; size_t size; } POSAPIParamDesp_t;
 
 
+/*!
+ *  \brief  descriptor of one API call within a batch submission
+ */
+typedef struct POSAPICallDesp {
+    // index of the called API
+    uint64_t api_id;
+
+    // descriptors of all parameters of the call
+    const POSAPIParamDesp_t *param_desps;
+
+    // number of parameters of the call
+    uint64_t nb_params;
+
+    // pointer to the memory area to store the returned value
+    void *ret_data;
+
+    // size of the return value
+    uint64_t ret_data_len;
+} POSAPICallDesp_t;
+
+
 /*!
  *  \brief  context of an API call
  */
@@ -201,6 +304,18 @@ typedef struct POSAPIContext {
     // return code of the API
     int return_code;
 
+    // parameters embedded inside the context, the first POS_API_NB_EMBEDDED_PARAMS
+    // entries of params point to here
+    POSAPIParam_t embedded_params[POS_API_NB_EMBEDDED_PARAMS];
+
+    /*!
+     *  \brief  constructor
+     *  \note   this constructor is for POSAPIContextArena, the context should
+     *          be loaded via POSAPIContext::load before used
+     */
+    POSAPIContext();
+
+
     /*!
      *  \brief  constructor
      *  \param  api_id_         index of the called API
@@ -222,9 +337,27 @@ typedef struct POSAPIContext {
     POSAPIContext(uint64_t api_id_, uint64_t retval_size);
 
 
-    ~POSAPIContext(){
-        for(auto param : params){ POS_CHECK_POINTER(param); delete param; }
-    }
+    /*!
+     *  \brief  (re)load the context with a new API call
+     *  \param  api_id_         index of the called API
+     *  \param  param_desps     descriptors of all involved parameters
+     *  \param  nb_params       number of involved parameters
+     *  \param  ret_data_       pointer to the memory area that store the returned value
+     *  \param  retval_size_    size of the return value
+     */
+    void load(
+        uint64_t api_id_, const POSAPIParamDesp_t* param_desps, uint64_t nb_params,
+        void* ret_data_, uint64_t retval_size_
+    );
+
+
+    /*!
+     *  \brief  release all parameters of the context
+     */
+    void clear_params();
+
+
+    ~POSAPIContext(){ this->clear_params(); }
 } POSAPIContext_t;
 
 
@@ -263,24 +396,39 @@ typedef struct POSHandleView {
      */
     uint64_t offset;
 
+    /*!
+     *  \brief      size of the range accessed from the offset, 0 for unknown
+     *  \example    for memory handle written by memcpy / memset, the size is known by the parser, so
+     *              that only the modified chunks are marked dirty for checkpointing; for kernels it's
+     *              unknown, and the range from the offset to the end of the handle is considered as
+     *              modified (e.g., a tensor within a block of the PyTorch caching allocator)
+     *  \note       this field isn't persisted, so restored views are considered accessing from the offset
+     */
+    uint64_t size;
+
     /*!
      *  \brief  constructor
      *  \param  handle_             pointer to the handle which is view targeted on
      *  \param  param_index_        index of the corresponding parameter of this handle view
      *  \param  offset_             offset from the base address of the handle
+     *  \param  size_               size of the range accessed from the offset, 0 for unknown
      */
     POSHandleView(
-        POSHandle* handle_, uint64_t param_index_ = 0, uint64_t offset_ = 0
-    ) : handle(handle_), param_index(param_index_), offset(offset_){}
+        POSHandle* handle_, uint64_t param_index_ = 0, uint64_t offset_ = 0, uint64_t size_ = 0
+    ) : handle(handle_), param_index(param_index_), offset(offset_), size(size_){}
 
     /*!
      *  \brief  constructor
      *  \note   this constructor is used only during restore phrase
      */
-    POSHandleView() : handle(nullptr), param_index(0), offset(0){}
+    POSHandleView() : handle(nullptr), param_index(0), offset(0), size(0){}
 } POSHandleView_t;
 
 
+// forward declaration
+class POSAPIContextArena;
+
+
 /*!
  *  \brief  work queue element, as the element within work 
  *          queue between frontend and runtime
@@ -301,6 +449,12 @@ typedef struct POSAPIContext_QE {
     // mark whether current WQE has returned to RPC thread
     bool has_return;
 
+    // mark whether current WQE is a sync call, which is returned via completion instead of CQ
+    bool is_sync;
+
+    // completion for the RPC thread to wait on, only used by sync call
+    POSCompletion completion;
+
     // execution status of the API call
     pos_api_execute_status_t status;
 
@@ -319,6 +473,32 @@ typedef struct POSAPIContext_QE {
     uint64_t parser_s_tick, parser_e_tick, worker_s_tick, worker_e_tick;
     /* ======= end of profiling fields ======== */
 
+    /*!
+     *  \brief  number of references to this WQE
+     *  \note   the WQE starts with one reference owned by the RPC frontend, which is
+     *          dropped once the CQE is digested; any stage that keeps using the WQE
+     *          after it's returned to the frontend (e.g., worker of a Return_After_Parse
+     *          API, ckpt dag queue, trace queue) should hold an extra reference
+     */
+    std::atomic<uint8_t> nb_refs;
+
+    // arena that this WQE is allocated from, nullptr for heap-allocated WQE
+    POSAPIContextArena *arena;
+
+    // bytes occupied by this WQE (i.e., the WQE, its API context and parameters), charged to the arena
+    uint64_t nb_bytes;
+
+    // epoch of the arena when this WQE was acquired (or pinned), 0 for untracked, see POSAPIContextArena
+    uint64_t epoch;
+
+
+    /*!
+     *  \brief  constructor
+     *  \note   this constructor is for POSAPIContextArena, the WQE should
+     *          be loaded via POSAPIContext_QE::load before used
+     */
+    POSAPIContext_QE();
+
 
     /*!
      *  \brief  constructor
@@ -353,6 +533,37 @@ typedef struct POSAPIContext_QE {
     ~POSAPIContext_QE();
 
 
+    /*!
+     *  \brief  (re)load the WQE with a new API call
+     *  \param  api_id          index of the called API
+     *  \param  uuid            uuid of the remote client
+     *  \param  param_desps     description of all parameters of the call
+     *  \param  nb_params       number of parameters of the call
+     *  \param  inst_id         uuid of this API call instance within the client
+     *  \param  retval_data     pointer to the memory area that store the returned value
+     *  \param  retval_size     size of the return value
+     *  \param  pos_client      pointer to the POSClient instance
+     */
+    void load(
+        uint64_t api_id, pos_client_uuid_t uuid, const POSAPIParamDesp_t* param_desps, uint64_t nb_params,
+        uint64_t inst_id, void* retval_data, uint64_t retval_size, POSClient* pos_client
+    );
+
+
+    /*!
+     *  \brief  obtain an extra reference of this WQE
+     */
+    inline void get_ref(){ this->nb_refs.fetch_add(1, std::memory_order_relaxed); }
+
+
+    /*!
+     *  \brief  drop a reference of this WQE, the WQE would be recycled to its arena
+     *          (or deleted if it's heap-allocated) once no reference remains
+     *  \note   the caller must not touch the WQE after calling this function
+     */
+    void put_ref();
+
+
     /*!
      *  \brief  persist the state of this APIcontext to specified directory
      *  \tparam with_params whether to persist with parameter information,
@@ -429,3 +640,165 @@ typedef struct POSAPIContext_QE {
 
 #define pos_api_inout_handle_offset_server_addr(qe_ptr, index)  \
     ((void*)((uint64_t)(qe_ptr->inout_handle_views[index].handle->server_addr) + (qe_ptr->inout_handle_views[index].offset)))
+
+
+
+/*!
+ *  \brief  number of WQE within a single slab of POSAPIContextArena
+ */
+#define POS_APICXT_ARENA_SLAB_SIZE  256
+
+
+/*!
+ *  \brief  per-client arena of WQEs
+ *  \note   WQEs are allocated slab-by-slab and recycled as a whole once retired,
+ *          so that the steady state of the RPC path is free of heap operations;
+ *          acquire should only be called by a single (RPC) thread, while recycle
+ *          could be called from any thread
+ */
+class POSAPIContextArena {
+ public:
+    POSAPIContextArena()
+        :   nb_acquired(0), nb_slabs(0),
+            _acquired_cnt(0), _acquired_bytes(0), _local_recycled_cnt(0), _local_recycled_bytes(0),
+            _remote_recycled_cnt(0), _remote_recycled_bytes(0), _epoch(1)
+    {
+        this->_epoch_nb_live[0].store(0);
+        this->_epoch_nb_live[1].store(0);
+    }
+    ~POSAPIContextArena();
+
+    /*!
+     *  \brief  obtain a free WQE from the arena
+     *  \note   the returned WQE holds one reference, and should be loaded via
+     *          POSAPIContext_QE::load before used
+     *  \return pointer to the obtained WQE
+     */
+    POSAPIContext_QE* acquire();
+
+    /*!
+     *  \brief  return a retired WQE back to the arena
+     *  \param  wqe the retired WQE
+     */
+    void recycle(POSAPIContext_QE* wqe);
+
+    /*!
+     *  \brief  track a heap-allocated WQE (e.g., restored from checkpoint) within the current epoch,
+     *          so that handles it refers to are kept until it's released
+     *  \note   this should be invoked before the owner thread starts acquiring (i.e., while restoring)
+     *  \param  wqe the heap-allocated WQE
+     */
+    void pin(POSAPIContext_QE* wqe);
+
+    /*!
+     *  \brief  stop tracking a heap-allocated WQE which is going to be released
+     *  \param  wqe the heap-allocated WQE
+     */
+    void unpin(POSAPIContext_QE* wqe);
+
+    /*!
+     *  \brief  obtain the epoch counter of the arena
+     *  \note   every WQE is tagged with the epoch when it's acquired, and the owner thread only
+     *          advances the epoch once all WQEs of the previous epoch are recycled, so that WQEs
+     *          of epoch e are all recycled once the counter reaches e + 2; a handle deleted while
+     *          the counter is e is therefore no longer referenced by any WQE after that
+     *  eturn pointer to the epoch counter, which could be read by any thread
+     */
+    inline const std::atomic<uint64_t>* get_epoch_counter() const { return &(this->_epoch); }
+
+    /*!
+     *  \brief  charge the bytes of a WQE loaded by the owner thread to the arena
+     *  \param  wqe the loaded WQE, whose nb_bytes is set
+     */
+    inline void charge(POSAPIContext_QE* wqe){
+        __add(this->_acquired_bytes, wqe->nb_bytes);
+    }
+
+    /*!
+     *  \brief  obtain the number of live WQEs, i.e., acquired but not yet recycled
+     *  \note   could be invoked by any thread, the result might be slightly stale
+     *  \return number of live WQEs
+     */
+    inline uint64_t get_nb_live() const {
+        uint64_t nb_recycled = this->_local_recycled_cnt.load(std::memory_order_relaxed)
+                                + this->_remote_recycled_cnt.load(std::memory_order_relaxed);
+        uint64_t nb_acquired = this->_acquired_cnt.load(std::memory_order_relaxed);
+        return nb_acquired > nb_recycled ? nb_acquired - nb_recycled : 0;
+    }
+
+    /*!
+     *  \brief  obtain the bytes occupied by live WQEs
+     *  \note   could be invoked by any thread, the result might be slightly stale
+     *  \return bytes occupied by live WQEs
+     */
+    inline uint64_t get_nb_live_bytes() const {
+        uint64_t recycled_bytes = this->_local_recycled_bytes.load(std::memory_order_relaxed)
+                                + this->_remote_recycled_bytes.load(std::memory_order_relaxed);
+        uint64_t acquired_bytes = this->_acquired_bytes.load(std::memory_order_relaxed);
+        return acquired_bytes > recycled_bytes ? acquired_bytes - recycled_bytes : 0;
+    }
+
+    /*!
+     *  \brief  obtain the bytes reserved by all slabs of the arena, live or free
+     *  \return bytes reserved by the arena
+     */
+    inline uint64_t get_nb_reserved_bytes() const {
+        return this->nb_slabs * POS_APICXT_ARENA_SLAB_SIZE * (sizeof(POSAPIContext_QE) + sizeof(POSAPIContext));
+    }
+
+    // number of WQEs acquired from this arena
+    uint64_t nb_acquired;
+
+    // number of slabs allocated by this arena
+    uint64_t nb_slabs;
+
+ private:
+    /*!
+     *  \brief  add to a statistic counter of the arena
+     *  \note   every counter has a single writer (the owner thread, or the holder of
+     *          _recycle_mutex), so a relaxed load-store is enough
+     */
+    static inline void __add(std::atomic<uint64_t>& counter, uint64_t value){
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // statistics of WQEs acquired / recycled by the owner thread
+    std::atomic<uint64_t> _acquired_cnt;
+    std::atomic<uint64_t> _acquired_bytes;
+    std::atomic<uint64_t> _local_recycled_cnt;
+    std::atomic<uint64_t> _local_recycled_bytes;
+
+    // statistics of WQEs recycled by non-owner threads, protected by _recycle_mutex
+    std::atomic<uint64_t> _remote_recycled_cnt;
+    std::atomic<uint64_t> _remote_recycled_bytes;
+
+    /*!
+     *  \brief  current epoch, and number of live WQEs of the current and the previous epoch
+     *          (indexed by the parity of the epoch)
+     *  \note   the epoch is only advanced by the owner thread, see get_epoch_counter
+     */
+    std::atomic<uint64_t> _epoch;
+    std::atomic<int64_t> _epoch_nb_live[2];
+
+    /*!
+     *  \brief  allocate a new slab of WQEs and insert them into the free list
+     */
+    void __allocate_slab();
+
+    // all allocated slabs
+    std::vector<POSAPIContext_QE*> _slabs;
+
+    // free WQEs, only accessed by the owner thread
+    std::vector<POSAPIContext_QE*> _free_list;
+
+    // WQEs recycled by non-owner threads
+    std::mutex _recycle_mutex;
+    std::vector<POSAPIContext_QE*> _recycle_list;
+
+    /*!
+     *  \brief  the thread that acquires WQEs from this arena
+     *  \note   it's set by the first acquire, which happens-before any recycle
+     *          as WQEs are passed among threads via queues
+     */
+    std::thread::id _owner_tid;
+};
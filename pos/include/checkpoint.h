@@ -19,10 +19,15 @@
 #include <iostream>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <unordered_map>
+#include <mutex>
+#include <atomic>
 #include <stdint.h>
+#include <string.h>
 #include "pos/include/common.h"
 #include "pos/include/log.h"
+#include "pos/include/utils/bitmap.h"
 
 
 // forward declaration
@@ -84,7 +89,8 @@ class POSCheckpointSlot {
     ) : _state_size(state_size),
         _custom_deallocator(deallocator),
         ckpt_position(ckpt_position),
-        state_type(state_type)
+        state_type(state_type),
+        _id(_next_id.fetch_add(1, std::memory_order_relaxed))
     {
         POS_ASSERT(state_size > 0);
         if(likely(allocator != nullptr)){
@@ -122,6 +128,14 @@ class POSCheckpointSlot {
      */
     inline uint64_t get_state_size(){ return this->_state_size; }
 
+    /*!
+     *  \brief  obtain the id of the slot
+     *  \note   ids are unique within the process and never reused, so unlike the address of the
+     *          slot, an id never refers to another slot once this slot is released
+     *  \return the id of the slot, never 0
+     */
+    inline uint64_t get_id() const { return this->_id; }
+
  protected:
     // size of the data inside this slot
     uint64_t _state_size;
@@ -131,6 +145,187 @@ class POSCheckpointSlot {
 
     // deallocator for deallocating memory region that stores checkpoint
     pos_custom_ckpt_deallocate_func_t _custom_deallocator;
+
+    // id of this slot
+    uint64_t _id;
+
+    // id of the next created slot
+    static inline std::atomic<uint64_t> _next_id{1};
+};
+
+
+/*!
+ *  \brief  default size of the chunk to track dirty state of large handles (e.g., memory)
+ */
+#define POS_CKPT_CHUNK_SIZE     (1ul << 21)
+
+
+/*!
+ *  \brief  contiguous range of the state to be checkpointed
+ */
+typedef struct pos_ckpt_chunk_range {
+    // offset from the base address of the state
+    uint64_t offset;
+
+    // size of the range
+    uint64_t size;
+} pos_ckpt_chunk_range_t;
+
+
+/*!
+ *  \brief  chunk-granular dirty tracking of the state of a handle, so that committing only
+ *          copies those chunks modified since the state was committed last time
+ *  \note   the state is split into fixed-size chunks, with two bitmaps:
+ *          [1] dirty: chunks modified since the current round began, marked by the worker thread
+ *              after launching each API that writes the handle;
+ *          [2] round: chunks to be copied within the current checkpoint round, which is collected
+ *              from the dirty bitmap once the round begins, and cleared once the round is committed
+ *  \note   a partial round is only correct on top of the slot that stores the state of the last
+ *          round (i.e., base slot), so the whole state is copied in case the checkpoint bag hands
+ *          out a different slot, or there's no base slot (e.g., the first round, or the last round
+ *          failed); the base slot is recorded by its id rather than its address, so a released
+ *          or recycled base slot is never dereferenced, nor mistaken for the slot of a new one
+ *  \note   this class is platform-independent, the copy of each range is done by the handle
+ *  \note   dirty bitmap is only accessed by the worker thread, while the round is accessed by
+ *          the committing thread after the round began, which never overlap with the beginning of
+ *          the next round
+ */
+class POSCheckpointDirtyChunks {
+ public:
+    /*!
+     *  \brief  constructor
+     *  \param  state_size  size of the tracked state
+     *  \param  chunk_size  size of each chunk
+     */
+    POSCheckpointDirtyChunks(uint64_t state_size, uint64_t chunk_size = POS_CKPT_CHUNK_SIZE)
+        : _state_size(state_size), _chunk_size(chunk_size), _base_slot_id(0), _round_is_full(false)
+    {
+        POS_ASSERT(chunk_size > 0);
+        this->_nb_chunks = (state_size + chunk_size - 1) / chunk_size;
+    }
+    ~POSCheckpointDirtyChunks() = default;
+
+
+    /*!
+     *  \brief  mark the given range of the state as dirty
+     *  \param  offset  offset of the modified range from the base address of the state
+     *  \param  size    size of the modified range, 0 for unknown (e.g., a kernel that is given a
+     *                  pointer into the state), in which case the range from the offset to the end
+     *                  of the state is marked, as the accessed size is unknown while the access
+     *                  is assumed to not go below the given pointer
+     */
+    inline void mark(uint64_t offset, uint64_t size){
+        if(unlikely(offset >= this->_state_size)){
+            this->_dirty.set_range(0, this->_nb_chunks);
+            return;
+        }
+        if(size == 0){ size = this->_state_size - offset; }
+        this->_dirty.set_range(
+            offset / this->_chunk_size,
+            std::min<uint64_t>((offset + size - 1) / this->_chunk_size + 1, this->_nb_chunks)
+        );
+    }
+
+
+    /*!
+     *  \brief  begin a new checkpoint round, collecting all dirty chunks into this round
+     *  \note   chunks of previous non-committed round are kept within this round
+     */
+    inline void begin_round(){
+        this->_round.merge(this->_dirty);
+        this->_dirty.clear_all();
+        if(this->_base_slot_id == 0){ this->_round_is_full = true; }
+    }
+
+
+    /*!
+     *  \brief  obtain all ranges to be copied within current round, with contiguous chunks merged
+     *  \param  ranges  the returned ranges
+     */
+    inline void get_round_ranges(std::vector<pos_ckpt_chunk_range_t>& ranges) const {
+        uint64_t end;
+
+        ranges.clear();
+        if(this->_round_is_full){
+            ranges.push_back({ /* offset */ 0, /* size */ this->_state_size });
+            return;
+        }
+
+        this->_round.for_each([&](uint64_t chunk_id){
+            if(chunk_id >= this->_nb_chunks){ return; }
+            end = std::min<uint64_t>((chunk_id + 1) * this->_chunk_size, this->_state_size);
+            if(ranges.size() > 0 && ranges.back().offset + ranges.back().size == chunk_id * this->_chunk_size){
+                ranges.back().size = end - ranges.back().offset;
+            } else {
+                ranges.push_back({ /* offset */ chunk_id * this->_chunk_size, /* size */ end - chunk_id * this->_chunk_size });
+            }
+        });
+    }
+
+
+    /*!
+     *  \brief  prepare the host-side slot to commit current round into
+     *  \note   the whole state is copied within current round if the slot isn't the base slot
+     *  \param  slot    the slot to be committed into
+     */
+    inline void prepare_slot(POSCheckpointSlot *slot){
+        POS_CHECK_POINTER(slot);
+        if(this->_base_slot_id != slot->get_id()){ this->_round_is_full = true; }
+    }
+
+
+    /*!
+     *  \brief  finish current round, the committed slot becomes the base of the next round
+     *  \param  slot    the slot that current round was committed into
+     */
+    inline void finish_round(POSCheckpointSlot *slot){
+        POS_CHECK_POINTER(slot);
+        this->_base_slot_id = slot->get_id();
+        this->_round.clear_all();
+        this->_round_is_full = false;
+    }
+
+
+    /*!
+     *  \brief  drop the base slot, so that next round copies the whole state
+     *  \note   invoked once the round failed to be committed
+     */
+    inline void reset(){
+        this->_base_slot_id = 0;
+        this->_round_is_full = true;
+    }
+
+
+    /*!
+     *  \brief  obtain the number of bytes to be copied within current round
+     *  \return number of bytes to be copied
+     */
+    inline uint64_t get_round_bytes() const {
+        if(this->_round_is_full){ return this->_state_size; }
+        return std::min<uint64_t>(this->_round.count() * this->_chunk_size, this->_state_size);
+    }
+
+ private:
+    // size of the tracked state
+    uint64_t _state_size;
+
+    // size of each chunk
+    uint64_t _chunk_size;
+
+    // number of chunks
+    uint64_t _nb_chunks;
+
+    // chunks modified since current round began
+    POSUtilBitmap _dirty;
+
+    // chunks to be copied within current round
+    POSUtilBitmap _round;
+
+    // id of the slot that stores the committed state of the last round, 0 for none
+    uint64_t _base_slot_id;
+
+    // whether the whole state should be copied within current round
+    bool _round_is_full;
 };
 
 
@@ -353,3 +548,170 @@ class POSCheckpointBag {
      */
     std::unordered_map<uint64_t, pos_host_ckpt_t> _host_ckpt_map;
 };
+
+
+/*!
+ *  \brief  initial estimations of the checkpoint cost model, used before they're measured
+ *  \note   bandwidths are in bytes per microsecond (i.e., MB/s)
+ */
+#define POS_CKPT_COST_INIT_D2H_BW           10000.0
+#define POS_CKPT_COST_INIT_PERSIST_BW       2000.0
+#define POS_CKPT_COST_INIT_WQE_PERSIST_US   20.0
+
+/*!
+ *  \brief  ratio of the time to replay an API while restoring, to its recorded worker time
+ */
+#define POS_CKPT_COST_REPLAY_RATIO          1.0
+
+/*!
+ *  \brief  weight of the latest round within the moving average of measurements
+ */
+#define POS_CKPT_COST_EWMA_WEIGHT           0.3
+
+/*!
+ *  \brief  measurements with less bytes / APIs than these are too noisy to be learned
+ */
+#define POS_CKPT_COST_MIN_SAMPLE_BYTES      MB(16)
+#define POS_CKPT_COST_MIN_SAMPLE_WQES       64
+
+
+/*!
+ *  \brief  cost model to decide how the bottom-half of a dump preserves the states modified since
+ *          the top-half, either by copying all dirty states (dirty copy), or by dumping the APIs
+ *          executed since the top-half to be replayed while restoring (recomputation)
+ *  \note   the bandwidths and the cost of dumping an API are learnt from previous rounds as moving
+ *          averages, and the replay time is estimated from the worker time recorded in the APIs
+ *  \note   thread-safe, as workers of different clients might dump concurrently
+ */
+class POSCheckpointCostModel {
+ public:
+    POSCheckpointCostModel()
+        :   _d2h_bw(POS_CKPT_COST_INIT_D2H_BW),
+            _persist_bw(POS_CKPT_COST_INIT_PERSIST_BW),
+            _wqe_persist_us(POS_CKPT_COST_INIT_WQE_PERSIST_US),
+            _nb_d2h_samples(0),
+            _nb_persist_samples(0),
+            _nb_wqe_samples(0)
+    {}
+    ~POSCheckpointCostModel() = default;
+
+
+    /*!
+     *  \brief  estimated costs of both strategies
+     */
+    typedef struct estimation {
+        // dirty copy: copy all dirty states to the host, and persist the part that isn't
+        // overlapped with copying
+        double d2h_us;
+        double persist_us;
+        double dirty_copy_us;
+
+        // recomputation: dump all APIs executed since the top-half, and replay them while restoring
+        double wqe_persist_us;
+        double replay_us;
+        double recompute_us;
+
+        // whether dirty copy is cheaper
+        bool do_dirty_copy;
+    } estimation_t;
+
+
+    /*!
+     *  \brief  estimate the costs of both strategies
+     *  \param  dirty_bytes     overall state size of dirty handles
+     *  \param  nb_wqes         number of APIs executed since the top-half
+     *  \param  worker_us       overall worker time recorded in these APIs
+     *  \return the estimation
+     */
+    inline estimation_t estimate(uint64_t dirty_bytes, uint64_t nb_wqes, double worker_us){
+        estimation_t est;
+        std::lock_guard<std::mutex> lock(this->_mutex);
+
+        est.d2h_us = (double)dirty_bytes / this->_d2h_bw;
+        est.persist_us = (double)dirty_bytes / this->_persist_bw;
+        est.dirty_copy_us = est.d2h_us + est.persist_us;
+
+        est.wqe_persist_us = (double)nb_wqes * this->_wqe_persist_us;
+        est.replay_us = worker_us * POS_CKPT_COST_REPLAY_RATIO;
+        est.recompute_us = est.wqe_persist_us + est.replay_us;
+
+        est.do_dirty_copy = est.dirty_copy_us <= est.recompute_us;
+        return est;
+    }
+
+
+    /*!
+     *  \brief  learn from the dirty copy of a round
+     *  \param  bytes       overall copied bytes
+     *  \param  d2h_us      time to copy all dirty states to the host
+     *  \param  persist_us  time to finish persisting after all dirty states are copied
+     */
+    inline void record_dirty_copy(uint64_t bytes, double d2h_us, double persist_us){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        if(bytes < POS_CKPT_COST_MIN_SAMPLE_BYTES){ return; }
+        if(d2h_us > 0){
+            __update(this->_d2h_bw, this->_nb_d2h_samples, (double)bytes / d2h_us);
+        }
+        if(persist_us > 0){
+            __update(this->_persist_bw, this->_nb_persist_samples, (double)bytes / persist_us);
+        }
+    }
+
+
+    /*!
+     *  \brief  learn from the recomputation of a round
+     *  \param  nb_wqes     number of dumped APIs
+     *  \param  persist_us  time to dump all these APIs
+     */
+    inline void record_recompute(uint64_t nb_wqes, double persist_us){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        if(nb_wqes < POS_CKPT_COST_MIN_SAMPLE_WQES || persist_us <= 0){ return; }
+        __update(this->_wqe_persist_us, this->_nb_wqe_samples, persist_us / (double)nb_wqes);
+    }
+
+
+    /*!
+     *  \brief  current estimations of the model
+     */
+    inline double get_d2h_bw(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_d2h_bw;
+    }
+    inline double get_persist_bw(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_persist_bw;
+    }
+    inline double get_wqe_persist_us(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_wqe_persist_us;
+    }
+
+ private:
+    /*!
+     *  \brief  update a moving average with a new measurement, the first one replaces the initial value
+     *  \param  value       the moving average
+     *  \param  nb_samples  number of measurements learnt so far
+     *  \param  sample      the new measurement
+     */
+    static inline void __update(double& value, uint64_t& nb_samples, double sample){
+        if(nb_samples == 0){
+            value = sample;
+        } else {
+            value = POS_CKPT_COST_EWMA_WEIGHT * sample + (1.0 - POS_CKPT_COST_EWMA_WEIGHT) * value;
+        }
+        nb_samples += 1;
+    }
+
+    std::mutex _mutex;
+
+    // bandwidths (bytes per microsecond)
+    double _d2h_bw;
+    double _persist_bw;
+
+    // time to dump an API (microseconds)
+    double _wqe_persist_us;
+
+    uint64_t _nb_d2h_samples;
+    uint64_t _nb_persist_samples;
+    uint64_t _nb_wqe_samples;
+};
@@ -21,6 +21,7 @@
 #include <set>
 #include <string>
 #include <fstream>
+#include <atomic>
 #include <stdint.h>
 #include <assert.h>
 #include "pos/include/common.h"
@@ -30,12 +31,37 @@
 #include "pos/include/command.h"
 #include "pos/include/transport.h"
 #include "pos/include/api_context.h"
+#include "pos/include/metrics/histogram.h"
 #include "pos/include/utils/lockfree_queue.h"
 #include "pos/include/utils/timer.h"
+#include "pos/include/utils/futex.h"
 
 
 // forward declaration
 class POSWorkspace;
+
+
+/*!
+ *  \brief spin budget (us) of the RPC thread before parking on a sync call,
+ *         the budget is adapted within [MIN, MAX] by the observed latency
+ */
+#define POS_CLIENT_SYNC_SPIN_INIT_US    20
+#define POS_CLIENT_SYNC_SPIN_MIN_US     2
+#define POS_CLIENT_SYNC_SPIN_MAX_US     200
+
+/*!
+ *  \brief capacity of the rpc2parser apicxt work queue, the RPC thread is back-pressured
+ *         (i.e., waits for the parser) once the queue is full
+ */
+#define POS_CLIENT_RPC2PARSER_WQ_LEN    4096
+
+/*!
+ *  \brief high watermark of the parser2worker apicxt work queue, the parser stops consuming
+ *         the rpc2parser queue once the worker falls behind by this number of apicxts
+ *  \note  the parser2worker queue itself stays unbounded, as restoring pushes all unexecuted
+ *         apicxts to it before the worker starts
+ */
+#define POS_CLIENT_PARSER2WORKER_WQ_HIGH_WATERMARK  4096
 typedef struct POSAPIContext_QE POSAPIContext_QE_t;
 
 
@@ -91,6 +117,14 @@ typedef struct pos_client_cxt {
     // whether to trace resource
     bool trace_resource;
     bool trace_performance;
+
+    // CPUs to pin the parser and worker daemons, empty for no pinning
+    std::vector<uint32_t> daemon_cpus;
+
+    // whether the parser and worker run on dedicated threads even if the daemon pool is enabled,
+    // and the scheduling weight of them within the daemon pool
+    bool is_daemon_dedicated;
+    uint32_t daemon_weight;
 } pos_client_cxt_t;
 #define POS_CLIENT_CXT_HEAD pos_client_cxt cxt_base;
 
@@ -112,6 +146,10 @@ typedef struct pos_create_client_param {
     // if it's, we won't initialize initial handles
     // inside each handle manager
     bool is_restoring;
+
+    // whether the client requests dedicated daemon threads, and its weight within the daemon pool
+    bool is_daemon_dedicated;
+    uint32_t daemon_weight;
 } pos_create_client_param_t;
 
 
@@ -126,6 +164,19 @@ enum pos_client_status_t : uint8_t {
 };
 
 
+/*!
+ *  \brief  stages of an API call whose latency is recorded per API
+ */
+enum pos_api_latency_stage_t : uint8_t {
+    kPOS_APILatencyStage_Queueing = 0,  // from created by RPC frontend to parsed (parser_s - create)
+    kPOS_APILatencyStage_Parse,         // parsing (parser_e - parser_s)
+    kPOS_APILatencyStage_Worker,        // execution on worker (worker_e - worker_s)
+    kPOS_APILatencyStage_EndToEnd,      // from created to returned (return - create)
+    kPOS_APILatencyStage_Nb
+};
+typedef POSMetrics_HistogramTable<kPOS_APILatencyStage_Nb> pos_api_latency_table_t;
+
+
 /*!
  *  \brief  station to store the checkpointed data
  */
@@ -274,6 +325,36 @@ class POSClient {
     // counter for mark whether a client is offline
     volatile uint8_t offline_counter;
 
+    // arena of WQEs issued by this client
+    POSAPIContextArena apicxt_arena;
+
+    /*!
+     *  \brief spin budget (TSC ticks) of the RPC thread before parking on a sync call
+     *  \note  adapted by the observed latency of sync calls, only touched by the RPC thread
+     */
+    uint64_t sync_spin_ticks;
+    uint64_t sync_spin_min_ticks;
+    uint64_t sync_spin_max_ticks;
+
+    // error of previous async call, would be reported by the next sync call
+    std::atomic<bool> has_async_error;
+    std::atomic<int> async_error_code;
+
+    /*!
+     *  \brief doorbells of the parser and worker daemons
+     *  \note  rung by push_q once an element is pushed to the queues consumed by the daemon,
+     *         and by those state changes that the parked daemon should react to
+     */
+    POSDoorbell parser_doorbell;
+    POSDoorbell worker_doorbell;
+
+    /*!
+     *  \brief latency histograms of each API (in TSC ticks), recorded by the parser and worker respectively
+     *  \note  each table has a single writer, and is merged on demand (e.g., by the OOB thread)
+     */
+    pos_api_latency_table_t *parser_api_latency;
+    pos_api_latency_table_t *worker_api_latency;
+
  protected:
     friend class POSWorkspace;
     friend class POSParser;
@@ -397,7 +478,9 @@ class POSClient {
      *  \tparam qdir    queue direction
      *  \tparam qtype   type of the queue
      *  \param  qe      queue element to be pushed
-     *  \return POS_SUCCESS for successfully pushed  
+     *  \return POS_SUCCESS for successfully pushed
+     *          POS_FAILED_NOT_READY for the (bounded) queue is full, the caller still owns the element
+     *          POS_FAILED_DRAIN for the queue is being destoryed
      */
     template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
     pos_retval_t push_q(void *qe);
@@ -425,16 +508,71 @@ class POSClient {
     pos_retval_t poll_q(std::vector<POSCommand_QE_t*>* qes);
 
     /*!
-     *  \brief  clear all elements inside the queue
+     *  \brief  poll a batch of apicxt queue elements from specified queue
+     *  \tparam qdir    queue direction
+     *  \tparam qtype   type of the queue
+     *  \param  qes     caller-provided array to store the polled queue elements
+     *  \param  max_nb  maximum number of elements to be polled (i.e., length of the array)
+     *  \return number of polled queue elements
+     */
+    template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+    uint64_t poll_q(POSAPIContext_QE** qes, uint64_t max_nb);
+
+    /*!
+     *  \brief  poll a batch of cmd queue elements from specified queue
+     *  \tparam qdir    queue direction
+     *  \tparam qtype   type of the queue
+     *  \param  qes     caller-provided array to store the polled queue elements
+     *  \param  max_nb  maximum number of elements to be polled (i.e., length of the array)
+     *  \return number of polled queue elements
+     */
+    template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+    uint64_t poll_q(POSCommand_QE_t** qes, uint64_t max_nb);
+
+    /*!
+     *  \brief  obtain the (approximate) number of elements inside specified queue
+     *  \tparam qdir    queue direction
+     *  \tparam qtype   type of the queue
+     *  \return number of elements inside the queue
+     */
+    template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+    uint64_t get_q_len();
+
+    /*!
+     *  \brief  clear all elements inside the queue, drained elements are reclaimed
+     *          (i.e., references of apicxts are dropped, and commands are deleted)
      *  \tparam qdir    queue direction
      *  \tparam qtype   type of the queue
-     *  \param  uuid    uuid for specifying client
      *  \return POS_SUCCESS for successfully clear
      */
     template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
     pos_retval_t clear_q();
 
+    /*!
+     *  \brief  return a processed apicxt back to the RPC frontend
+     *  \note   sync call is returned by signaling its completion, while async call is
+     *          returned via the completion queue; the wqe can't be touched after return
+     *  \tparam qdir    direction of the completion queue, either rpc2parser or rpc2worker
+     *  \param  wqe     the apicxt to be returned
+     *  \return POS_SUCCESS for successfully return
+     */
+    template<pos_queue_direction_t qdir>
+    pos_retval_t complete_apicxt(POSAPIContext_QE* wqe);
+
+    /*!
+     *  \brief  retire all returned async apicxts, and drop the references owned by the RPC frontend
+     *  \note   called by the RPC thread, and by the background reclaimer of the workspace for
+     *          idle clients; only one of them retires at a time, the other one returns immediately
+     */
+    void retire_apicxts();
+
  protected:
+    // scratch buffer of retire_apicxts
+    std::vector<POSAPIContext_QE*> _retired_apicxts;
+
+    // whether someone is retiring apicxts, held forever once the queues are destoryed
+    std::atomic<bool> _is_retiring;
+
     // api context queue pairs from RPC frontend to parser
     POSLockFreeQueue<POSAPIContext_QE_t*> *_apicxt_rpc2parser_wq;
     POSLockFreeQueue<POSAPIContext_QE_t*> *_apicxt_rpc2parser_cq;
@@ -472,6 +610,33 @@ class POSClient {
      *  \return POS_SUCCESS for successfully destory
      */
     pos_retval_t __destory_qgroup();
+
+    /*!
+     *  \brief  obtain the apicxt queue with specified direction and type
+     *  \tparam qdir    queue direction
+     *  \tparam qtype   type of the queue
+     *  \return pointer to the queue
+     */
+    template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+    POSLockFreeQueue<POSAPIContext_QE_t*>* __get_apicxt_q();
+
+    /*!
+     *  \brief  obtain the cmd queue with specified direction and type
+     *  \tparam qdir    queue direction
+     *  \tparam qtype   type of the queue
+     *  \return pointer to the queue
+     */
+    template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+    POSLockFreeQueue<POSCommand_QE_t*>* __get_cmd_q();
+
+    /*!
+     *  \brief  reclaim an apicxt drained from a work queue, i.e., drop the reference owned by the
+     *          RPC frontend (async apicxt) or by the worker (apicxt returned after parse)
+     *  \note   an unreturned sync apicxt is owned by the waiting RPC thread, so it's returned as
+     *          failed instead of being released
+     *  \param  wqe     the drained apicxt
+     */
+    void __reclaim_apicxt(POSAPIContext_QE* wqe);
     /* =============== asynchronous queues =============== */
 
 
@@ -485,6 +650,15 @@ class POSClient {
     std::map<pos_resource_typeid_t, POSHandleManager<POSHandle>*> handle_managers;
 
 
+    /*!
+     *  \brief  number of handles (across all handle managers) that are pending to be created or
+     *          broken, i.e., those to be restored by the worker before launching ops rely on them
+     *  \note   it's updated by the handle managers on every status change, and stays at zero in
+     *          the steady state, so that the worker could skip walking handle trees of each op
+     */
+    std::atomic<int64_t> nb_nonactive_handles;
+
+
     /*!
      *  \brief  instantiate handle manager for all used resources
      *  \note   the children class should replace this method to initialize their 
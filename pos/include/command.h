@@ -18,6 +18,7 @@
 
 #include <iostream>
 #include <set>
+#include <string>
 #include "pos/include/common.h"
 #include "pos/include/log.h"
 
@@ -65,6 +66,14 @@ typedef struct POSCommand_QE {
     bool do_cow;
     bool force_recompute;
 
+    /*!
+     *  \brief  for incremental checkpoint: directory of the previous image (empty for a full
+     *          image), and those stateful handles unchanged since that image, which are
+     *          referenced instead of committed and persisted again
+     */
+    std::string base_ckpt_dir;
+    std::set<POSHandle*> unchanged_stateful_handles;
+
     /*!
      *  \brief  record all handles that need to be checkpointed within this checkpoint op
      *  \param  handle_set  sets of handles to be added
@@ -82,6 +91,9 @@ typedef struct POSCommand_QE {
     inline void record_stateless_handles(POSHandle *handle){
         stateless_handles.insert(handle);
     }
+    inline void record_unchanged_stateful_handles(POSHandle *handle){
+        unchanged_stateful_handles.insert(handle);
+    }
     // ============================== ckpt payloads ==============================
 
     POSCommand_QE() : type(kPOS_Command_Nothing), retval(POS_SUCCESS) {}
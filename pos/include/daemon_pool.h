@@ -0,0 +1,272 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+
+#include "pos/include/common.h"
+#include "pos/include/log.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/futex.h"
+
+
+// forward declaration
+class POSDaemonPool;
+
+
+/*!
+ *  \brief  time slice (us) of a daemon task on a pool thread, the task is preempted
+ *          at the end of the slice if it still has pending elements
+ */
+#define POS_DAEMON_POOL_SLICE_US            200
+
+/*!
+ *  \brief  default / maximum scheduling weight of a daemon task within the pool
+ */
+#define POS_DAEMON_POOL_DEFAULT_WEIGHT      1
+#define POS_DAEMON_POOL_MAX_WEIGHT          1024
+
+
+/*!
+ *  \brief  a daemon stage (e.g., parser / worker of a client), which could be driven either
+ *          by its dedicated thread, or by the threads of the shared daemon pool
+ *  \note   the stage exposes a single polling iteration via daemon_poll, the driver is in
+ *          charge of idling (spin / yield / park) when the stage finds its queues empty
+ */
+class POSDaemonTask : public POSDoorbellListener {
+ public:
+    /*!
+     *  \param  doorbell    doorbell rung by producers of the stage's queues
+     */
+    POSDaemonTask(POSDoorbell* doorbell);
+    virtual ~POSDaemonTask() = default;
+
+    /*!
+     *  \brief  wake up the task within the daemon pool once its doorbell is rung
+     */
+    void on_ring() override;
+
+    // accumulated busy / idle time (TSC ticks) of the stage
+    uint64_t daemon_busy_ticks;
+    uint64_t daemon_idle_ticks;
+
+    // number of times the stage parks (dedicated thread) / sleeps (daemon pool)
+    uint64_t daemon_nb_parks;
+
+ protected:
+    friend class POSDaemonPool;
+
+    /*!
+     *  \brief  one polling iteration of the stage
+     *  \note   always invoked by at most one thread at a time, so that elements of the
+     *          stage are digested in order
+     *  \return number of digested elements (or conducted procedures), 0 for all queues are empty
+     */
+    virtual uint64_t daemon_poll() = 0;
+
+    /*!
+     *  \brief      initialization of the stage, invoked once by the first thread that drives the stage
+     *  \example    for CUDA, one could create the streams that used by the stage
+     */
+    virtual pos_retval_t daemon_init(){ return POS_SUCCESS; }
+
+    /*!
+     *  \brief      bind the calling thread to the context of the stage, invoked before daemon_init
+     *              and whenever the stage is moved to another thread
+     *  \example    for CUDA, one need to call API e.g. cudaSetDevice first to setup the context for a thread
+     */
+    virtual pos_retval_t daemon_attach(){ return POS_SUCCESS; }
+
+    // doorbell rung by producers of the stage's queues
+    POSDoorbell *_doorbell;
+
+    // daemon pool that drives the stage, nullptr for driven by the dedicated thread
+    POSDaemonPool *_daemon_pool;
+
+ private:
+    // scheduling state of the task within the daemon pool
+    enum pool_state_t : uint8_t {
+        kPool_Sleeping = 0,     // all queues are empty, waiting for the doorbell
+        kPool_Queued,           // within the run queue of a pool thread
+        kPool_Running,          // running on a pool thread
+        kPool_RunningNotified,  // running on a pool thread, and rung during running
+        kPool_Detached          // removed from the pool
+    };
+    std::atomic<uint8_t> _pool_state;
+
+    // scheduling weight and virtual runtime (TSC ticks / weight) of the task
+    uint32_t _pool_weight;
+    uint64_t _pool_vruntime;
+
+    // index of the pool thread that last ran the task, -1 for never ran
+    int64_t _pool_thread_id;
+
+    // whether daemon_init has been invoked
+    bool _pool_is_inited;
+
+    // whether the task is being removed from the pool
+    std::atomic<bool> _pool_is_removing;
+};
+
+
+/*!
+ *  \brief  fixed-size thread pool that drives the daemon stages of all clients
+ *  \note   each pool thread owns a run queue, and steals from the run queues of others;
+ *          the runnable task with the minimum virtual runtime is picked first,
+ *          where the virtual runtime is charged by the occupied time divided by the weight
+ *          of the task (i.e., weighted-fair scheduling); a task is only driven by one pool
+ *          thread at a time, so that its elements are digested in order
+ */
+class POSDaemonPool {
+ public:
+    /*!
+     *  \brief  constructor, which raises all pool threads
+     *  \param  tsc_timer   TSC timer of the workspace
+     *  \param  nb_threads  number of pool threads
+     *  \param  cpus        CPUs to pin the pool threads, empty for no pinning
+     */
+    POSDaemonPool(POSUtilTscTimer* tsc_timer, uint32_t nb_threads, const std::vector<uint32_t>& cpus);
+
+    /*!
+     *  \brief  deconstructor, which stops all pool threads
+     *  \note   all tasks should be removed before destroying the pool
+     */
+    ~POSDaemonPool();
+
+    /*!
+     *  \brief  add a daemon task to the pool
+     *  \note   the task starts running once its doorbell is rung
+     *  \param  task    the task to be added
+     *  \param  weight  scheduling weight of the task
+     */
+    void add(POSDaemonTask* task, uint32_t weight);
+
+    /*!
+     *  \brief  remove a daemon task from the pool
+     *  \note   block until no pool thread is driving the task
+     *  \param  task    the task to be removed
+     */
+    void remove(POSDaemonTask* task);
+
+    /*!
+     *  \brief  mark the task as runnable, and put it into a run queue if it's sleeping
+     *  \param  task    the task to be notified
+     */
+    void notify(POSDaemonTask* task);
+
+    /*!
+     *  \brief  obtain the number of pool threads
+     *  \return number of pool threads
+     */
+    inline uint32_t get_nb_threads() const { return this->_threads.size(); }
+
+ private:
+    /*!
+     *  \brief  context of a pool thread
+     */
+    typedef struct pool_thread_cxt {
+        // run queue of the thread, protected by mutex
+        std::vector<POSDaemonTask*> runq;
+        std::mutex mutex;
+
+        // doorbell to park the thread while no task is runnable
+        POSDoorbell doorbell;
+
+        // whether the thread finds no runnable task
+        std::atomic<bool> is_idle;
+
+        // thread handle
+        std::thread *thread;
+
+        pool_thread_cxt() : is_idle(false), thread(nullptr) {}
+    } pool_thread_cxt_t;
+
+    /*!
+     *  \brief  processing daemon of a pool thread
+     *  \param  thread_id   index of the pool thread
+     */
+    void __daemon(uint64_t thread_id);
+
+    /*!
+     *  \brief  run a task on the calling pool thread for a time slice
+     *  \param  task        the task to be run
+     *  \param  thread_id   index of the pool thread
+     */
+    void __run(POSDaemonTask* task, uint64_t thread_id);
+
+    /*!
+     *  \brief  pick the runnable task with the minimum virtual runtime, which might be
+     *          stolen from the run queue of another pool thread
+     *  \param  thread_id   index of the pool thread
+     *  \return the picked task, nullptr for no runnable task
+     */
+    POSDaemonTask* __pick(uint64_t thread_id);
+
+    /*!
+     *  \brief  find the task with the minimum virtual runtime within the run queue
+     *  \note   should be invoked with the mutex of the run queue held
+     *  \param  cxt     context of the pool thread
+     *  \return index of the task within the run queue, -1 for empty run queue
+     */
+    int64_t __find_min_vruntime(pool_thread_cxt_t* cxt);
+
+    /*!
+     *  \brief  put a queued task into a run queue, the last thread that ran the task is
+     *          preferred unless it's busy while some other thread is idle
+     *  \param  task    the task to be put, should be in kPool_Queued state
+     */
+    void __enqueue(POSDaemonTask* task);
+
+    /*!
+     *  \brief  notify all sleeping tasks periodically, so that those states that aren't
+     *          signaled through the doorbell could still be observed by the tasks
+     *  \param  now_tick    current TSC tick
+     */
+    void __sweep(uint64_t now_tick);
+
+    // TSC timer of the workspace
+    POSUtilTscTimer *_tsc_timer;
+
+    // contexts of all pool threads
+    std::vector<pool_thread_cxt_t*> _threads;
+
+    // CPUs to pin the pool threads
+    std::vector<uint32_t> _cpus;
+
+    // all tasks within the pool, protected by _tasks_mutex
+    std::set<POSDaemonTask*> _tasks;
+    std::mutex _tasks_mutex;
+
+    // virtual clock of the pool, i.e., the virtual runtime of the latest picked task
+    std::atomic<uint64_t> _min_vruntime;
+
+    // tick of the last sweep over sleeping tasks
+    std::atomic<uint64_t> _last_sweep_tick;
+
+    // time slice, and interval of sweep (TSC ticks)
+    uint64_t _slice_ticks;
+    uint64_t _sweep_ticks;
+
+    // stop flag to indicate pool threads to stop
+    volatile bool _stop_flag;
+};
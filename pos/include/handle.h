@@ -22,13 +22,16 @@
 #include <string>
 #include <map>
 #include <set>
+#include <deque>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <thread>
 #include <future>
 #include <atomic>
 #include <filesystem>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -38,13 +41,32 @@
 #include "pos/include/common.h"
 #include "pos/include/log.h"
 #include "pos/include/utils/lockfree_queue.h"
+#include "pos/include/utils/range_index.h"
+#include "pos/include/utils/bitmap.h"
+#include "pos/include/utils/slab.h"
+#include "pos/include/utils/futex.h"
 #include "pos/include/checkpoint.h"
+#include "pos/include/persist_pool.h"
 #include "pos/include/metrics.h"
 
 
 #define kPOS_HandleDefaultSize   (1<<4)
 
 
+/*!
+ *  \brief  TSC ticks to spin before parking, while waiting for the add / commit of the state
+ *          conducted by another thread (e.g., CoW by the worker thread), so that short copies
+ *          are waited by spinning, while long copies (e.g., CoW of a 1 GB buffer) won't burn a core
+ */
+#define POS_HANDLE_PRESERVE_SPIN_TICKS  50000
+
+
+/*!
+ *  \brief  maximum number of deleted handles to be checked per allocation, for freeing one of them
+ */
+#define POS_HANDLE_RECYCLE_MAX_NB_SCANS 8
+
+
 /*!
  *  \brief  idx of base resource types
  */
@@ -147,21 +169,23 @@ class POSHandle {
      */
     POSHandle(
         void *client_addr_, size_t size_, void* hm, pos_u64id_t id_, size_t state_size_=0
-    ) : client_addr(client_addr_),
-        server_addr(nullptr),
-        size(size_),
-        id(id_),
+    ) : id(id_),
         resource_type_id(kPOS_ResourceTypeId_Unknown),
         status(kPOS_HandleStatus_Create_Pending),
-        state_status(kPOS_HandleStatus_StateReady), 
+        state_status(kPOS_HandleStatus_StateReady),
+        client_addr(client_addr_),
+        server_addr(nullptr),
+        size(size_),
         state_size(state_size_),
         latest_version(0),
         ckpt_bag(nullptr),
-        _hm(hm),
-        _persist_thread(nullptr),
-        _persist_promise(nullptr)
+        dirty_chunks(nullptr),
+        _is_persisting(false),
+        _persist_retval(POS_SUCCESS),
+        _hm(hm)
     {
         this->_state_preserve_counter.store(0);
+        this->_nb_children.store(0);
     }
 
 
@@ -175,21 +199,23 @@ class POSHandle {
      */
     POSHandle(
         size_t size_, void* hm, pos_u64id_t id_, size_t state_size_=0
-    ) : client_addr(nullptr),
-        server_addr(nullptr),
-        size(size_),
-        id(id_),
+    ) : id(id_),
         resource_type_id(kPOS_ResourceTypeId_Unknown),
         status(kPOS_HandleStatus_Create_Pending),
         state_status(kPOS_HandleStatus_StateReady),
+        client_addr(nullptr),
+        server_addr(nullptr),
+        size(size_),
         state_size(state_size_),
         latest_version(0),
         ckpt_bag(nullptr),
-        _hm(hm),
-        _persist_thread(nullptr),
-        _persist_promise(nullptr)
+        dirty_chunks(nullptr),
+        _is_persisting(false),
+        _persist_retval(POS_SUCCESS),
+        _hm(hm)
     {
         this->_state_preserve_counter.store(0);
+        this->_nb_children.store(0);
     }
 
 
@@ -200,21 +226,23 @@ class POSHandle {
      */
     POSHandle(
         void* hm
-    ) : client_addr(nullptr),
-        server_addr(nullptr),
-        size(0),
-        id(0),
+    ) : id(0),
         resource_type_id(kPOS_ResourceTypeId_Unknown),
         status(kPOS_HandleStatus_Create_Pending),
         state_status(kPOS_HandleStatus_StateMiss),
+        client_addr(nullptr),
+        server_addr(nullptr),
+        size(0),
         state_size(0),
         latest_version(0),
         ckpt_bag(nullptr),
-        _hm(hm),
-        _persist_thread(nullptr),
-        _persist_promise(nullptr)
+        dirty_chunks(nullptr),
+        _is_persisting(false),
+        _persist_retval(POS_SUCCESS),
+        _hm(hm)
     {
         this->_state_preserve_counter.store(0);
+        this->_nb_children.store(0);
     }
 
 
@@ -365,99 +393,86 @@ class POSHandle {
      */
     inline void record_parent_handle(POSHandle* parent){
         POS_CHECK_POINTER(parent); parent_handles.push_back(parent);
+        parent->_nb_children.fetch_add(1, std::memory_order_relaxed);
     }
 
 
     /*!
-     *  \brief  wrapper map to store broken handles
+     *  \brief  replace a recorded parent handle of current handle
+     *  \param  index   index of the parent handle to be replaced
+     *  \param  parent  the new parent handle
      */
-    typedef struct pos_broken_handle_list {
-        /*!
-         *  \brief  list of broken handles
-         *  \note   outter index: layer id
-         */
-        std::vector<std::vector<POSHandle*>*> _broken_handles;
-        inline uint16_t get_nb_layers(){ return _broken_handles.size(); }
-
-        /*!
-         *  \brief  add new broken handle to the map
-         *  \param  layer_id    index of the layer that this broken handle locates in
-         *  \param  handle      pointer to the broken handle
-         */
-        inline void add_handle(uint16_t layer_id, POSHandle* handle){
-            std::vector<POSHandle*> *vec;
-
-            while(layer_id >= _broken_handles.size()){
-                POS_CHECK_POINTER(vec = new std::vector<POSHandle*>());
-                _broken_handles.push_back(vec);
-            }
+    inline void replace_parent_handle(uint64_t index, POSHandle* parent){
+        POS_CHECK_POINTER(parent);
+        POS_ASSERT(index < parent_handles.size());
+        parent->_nb_children.fetch_add(1, std::memory_order_relaxed);
+        parent_handles[index]->_nb_children.fetch_sub(1, std::memory_order_release);
+        parent_handles[index] = parent;
+    }
 
-            _broken_handles[layer_id]->push_back(handle);
-        }
 
-        /*!
-         *  \brief  reset this map (i.e., clear all recorded broken handles)
-         */
-        inline void reset(){
-            uint16_t i;
-            for(i=0; i<_broken_handles.size(); i++){
-                if(likely(_broken_handles[i] != nullptr)){ _broken_handles[i]->clear(); }
-            }
+    /*!
+     *  \brief  drop all recorded parent handles of current handle, once it's going to be freed
+     */
+    inline void drop_parent_handles(){
+        for(POSHandle *parent : parent_handles){
+            POS_CHECK_POINTER(parent);
+            parent->_nb_children.fetch_sub(1, std::memory_order_release);
         }
+        parent_handles.clear();
+    }
 
-        /*!
-         *  \brief  repeatly call this function to traverse the current list
-         *  \param  layer_id_keeper     keeping the intermedia traverse layer id
-         *                              [default value should be the return value of get_nb_layers()]
-         *  \param  handle_id_keeper    keeping the intermedia traverse handle id within the layer
-         *                              [default value should be 0]
-         *  \return non-nullptr for the obtained handle; nullptr for reaching the end of traversing
-         */
-        inline POSHandle* reverse_get_handle(uint16_t& layer_id_keeper, uint64_t& handle_id_keeper){
-            POSHandle *retval = nullptr;
-            
-            POS_CHECK_POINTER(_broken_handles[layer_id_keeper]);
-
-            if(unlikely(handle_id_keeper >= _broken_handles[layer_id_keeper]->size())){
-                if(layer_id_keeper == 0){
-                    goto exit;
-                } else {
-                    layer_id_keeper -= 1;
-                    handle_id_keeper = 0;
-                }
-            }
 
-            POS_CHECK_POINTER(_broken_handles[layer_id_keeper]);
+    /*!
+     *  \brief  obtain the number of handles which record current handle as parent
+     *  \return number of child handles
+     */
+    inline uint32_t get_nb_children() const { return this->_nb_children.load(std::memory_order_acquire); }
 
-            if(_broken_handles[layer_id_keeper]->size() > 0)
-                retval = (*(_broken_handles[layer_id_keeper]))[handle_id_keeper];
-            
-            handle_id_keeper += 1;
 
-        exit:
-            return retval;
-        }
+    /*!
+     *  \brief  reusable list to collect broken handles along the handle trees
+     *  \note   handles are emitted in topological order (i.e., parents before children), so it's
+     *          safe to restore them in the emitting order
+     *  \note   each handle is visited at most once until the list is reset, even if it's shared
+     *          by multiple handles (e.g., the context of all memory handles), so that a broken
+     *          parent is restored only once per op
+     *  \note   the buffers are kept across reset to avoid allocation on the per-op path
+     */
+    typedef struct pos_broken_handle_list {
+        // collected broken handles, in topological order
+        std::vector<POSHandle*> broken_handles;
 
         /*!
-         *  \brief  deconstructor
+         *  \brief  reset this list (i.e., clear all recorded broken handles and visited marks)
          */
-        ~pos_broken_handle_list(){
-            uint16_t i;
-            for(i=0; i<_broken_handles.size(); i++){
-                if(likely(_broken_handles[i] != nullptr))
-                   delete _broken_handles[i];
-            }
+        inline void reset(){
+            broken_handles.clear();
+            _visited.clear();
         }
+
+     private:
+        friend class POSHandle;
+
+        // handles visited since last reset
+        std::unordered_set<POSHandle*> _visited;
+
+        // stack of the iterative walk: <handle, index of the next parent to visit>
+        std::vector<std::pair<POSHandle*, uint64_t>> _stack;
     } pos_broken_handle_list_t;
 
 
     /*!
-     *  \brief  collect all broken handles along the handle trees
-     *  \note   this function will call recursively, aware of performance issue!
-     *  \param  broken_handle_list  list of broken handles, 
-     *  \param  layer_id            index of the layer at this call
+     *  \brief  collect all broken handles along the handle tree rooted at this handle, those
+     *          already visited since last reset of the list would be skipped
+     *  \param  broken_handle_list  list to append the broken handles to
      */
-    void collect_broken_handles(pos_broken_handle_list_t *broken_handle_list, uint16_t layer_id = 0);
+    void collect_broken_handles(pos_broken_handle_list_t *broken_handle_list);
+
+
+ protected:
+    // number of handles which record this handle as parent, a handle with children is never freed
+    std::atomic<uint32_t> _nb_children;
     /* ===================== parent handles management ======================= */
 
 
@@ -473,12 +488,55 @@ class POSHandle {
     POSCheckpointBag *ckpt_bag;
 
 
+    /*!
+     *  \brief  chunk-granular dirty tracking of the state, so that adding and committing only
+     *          copy modified chunks of large state
+     *  \note   it's optional, and should be initialized by those implementations of stateful
+     *          handle that support partial copying (e.g., memory) within __init_ckpt_bag;
+     *          handles without it always copy the whole state
+     */
+    POSCheckpointDirtyChunks *dirty_chunks;
+
+
     /*!
      *  \brief  reset the state preserve counter to zero, to start a new checkpoint round
      */
     void reset_preserve_counter();
 
 
+    /*!
+     *  \brief  mark the given range of the state as modified
+     *  \note   this function should be called at the worker thread
+     *  \param  offset  offset of the modified range from the base address of the handle
+     *  \param  size    size of the modified range, 0 for unknown
+     */
+    inline void mark_dirty_state(uint64_t offset, uint64_t size){
+        if(this->dirty_chunks != nullptr){ this->dirty_chunks->mark(offset, size); }
+    }
+
+
+    /*!
+     *  \brief  collect all modified ranges of the state to be copied within the coming add/commit
+     *  \note   this function should be called at the worker thread, before the add/commit of
+     *          a checkpoint round
+     */
+    inline void begin_checkpoint_round(){
+        if(this->dirty_chunks != nullptr){ this->dirty_chunks->begin_round(); }
+    }
+
+
+    /*!
+     *  \brief  obtain the number of bytes to be copied within current checkpoint round
+     *  \note   should be called between begin_checkpoint_round and the add/commit, as the
+     *          round is cleared once committed
+     *  \return number of bytes to be copied
+     */
+    inline uint64_t get_checkpoint_round_bytes() const {
+        if(this->dirty_chunks != nullptr){ return this->dirty_chunks->get_round_bytes(); }
+        return this->state_size;
+    }
+
+
     /*!
      *  \brief  add the state of the resource behind this handle to another on-device resource syncly
      *  \note   only handle of stateful resource should implement this method
@@ -496,9 +554,10 @@ class POSHandle {
      *  \note   this function should be called at the worker thread
      *  \param  version_id  version of this checkpoint
      *  \param  stream_id   index of the stream to do this checkpoint
+     *  \param  is_blocked  whether the commit was blocked by the ongoing add on the other thread
      *  \return POS_SUCCESS for successfully commited
      */
-    pos_retval_t checkpoint_commit_async(uint64_t version_id, uint64_t stream_id=0);
+    pos_retval_t checkpoint_commit_async(uint64_t version_id, uint64_t stream_id=0, bool* is_blocked=nullptr);
 
 
     /*!
@@ -535,9 +594,15 @@ class POSHandle {
      *  \param  ckpt_dir            directory to store checkpoint files
      *  \param  with_state          whether to persist with state
      *  \param  version_id          version of checkpoint to be persisted, if with_state is true
+     *  \param  persist_pool        pool to conduct the persisting, nullptr for persisting on the calling thread
+     *  \param  persist_group       group to track the completion of the persisting within the
+     *                              checkpoint command, nullptr for not tracked
      *  \return POS_SUCCESS for successfully persisting  
      */
-    pos_retval_t checkpoint_persist_async(std::string ckpt_dir, bool with_state, uint64_t version_id);
+    pos_retval_t checkpoint_persist_async(
+        std::string ckpt_dir, bool with_state, uint64_t version_id,
+        POSPersistPool* persist_pool, POSPersistGroup* persist_group=nullptr
+    );
 
 
     /*!
@@ -551,9 +616,24 @@ class POSHandle {
     pos_retval_t checkpoint_persist_sync(std::string ckpt_dir, bool with_state, uint64_t version_id);
 
 
+    /*!
+     *  \brief  persist this handle by referencing its checkpoint file inside a previous image,
+     *          used by incremental checkpoint for handles that are unchanged since that image
+     *  \note   the reference is a symbolic link to the file that finally stores the state, so
+     *          the restore procedure reads it as usual, and the chain of images never deepens
+     *  \param  ckpt_dir        directory to store checkpoint files
+     *  \param  base_ckpt_dir   directory of the previous image
+     *  \return POS_SUCCESS for successfully referenced;
+     *          POS_FAILED_NOT_EXIST for this handle wasn't persisted within the previous image,
+     *          the caller should persist it as usual
+     */
+    pos_retval_t checkpoint_persist_reference(std::string ckpt_dir, std::string base_ckpt_dir);
+
+
     /*!
      *  \brief  synchronize the persisting process
-     *  \return POS_SUCCESS for successfully persist
+     *  \return POS_SUCCESS for successfully persist;
+     *          POS_FAILED_NOT_EXIST for no persisting was raised since last synchronization
      */
     pos_retval_t sync_persist();
 
@@ -562,9 +642,16 @@ class POSHandle {
     // counter for exclude copy-on-write and checkpoint process
     std::atomic<uint8_t> _state_preserve_counter;
 
-    // thread to persist checkpoint of the current handle
-    std::thread *_persist_thread;
-    std::promise<pos_retval_t> *_persist_promise;
+    // completion of the add / commit that won the state preserve counter,
+    // waited by the other thread which arrives while the add / commit is ongoing
+    POSCompletion _state_preserve_completion;
+
+    // whether there's persisting raised but not yet synchronized
+    std::atomic<bool> _is_persisting;
+
+    // completion and result of the raised persisting, set by the persist pool
+    POSCompletion _persist_completion;
+    pos_retval_t _persist_retval;
 
 
     /*!
@@ -618,12 +705,31 @@ class POSHandle {
 
  private:
     /*!
-     *  \brief  async thread to persist the checkpoint to file system
+     *  \brief  wait until the add / commit that won the state preserve counter is finished,
+     *          spin for a short while before parking on the futex
+     */
+    void __wait_state_preserve();
+
+
+    friend class POSPersistPool;
+
+    /*!
+     *  \brief  persist the checkpoint to file system, invoked by the persist pool
      *  \param  ckpt_slot   the checkopoint slot which stores the host-side checkpoint
      *  \param  ckpt_dir    directory to store the checkpoint
      *  \return POS_SUCCESS for successfully persist
      */
-    pos_retval_t __persist_async_thread(POSCheckpointSlot* ckpt_slot, std::string ckpt_dir);
+    pos_retval_t __persist(POSCheckpointSlot* ckpt_slot, const std::string& ckpt_dir);
+
+
+    /*!
+     *  \brief  mark the raised persisting as finished
+     *  \param  retval  result of the persisting
+     */
+    inline void __finish_persist(pos_retval_t retval){
+        this->_persist_retval = retval;
+        this->_persist_completion.complete();
+    }
     /* ==================== checkpoint add/commit/persist ==================== */
 
 
@@ -705,6 +811,379 @@ class POSHandle {
 };
 
 
+/*!
+ *  \brief  number of handles per chunk, number of chunks per directory, and maximum number of
+ *          directories of POSHandleHotMeta, i.e., up to 2^32 handle ids per handle manager
+ */
+#define POS_HANDLE_HOT_META_CHUNK_SIZE      1024
+#define POS_HANDLE_HOT_META_DIR_SIZE        4096
+#define POS_HANDLE_HOT_META_MAX_NB_DIRS     1024
+
+
+/*!
+ *  \brief  hot metadata of all handles within a handle manager, i.e., the handle pointer resolved
+ *          by id (e.g., from the address index) and the status, as struct-of-arrays indexed by id
+ *  \note   the status column backs the status checks of the manager (e.g., the non-active counter,
+ *          freeing deleted handles) without touching the large handle objects scattered over the heap
+ *  \note   the table is organized as fixed-size chunks which are never moved once allocated,
+ *          so that the worker thread could update the status of existing handles while the parser
+ *          thread is appending new handles
+ *  \note   statuses are swapped atomically, so that each transition is counted exactly once even
+ *          if both threads update the same handle
+ *  \note   chunks are indexed by a two-level directory, both levels are allocated on demand, so
+ *          that a small manager only pays for the top-level directory (8 KB)
+ */
+class POSHandleHotMeta {
+ public:
+    POSHandleHotMeta() : _local_nb_nonactive(0), _nb_nonactive(&_local_nb_nonactive) {
+        POS_CHECK_POINTER(this->_dirs = new std::atomic<dir_t*>[POS_HANDLE_HOT_META_MAX_NB_DIRS]);
+        for(uint64_t i=0; i<POS_HANDLE_HOT_META_MAX_NB_DIRS; i++){
+            this->_dirs[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~POSHandleHotMeta(){
+        uint64_t i, j;
+        dir_t *dir;
+
+        for(i=0; i<POS_HANDLE_HOT_META_MAX_NB_DIRS; i++){
+            if((dir = this->_dirs[i].load(std::memory_order_relaxed)) == nullptr){ continue; }
+            for(j=0; j<POS_HANDLE_HOT_META_DIR_SIZE; j++){
+                delete dir->chunks[j].load(std::memory_order_relaxed);
+            }
+            delete dir;
+        }
+        delete[] this->_dirs;
+    }
+
+
+    /*!
+     *  \brief  obtain the maximum number of handles the table could hold
+     *  \return the maximum number of handles, ids of all handles must be below it
+     */
+    static constexpr uint64_t get_capacity(){
+        return (uint64_t)POS_HANDLE_HOT_META_CHUNK_SIZE * POS_HANDLE_HOT_META_DIR_SIZE * POS_HANDLE_HOT_META_MAX_NB_DIRS;
+    }
+
+
+    /*!
+     *  \brief  record the given handle and its status into the table
+     *  \note   the id of the handle must be below get_capacity(), which is checked while allocating
+     *  \param  handle  the given handle
+     */
+    inline void sync(POSHandle *handle){
+        chunk_t *chunk;
+        uint64_t slot;
+        bool is_synced;
+        pos_handle_status_t old_status;
+
+        POS_CHECK_POINTER(handle);
+        POS_CHECK_POINTER(chunk = this->__get_chunk(handle->id, /* do_alloc */ true));
+
+        slot = handle->id % POS_HANDLE_HOT_META_CHUNK_SIZE;
+        is_synced = chunk->handles[slot] != nullptr;
+        chunk->handles[slot] = handle;
+        old_status = chunk->statuses[slot].exchange(handle->status, std::memory_order_relaxed);
+        this->__count_status_change(is_synced, old_status, handle->status);
+    }
+
+
+    /*!
+     *  \brief  update the status of a handle within the table
+     *  \note   no-op if the handle was never synced into the table
+     *  \param  id  index of the handle
+     */
+    inline void set_status(pos_u64id_t id, pos_handle_status_t status){
+        chunk_t *chunk = this->__get_chunk(id, /* do_alloc */ false);
+        uint64_t slot = id % POS_HANDLE_HOT_META_CHUNK_SIZE;
+        if(likely(chunk != nullptr)){
+            this->__count_status_change(
+                /* is_synced */ chunk->handles[slot] != nullptr,
+                /* old_status */ chunk->statuses[slot].exchange(status, std::memory_order_relaxed),
+                /* new_status */ status
+            );
+        }
+    }
+    /*!
+     *  \brief  remove a freed handle from the table, so that its id reads as never synced
+     *  \param  id  index of the handle
+     */
+    inline void remove(pos_u64id_t id){
+        chunk_t *chunk = this->__get_chunk(id, /* do_alloc */ false);
+        uint64_t slot = id % POS_HANDLE_HOT_META_CHUNK_SIZE;
+        if(likely(chunk != nullptr)){
+            this->__count_status_change(
+                /* is_synced */ chunk->handles[slot] != nullptr,
+                /* old_status */ chunk->statuses[slot].exchange(kPOS_HandleStatus_Deleted, std::memory_order_relaxed),
+                /* new_status */ kPOS_HandleStatus_Deleted
+            );
+            chunk->handles[slot] = nullptr;
+        }
+    }
+
+
+    /*!
+     *  \brief  obtain the handle / status of the given id
+     *  \note   the handle must have been synced into the table
+     *  \param  id  index of the handle
+     */
+    inline POSHandle* get_handle(pos_u64id_t id) const { return this->__get_synced_chunk(id)->handles[id % POS_HANDLE_HOT_META_CHUNK_SIZE]; }
+    inline pos_handle_status_t get_status(pos_u64id_t id) const {
+        return this->__get_synced_chunk(id)->statuses[id % POS_HANDLE_HOT_META_CHUNK_SIZE].load(std::memory_order_relaxed);
+    }
+
+
+    /*!
+     *  \brief  obtain the handle of the given id, which might never be synced into the table
+     *          (e.g., holes of ids left by restoring)
+     *  \param  id  index of the handle
+     *  \return pointer to the handle, nullptr for not exist
+     */
+    inline POSHandle* try_get_handle(pos_u64id_t id) const {
+        chunk_t *chunk = this->__lookup_chunk(id);
+        return chunk != nullptr ? chunk->handles[id % POS_HANDLE_HOT_META_CHUNK_SIZE] : nullptr;
+    }
+
+
+    /*!
+     *  \brief  redirect the counting of non-active handles to the given counter (e.g., the one
+     *          owned by the client), so that a single counter covers all handle managers
+     *  \note   handles counted before binding are moved to the given counter
+     *  \param  counter the given counter
+     */
+    inline void bind_nonactive_counter(std::atomic<int64_t> *counter){
+        POS_CHECK_POINTER(counter);
+        counter->fetch_add(this->_nb_nonactive->exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        this->_nb_nonactive = counter;
+    }
+
+ private:
+    typedef struct chunk {
+        POSHandle *handles[POS_HANDLE_HOT_META_CHUNK_SIZE];
+        std::atomic<pos_handle_status_t> statuses[POS_HANDLE_HOT_META_CHUNK_SIZE];
+    } chunk_t;
+
+    typedef struct dir {
+        std::atomic<chunk_t*> chunks[POS_HANDLE_HOT_META_DIR_SIZE];
+        dir(){ for(auto& chunk : this->chunks){ chunk.store(nullptr, std::memory_order_relaxed); } }
+    } dir_t;
+
+    /*!
+     *  \brief  install a newly allocated entry into the given slot of the directory, if it's empty
+     *  \note   some other thread might install the entry concurrently, the loser frees its own one
+     *  \param  slot    slot of the directory
+     *  \return pointer to the installed entry
+     */
+    template<typename T_Entry>
+    static inline T_Entry* __install(std::atomic<T_Entry*>& slot){
+        T_Entry *entry, *expected = nullptr;
+
+        POS_CHECK_POINTER(entry = new T_Entry());
+        if(!slot.compare_exchange_strong(expected, entry, std::memory_order_acq_rel)){
+            delete entry;
+            entry = expected;
+        }
+        return entry;
+    }
+
+    /*!
+     *  \brief  obtain the chunk that holds the given handle
+     *  \param  id          index of the handle
+     *  \param  do_alloc    whether to allocate the chunk (and its directory) if it's not exist
+     *  \return pointer to the chunk, nullptr for not exist or the id is beyond the capacity
+     */
+    inline chunk_t* __get_chunk(pos_u64id_t id, bool do_alloc){
+        dir_t *dir;
+        chunk_t *chunk;
+        uint64_t chunk_id = id / POS_HANDLE_HOT_META_CHUNK_SIZE;
+
+        if(unlikely(id >= get_capacity())){ return nullptr; }
+
+        dir = this->_dirs[chunk_id / POS_HANDLE_HOT_META_DIR_SIZE].load(std::memory_order_acquire);
+        if(unlikely(dir == nullptr)){
+            if(!do_alloc){ return nullptr; }
+            dir = __install(this->_dirs[chunk_id / POS_HANDLE_HOT_META_DIR_SIZE]);
+        }
+
+        chunk = dir->chunks[chunk_id % POS_HANDLE_HOT_META_DIR_SIZE].load(std::memory_order_acquire);
+        if(unlikely(chunk == nullptr && do_alloc)){
+            chunk = __install(dir->chunks[chunk_id % POS_HANDLE_HOT_META_DIR_SIZE]);
+        }
+
+        return chunk;
+    }
+
+    /*!
+     *  \brief  obtain the chunk that holds the given handle, without allocation
+     *  \param  id  index of the handle
+     *  \return pointer to the chunk, nullptr for not exist or the id is beyond the capacity
+     */
+    inline chunk_t* __lookup_chunk(pos_u64id_t id) const {
+        dir_t *dir;
+        uint64_t chunk_id = id / POS_HANDLE_HOT_META_CHUNK_SIZE;
+
+        if(unlikely(id >= get_capacity())){ return nullptr; }
+        dir = this->_dirs[chunk_id / POS_HANDLE_HOT_META_DIR_SIZE].load(std::memory_order_acquire);
+        if(unlikely(dir == nullptr)){ return nullptr; }
+        return dir->chunks[chunk_id % POS_HANDLE_HOT_META_DIR_SIZE].load(std::memory_order_acquire);
+    }
+
+    inline chunk_t* __get_synced_chunk(pos_u64id_t id) const {
+        chunk_t *chunk;
+        POS_CHECK_POINTER(chunk = this->__lookup_chunk(id));
+        return chunk;
+    }
+
+    /*!
+     *  \brief  account a status change of a handle to the counter of non-active handles
+     *  \note   only handles pending to be created or broken are counted, i.e., those to be
+     *          restored by the worker before launching ops rely on them
+     *  \param  is_synced   whether the handle was synced into the table before (i.e., the old
+     *                      status is valid)
+     *  \param  old_status  the old status of the handle
+     *  \param  new_status  the new status of the handle
+     */
+    inline void __count_status_change(bool is_synced, pos_handle_status_t old_status, pos_handle_status_t new_status){
+        int64_t delta = 0;
+
+        if(is_synced && (old_status == kPOS_HandleStatus_Create_Pending || old_status == kPOS_HandleStatus_Broken)){
+            delta -= 1;
+        }
+        if(new_status == kPOS_HandleStatus_Create_Pending || new_status == kPOS_HandleStatus_Broken){
+            delta += 1;
+        }
+        if(delta != 0){ this->_nb_nonactive->fetch_add(delta, std::memory_order_relaxed); }
+    }
+
+    // top-level directory of chunks
+    std::atomic<dir_t*> *_dirs;
+
+    // counter of non-active handles, points to _local_nb_nonactive until bound to another one
+    std::atomic<int64_t> _local_nb_nonactive;
+    std::atomic<int64_t> *_nb_nonactive;
+};
+
+
+/*!
+ *  \brief  set of handles across resource types, with an optional value attached to each handle
+ *  \note   membership is kept as a bitmap per resource type indexed by the (dense) handle id, so
+ *          that insertion / membership test are O(1) instead of walking a pointer-keyed tree,
+ *          which matters on the per-WQE path (e.g., dirty handles during concurrent checkpoint)
+ *  \note   not thread-safe
+ *  \tparam T_Value type of the value attached to each handle
+ */
+template<typename T_Value = bool>
+class POSHandleBitmap {
+ public:
+    POSHandleBitmap() : _size(0) {}
+    ~POSHandleBitmap() = default;
+
+
+    /*!
+     *  \brief  insert a handle into the set
+     *  \param  handle  the handle to be inserted
+     *  \param  value   value attached to the handle
+     *  \return true for newly inserted; false for the handle is already in the set, whose
+     *          value is left untouched
+     */
+    inline bool insert(POSHandle* handle, T_Value value = T_Value()){
+        typed_set_t *typed_set;
+
+        POS_CHECK_POINTER(handle);
+
+        if(unlikely(handle->resource_type_id >= this->_typed_sets.size())){
+            this->_typed_sets.resize(handle->resource_type_id + 1);
+        }
+        typed_set = &(this->_typed_sets[handle->resource_type_id]);
+
+        if(!typed_set->bitmap.set(handle->id)){ return false; }
+
+        if(unlikely(handle->id >= typed_set->entries.size())){
+            typed_set->entries.resize(std::max<uint64_t>(handle->id + 1, typed_set->entries.size() * 2));
+        }
+        typed_set->entries[handle->id] = { handle, value };
+        this->_size += 1;
+
+        return true;
+    }
+
+
+    /*!
+     *  \brief  check whether a handle is in the set
+     *  \param  handle  the handle to be checked
+     *  \return true for the handle is in the set
+     */
+    inline bool contains(POSHandle* handle) const {
+        POS_CHECK_POINTER(handle);
+        if(unlikely(handle->resource_type_id >= this->_typed_sets.size())){ return false; }
+        return this->_typed_sets[handle->resource_type_id].bitmap.test(handle->id);
+    }
+
+
+    /*!
+     *  \brief  obtain the value attached to a handle
+     *  \note   the handle must be in the set
+     *  \param  handle  the handle
+     *  \return value attached to the handle
+     */
+    inline const T_Value& get(POSHandle* handle) const {
+        POS_ASSERT(this->contains(handle));
+        return this->_typed_sets[handle->resource_type_id].entries[handle->id].value;
+    }
+
+
+    /*!
+     *  \brief  remove all handles from the set, while keeping the capacity
+     */
+    inline void clear(){
+        for(auto& typed_set : this->_typed_sets){ typed_set.bitmap.clear_all(); }
+        this->_size = 0;
+    }
+
+
+    /*!
+     *  \brief  invoke the given function on every handle within the set, ordered by
+     *          resource type and then handle id
+     *  \param  fn  the function to be invoked, with the handle and its value as parameters
+     */
+    template<typename T_Fn>
+    inline void for_each(T_Fn&& fn) const {
+        for(auto& typed_set : this->_typed_sets){
+            typed_set.bitmap.for_each([&](uint64_t id){
+                fn(typed_set.entries[id].handle, typed_set.entries[id].value);
+            });
+        }
+    }
+
+
+    /*!
+     *  \brief  obtain the number of handles within the set
+     *  \return number of handles
+     */
+    inline uint64_t size() const { return this->_size; }
+
+ private:
+    typedef struct entry {
+        POSHandle *handle;
+        T_Value value;
+    } entry_t;
+
+    typedef struct typed_set {
+        // membership of handles, indexed by handle id
+        POSUtilBitmap bitmap;
+
+        // handles and their values, indexed by handle id, only valid when the bit is set
+        std::vector<entry_t> entries;
+    } typed_set_t;
+
+    // sets of each resource type, indexed by resource type id
+    std::vector<typed_set_t> _typed_sets;
+
+    // number of handles within the set
+    uint64_t _size;
+};
+
+
 /*!
  *  \brief   manager for handles of a specific kind of resource
  *  \tparam  T_POSHandle  specific handle class for the resource
@@ -738,7 +1217,8 @@ class POSHandleManager {
      *                      are equal (true for hardware resource, false for software resource)
      */
     POSHandleManager(bool passthrough = false)
-        : _base_ptr(kPOS_ResourceBaseAddr), _passthrough(passthrough), _rid(kPOS_ResourceTypeId_Unknown) {}
+        : latest_used_handle(nullptr), default_handle(nullptr), _nb_handles(0), _apicxt_epoch(nullptr), _nb_recycle_pauses(0),
+          _rid(kPOS_ResourceTypeId_Unknown), _base_ptr(kPOS_ResourceBaseAddr), _passthrough(passthrough) {}
 
 
     ~POSHandleManager() = default;
@@ -766,7 +1246,7 @@ class POSHandleManager {
      *  \param  use_expected_addr   indicate whether to use expected client-side address
      *  \param  expected_addr       the expected mock addr to allocate the resource (optional)
      *  \param  state_size          size of resource state behind this handle  
-     *  \return POS_FAILED_DRAIN for run out of virtual address space; 
+     *  \return POS_FAILED_DRAIN for run out of virtual address space or handle ids;
      *          POS_SUCCESS for successfully allocation
      */
     virtual pos_retval_t allocate_mocked_resource(
@@ -781,9 +1261,92 @@ class POSHandleManager {
 
  protected:
     /*!
-     *  \brief  list of handles managed by this manager (including those removed ones)
+     *  \brief  number of handles managed by this manager (including those removed ones)
+     *  \note   handles themselves are stored in the handle column of _hot_meta, indexed by id;
+     *          a slot is filled before the count covering it is published (release), so that
+     *          other threads could read handles below the count without locking
+     */
+    std::atomic<uint64_t> _nb_handles;
+
+    /*!
+     *  \brief  publish a newly recorded handle to readers of other threads
+     *  \param  id  index of the handle, which must be synced into _hot_meta
+     */
+    inline void __publish_handle(pos_u64id_t id){
+        if(id >= this->_nb_handles.load(std::memory_order_relaxed)){
+            this->_nb_handles.store(id + 1, std::memory_order_release);
+        }
+    }
+
+    /*!
+     *  \brief  slab that all handle objects of this manager are created from
+     *  \note   a deleted handle is freed once nothing refers to it, and both its place within the
+     *          slab and its id are reused by later allocation, see __recycle_deleted_handle
      */
-    std::vector<T_POSHandle*> _handles;
+    POSUtilSlab<T_POSHandle> _handle_slab;
+
+    // hot metadata of all handles, see POSHandleHotMeta
+    POSHandleHotMeta _hot_meta;
+
+    /*!
+     *  \brief  ids of handles that haven't been deleted (in no particular order), and the position
+     *          of each handle within it (indexed by handle id, UINT64_MAX for not live)
+     *  \note   a handle leaves this list once it's marked as Delete_Pending, both are only
+     *          updated by the parser thread
+     */
+    std::vector<pos_u64id_t> _live_handle_ids;
+    std::vector<uint64_t> _live_handle_pos;
+
+    /*!
+     *  \brief  add / remove a handle to / from the list of live handles
+     *  \param  id  index of the handle
+     */
+    inline void __add_live_handle(pos_u64id_t id){
+        if(unlikely(id >= this->_live_handle_pos.size())){
+            this->_live_handle_pos.resize(std::max<uint64_t>(id + 1, this->_live_handle_pos.size() * 2), UINT64_MAX);
+        }
+        if(unlikely(this->_live_handle_pos[id] != UINT64_MAX)){ return; }
+        this->_live_handle_pos[id] = this->_live_handle_ids.size();
+        this->_live_handle_ids.push_back(id);
+    }
+    inline bool __remove_live_handle(pos_u64id_t id){
+        uint64_t pos;
+        if(unlikely(id >= this->_live_handle_pos.size() || this->_live_handle_pos[id] == UINT64_MAX)){ return false; }
+        pos = this->_live_handle_pos[id];
+        this->_live_handle_ids[pos] = this->_live_handle_ids.back();
+        this->_live_handle_pos[this->_live_handle_ids[pos]] = pos;
+        this->_live_handle_ids.pop_back();
+        this->_live_handle_pos[id] = UINT64_MAX;
+        return true;
+    }
+
+
+    /*!
+     *  \brief  ids of handles marked as Delete_Pending, along with the epoch of the WQE arena when
+     *          each was marked (see POSAPIContextArena::get_epoch_counter), in the order of deletion
+     *  \note   only accessed by the parser thread
+     */
+    std::deque<std::pair<pos_u64id_t, uint64_t>> _deleted_handles;
+
+    // epoch counter of the WQE arena of the client, deleted handles are never freed if it's unbound
+    const std::atomic<uint64_t> *_apicxt_epoch;
+
+    // number of in-flight checkpoints, which pause freeing deleted handles
+    uint64_t _nb_recycle_pauses;
+
+    // ids of freed handles, to be reused by later allocation
+    std::vector<pos_u64id_t> _free_handle_ids;
+
+    /*!
+     *  \brief  free a deleted handle that nothing refers to any more, and put its id to _free_handle_ids
+     *  \note   a deleted handle is no longer referred once (1) the worker has executed its deletion,
+     *          (2) all WQEs issued before its deletion are recycled, (3) it's the parent of no other
+     *          handle, and (4) no checkpoint, which holds handles on its own, is in flight; memoized
+     *          launches don't count, as they are invalidated by the address epoch bumped by deletion
+     *  \return POS_SUCCESS for successfully freed a handle;
+     *          POS_FAILED_NOT_EXIST for no deleted handle could be freed
+     */
+    pos_retval_t __recycle_deleted_handle();
 
     
     // resource type id of this handle manager
@@ -798,7 +1361,7 @@ class POSHandleManager {
      *  \param  expected_addr       the expected mock addr to allocate the resource (optional)
      *  \note   this function should be internally invoked by allocate_mocked_resource, which leave 
      *          to children class to implement
-     *  \return POS_FAILED_DRAIN for run out of virtual address space; 
+     *  \return POS_FAILED_DRAIN for run out of virtual address space or handle ids;
      *          POS_SUCCESS for successfully allocation
      */
     pos_retval_t __allocate_mocked_resource(
@@ -811,7 +1374,12 @@ class POSHandleManager {
 
 
  private:
-    std::unordered_map<uint64_t, T_POSHandle*> _deleted_handle_address_map;
+    /*!
+     *  \brief  client-side address ranges released by deleted handles, to be reused by subsequent
+     *          allocations of the same size (only for non-passthrough handle manager)
+     *  \note   key: size of the range; value: base addresses of the ranges
+     */
+    std::unordered_map<uint64_t, std::vector<uint64_t>> _reclaimed_client_addrs;
     /* ================================ basic ================================ */
 
 
@@ -839,19 +1407,73 @@ class POSHandleManager {
 
     /*!
      *  \brief  obtain the number of recorded handles
+     *  \note   this is also the upper bound of ids of all recorded handles, including those deleted
      *  \return the number of recorded handles
      */
-    inline uint64_t get_nb_handles(){ return this->_handles.size(); }
+    inline uint64_t get_nb_handles(){ return this->_nb_handles.load(std::memory_order_acquire); }
+
+
+    /*!
+     *  \brief  obtain the number of live handles, i.e., those haven't been deleted
+     *  \return the number of live handles
+     */
+    inline uint64_t get_nb_live_handles(){ return this->_live_handle_ids.size(); }
+
+
+    /*!
+     *  \brief  invoke the given function on every live handle (in no particular order), which
+     *          costs proportional to the number of live handles instead of all recorded handles
+     *  \note   this function should be called at the parser thread (or before the parser start)
+     *  \param  fn  the function to be invoked, with the handle as parameter
+     */
+    template<typename T_Fn>
+    inline void for_each_live_handle(T_Fn&& fn){
+        for(pos_u64id_t id : this->_live_handle_ids){ fn((T_POSHandle*)(this->_hot_meta.get_handle(id))); }
+    }
+
+
+    /*!
+     *  \brief  view of all handles recorded by the manager when the snapshot is taken
+     *  \note   it refers to the chunked table of _hot_meta instead of copying, whose slots never
+     *          move once allocated and are filled before being published, so that it's safe to
+     *          iterate the snapshot from any thread while the parser keeps allocating handles
+     *  \note   slots of ids never recorded (e.g., holes left by restoring) are nullptr
+     */
+    class handle_snapshot_t {
+     public:
+        handle_snapshot_t(const POSHandleHotMeta *hot_meta, uint64_t nb_handles)
+            : _hot_meta(hot_meta), _nb_handles(nb_handles) {}
+
+        class iterator {
+         public:
+            iterator(const POSHandleHotMeta *hot_meta, uint64_t id) : _hot_meta(hot_meta), _id(id) {}
+            inline T_POSHandle* operator*() const { return (T_POSHandle*)(this->_hot_meta->try_get_handle(this->_id)); }
+            inline iterator& operator++(){ this->_id += 1; return *this; }
+            inline bool operator!=(const iterator& other) const { return this->_id != other._id; }
+         private:
+            const POSHandleHotMeta *_hot_meta;
+            uint64_t _id;
+        };
+
+        inline iterator begin() const { return iterator(this->_hot_meta, 0); }
+        inline iterator end() const { return iterator(this->_hot_meta, this->_nb_handles); }
+        inline uint64_t size() const { return this->_nb_handles; }
+        inline T_POSHandle* operator[](uint64_t id) const {
+            return id < this->_nb_handles ? (T_POSHandle*)(this->_hot_meta->try_get_handle(id)) : nullptr;
+        }
+
+     private:
+        const POSHandleHotMeta *_hot_meta;
+        uint64_t _nb_handles;
+    };
 
 
     /*!
-     *  \brief  obtain all handles
-     *  \note   aware of thread safety when use this function
-     *  \return the list of handles
+     *  \brief  obtain all handles, without copying
+     *  \return snapshot of the current handle list, see handle_snapshot_t
      */
-    inline std::vector<T_POSHandle*> get_handles(){ 
-        /* here is a snapshot of current handle list */
-        return this->_handles;
+    inline handle_snapshot_t get_handles(){
+        return handle_snapshot_t(&(this->_hot_meta), this->get_nb_handles());
     }
 
 
@@ -864,7 +1486,7 @@ class POSHandleManager {
         if(unlikely(id >= this->get_nb_handles())){
             return nullptr;
         } else {
-            return this->_handles[id];
+            return (T_POSHandle*)(this->_hot_meta.try_get_handle(id));
         }
     }
 
@@ -905,7 +1527,9 @@ class POSHandleManager {
         POS_CHECK_POINTER(handle);
 
         if(likely(POS_FAILED_NOT_EXIST == __get_handle_by_client_addr(addr, &__tmp))){
-            _handle_address_map[addr_u64] = handle;
+            _hot_meta.sync(handle);
+            _handle_address_index.insert(addr_u64, handle->size, handle->id);
+            _address_epoch += 1;
         } else {
             POS_CHECK_POINTER(__tmp);
 
@@ -924,6 +1548,75 @@ class POSHandleManager {
         return retval;
     }
 
+
+    /*!
+     *  \brief  obtain the epoch of the address index
+     *  \note   the epoch is bumped whenever a handle is added to / removed from the address index,
+     *          so that a cached translation from client-side address to handle (e.g., memoized
+     *          parsing of kernel launch) stays valid as long as the epoch is unchanged
+     *  \return epoch of the address index
+     */
+    inline uint64_t get_address_epoch() const { return _address_epoch; }
+
+
+    /*!
+     *  \brief  scan a buffer (e.g., a struct parameter of a kernel) for potential client-side
+     *          addresses of handles, i.e., a 48-bit address starting at every byte offset
+     *  \note   8 consecutive offsets are assembled from two 8-byte words at once, and those
+     *          out of the window of the address index are rejected by a single compare per lane;
+     *          the survivors are then checked against the page filter of the index, and only
+     *          those pass both are searched within the index
+     *  \param  buf     base address of the buffer
+     *  \param  size    size of the buffer
+     *  \param  fn      function to be invoked on each found handle, with the offset within the
+     *                  buffer, the client-side address, and the handle as parameters
+     */
+    template<typename T_Fn>
+    inline void scan_client_addrs(const uint8_t* buf, uint64_t size, T_Fn&& fn){
+        static constexpr uint64_t kAddrMask = (1ul << 48) - 1;
+        uint64_t i, offset, window_begin, window_end, window_size, words[2], lanes[8], lane_mask;
+        T_POSHandle *handle;
+
+        auto __check = [&](uint64_t offset, uint64_t addr){
+            if(likely(!this->_handle_address_index.may_cover(addr))){ return; }
+            if(POS_SUCCESS == this->__get_handle_by_client_addr((void*)addr, &handle)){
+                fn(offset, addr, handle);
+            }
+        };
+
+        POS_CHECK_POINTER(buf);
+        if(unlikely(size < 6)){ return; }
+
+        this->_handle_address_index.get_window(&window_begin, &window_end);
+        window_size = window_end - window_begin;
+        if(unlikely(window_size == 0)){ return; }
+
+        // 8 offsets per iteration, offset + 7 needs 6 bytes, so 14 bytes are read within the 16 loaded
+        for(offset=0; offset+16<=size; offset+=8){
+            memcpy(words, buf + offset, sizeof(words));
+            lanes[0] = words[0] & kAddrMask;
+            for(i=1; i<8; i++){
+                lanes[i] = ((words[0] >> (i * 8)) | (words[1] << (64 - i * 8))) & kAddrMask;
+            }
+            lane_mask = 0;
+            for(i=0; i<8; i++){
+                lane_mask |= (uint64_t)(lanes[i] - window_begin < window_size) << i;
+            }
+            while(unlikely(lane_mask != 0)){
+                i = __builtin_ctzl(lane_mask);
+                __check(offset + i, lanes[i]);
+                lane_mask &= lane_mask - 1;
+            }
+        }
+
+        // the rest offsets
+        for(; offset+6<=size; offset++){
+            words[0] = 0;
+            memcpy(words, buf + offset, 6);
+            if(words[0] - window_begin < window_size){ __check(offset, words[0]); }
+        }
+    }
+
  protected:
     uint64_t _base_ptr;
     
@@ -935,7 +1628,16 @@ class POSHandleManager {
 
 
  private:
-    std::map<uint64_t, T_POSHandle*> _handle_address_map;
+    /*!
+     *  \brief  index of client-side address ranges of all live handles
+     *  \note   it's queried for every pointer argument of every API (e.g., cudaLaunchKernel),
+     *          see POSUtilRangeIndex for the layout; the index maps to handle id, which is then
+     *          resolved through _hot_meta without touching the handle objects
+     */
+    POSUtilRangeIndex<pos_u64id_t> _handle_address_index;
+
+    // epoch of the address index, see get_address_epoch
+    uint64_t _address_epoch = 0;
     /* ======================== address management =========================== */
 
 
@@ -947,7 +1649,18 @@ class POSHandleManager {
      */
     inline void record_modified_handle(T_POSHandle* handle){
         POS_CHECK_POINTER(handle);
-        _modified_handles.insert(handle);
+        _modified_handles.set(handle->id);
+    }
+
+
+    /*!
+     *  \brief  check whether the handle was modified since the records were cleared
+     *  \param  handle  the handle to be checked
+     *  \return true for the handle was modified
+     */
+    inline bool is_modified_handle(T_POSHandle* handle) const {
+        POS_CHECK_POINTER(handle);
+        return _modified_handles.test(handle->id);
     }
 
 
@@ -955,36 +1668,73 @@ class POSHandleManager {
      *  \brief  clear all records of modified handles
      */
     inline void clear_modified_handle(){ 
-        _modified_handles.clear();
+        _modified_handles.clear_all();
     }
 
 
     /*!
-     *  \brief  get all records of modified handles
-     *  \return all records of modified handles
+     *  \brief  invoke the given function on every modified handle
+     *  \param  fn  the function to be invoked, with the modified handle as parameter
      */
-    inline std::set<T_POSHandle*>& get_modified_handles(){
-        return _modified_handles;
+    template<typename T_Fn>
+    inline void for_each_modified_handle(T_Fn&& fn){
+        _modified_handles.for_each([&](uint64_t id){ fn((T_POSHandle*)(this->_hot_meta.get_handle(id))); });
     }
 
 
+    /*!
+     *  \brief  obtain the number of modified handles
+     *  \return number of modified handles
+     */
+    inline uint64_t get_nb_modified_handles() const { return _modified_handles.count(); }
+
+
  protected:
     /*!
-     *  \brief  this map records all modified buffers since last checkpoint, 
-     *          will be updated during parsing, and cleared during launching
-     *          checkpointing op
+     *  \brief  this bitmap (indexed by handle id) records all modified buffers since last checkpoint,
+     *          will be updated during parsing, and cleared during launching checkpointing op
      */
-    std::set<T_POSHandle*> _modified_handles;
+    POSUtilBitmap _modified_handles;
     /* ======================== incremental support ========================== */
 
 
     /* ===================== handle status management ======================== */
  public:
+    /*!
+     *  \brief  count handles of this manager which are pending to be created or broken into the
+     *          given counter, see POSClient::nb_nonactive_handles
+     *  \param  counter the given counter
+     */
+    inline void bind_nonactive_counter(std::atomic<int64_t> *counter){
+        this->_hot_meta.bind_nonactive_counter(counter);
+    }
+
+    /*!
+     *  \brief  bind the epoch counter of the WQE arena of the client, to learn when a deleted handle
+     *          is no longer referred by any WQE, see __recycle_deleted_handle
+     *  \param  epoch   the epoch counter
+     */
+    inline void bind_apicxt_epoch(const std::atomic<uint64_t> *epoch){
+        this->_apicxt_epoch = epoch;
+    }
+
+    /*!
+     *  \brief  pause / resume freeing deleted handles, while a checkpoint is in flight
+     *  \note   this function should be called at the parser thread
+     */
+    inline void pause_handle_recycle(){ this->_nb_recycle_pauses += 1; }
+    inline void resume_handle_recycle(){
+        POS_ASSERT(this->_nb_recycle_pauses > 0);
+        this->_nb_recycle_pauses -= 1;
+    }
+
     inline pos_retval_t mark_handle_status(T_POSHandle *handle, pos_handle_status_t status){
         pos_retval_t retval = POS_SUCCESS;
-        typename std::map<uint64_t, T_POSHandle*>::iterator handle_map_iter;
+        pos_u64id_t removed_id;
         
         POS_CHECK_POINTER(handle);
+
+        _hot_meta.set_status(handle->id, status);
         
         switch (status)
         {
@@ -1015,14 +1765,19 @@ class POSHandleManager {
         case kPOS_HandleStatus_Delete_Pending:
             handle->status = kPOS_HandleStatus_Delete_Pending;
 
-            // remove the handle from the address map
-            handle_map_iter = _handle_address_map.find((uint64_t)(handle->client_addr));
-            if (likely(handle_map_iter != _handle_address_map.end())) {
-                _deleted_handle_address_map.insert({
-                    /* client_addr */ (uint64_t)(handle->client_addr),
-                    /* handle */ handle_map_iter->second
+            // remove the handle from the address index, and release its client-side address for reusing
+            if (likely(POS_SUCCESS == _handle_address_index.erase((uint64_t)(handle->client_addr), &removed_id))) {
+                if(!this->_passthrough){
+                    _reclaimed_client_addrs[handle->size].push_back((uint64_t)(handle->client_addr));
+                }
+                _address_epoch += 1;
+            }
+
+            // the handle won't be involved in subsequent checkpoints, and would be freed once unreferred
+            if(likely(this->__remove_live_handle(handle->id) && this->_apicxt_epoch != nullptr)){
+                this->_deleted_handles.push_back({
+                    handle->id, this->_apicxt_epoch->load(std::memory_order_acquire)
                 });
-                _handle_address_map.erase((uint64_t)(handle->client_addr));   
             }
 
             POS_DEBUG_C(
@@ -1034,15 +1789,10 @@ class POSHandleManager {
         case kPOS_HandleStatus_Deleted:
             handle->status = kPOS_HandleStatus_Deleted;
 
-            // remove the handle from the address map (should be already deleted in the last case)
-            handle_map_iter = _handle_address_map.find((uint64_t)(handle->client_addr));
-            if (unlikely(handle_map_iter != _handle_address_map.end())) {
+            // remove the handle from the address index (should be already deleted in the last case)
+            if (unlikely(POS_SUCCESS == _handle_address_index.erase((uint64_t)(handle->client_addr), &removed_id))) {
                 POS_WARN_C_DETAIL("remove handle from address map when mark it as deleted, is this a bug?");
-                _deleted_handle_address_map.insert({
-                    /* client_addr */ (uint64_t)(handle->client_addr),
-                    /* handle */ handle_map_iter->second
-                });
-                _handle_address_map.erase((uint64_t)(handle->client_addr));
+                _address_epoch += 1;
             }
 
             POS_DEBUG_C(
@@ -1130,6 +1880,7 @@ class POSHandleManager {
         //! \todo   is simply reasssign server-side address enough?
         handle->server_addr = preserved_handle->server_addr;
         handle->status = kPOS_HandleStatus_Active;
+        this->_hot_meta.sync(handle);
 
     exit:
         return retval;
@@ -1166,7 +1917,8 @@ class POSHandleManager {
      *  \param  size                    size of thhe handle
      *  \param  parent_handles_waitlist  list of parent handles and their type
      *  \param  state_size              size of state behind this handle
-     *  \return POS_SUCCESS for successfully restore
+     *  \return POS_SUCCESS for successfully restore;
+     *          POS_FAILED_INVALID_INPUT for the handle id is beyond the capacity of the manager
      */
     pos_retval_t __restore_mocked_resource(
         T_POSHandle** handle,
@@ -1189,7 +1941,7 @@ class POSHandleManager {
  *                              (note: these related handles might be other types)
  *  \param  use_expected_addr   indicate whether to use expected client-side address
  *  \param  expected_addr       the expected mock addr to allocate the resource (optional)
- *  \return POS_FAILED_DRAIN for run out of virtual address space; 
+ *  \return POS_FAILED_DRAIN for run out of virtual address space or handle ids;
  *          POS_SUCCESS for successfully allocation
  */
 template<class T_POSHandle>
@@ -1212,7 +1964,7 @@ pos_retval_t POSHandleManager<T_POSHandle>::allocate_mocked_resource(
  *  \param  use_expected_addr   whether to use expected client address
  *  \param  expected_addr       the expected mock addr to allocate the resource (optional)
  *  \note   this function should be internally invoked by allocate_mocked_resource, which leave to children class to implement
- *  \return POS_FAILED_DRAIN for run out of virtual address space;
+ *  \return POS_FAILED_DRAIN for run out of virtual address space or handle ids;
  *          POS_FAILED_ALREADY_EXIST for duplication failed;
  *          POS_SUCCESS for successfully allocation
  */
@@ -1225,14 +1977,35 @@ pos_retval_t POSHandleManager<T_POSHandle>::__allocate_mocked_resource(
     uint64_t state_size
 ){
     pos_retval_t retval = POS_SUCCESS;
+    uint64_t client_addr;
+    pos_u64id_t id;
+    bool is_recycled_id;
+    typename std::unordered_map<uint64_t, std::vector<uint64_t>>::iterator reclaimed_iter;
 
     POS_CHECK_POINTER(handle);
 
+    // reuse the id of a freed handle, otherwise make sure the new one still fits within the hot metadata table
+    if(likely(this->_free_handle_ids.size() == 0)){
+        this->__recycle_deleted_handle();
+    }
+    is_recycled_id = this->_free_handle_ids.size() > 0;
+    if(unlikely(is_recycled_id)){
+        id = this->_free_handle_ids.back();
+    } else {
+        id = this->get_nb_handles();
+        if(unlikely(id >= POSHandleHotMeta::get_capacity())){
+            POS_WARN_C("failed to allocate new resource, run out of handle ids: #handles(%lu)", id);
+            retval = POS_FAILED_DRAIN;
+            *handle = nullptr;
+            goto exit;
+        }
+    }
+
     if(this->_passthrough){
-        *handle = new T_POSHandle(
+        *handle = this->_handle_slab.create(
             /* size_ */ size,
             /* hm */ this,
-            /* id_ */ this->_handles.size(),
+            /* id_ */ id,
             /* state_size_ */ state_size
         );
         POS_CHECK_POINTER(*handle);
@@ -1242,6 +2015,30 @@ pos_retval_t POSHandleManager<T_POSHandle>::__allocate_mocked_resource(
             this->_base_ptr = expected_addr;
         }
 
+        // reuse the client-side address released by a deleted handle with the same size
+        if(likely(use_expected_addr == false)){
+            reclaimed_iter = this->_reclaimed_client_addrs.find(size);
+            if(reclaimed_iter != this->_reclaimed_client_addrs.end() && reclaimed_iter->second.size() > 0){
+                client_addr = reclaimed_iter->second.back();
+                reclaimed_iter->second.pop_back();
+
+                *handle = this->_handle_slab.create(
+                    /* client_addr */ (void*)(client_addr),
+                    /* size_ */ size,
+                    /* hm */ this,
+                    /* id_ */ id,
+                    /* state_size_ */ state_size
+                );
+                POS_CHECK_POINTER(*handle);
+
+                retval = record_handle_address((void*)(client_addr), *handle);
+                if(unlikely(POS_SUCCESS != retval)){
+                    goto exit;
+                }
+                goto allocated;
+            }
+        }
+
         // make sure the resource to be allocated won't exceed the range
         if(unlikely(kPOS_ResourceEndAddr - this->_base_ptr < size)){
             POS_WARN_C(
@@ -1253,11 +2050,11 @@ pos_retval_t POSHandleManager<T_POSHandle>::__allocate_mocked_resource(
             goto exit;
         }
 
-        *handle = new T_POSHandle(
+        *handle = this->_handle_slab.create(
             /* client_addr */ (void*)(this->_base_ptr),
             /* size_ */ size,
             /* hm */ this,
-            /* id_ */ this->_handles.size(),
+            /* id_ */ id,
             /* state_size_ */ state_size
         );
         POS_CHECK_POINTER(*handle);
@@ -1271,18 +2068,80 @@ pos_retval_t POSHandleManager<T_POSHandle>::__allocate_mocked_resource(
         this->_base_ptr += size;
     }
 
+allocated:
     POS_DEBUG_C(
         "allocate new resource: _base_ptr(%p), size(%lu), POSHandle.resource_type_id(%u)",
         this->_base_ptr, size, (*handle)->resource_type_id
     );
 
-    this->_handles.push_back(*handle);
+    this->_hot_meta.sync(*handle);
+    this->__publish_handle((*handle)->id);
+    this->__add_live_handle((*handle)->id);
+
+    // the previous holder of the id might be recorded by the base image of incremental checkpoint
+    if(unlikely(is_recycled_id)){
+        this->_free_handle_ids.pop_back();
+        this->record_modified_handle(*handle);
+    }
 
   exit:
     return retval;
 }
 
 
+template<class T_POSHandle>
+pos_retval_t POSHandleManager<T_POSHandle>::__recycle_deleted_handle(){
+    pos_retval_t retval = POS_FAILED_NOT_EXIST;
+    uint64_t i, nb_scanned, epoch;
+    std::pair<pos_u64id_t, uint64_t> deleted;
+    T_POSHandle *deleted_handle;
+
+    if(likely(this->_deleted_handles.size() == 0)){ goto exit; }
+    if(unlikely(this->_nb_recycle_pauses > 0 || this->_apicxt_epoch == nullptr)){ goto exit; }
+
+    epoch = this->_apicxt_epoch->load(std::memory_order_acquire);
+
+    // deleted handles still referred by children are rotated to the back, so we only scan a few
+    nb_scanned = std::min<uint64_t>(this->_deleted_handles.size(), POS_HANDLE_RECYCLE_MAX_NB_SCANS);
+    for(i=0; i<nb_scanned; i++){
+        deleted = this->_deleted_handles.front();
+
+        // WQEs issued before the deletion might still be alive, so are those of later deletion
+        if(deleted.second + 2 > epoch){ break; }
+        this->_deleted_handles.pop_front();
+
+        POS_CHECK_POINTER(deleted_handle = (T_POSHandle*)(this->_hot_meta.get_handle(deleted.first)));
+        if(     this->_hot_meta.get_status(deleted.first) != kPOS_HandleStatus_Deleted
+            ||  deleted_handle->get_nb_children() > 0
+            ||  deleted_handle == this->latest_used_handle
+            ||  deleted_handle == this->default_handle
+            ||  this->_pooled_handles.count(deleted_handle) > 0
+        ){
+            this->_deleted_handles.push_back(deleted);
+            continue;
+        }
+
+        deleted_handle->drop_parent_handles();
+        if(deleted_handle->ckpt_bag != nullptr){
+            deleted_handle->ckpt_bag->clear();
+            delete deleted_handle->ckpt_bag;
+        }
+        if(deleted_handle->dirty_chunks != nullptr){
+            delete deleted_handle->dirty_chunks;
+        }
+        this->_handle_slab.destroy(deleted_handle);
+        this->_hot_meta.remove(deleted.first);
+
+        this->_free_handle_ids.push_back(deleted.first);
+        retval = POS_SUCCESS;
+        break;
+    }
+
+exit:
+    return retval;
+}
+
+
 /*!
  *  \brief  obtain a handle by given client-side address
  *  \param  client_addr the given client-side address
@@ -1309,67 +2168,32 @@ pos_retval_t POSHandleManager<T_POSHandle>::get_handle_by_client_addr(void* clie
 template<class T_POSHandle>
 pos_retval_t POSHandleManager<T_POSHandle>::__get_handle_by_client_addr(void* client_addr, T_POSHandle** handle, uint64_t* offset){
     pos_retval_t ret = POS_SUCCESS;
-    T_POSHandle *handle_ptr;
-    uint64_t i;
-    uint64_t client_addr_u64 = (uint64_t)(client_addr);
-
-    typename std::map<uint64_t, T_POSHandle*>::iterator handle_map_iter;
+    pos_u64id_t id;
 
     POS_CHECK_POINTER(handle);
-    
+
     /*!
-     *  \note   direct case: the given address is exactly the base address
+     *  \note   a single lookup covers both the direct case (i.e., the given address is exactly
+     *          the base address) and the indirect case (i.e., the given address is beyond the
+     *          base address), and the last hit handle is checked first
      */
-    if(unlikely(this->_handle_address_map.count(client_addr_u64) > 0)){
-        *handle = this->_handle_address_map[client_addr_u64];
-
-        /*!
-         *  \note   those handle that has been deleted (i.e., kPOS_HandleStatus_Deleted) and 
-         *          are going to be deleted (i.e., kPOS_HandleStatus_Delete_Pending) must be
-         *          not in the map! 
-         */
-        POS_ASSERT(
-            (*handle)->status != kPOS_HandleStatus_Deleted 
-            && (*handle)->status != kPOS_HandleStatus_Delete_Pending
-        );
-
-        if(unlikely(offset != nullptr)){
-            *offset = 0;
-        }
+    if(unlikely(POS_SUCCESS != (ret = this->_handle_address_index.lookup((uint64_t)(client_addr), &id, offset)))){
+        *handle = nullptr;
+        ret = POS_FAILED_NOT_EXIST;
         goto exit;
     }
-    
+
     /*!
-     *  \brief  indirect case: the given address is beyond the base address
-     *  \note   most of query will fall back to this part
+     *  \note   those handle that has been deleted (i.e., kPOS_HandleStatus_Deleted) and 
+     *          are going to be deleted (i.e., kPOS_HandleStatus_Delete_Pending) must be
+     *          not in the index! 
      */
-    handle_map_iter = this->_handle_address_map.lower_bound(client_addr_u64);
-    if(handle_map_iter != this->_handle_address_map.begin()){
-        // get the first handle less than the given address
-        handle_map_iter--;
-        handle_ptr = handle_map_iter->second;
-
-        POS_ASSERT(
-            handle_ptr->status != kPOS_HandleStatus_Deleted && handle_ptr->status != kPOS_HandleStatus_Delete_Pending
-        );
-
-        if(likely(
-            (uint64_t)(handle_ptr->client_addr) <= client_addr_u64 
-            && client_addr_u64 < (uint64_t)(handle_ptr->client_addr) + handle_ptr->size
-        )){
-            *handle = handle_ptr;
-
-            if(offset != nullptr){
-                *offset = client_addr_u64 - (uint64_t)(handle_ptr->client_addr);
-            }
-
-            goto exit;
-        }
-    }
+    POS_ASSERT(
+        this->_hot_meta.get_status(id) != kPOS_HandleStatus_Deleted 
+        && this->_hot_meta.get_status(id) != kPOS_HandleStatus_Delete_Pending
+    );
 
-not_found:
-    *handle = nullptr;
-    ret = POS_FAILED_NOT_EXIST;
+    *handle = (T_POSHandle*)(this->_hot_meta.get_handle(id));
 
 exit:
     return ret;
@@ -1389,11 +2213,6 @@ pos_retval_t POSHandleManager<T_POSHandle>::__restore_mocked_resource(
     pos_retval_t retval = POS_SUCCESS;
     POS_CHECK_POINTER(handle);
 
-    // resize vector on-demand
-    if(this->_handles.size() <= id){
-        this->_handles.resize(id+1, nullptr);
-    }
-
     /*!
      *  \brief  check conflict on handle index
      *  \note   wo tolerate conflict handle index, as some initialized handles might be created while handle manager be initialized
@@ -1403,8 +2222,14 @@ pos_retval_t POSHandleManager<T_POSHandle>::__restore_mocked_resource(
     //     retval = POS_FAILED_ALREADY_EXIST;
     //     goto exit;
     // }
-    if(unlikely(this->_handles[id] != nullptr)){
-        *handle = this->_handles[id];
+    if(unlikely(this->_hot_meta.try_get_handle(id) != nullptr)){
+        *handle = (T_POSHandle*)(this->_hot_meta.try_get_handle(id));
+        goto exit;
+    }
+
+    if(unlikely(id >= POSHandleHotMeta::get_capacity())){
+        POS_WARN_C("failed to restore mocked resource, handle id out of range: id(%lu)", id);
+        retval = POS_FAILED_INVALID_INPUT;
         goto exit;
     }
 
@@ -1419,7 +2244,7 @@ pos_retval_t POSHandleManager<T_POSHandle>::__restore_mocked_resource(
     // }
 
     if(this->_passthrough){
-        *handle = new T_POSHandle(
+        *handle = this->_handle_slab.create(
             /* size_ */ size,
             /* hm */ this,
             /* id_ */ id,
@@ -1444,7 +2269,7 @@ pos_retval_t POSHandleManager<T_POSHandle>::__restore_mocked_resource(
             this->_base_ptr = client_addr + size;
         }
 
-        *handle = new T_POSHandle(
+        *handle = this->_handle_slab.create(
             /* client_addr */ (void*)(client_addr),
             /* size_ */ size,
             /* hm */ this,
@@ -1469,7 +2294,9 @@ pos_retval_t POSHandleManager<T_POSHandle>::__restore_mocked_resource(
     (*handle)->parent_handles_waitlist = parent_handles_waitlist;
 
     POS_DEBUG_C("allocated mocked resource: client_addr(%p), size(%lu)", client_addr, size);
-    this->_handles[id] = (*handle);
+    this->_hot_meta.sync(*handle);
+    this->__publish_handle(id);
+    this->__add_live_handle(id);
 
 exit:
     return retval;
@@ -19,3 +19,4 @@
 #include "pos/include/metrics/reducer.h"
 #include "pos/include/metrics/ticker.h"
 #include "pos/include/metrics/sequence.h"
+#include "pos/include/metrics/histogram.h"
@@ -40,6 +40,16 @@ class POSMetrics_CounterList {
     }
 
 
+    inline void add_counter(K index, uint64_t value){
+        auto it = this->_map.find(index);
+        if(unlikely(it == this->_map.end())){
+            this->_map[index] = value;
+        } else {
+            this->_map[index] += value;
+        }
+    }
+
+
     inline uint64_t get_counter(K index){
         auto it = this->_map.find(index);
         if(unlikely(it == this->_map.end())){
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <stdint.h>
+
+#include "pos/include/common.h"
+
+
+/*!
+ *  \brief  number of sub-buckets per power of two of the histogram (as 2^bits), which bounds
+ *          the relative error of the reported value to 1/2^bits (i.e., 12.5%)
+ */
+#define POS_METRICS_HISTOGRAM_SUB_BUCKET_BITS   3
+
+
+/*!
+ *  \brief  HDR-style histogram with logarithmic buckets
+ *  \note   values below 2^bits are recorded exactly, each power of two beyond is split into
+ *          2^bits linear sub-buckets
+ *  \note   the histogram should be recorded by a single thread, while it could be read
+ *          (e.g., merged) by other threads concurrently without any lock; the reader
+ *          might observe a slightly stale snapshot
+ */
+class POSMetrics_Histogram {
+ public:
+    POSMetrics_Histogram() : _count(0), _sum(0), _max(0) {
+        for(auto& bucket : this->_buckets){ bucket.store(0, std::memory_order_relaxed); }
+    }
+    ~POSMetrics_Histogram() = default;
+
+    static constexpr uint64_t kNbSubBuckets = 1ul << POS_METRICS_HISTOGRAM_SUB_BUCKET_BITS;
+    static constexpr uint64_t kNbBuckets = (64 - POS_METRICS_HISTOGRAM_SUB_BUCKET_BITS + 1) * kNbSubBuckets;
+
+
+    /*!
+     *  \brief  record a value
+     *  \note   should only be invoked by the owner thread of the histogram
+     *  \param  value   the value to be recorded
+     */
+    inline void record(uint64_t value){
+        __add(this->_buckets[get_bucket_index(value)], 1);
+        __add(this->_count, 1);
+        __add(this->_sum, value);
+        if(unlikely(value > this->_max.load(std::memory_order_relaxed))){
+            this->_max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+
+    /*!
+     *  \brief  merge another histogram into this one
+     *  \note   should only be invoked by the owner thread of this histogram, while the
+     *          merged histogram could be recorded concurrently
+     *  \param  other   the histogram to be merged
+     */
+    inline void merge(const POSMetrics_Histogram& other){
+        uint64_t i;
+        for(i=0; i<kNbBuckets; i++){
+            __add(this->_buckets[i], other._buckets[i].load(std::memory_order_relaxed));
+        }
+        __add(this->_count, other._count.load(std::memory_order_relaxed));
+        __add(this->_sum, other._sum.load(std::memory_order_relaxed));
+        if(other._max.load(std::memory_order_relaxed) > this->_max.load(std::memory_order_relaxed)){
+            this->_max.store(other._max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+
+    /*!
+     *  \brief  obtain the value at specified percentile
+     *  \param  percentile  the percentile, within [0, 100]
+     *  \return the upper bound of the bucket that holds the percentile, capped by the
+     *          maximum recorded value; 0 for empty histogram
+     */
+    inline uint64_t get_percentile(double percentile) const {
+        uint64_t i, count, target, accumulated = 0;
+
+        count = this->_count.load(std::memory_order_relaxed);
+        if(unlikely(count == 0)){ return 0; }
+
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        target = std::max<uint64_t>((uint64_t)(percentile / 100.0 * count + 0.5), 1);
+
+        for(i=0; i<kNbBuckets; i++){
+            accumulated += this->_buckets[i].load(std::memory_order_relaxed);
+            if(accumulated >= target){
+                return std::min(get_bucket_upper_bound(i), this->get_max());
+            }
+        }
+
+        return this->get_max();
+    }
+
+
+    inline uint64_t get_count() const { return this->_count.load(std::memory_order_relaxed); }
+    inline uint64_t get_sum() const { return this->_sum.load(std::memory_order_relaxed); }
+    inline uint64_t get_max() const { return this->_max.load(std::memory_order_relaxed); }
+    inline double get_avg() const {
+        uint64_t count = this->get_count();
+        return count > 0 ? (double)(this->get_sum()) / (double)(count) : (double)(0);
+    }
+
+
+    /*!
+     *  \brief  obtain the index of the bucket that holds the given value
+     *  \param  value   the given value
+     *  \return index of the bucket
+     */
+    static inline uint64_t get_bucket_index(uint64_t value){
+        uint64_t shift;
+        if(value < kNbSubBuckets){ return value; }
+        shift = 63 - __builtin_clzl(value) - POS_METRICS_HISTOGRAM_SUB_BUCKET_BITS;
+        return (shift + 1) * kNbSubBuckets + ((value >> shift) - kNbSubBuckets);
+    }
+
+
+    /*!
+     *  \brief  obtain the largest value that falls into the given bucket
+     *  \param  index   index of the bucket
+     *  \return the largest value of the bucket
+     */
+    static inline uint64_t get_bucket_upper_bound(uint64_t index){
+        uint64_t shift;
+        if(index < kNbSubBuckets){ return index; }
+        shift = index / kNbSubBuckets - 1;
+        return (((index % kNbSubBuckets + kNbSubBuckets) + 1) << shift) - 1;
+    }
+
+
+ private:
+    /*!
+     *  \brief  add to a counter of the histogram
+     *  \note   every counter has a single writer, so a relaxed load-store is enough and
+     *          avoids the locked read-modify-write on the recording path
+     */
+    static inline void __add(std::atomic<uint64_t>& counter, uint64_t value){
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> _buckets[kNbBuckets];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _max;
+};
+
+
+/*!
+ *  \brief  table of histograms, indexed by a row id (e.g., API id) and a column (e.g., stage)
+ *  \note   rows are allocated on the first record, so that the table only occupies memory for
+ *          those rows that have been recorded; like the histogram, the table should be recorded
+ *          by a single thread, while it could be read by other threads concurrently
+ *  \tparam nb_columns  number of histograms per row
+ */
+template<uint64_t nb_columns>
+class POSMetrics_HistogramTable {
+ public:
+    typedef struct row {
+        POSMetrics_Histogram columns[nb_columns];
+    } row_t;
+
+    /*!
+     *  \param  nb_rows maximum number of rows (i.e., the largest row id + 1)
+     */
+    POSMetrics_HistogramTable(uint64_t nb_rows) : _nb_rows(nb_rows) {
+        POS_CHECK_POINTER(this->_rows = new std::atomic<row_t*>[nb_rows]);
+        for(uint64_t i=0; i<nb_rows; i++){ this->_rows[i].store(nullptr, std::memory_order_relaxed); }
+    }
+
+    ~POSMetrics_HistogramTable(){
+        for(uint64_t i=0; i<this->_nb_rows; i++){
+            delete this->_rows[i].load(std::memory_order_relaxed);
+        }
+        delete[] this->_rows;
+    }
+
+
+    /*!
+     *  \brief  record a value
+     *  \note   should only be invoked by the owner thread of the table
+     *  \param  row_id  id of the row, values of out-of-range row are dropped
+     *  \param  column  column of the histogram within the row
+     *  \param  value   the value to be recorded
+     */
+    inline void record(uint64_t row_id, uint64_t column, uint64_t value){
+        row_t *row;
+
+        POS_ASSERT(column < nb_columns);
+        if(unlikely(row_id >= this->_nb_rows)){ return; }
+
+        row = this->_rows[row_id].load(std::memory_order_relaxed);
+        if(unlikely(row == nullptr)){
+            POS_CHECK_POINTER(row = new row_t());
+            this->_rows[row_id].store(row, std::memory_order_release);
+        }
+
+        row->columns[column].record(value);
+    }
+
+
+    /*!
+     *  \brief  merge another table into this one
+     *  \note   should only be invoked by the owner thread of this table, while the
+     *          merged table could be recorded concurrently
+     *  \param  other   the table to be merged
+     */
+    inline void merge(const POSMetrics_HistogramTable<nb_columns>& other){
+        uint64_t i, j;
+        const row_t *other_row;
+        row_t *row;
+
+        for(i=0; i<std::min(this->_nb_rows, other._nb_rows); i++){
+            if((other_row = other._rows[i].load(std::memory_order_acquire)) == nullptr){ continue; }
+            row = this->_rows[i].load(std::memory_order_relaxed);
+            if(row == nullptr){
+                POS_CHECK_POINTER(row = new row_t());
+                this->_rows[i].store(row, std::memory_order_release);
+            }
+            for(j=0; j<nb_columns; j++){ row->columns[j].merge(other_row->columns[j]); }
+        }
+    }
+
+
+    /*!
+     *  \brief  obtain the histogram of specified row and column
+     *  \param  row_id  id of the row
+     *  \param  column  column of the histogram within the row
+     *  \return pointer to the histogram, nullptr for the row hasn't been recorded
+     */
+    inline const POSMetrics_Histogram* get(uint64_t row_id, uint64_t column) const {
+        row_t *row;
+        POS_ASSERT(column < nb_columns);
+        if(unlikely(row_id >= this->_nb_rows)){ return nullptr; }
+        if((row = this->_rows[row_id].load(std::memory_order_acquire)) == nullptr){ return nullptr; }
+        return &(row->columns[column]);
+    }
+
+    inline uint64_t get_nb_rows() const { return this->_nb_rows; }
+
+ private:
+    std::atomic<row_t*> *_rows;
+    uint64_t _nb_rows;
+};
@@ -34,6 +34,8 @@ namespace agent_register_client {
         /* client */
         char job_name[kMaxJobNameLen+1];
         __pid_t pid;
+        bool is_daemon_dedicated;
+        uint32_t daemon_weight;
         /* server */
         bool is_registered;
     } oob_payload_t;
@@ -42,6 +44,8 @@ namespace agent_register_client {
     typedef struct oob_call_data {
         std::string job_name;
         __pid_t pid;
+        bool is_daemon_dedicated;
+        uint32_t daemon_weight;
     } oob_call_data_t;
 } // namespace agent_register_client
 
@@ -58,4 +58,32 @@ namespace cli_trace_resource {
 } // namespace cli_trace_resource
 
 
+namespace cli_trace_performance {
+    static constexpr uint32_t kTraceFilePathMaxLen = 128;
+    static constexpr uint32_t kServerRetMsgMaxLen = 128;
+
+    // name of the per-API latency report file within the trace directory
+    static constexpr const char* kAPILatencyFileName = "api_latency.txt";
+
+    // payload format
+    typedef struct oob_payload {
+        /* client */
+        char trace_dir[kTraceFilePathMaxLen];
+        /* server */
+        pos_retval_t retval;
+        char retmsg[kServerRetMsgMaxLen];
+    } oob_payload_t;
+    static_assert(sizeof(oob_payload_t) <= POS_OOB_MSG_MAXLEN);
+
+    // metadata from CLI
+    typedef struct oob_call_data {
+        /* client */
+        char trace_dir[kTraceFilePathMaxLen];
+        /* server */
+        pos_retval_t retval;
+        char retmsg[kServerRetMsgMaxLen];
+    } oob_call_data_t;
+} // namespace cli_trace_performance
+
+
 } // namespace oob_functions
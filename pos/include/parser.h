@@ -19,15 +19,18 @@
 #include <iostream>
 #include <thread>
 #include <vector>
+#include <string>
 #include <map>
 #include <sched.h>
 #include <pthread.h>
 #include "pos/include/common.h"
 #include "pos/include/log.h"
 #include "pos/include/utils/lockfree_queue.h"
+#include "pos/include/utils/dispatch_table.h"
 #include "pos/include/api_context.h"
 #include "pos/include/command.h"
 #include "pos/include/metrics.h"
+#include "pos/include/daemon_pool.h"
 
 // forward declaration
 class POSClient;
@@ -55,8 +58,10 @@ namespace ps_functions {
 
 /*!
  *  \brief  POS Parser
+ *  \note   the parser is driven by either its dedicated daemon thread, or the shared
+ *          daemon pool of the workspace (see POSDaemonPool)
  */
-class POSParser {
+class POSParser : public POSDaemonTask {
  public:
     /*!
      *  \brief  constructor
@@ -93,9 +98,17 @@ class POSParser {
 
         enum metrics_counter_type_t : uint8_t {
             KERNEL_number_of_user_kernels = 0,
-            KERNEL_number_of_vendor_kernels
+            KERNEL_number_of_vendor_kernels,
+            KERNEL_number_of_memoized_launches,
+            DAEMON_nb_parks
         };
         POSMetrics_CounterList<metrics_counter_type_t> metric_counters;
+
+        enum metrics_ticker_type_t : uint8_t {
+            DAEMON_busy_ticks = 0,
+            DAEMON_idle_ticks
+        };
+        POSMetrics_TickerList<metrics_ticker_type_t> metric_tickers;
     #endif
     /* ==================== POSParser Metrics ==================== */
 
@@ -115,48 +128,91 @@ class POSParser {
 
     // parser function map
     std::map<uint64_t, pos_runtime_parser_function_t> _parser_functions;
+
+    // flat table of parser functions, indexed by api_id
+    POSDispatchTable<pos_runtime_parser_function_t> _parser_function_table;
+
+    // buffers of polled elements, reused across polling iterations
+    POSCommand_QE_t* _cmd_wqes[POS_LOCKLESS_QUEUE_POLL_BATCH];
+    POSAPIContext_QE* _apicxt_wqes[POS_LOCKLESS_QUEUE_POLL_BATCH];
     
     /*!
      *  \brief  insertion of parse functions
+     *  \note   the implementation could either insert to _parser_functions, or directly
+     *          bind _parser_function_table to a flat array generated at compile time
      *  \return POS_SUCCESS for succefully insertion
      */
     virtual pos_retval_t init_ps_functions(){ return POS_FAILED_NOT_IMPLEMENTED; }
 
     /*!
-     *  \brief      initialization of the runtime daemon thread
-     *  \example    for CUDA, one need to call API e.g. cudaSetDevice first to setup the context for a thread
+     *  \brief  one polling iteration of the parser
+     *  \return number of digested elements, 0 for all queues are empty
      */
-    virtual pos_retval_t daemon_init(){ return POS_SUCCESS; }
+    uint64_t daemon_poll() override;
 
  private:
     /*!
-     *  \brief  processing daemon of the parser
+     *  \brief  processing daemon of the parser, which drives daemon_poll on the dedicated thread
      */
     void __daemon();
 
     /*!
-     *  \brief  insert checkpoint op to the DAG based on certain conditions
+     *  \brief  record the busy / idle statistics of the stopped daemon into metrics
+     */
+    void __record_daemon_metrics();
+
+    /*!
+     *  \brief  collect handles to be (pre)dumped by the checkpoint command
      *  \note   aware of the macro POS_CONF_EVAL_CkptEnableIncremental
+     *  \note   freeing deleted handles is paused until the command finished
+     *  \param  cmd     the checkpoint command
      *  \return POS_SUCCESS for successfully checkpoint insertion
      */
-    pos_retval_t __checkpoint_insertion();
+    pos_retval_t __checkpoint_insertion(POSCommand_QE_t *cmd);
 
     /*!
      *  \brief  naive implementation of checkpoint insertion procedure
-     *  \note   this implementation naively insert a checkpoint op, 
+     *  \note   this implementation naively records all handles of the target resource types,
      *          without any optimization hint
-     *  \param  client  the client to be checkpointed
+     *  \param  cmd     the checkpoint command
      *  \return POS_SUCCESS for successfully checkpoint insertion
      */
-    pos_retval_t __checkpoint_insertion_naive();
+    pos_retval_t __checkpoint_insertion_naive(POSCommand_QE_t *cmd);
 
     /*!
-     *  \brief  level-1/2 optimization of checkpoint insertion procedure
-     *  \note   this implementation give hints of those memory handles that
-     *          been modified (INOUT/OUT) since last checkpoint
+     *  \brief  incremental implementation of checkpoint insertion procedure
+     *  \note   this implementation only records those stateful handles that been modified
+     *          (INOUT/OUT) or created since the previous finished image, while the others
+     *          are referenced from that image
+     *  \param  cmd     the checkpoint command
      *  \return POS_SUCCESS for successfully checkpoint insertion
      */
-    pos_retval_t __checkpoint_insertion_incremental();
+    pos_retval_t __checkpoint_insertion_incremental(POSCommand_QE_t *cmd);
+
+    /*!
+     *  \brief  bookkeeping once the worker finished the checkpoint command
+     *  \note   a finished image becomes the base of the next incremental checkpoint, while
+     *          the modified records of a failed one are put back to the handle managers
+     *  \note   freeing deleted handles paused by the command is resumed
+     *  \param  cmd     the finished checkpoint command
+     */
+    void __checkpoint_insertion_finished(POSCommand_QE_t *cmd);
+
+    /*!
+     *  \brief  context of incremental checkpoint
+     */
+    typedef struct incremental_ckpt_cxt {
+        // directory of the latest finished image, which is the base of the next incremental image
+        std::string base_ckpt_dir;
+
+        // number of handles per resource type covered by the base image
+        std::map<pos_resource_typeid_t, uint64_t> base_nb_handles;
+
+        // the checkpoint command in flight, and number of handles per resource type it covers
+        POSCommand_QE_t *inflight_cmd = nullptr;
+        std::map<pos_resource_typeid_t, uint64_t> inflight_nb_handles;
+    } incremental_ckpt_cxt_t;
+    incremental_ckpt_cxt_t _incremental_ckpt_cxt;
 
 
     /*!
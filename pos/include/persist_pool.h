@@ -0,0 +1,197 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+#include "pos/include/common.h"
+#include "pos/include/log.h"
+
+
+// forward declaration
+class POSHandle;
+class POSCheckpointSlot;
+
+
+/*!
+ *  \brief  default number of threads within the persist pool
+ */
+#define POS_PERSIST_POOL_NB_THREADS         8
+
+/*!
+ *  \brief  jobs with state smaller than this size are regarded as small, a pool thread takes
+ *          consecutive small jobs at once, up to the given number of bytes / jobs, so that
+ *          small handles are written back-to-back without waking up a thread for each of them
+ */
+#define POS_PERSIST_POOL_SMALL_JOB_BYTES    MB(1)
+#define POS_PERSIST_POOL_BATCH_BYTES        MB(16)
+#define POS_PERSIST_POOL_BATCH_MAX_NB_JOBS  256
+
+
+/*!
+ *  \brief  completion tracking of all persisting raised by a checkpoint command
+ *  \note   multiple pool threads could complete jobs of the same group concurrently
+ */
+class POSPersistGroup {
+ public:
+    POSPersistGroup() : _nb_pending(0), _nb_done(0), _retval(POS_SUCCESS) {}
+    ~POSPersistGroup() = default;
+
+    /*!
+     *  \brief  reset the group for a new checkpoint command
+     *  \note   all jobs of the previous command should have been waited
+     */
+    inline void reset(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        POS_ASSERT(this->_nb_pending == 0);
+        this->_nb_done = 0;
+        this->_retval = POS_SUCCESS;
+    }
+
+    /*!
+     *  \brief  record a job submitted under this group
+     */
+    inline void add(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_nb_pending += 1;
+    }
+
+    /*!
+     *  \brief  record a finished job of this group, and wake up the waiter once all jobs finished
+     *  \param  retval  result of the job
+     */
+    inline void done(pos_retval_t retval){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        POS_ASSERT(this->_nb_pending > 0);
+        this->_nb_pending -= 1;
+        this->_nb_done += 1;
+        if(unlikely(retval != POS_SUCCESS)){ this->_retval = retval; }
+        if(this->_nb_pending == 0){ this->_cv.notify_all(); }
+    }
+
+    /*!
+     *  \brief  wait until all jobs submitted under this group are finished
+     *  \return POS_SUCCESS for all jobs succeeded, otherwise the result of a failed job
+     */
+    inline pos_retval_t wait(){
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_cv.wait(lock, [this]{ return this->_nb_pending == 0; });
+        return this->_retval;
+    }
+
+    /*!
+     *  \brief  obtain the number of finished jobs since last reset
+     *  \return number of finished jobs
+     */
+    inline uint64_t get_nb_done(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_nb_done;
+    }
+
+ private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    uint64_t _nb_pending;
+    uint64_t _nb_done;
+    pos_retval_t _retval;
+};
+
+
+/*!
+ *  \brief  fixed-size thread pool that persists checkpoints of handles to the file system,
+ *          shared by all clients within the workspace
+ *  \note   pending jobs are ordered by their state size, so that large handles start first
+ *          and won't become the tail of the checkpoint; jobs of the same size are served
+ *          in submission order
+ */
+class POSPersistPool {
+ public:
+    /*!
+     *  \brief  constructor, which raises all pool threads
+     *  \param  nb_threads  number of pool threads
+     */
+    POSPersistPool(uint32_t nb_threads);
+
+    /*!
+     *  \brief  deconstructor, which stops all pool threads after draining pending jobs
+     */
+    ~POSPersistPool();
+
+    /*!
+     *  \brief  submit a job to persist the given handle
+     *  \note   invoked by POSHandle::checkpoint_persist_async, which resets the completion of
+     *          the handle before submission
+     *  \param  handle      the handle to be persisted
+     *  \param  ckpt_slot   checkpoint slot that stores the state, nullptr for persisting without state
+     *  \param  ckpt_dir    directory to store the checkpoint file
+     *  \param  size        state size to be persisted, used for ordering jobs
+     *  \param  group       group to track the job, nullptr for not tracked
+     */
+    void submit(
+        POSHandle* handle, POSCheckpointSlot* ckpt_slot, const std::string& ckpt_dir,
+        uint64_t size, POSPersistGroup* group
+    );
+
+    /*!
+     *  \brief  obtain the number of pool threads
+     *  \return number of pool threads
+     */
+    inline uint32_t get_nb_threads() const { return this->_threads.size(); }
+
+ private:
+    /*!
+     *  \brief  a job to persist a handle
+     */
+    typedef struct persist_job {
+        POSHandle *handle;
+        POSCheckpointSlot *ckpt_slot;
+        std::string ckpt_dir;
+        uint64_t size;
+        uint64_t seq;
+        POSPersistGroup *group;
+
+        // larger size first, then earlier submission first
+        inline bool operator<(const struct persist_job& other) const {
+            return this->size != other.size ? this->size < other.size : this->seq > other.seq;
+        }
+    } persist_job_t;
+
+    /*!
+     *  \brief  processing routine of a pool thread
+     */
+    void __thread_main();
+
+    // pending jobs, protected by mutex
+    std::priority_queue<persist_job_t> _jobs;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+
+    // sequence number of the next submitted job
+    uint64_t _next_seq;
+
+    // whether the pool is being stopped
+    bool _stop_flag;
+
+    std::vector<std::thread*> _threads;
+};
@@ -38,4 +38,12 @@ POSAgent* pos_create_agent();
  */
 int pos_destory_agent(POSAgent* pos_agent);
 
+/*!
+ *  \brief  obtain the uuid of the client registered by the agent
+ *  \note   the uuid should be piggybacked in each API call (see pos_process)
+ *  \param  pos_agent   pointer to the agent
+ *  \return uuid of the client
+ */
+uint64_t pos_agent_get_uuid(POSAgent* pos_agent);
+
 } // extern "C"
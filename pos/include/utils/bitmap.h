@@ -0,0 +1,170 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+
+
+/*!
+ *  \brief  dynamic bitmap indexed by dense ids (e.g., id of handles within a handle manager)
+ *  \note   the bitmap grows on setting an id beyond its current capacity, and never shrinks;
+ *          set / clear / test are O(1), while iteration scans 64 ids per word and only
+ *          visits those words that contain set bits
+ *  \note   not thread-safe
+ */
+class POSUtilBitmap {
+ public:
+    POSUtilBitmap() : _nb_set(0) {}
+    ~POSUtilBitmap() = default;
+
+
+    /*!
+     *  \brief  set the bit of the given id
+     *  \param  id  the given id
+     *  \return true for the bit was unset before (i.e., newly set)
+     */
+    inline bool set(uint64_t id){
+        uint64_t word_id = id >> 6, mask = 1ul << (id & 63);
+
+        if(unlikely(word_id >= this->_words.size())){
+            this->_words.resize(std::max<uint64_t>(word_id + 1, this->_words.size() * 2), 0);
+        }
+        if(this->_words[word_id] & mask){ return false; }
+
+        this->_words[word_id] |= mask;
+        this->_nb_set += 1;
+        return true;
+    }
+
+
+    /*!
+     *  \brief  set the bits of all ids within [begin_id, end_id)
+     *  \param  begin_id    the first id to be set
+     *  \param  end_id      the id after the last one to be set
+     */
+    inline void set_range(uint64_t begin_id, uint64_t end_id){
+        uint64_t word_id, begin_word, end_word, mask, old_word;
+
+        if(unlikely(begin_id >= end_id)){ return; }
+
+        begin_word = begin_id >> 6;
+        end_word = (end_id - 1) >> 6;
+        if(unlikely(end_word >= this->_words.size())){
+            this->_words.resize(std::max<uint64_t>(end_word + 1, this->_words.size() * 2), 0);
+        }
+
+        for(word_id=begin_word; word_id<=end_word; word_id++){
+            mask = ~0ul;
+            if(word_id == begin_word){ mask &= ~0ul << (begin_id & 63); }
+            if(word_id == end_word && (end_id & 63) != 0){ mask &= ~0ul >> (64 - (end_id & 63)); }
+            old_word = this->_words[word_id];
+            this->_words[word_id] |= mask;
+            this->_nb_set += __builtin_popcountl(this->_words[word_id]) - __builtin_popcountl(old_word);
+        }
+    }
+
+
+    /*!
+     *  \brief  set all bits that are set within the other bitmap
+     *  \param  other   the other bitmap
+     */
+    inline void merge(const POSUtilBitmap& other){
+        uint64_t i, old_word;
+
+        if(other._nb_set == 0){ return; }
+        if(unlikely(other._words.size() > this->_words.size())){
+            this->_words.resize(other._words.size(), 0);
+        }
+        for(i=0; i<other._words.size(); i++){
+            old_word = this->_words[i];
+            this->_words[i] |= other._words[i];
+            this->_nb_set += __builtin_popcountl(this->_words[i]) - __builtin_popcountl(old_word);
+        }
+    }
+
+
+    /*!
+     *  \brief  clear the bit of the given id
+     *  \param  id  the given id
+     *  \return true for the bit was set before
+     */
+    inline bool clear(uint64_t id){
+        uint64_t word_id = id >> 6, mask = 1ul << (id & 63);
+
+        if(unlikely(word_id >= this->_words.size())){ return false; }
+        if(!(this->_words[word_id] & mask)){ return false; }
+
+        this->_words[word_id] &= ~mask;
+        this->_nb_set -= 1;
+        return true;
+    }
+
+
+    /*!
+     *  \brief  test whether the bit of the given id is set
+     *  \param  id  the given id
+     *  \return true for the bit is set
+     */
+    inline bool test(uint64_t id) const {
+        uint64_t word_id = id >> 6;
+        if(unlikely(word_id >= this->_words.size())){ return false; }
+        return (this->_words[word_id] >> (id & 63)) & 1ul;
+    }
+
+
+    /*!
+     *  \brief  clear all bits, while keeping the capacity
+     */
+    inline void clear_all(){
+        if(this->_nb_set == 0){ return; }
+        std::fill(this->_words.begin(), this->_words.end(), 0);
+        this->_nb_set = 0;
+    }
+
+
+    /*!
+     *  \brief  invoke the given function on every set id, in ascending order
+     *  \param  fn  the function to be invoked, with the id as parameter
+     */
+    template<typename T_Fn>
+    inline void for_each(T_Fn&& fn) const {
+        uint64_t i, word;
+        for(i=0; i<this->_words.size(); i++){
+            word = this->_words[i];
+            while(word != 0){
+                fn((i << 6) + __builtin_ctzl(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+
+    /*!
+     *  \brief  obtain the number of set bits
+     *  \return number of set bits
+     */
+    inline uint64_t count() const { return this->_nb_set; }
+
+ private:
+    std::vector<uint64_t> _words;
+    uint64_t _nb_set;
+};
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "pos/include/common.h"
+#include "pos/include/utils/timer.h"
+#include "pos/include/utils/futex.h"
+
+
+/*!
+ *  \brief  safety-net timeout (us) of a parked daemon, the daemon re-checks those
+ *          states that aren't signaled through the doorbell after the timeout
+ */
+#define POS_DAEMON_POLL_PARK_TIMEOUT_US   5000
+
+
+/*!
+ *  \brief  polling policy of daemon threads (e.g., parser and worker) on empty queues
+ */
+enum pos_daemon_poll_policy_t : uint8_t {
+    kPOS_DaemonPollPolicy_Spin = 0,
+    kPOS_DaemonPollPolicy_SpinYield,
+    kPOS_DaemonPollPolicy_SpinPark
+};
+
+
+/*!
+ *  \brief  idle-aware polling of a daemon thread, which spins on empty queues for a
+ *          bounded duration, then yields the CPU or parks on the doorbell
+ *  \note   the daemon reports the outcome of each polling iteration via on_busy / on_idle,
+ *          and the poller accumulates the busy / idle time of the daemon thread
+ */
+class POSDaemonPoller {
+ public:
+    /*!
+     *  \param  doorbell    doorbell rung by producers of the daemon's queues
+     *  \param  policy      polling policy on empty queues
+     *  \param  spin_ticks  duration (TSC ticks) to spin on empty queues before yielding / parking
+     */
+    POSDaemonPoller(POSDoorbell* doorbell, pos_daemon_poll_policy_t policy, uint64_t spin_ticks)
+        :   busy_ticks(0),
+            idle_ticks(0),
+            nb_parks(0),
+            _doorbell(doorbell),
+            _policy(policy),
+            _spin_ticks(spin_ticks),
+            _idle_s_tick(0),
+            _is_park_prepared(false),
+            _park_key(0)
+    {
+        POS_CHECK_POINTER(doorbell);
+        this->_park_timeout.tv_sec = POS_DAEMON_POLL_PARK_TIMEOUT_US / 1000000;
+        this->_park_timeout.tv_nsec = (POS_DAEMON_POLL_PARK_TIMEOUT_US % 1000000) * 1000;
+        this->_last_tick = POSUtilTscTimer::get_tsc();
+    }
+    ~POSDaemonPoller(){
+        if(this->_is_park_prepared){ this->_doorbell->cancel_park(); }
+    }
+
+    /*!
+     *  \brief  report that the last polling iteration digested some elements
+     */
+    inline void on_busy(){
+        uint64_t now = POSUtilTscTimer::get_tsc();
+
+        if(unlikely(this->_is_park_prepared)){
+            this->_doorbell->cancel_park();
+            this->_is_park_prepared = false;
+        }
+        this->_idle_s_tick = 0;
+
+        this->busy_ticks += now - this->_last_tick;
+        this->_last_tick = now;
+    }
+
+    /*!
+     *  \brief  report that the last polling iteration found all queues empty
+     *  \note   under spin-then-park policy, the first call after the spin budget only
+     *          announces the park, the daemon should re-poll its queues before the
+     *          next call actually parks
+     */
+    inline void on_idle(){
+        uint64_t now = POSUtilTscTimer::get_tsc();
+        bool is_rung;
+
+        if(this->_policy == kPOS_DaemonPollPolicy_Spin){
+            pos_cpu_relax();
+            goto exit;
+        }
+
+        if(this->_idle_s_tick == 0){
+            this->_idle_s_tick = now;
+            goto exit;
+        }
+
+        if(now - this->_idle_s_tick < this->_spin_ticks){
+            pos_cpu_relax();
+            goto exit;
+        }
+
+        if(this->_policy == kPOS_DaemonPollPolicy_SpinYield){
+            sched_yield();
+            goto exit;
+        }
+
+        // kPOS_DaemonPollPolicy_SpinPark
+        if(this->_is_park_prepared == false){
+            this->_park_key = this->_doorbell->prepare_park();
+            this->_is_park_prepared = true;
+            goto exit;
+        }
+
+        this->nb_parks += 1;
+        is_rung = this->_doorbell->park(this->_park_key, &this->_park_timeout);
+        this->_is_park_prepared = false;
+
+        // spin again if we're rung, otherwise (timeout) we park again right after re-polling
+        if(is_rung){ this->_idle_s_tick = 0; }
+
+    exit:
+        now = POSUtilTscTimer::get_tsc();
+        this->idle_ticks += now - this->_last_tick;
+        this->_last_tick = now;
+    }
+
+    // accumulated busy / idle time (TSC ticks) of the daemon thread
+    uint64_t busy_ticks;
+    uint64_t idle_ticks;
+
+    // number of times the daemon thread parks
+    uint64_t nb_parks;
+
+ private:
+    // doorbell rung by producers
+    POSDoorbell *_doorbell;
+
+    // polling policy on empty queues
+    pos_daemon_poll_policy_t _policy;
+
+    // spin budget (TSC ticks) on empty queues
+    uint64_t _spin_ticks;
+
+    // start tick of the current idle period, 0 for not idle
+    uint64_t _idle_s_tick;
+
+    // tick of the last report, for accounting busy / idle time
+    uint64_t _last_tick;
+
+    // whether the park is announced on the doorbell, and the corresponding key
+    bool _is_park_prepared;
+    uint32_t _park_key;
+
+    // safety-net timeout of the park
+    struct timespec _park_timeout;
+};
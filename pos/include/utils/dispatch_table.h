@@ -0,0 +1,118 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+
+
+/*!
+ *  \brief  generate a flat array indexed by API id at compile time
+ *  \tparam T           type of the slot, the empty slot is value-initialized (e.g., nullptr)
+ *  \tparam nb_slots    number of slots, should be larger than the maximum API id
+ *  \tparam nb_entries  number of provided entries
+ *  \param  entries     list of <api_id, value> pairs
+ *  \return the generated flat array
+ */
+template<typename T, uint64_t nb_slots, uint64_t nb_entries>
+constexpr std::array<T, nb_slots> pos_make_dispatch_array(const std::pair<uint64_t, T> (&entries)[nb_entries]){
+    std::array<T, nb_slots> slots {};
+    for(uint64_t i=0; i<nb_entries; i++){
+        slots[entries[i].first] = entries[i].second;
+    }
+    return slots;
+}
+
+
+/*!
+ *  \brief  flat dispatch table indexed by API id, which replaces the map lookup on the
+ *          per-WQE path with a single indexed load
+ *  \note   the table is either bound to a flat array generated at compile time
+ *          (see pos_make_dispatch_array), or built from a registration map at runtime
+ *  \tparam T   type of the slot, the empty slot is value-initialized (e.g., nullptr)
+ */
+template<typename T>
+class POSDispatchTable {
+ public:
+    POSDispatchTable() : _slots(nullptr), _nb_slots(0) {}
+    ~POSDispatchTable() = default;
+
+    /*!
+     *  \brief  bind the table to an external flat array
+     *  \param  slots       the flat array, should outlive this table
+     *  \param  nb_slots    number of slots in the flat array
+     */
+    inline void bind(const T* slots, uint64_t nb_slots){
+        this->_owned_slots.clear();
+        this->_slots = slots;
+        this->_nb_slots = nb_slots;
+    }
+
+    /*!
+     *  \brief  build the table from a registration map
+     *  \param  map     the registration map (api_id -> value)
+     *  \param  func    function to generate the slot from the value inside the map
+     */
+    template<typename V, typename F>
+    inline void build(const std::map<uint64_t, V>& map, F&& func){
+        this->_owned_slots.clear();
+        if(map.size() > 0){
+            this->_owned_slots.resize(map.rbegin()->first + 1);
+            for(auto& [api_id, value] : map){ this->_owned_slots[api_id] = func(value); }
+        }
+        this->_slots = this->_owned_slots.data();
+        this->_nb_slots = this->_owned_slots.size();
+    }
+
+    /*!
+     *  \brief  build the table from a registration map, which stores the slot value directly
+     *  \param  map     the registration map (api_id -> value)
+     */
+    inline void build(const std::map<uint64_t, T>& map){
+        this->build(map, [](const T& value) -> T { return value; });
+    }
+
+    /*!
+     *  \brief  obtain the slot of specified API
+     *  \param  api_id  id of the API
+     *  \return the slot, or the empty slot if the API isn't registered
+     */
+    inline T get(uint64_t api_id) const {
+        if(unlikely(api_id >= this->_nb_slots)){ return T(); }
+        return this->_slots[api_id];
+    }
+
+    /*!
+     *  \brief  obtain the number of slots inside the table
+     *  \return the number of slots
+     */
+    inline uint64_t size() const { return this->_nb_slots; }
+
+ private:
+    // slots owned by this table, only used when it's built at runtime
+    std::vector<T> _owned_slots;
+
+    // flat array of slots
+    const T *_slots;
+    uint64_t _nb_slots;
+};
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "pos/include/common.h"
+#include "pos/include/utils/timer.h"
+
+
+POS_STATIC_ASSERT(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+
+/*!
+ *  \brief  relax the CPU inside a spin loop
+ */
+static inline void pos_cpu_relax(){
+    __builtin_ia32_pause();
+}
+
+
+/*!
+ *  \brief  park the calling thread while the value of the futex word equals to expected
+ *  \param  addr        address of the futex word
+ *  \param  expected    expected value of the futex word
+ *  \param  timeout     relative timeout of the wait, nullptr for no timeout
+ *  \return 0 for woken up, -1 for value mismatch, interrupted or timeout
+ */
+static inline long pos_futex_wait(std::atomic<uint32_t>* addr, uint32_t expected, const struct timespec* timeout=nullptr){
+    return syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0
+    );
+}
+
+
+/*!
+ *  \brief  wake up threads that parked on the futex word
+ *  \param  addr        address of the futex word
+ *  \param  nb_waiters  maximum number of threads to be woken up
+ *  \return number of woken up threads
+ */
+static inline long pos_futex_wake(std::atomic<uint32_t>* addr, int nb_waiters){
+    return syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, nb_waiters, nullptr, nullptr, 0
+    );
+}
+
+
+/*!
+ *  \brief  one-shot completion with spin-then-park waiting
+ *  \note   single waiter, single completer; the completer only issues a futex wake
+ *          when the waiter has been parked
+ */
+class POSCompletion {
+ public:
+    POSCompletion() : _state(kPending) {}
+    ~POSCompletion() = default;
+
+    /*!
+     *  \brief  reset the completion for reuse
+     */
+    inline void reset(){ this->_state.store(kPending, std::memory_order_relaxed); }
+
+    /*!
+     *  \brief  check whether the completion is done
+     *  \return identify whether the completion is done
+     */
+    inline bool is_done() const { return this->_state.load(std::memory_order_acquire) == kDone; }
+
+    /*!
+     *  \brief  mark the completion as done, and wake up the waiter if it's parked
+     *  \note   the owner of the completion might reuse it right after the done state
+     *          is observed, the futex wake on a reused word is a harmless spurious wakeup
+     */
+    inline void complete(){
+        if(unlikely(this->_state.exchange(kDone, std::memory_order_acq_rel) == kParked)){
+            pos_futex_wake(&this->_state, 1);
+        }
+    }
+
+    /*!
+     *  \brief  wait until the completion is done, spin for a bounded duration before parking
+     *  \param  spin_ticks  spin budget (TSC ticks), adapted based on the observed waiting time:
+     *                      grows toward twice the waiting time if it's completed while spinning,
+     *                      and shrinks if the waiter has to be parked
+     *  \param  min_ticks   lower bound of the spin budget
+     *  \param  max_ticks   upper bound of the spin budget
+     *  \return true for the waiter was parked, false for completed while spinning
+     */
+    inline bool wait(uint64_t& spin_ticks, uint64_t min_ticks, uint64_t max_ticks){
+        uint64_t s_tick, elapsed;
+        uint32_t expected;
+
+        s_tick = POSUtilTscTimer::get_tsc();
+        while(this->_state.load(std::memory_order_acquire) != kDone){
+            elapsed = POSUtilTscTimer::get_tsc() - s_tick;
+            if(unlikely(elapsed >= spin_ticks)){ goto park; }
+            pos_cpu_relax();
+        }
+
+        // completed while spinning
+        elapsed = POSUtilTscTimer::get_tsc() - s_tick;
+        if(2 * elapsed > spin_ticks){ spin_ticks += (2 * elapsed - spin_ticks) / 8; }
+        if(spin_ticks > max_ticks){ spin_ticks = max_ticks; }
+        return false;
+
+    park:
+        expected = kPending;
+        if(this->_state.compare_exchange_strong(expected, kParked, std::memory_order_acq_rel)){
+            while(this->_state.load(std::memory_order_acquire) != kDone){
+                pos_futex_wait(&this->_state, kParked);
+            }
+        }
+        spin_ticks -= spin_ticks / 8;
+        if(spin_ticks < min_ticks){ spin_ticks = min_ticks; }
+        return true;
+    }
+
+ private:
+    enum : uint32_t {
+        kPending = 0,
+        kParked,
+        kDone
+    };
+
+    // state of the completion, also used as the futex word
+    std::atomic<uint32_t> _state;
+};
+
+
+/*!
+ *  \brief  listener of a doorbell, which takes over the wake-up of a consumer that
+ *          isn't parked on the futex (e.g., a daemon stage driven by a thread pool)
+ */
+class POSDoorbellListener {
+ public:
+    /*!
+     *  \brief  invoked by the producer when the doorbell is rung while the consumer is
+     *          (about to be) parked, in place of the futex wake
+     *  \note   might be invoked concurrently by multiple producers
+     */
+    virtual void on_ring() = 0;
+};
+
+
+/*!
+ *  \brief  doorbell of a queue consumer, which parks the consumer on the futex while
+ *          all of its queues are empty (i.e., an eventcount)
+ *  \note   multiple producers, single consumer; producers ring the doorbell after
+ *          pushing to the queue, which issues a futex wake only when the consumer
+ *          is (about to be) parked, so the fast path of a ring is a fence and a load
+ *  \note   protocol of the consumer: key = prepare_park(); re-check all queues; then
+ *          park(key) if they're still empty, otherwise cancel_park()
+ */
+class POSDoorbell {
+ public:
+    POSDoorbell() : _state(0), _listener(nullptr) {}
+    ~POSDoorbell() = default;
+
+    /*!
+     *  \brief  set the listener to be notified instead of issuing the futex wake
+     *  \param  listener    the listener, nullptr for waking up the parked consumer
+     */
+    inline void set_listener(POSDoorbellListener* listener){
+        this->_listener.store(listener, std::memory_order_release);
+    }
+
+    /*!
+     *  \brief  announce that the consumer is going to park
+     *  \note   the consumer must re-check its queues after this call, to catch
+     *          the elements pushed before the announcement is visible
+     *  \return key to be passed to park
+     */
+    inline uint32_t prepare_park(){
+        return this->_state.fetch_or(kParked, std::memory_order_seq_cst) | kParked;
+    }
+
+    /*!
+     *  \brief  park the consumer until the doorbell is rung after prepare_park
+     *  \param  key         key returned by prepare_park
+     *  \param  timeout     relative timeout of the park, nullptr for no timeout
+     *  \return false for the park is timeout, true for otherwise (e.g., rung)
+     */
+    inline bool park(uint32_t key, const struct timespec* timeout=nullptr){
+        bool is_timeout;
+        is_timeout = pos_futex_wait(&this->_state, key, timeout) == -1 && errno == ETIMEDOUT;
+        this->_state.fetch_and(~kParked, std::memory_order_relaxed);
+        return !is_timeout;
+    }
+
+    /*!
+     *  \brief  withdraw the announcement of prepare_park, as the queues aren't empty
+     */
+    inline void cancel_park(){
+        this->_state.fetch_and(~kParked, std::memory_order_relaxed);
+    }
+
+    /*!
+     *  \brief  ring the doorbell after pushing to the queue
+     */
+    inline void ring(){
+        POSDoorbellListener *listener;
+
+        // order the push to the queue before checking the parked flag,
+        // pairs with the fetch_or inside prepare_park
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(unlikely(this->_state.load(std::memory_order_relaxed) & kParked)){
+            this->_state.fetch_add(kEpoch, std::memory_order_relaxed);
+            if((listener = this->_listener.load(std::memory_order_acquire)) != nullptr){
+                listener->on_ring();
+            } else {
+                pos_futex_wake(&this->_state, 1);
+            }
+        }
+    }
+
+ private:
+    enum : uint32_t {
+        kParked = 1,    // bit 0: whether the consumer is (about to be) parked
+        kEpoch = 2      // bit 1~31: epoch of the rings
+    };
+
+    // state of the doorbell, also used as the futex word
+    std::atomic<uint32_t> _state;
+
+    // listener that takes over the wake-up, nullptr for futex wake
+    std::atomic<POSDoorbellListener*> _listener;
+};
@@ -17,32 +17,79 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
 
+#include "pos/include/common.h"
+#include "pos/include/utils/futex.h"
 #include "pos/include/utils/readerwriterqueue/atomicops.h"
 #include "pos/include/utils/readerwriterqueue/readerwriterqueue.h"
 
 #define POS_LOCKLESS_QUEUE_LEN  8192
 
 /*!
- *  \brief  lock-free queue
+ *  \brief  maximum number of elements dequeued by a single poll of the parser / worker
+ */
+#define POS_LOCKLESS_QUEUE_POLL_BATCH   64
+
+/*!
+ *  \brief  single-producer single-consumer lock-free queue
+ *  \note   the queue is unbounded by default, a bounded queue rejects the push once it's full,
+ *          so that the producer is explicitly back-pressured by the consumer
  *  \tparam T   elemenet type
  */
 template<typename T>
 class POSLockFreeQueue {
  public:
-    POSLockFreeQueue() : _is_enqueue_locked(false), _is_dequeue_locked(false) {
-        _q = new moodycamel::ReaderWriterQueue<T, POS_LOCKLESS_QUEUE_LEN>();
-        POS_CHECK_POINTER(_q);
+    /*!
+     *  \brief  constructor
+     *  \param  capacity    capacity of the queue, 0 for unbounded queue;
+     *                      the actual capacity might be larger as it's rounded to the block size
+     */
+    POSLockFreeQueue(uint64_t capacity = 0)
+        :   _capacity(capacity), _is_enqueue_locked(false), _is_dequeue_locked(false),
+            _is_enqueuing(false), _is_dequeuing(false)
+    {
+        if(capacity > 0){
+            _q = new moodycamel::ReaderWriterQueue<T, POS_LOCKLESS_QUEUE_LEN>(capacity);
+            POS_CHECK_POINTER(_q);
+            this->_capacity = _q->max_capacity();
+        } else {
+            _q = new moodycamel::ReaderWriterQueue<T, POS_LOCKLESS_QUEUE_LEN>();
+            POS_CHECK_POINTER(_q);
+        }
     }
-    ~POSLockFreeQueue() = default;
+
+    /*!
+     *  \brief  deconstructor
+     *  \note   remained elements aren't reclaimed, one should drain the queue before destroying it
+     */
+    ~POSLockFreeQueue(){ delete _q; }
 
     /*!
      *  \brief  generate a new queue node and append to the tail of it
-     *  \param  data    the payload that the newly added node points to
+     *  \param  element the element to be appended
+     *  \return POS_SUCCESS for successfully pushed
+     *          POS_FAILED_NOT_READY for the bounded queue is full, the caller still owns the element
+     *          POS_FAILED_DRAIN for the queue is locked, the caller still owns the element
      */
-    void push(T element){
-        if(this->_is_enqueue_locked == false)
-            _q->enqueue(element); 
+    pos_retval_t push(T element){
+        pos_retval_t retval = POS_SUCCESS;
+
+        this->_is_enqueuing.store(true, std::memory_order_seq_cst);
+        if(unlikely(this->_is_enqueue_locked.load(std::memory_order_seq_cst) == true)){
+            retval = POS_FAILED_DRAIN;
+            goto exit;
+        }
+
+        if(this->_capacity > 0){
+            if(unlikely(!_q->try_enqueue(element))){ retval = POS_FAILED_NOT_READY; }
+        } else {
+            _q->enqueue(element);
+        }
+
+    exit:
+        this->_is_enqueuing.store(false, std::memory_order_release);
+        return retval;
     }
 
     /*!
@@ -50,15 +97,28 @@ class POSLockFreeQueue {
      *          head element points to
      *  \param  element reference to the variable to stored dequeued element (if any)
      *  \return POS_SUCCESS for successfully dequeued
-     *          POS_FAILED_NOT_READY for empty queue
+     *          POS_FAILED_NOT_READY for empty (or locked) queue
      */
     pos_retval_t dequeue(T& element){
-        if(this->_is_dequeue_locked == false){
-            if(_q->try_dequeue(element)){ return POS_SUCCESS; }
-            else { return POS_FAILED_NOT_READY; }
-        } else {
-            return POS_FAILED_NOT_READY;
+        return this->dequeue_bulk(&element, 1) == 1 ? POS_SUCCESS : POS_FAILED_NOT_READY;
+    }
+
+    /*!
+     *  \brief  dequeue a batch of elements from the head of the queue
+     *  \param  elements    caller-provided array to store the dequeued elements
+     *  \param  max_nb      maximum number of elements to be dequeued (i.e., length of the array)
+     *  \return number of dequeued elements, 0 for empty (or locked) queue
+     */
+    uint64_t dequeue_bulk(T* elements, uint64_t max_nb){
+        uint64_t nb = 0;
+
+        this->_is_dequeuing.store(true, std::memory_order_seq_cst);
+        if(likely(this->_is_dequeue_locked.load(std::memory_order_seq_cst) == false)){
+            while(nb < max_nb && _q->try_dequeue(elements[nb])){ nb++; }
         }
+        this->_is_dequeuing.store(false, std::memory_order_release);
+
+        return nb;
     }
 
     /*!
@@ -83,45 +143,81 @@ class POSLockFreeQueue {
     inline uint64_t len(){ return _q->size_approx(); }
 
     /*!
-     *  \brief  clear the queue
+     *  \brief  obtain the capacity of this queue
+     *  \return capacity of the queue, 0 for unbounded queue
      */
-    inline void drain(){
-        uint64_t i, len;
-        len = this->len();
+    inline uint64_t capacity() const { return this->_capacity; }
 
-        this->lock_enqueue();
-        this->lock_dequeue();
-        // TODO: how to deal with memory leak?
-        for(i=0; i<len; i++){ this->pop(); }
-        this->unlock_enqueue();
-        this->unlock_dequeue();
+    /*!
+     *  \brief  clear the queue, and hand all drained elements back to their owner
+     *  \note   the consumer is excluded during draining, while the producer could still push,
+     *          elements pushed concurrently might be left in the queue
+     *  \param  reclaim     callable to reclaim each drained element, i.e., void(T)
+     *  \return number of drained elements
+     */
+    template<typename reclaimer_t>
+    uint64_t drain(reclaimer_t&& reclaim){
+        uint64_t nb_drained = 0;
+        bool is_dequeue_locked;
+        T element;
+
+        is_dequeue_locked = this->_is_dequeue_locked.load(std::memory_order_acquire);
+        if(is_dequeue_locked == false){ this->lock_dequeue(); }
+
+        while(_q->try_dequeue(element)){
+            reclaim(element);
+            nb_drained++;
+        }
+
+        if(is_dequeue_locked == false){ this->unlock_dequeue(); }
+
+        return nb_drained;
     }
 
     /*!
      *  \brief  lock the queue
+     *  \note   block until the in-flight enqueue / dequeue finishes, after which
+     *          nothing would be enqueued / dequeued until the queue is unlocked
      */
-    inline void lock_enqueue(){ this->_is_enqueue_locked = true; }
-    inline void lock_dequeue(){ this->_is_dequeue_locked = true; }
+    inline void lock_enqueue(){
+        this->_is_enqueue_locked.store(true, std::memory_order_seq_cst);
+        while(this->_is_enqueuing.load(std::memory_order_seq_cst) == true){ pos_cpu_relax(); }
+    }
+    inline void lock_dequeue(){
+        this->_is_dequeue_locked.store(true, std::memory_order_seq_cst);
+        while(this->_is_dequeuing.load(std::memory_order_seq_cst) == true){ pos_cpu_relax(); }
+    }
     inline void lock(){ 
-        this->_is_enqueue_locked = true;
-        this->_is_dequeue_locked = true; 
+        this->lock_enqueue();
+        this->lock_dequeue();
     }
 
     /*!
      *  \brief  unlock the queue
      */
-    inline void unlock_enqueue(){ this->_is_enqueue_locked = false; }
-    inline void unlock_dequeue(){ this->_is_dequeue_locked = false; }
+    inline void unlock_enqueue(){ this->_is_enqueue_locked.store(false, std::memory_order_release); }
+    inline void unlock_dequeue(){ this->_is_dequeue_locked.store(false, std::memory_order_release); }
     inline void unlock(){ 
-        this->_is_enqueue_locked = false;
-        this->_is_dequeue_locked = false; 
+        this->unlock_enqueue();
+        this->unlock_dequeue();
     }
 
  private:
     // queue object
     moodycamel::ReaderWriterQueue<T, POS_LOCKLESS_QUEUE_LEN> *_q;
 
-    // identify whether this queue is locked, if locked, nothing would be enqueued/dequeued
-    bool _is_enqueue_locked;
-    bool _is_dequeue_locked;
+    // capacity of the queue, 0 for unbounded
+    uint64_t _capacity;
+
+    /*!
+     *  \brief  identify whether this queue is locked, if locked, nothing would be enqueued/dequeued
+     *  \note   the lock flag and the in-flight flag of each side form a Dekker-style handshake:
+     *          the locker sets the lock flag then waits the in-flight flag to be cleared, while the
+     *          producer / consumer sets the in-flight flag then checks the lock flag, so that both
+     *          sides can't pass at the same time
+     */
+    std::atomic<bool> _is_enqueue_locked;
+    std::atomic<bool> _is_dequeue_locked;
+    std::atomic<bool> _is_enqueuing;
+    std::atomic<bool> _is_dequeuing;
 };
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+
+
+/*!
+ *  \brief  number of recently hit ranges cached by POSUtilRangeIndex
+ */
+#define POS_RANGE_INDEX_NB_CACHED   8
+
+
+/*!
+ *  \brief  shift of the coarse page tracked by the page filter of POSUtilRangeIndex (32MB)
+ */
+#define POS_RANGE_INDEX_PAGE_SHIFT  25
+
+
+/*!
+ *  \brief  number of bits of the page filter of POSUtilRangeIndex
+ */
+#define POS_RANGE_INDEX_PAGE_FILTER_NB_BITS (1ul << 16)
+
+
+/*!
+ *  \brief  index of address ranges, which maps an address to the range that covers it
+ *  \note   ranges are kept in a flat array sorted by their base addresses, so a lookup is a
+ *          binary search over contiguous memory instead of a walk over tree nodes; recently
+ *          hit ranges are cached in front of the array, as consecutive lookups (e.g., pointer
+ *          arguments of kernels within a layer) tend to fall into the same few ranges
+ *  \note   erasion leaves a tombstone in place, which is reused by the insertion onto the
+ *          same position (e.g., the allocator hands out a freed address again), and is
+ *          compacted once tombstones make up half of the array; together with appending
+ *          (mocked addresses grow monotonically), most insertions / erasions don't shift
+ *          the array
+ *  \note   a conservative filter is maintained for rejecting addresses before the lookup
+ *          (see may_cover), i.e., the window [min base, max end) of all ranges, and a hashed
+ *          bitmap of coarse pages covered by ranges; erased ranges stay in the filter until the
+ *          next compaction, so the filter might have false positives but no false negatives
+ *  \tparam T   type of the value attached to each range
+ */
+template<typename T>
+class POSUtilRangeIndex {
+ public:
+    POSUtilRangeIndex() : _nb_tombstones(0), _cache_cursor(0), _window_begin(0), _window_end(0) {
+        this->__clear_cache();
+        this->__clear_filter();
+    }
+    ~POSUtilRangeIndex() = default;
+
+    /*!
+     *  \brief  insert a range into the index
+     *  \param  base    base address of the range
+     *  \param  size    size of the range
+     *  \param  value   value attached to the range
+     *  \return POS_SUCCESS for successfully inserted;
+     *          POS_FAILED_ALREADY_EXIST for a range with the same base address exists
+     */
+    inline pos_retval_t insert(uint64_t base, uint64_t size, T value){
+        pos_retval_t retval = POS_SUCCESS;
+        uint64_t index;
+
+        this->__add_to_filter(base, size);
+
+        // fast path: append to the end
+        if(likely(this->_bases.empty() || this->_bases.back() < base)){
+            this->_bases.push_back(base);
+            this->_ranges.push_back({ base, base + size, value, true });
+            goto exit;
+        }
+
+        index = this->__lower_bound(base);
+        if(index < this->_bases.size() && this->_bases[index] == base){
+            if(unlikely(this->_ranges[index].is_alive)){
+                retval = POS_FAILED_ALREADY_EXIST;
+                goto exit;
+            }
+            // reuse the tombstone on the same position
+            this->_ranges[index] = { base, base + size, value, true };
+            this->_nb_tombstones -= 1;
+            goto exit;
+        }
+
+        if(index > 0 && !(this->_ranges[index-1].is_alive)){
+            // reuse the preceding tombstone, the array stays sorted as base lies between its neighbors
+            this->_bases[index-1] = base;
+            this->_ranges[index-1] = { base, base + size, value, true };
+            this->_nb_tombstones -= 1;
+            goto exit;
+        }
+
+        this->_bases.insert(this->_bases.begin() + index, base);
+        this->_ranges.insert(this->_ranges.begin() + index, { base, base + size, value, true });
+
+    exit:
+        return retval;
+    }
+
+
+    /*!
+     *  \brief  erase the range with specified base address from the index
+     *  \param  base    base address of the range
+     *  \param  value   pointer to store the value attached to the erased range (optional)
+     *  \return POS_SUCCESS for successfully erased;
+     *          POS_FAILED_NOT_EXIST for no range with the given base address
+     */
+    inline pos_retval_t erase(uint64_t base, T* value=nullptr){
+        pos_retval_t retval = POS_SUCCESS;
+        uint64_t i, index;
+
+        index = this->__lower_bound(base);
+        if(unlikely(
+            index == this->_bases.size() || this->_bases[index] != base || !(this->_ranges[index].is_alive)
+        )){
+            retval = POS_FAILED_NOT_EXIST;
+            goto exit;
+        }
+
+        if(value != nullptr){ *value = this->_ranges[index].value; }
+        this->_ranges[index].is_alive = false;
+        this->_nb_tombstones += 1;
+
+        for(i=0; i<POS_RANGE_INDEX_NB_CACHED; i++){
+            if(this->_cache[i].base == base){ this->_cache[i].is_alive = false; }
+        }
+
+        if(unlikely(this->_nb_tombstones * 2 > this->_bases.size())){
+            this->__compact();
+        }
+
+    exit:
+        return retval;
+    }
+
+
+    /*!
+     *  \brief  obtain the range that covers the given address
+     *  \note   an address equals to the base address of a range always hits that range,
+     *          even if the range is empty
+     *  \param  addr    the given address
+     *  \param  value   pointer to store the value attached to the covering range
+     *  \param  offset  pointer to store the offset of the address from the base address (optional)
+     *  \return POS_SUCCESS for successfully found;
+     *          POS_FAILED_NOT_EXIST for no range covers the given address
+     */
+    inline pos_retval_t lookup(uint64_t addr, T* value, uint64_t* offset=nullptr){
+        pos_retval_t retval = POS_SUCCESS;
+        const uint64_t *bases;
+        const range_t *range;
+        uint64_t i, n, half;
+        int64_t index;
+
+        POS_CHECK_POINTER(value);
+
+        // fast path: hit one of the recently hit ranges
+        for(i=0; i<POS_RANGE_INDEX_NB_CACHED; i++){
+            range = &(this->_cache[i]);
+            if(__is_covered(range, addr)){ goto found; }
+        }
+
+        if(unlikely(
+            this->_bases.empty() || addr - this->_window_begin >= this->_window_end - this->_window_begin
+        )){
+            retval = POS_FAILED_NOT_EXIST;
+            goto exit;
+        }
+
+        // slow path: branchless search for the last base address that isn't larger than the given address
+        bases = this->_bases.data();
+        n = this->_bases.size();
+        while(n > 1){
+            half = n / 2;
+            bases = (bases[half] <= addr) ? bases + half : bases;
+            n -= half;
+        }
+        index = bases - this->_bases.data();
+
+        // skip tombstones
+        while(index >= 0 && unlikely(!(this->_ranges[index].is_alive))){ index--; }
+        if(unlikely(index < 0 || !__is_covered(&(this->_ranges[index]), addr))){
+            retval = POS_FAILED_NOT_EXIST;
+            goto exit;
+        }
+
+        this->_cache[this->_cache_cursor] = this->_ranges[index];
+        range = &(this->_cache[this->_cache_cursor]);
+        this->_cache_cursor = (this->_cache_cursor + 1) % POS_RANGE_INDEX_NB_CACHED;
+
+    found:
+        *value = range->value;
+        if(offset != nullptr){ *offset = addr - range->base; }
+
+    exit:
+        return retval;
+    }
+
+
+    /*!
+     *  \brief  obtain the number of (live) ranges inside the index
+     *  \return number of ranges
+     */
+    inline uint64_t size() const { return this->_bases.size() - this->_nb_tombstones; }
+
+
+    /*!
+     *  \brief  check whether the given address might be covered by a range, without searching
+     *  \note   false for the address is definitely not covered, true for it needs a lookup
+     *  \param  addr    the given address
+     *  \return whether the given address might be covered
+     */
+    inline bool may_cover(uint64_t addr) const {
+        uint64_t page_hash;
+        if(addr - this->_window_begin >= this->_window_end - this->_window_begin){ return false; }
+        page_hash = __hash_page(addr >> POS_RANGE_INDEX_PAGE_SHIFT);
+        return (this->_page_filter[page_hash >> 6] >> (page_hash & 63)) & 1ul;
+    }
+
+
+    /*!
+     *  \brief  obtain the window that covers all ranges, i.e., [begin, end)
+     *  \note   an empty window (begin == end) for no range was inserted
+     *  \param  begin   pointer to store the begin of the window
+     *  \param  end     pointer to store the end of the window
+     */
+    inline void get_window(uint64_t* begin, uint64_t* end) const {
+        POS_CHECK_POINTER(begin);
+        POS_CHECK_POINTER(end);
+        *begin = this->_window_begin;
+        *end = this->_window_end;
+    }
+
+ private:
+    typedef struct range {
+        uint64_t base;
+        uint64_t end;
+        T value;
+        bool is_alive;
+    } range_t;
+
+    static inline bool __is_covered(const range_t* range, uint64_t addr){
+        return range->is_alive && (range->base == addr || (range->base < addr && addr < range->end));
+    }
+
+    /*!
+     *  \brief  find the first base address that isn't smaller than the given address
+     *  \param  base    the given address
+     *  \return index of the found base address, size of the index for not found
+     */
+    inline uint64_t __lower_bound(uint64_t base){
+        return std::lower_bound(this->_bases.begin(), this->_bases.end(), base) - this->_bases.begin();
+    }
+
+    inline void __clear_cache(){
+        for(auto& range : this->_cache){ range.is_alive = false; }
+    }
+
+    static inline uint64_t __hash_page(uint64_t page){
+        return (page * 0x9e3779b97f4a7c15ul) >> (64 - __builtin_ctzl(POS_RANGE_INDEX_PAGE_FILTER_NB_BITS));
+    }
+
+    inline void __clear_filter(){
+        std::fill(std::begin(this->_page_filter), std::end(this->_page_filter), 0);
+        this->_window_begin = 0;
+        this->_window_end = 0;
+    }
+
+    /*!
+     *  \brief  add a range to the window and the page filter
+     *  \note   an empty range still covers its base address, see lookup
+     *  \param  base    base address of the range
+     *  \param  size    size of the range
+     */
+    inline void __add_to_filter(uint64_t base, uint64_t size){
+        uint64_t page, page_hash, end = base + std::max<uint64_t>(size, 1);
+
+        if(unlikely(this->_window_end == 0)){
+            this->_window_begin = base;
+            this->_window_end = end;
+        } else {
+            this->_window_begin = std::min(this->_window_begin, base);
+            this->_window_end = std::max(this->_window_end, end);
+        }
+
+        if(unlikely(
+            ((end - 1) >> POS_RANGE_INDEX_PAGE_SHIFT) - (base >> POS_RANGE_INDEX_PAGE_SHIFT)
+            >= POS_RANGE_INDEX_PAGE_FILTER_NB_BITS
+        )){
+            // the range covers more pages than the filter has, every bit would be set anyway
+            std::fill(std::begin(this->_page_filter), std::end(this->_page_filter), ~0ul);
+            return;
+        }
+        for(page = base >> POS_RANGE_INDEX_PAGE_SHIFT; page <= ((end - 1) >> POS_RANGE_INDEX_PAGE_SHIFT); page++){
+            page_hash = __hash_page(page);
+            this->_page_filter[page_hash >> 6] |= 1ul << (page_hash & 63);
+        }
+    }
+
+    /*!
+     *  \brief  remove all tombstones from the arrays
+     */
+    inline void __compact(){
+        uint64_t i, j = 0;
+        for(i=0; i<this->_bases.size(); i++){
+            if(!(this->_ranges[i].is_alive)){ continue; }
+            this->_bases[j] = this->_bases[i];
+            this->_ranges[j] = this->_ranges[i];
+            j++;
+        }
+        this->_bases.resize(j);
+        this->_ranges.resize(j);
+        this->_nb_tombstones = 0;
+
+        // drop erased ranges from the filter
+        this->__clear_filter();
+        for(i=0; i<j; i++){
+            this->__add_to_filter(this->_ranges[i].base, this->_ranges[i].end - this->_ranges[i].base);
+        }
+    }
+
+    /*!
+     *  \brief  ranges sorted by their base addresses, erased ones are kept as tombstones
+     *  \note   base addresses are also kept in a separate dense array, so that the binary
+     *          search only touches 8 bytes per probe
+     */
+    std::vector<uint64_t> _bases;
+    std::vector<range_t> _ranges;
+    uint64_t _nb_tombstones;
+
+    // copies of recently hit ranges, replaced in round-robin
+    range_t _cache[POS_RANGE_INDEX_NB_CACHED];
+    uint64_t _cache_cursor;
+
+    // window that covers all ranges, i.e., [_window_begin, _window_end)
+    uint64_t _window_begin;
+    uint64_t _window_end;
+
+    // hashed bitmap of coarse pages covered by ranges
+    uint64_t _page_filter[POS_RANGE_INDEX_PAGE_FILTER_NB_BITS / 64];
+};
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <mutex>
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+#include "pos/include/log.h"
+
+
+/*!
+ *  \brief  backend of the size-class pool, which provides and releases raw blocks
+ *          (e.g., cudaMallocHost / cudaFreeHost, cudaMalloc / cudaFree, mmap / munmap)
+ *  \note   the size of the block is passed on release, as some backends (e.g., munmap) require it
+ */
+using pos_size_class_pool_alloc_func_t = void*(*)(uint64_t size);
+using pos_size_class_pool_free_func_t = void(*)(void* ptr, uint64_t size);
+
+
+/*!
+ *  \brief  thread-safe pool of variable-sized blocks, to amortize expensive allocations
+ *          (e.g., pinned host memory) across users with different sizes
+ *  \note   requested sizes are rounded up to size classes, each power of two is divided into
+ *          4 classes so that the rounding wastes at most 25% of the size; released blocks are
+ *          cached and reused by later requests in a best-fit manner, i.e., the smallest cached
+ *          block that is large enough and wastes no more than another 25% of the size class
+ *  \note   cached blocks beyond the given capacity are returned to the backend directly
+ */
+class POSUtilSizeClassPool {
+ public:
+    /*!
+     *  \brief  constructor
+     *  \param  alloc_func          backend function to allocate a raw block
+     *  \param  free_func           backend function to release a raw block
+     *  \param  max_cached_bytes    maximum number of bytes cached by the pool
+     */
+    POSUtilSizeClassPool(
+        pos_size_class_pool_alloc_func_t alloc_func,
+        pos_size_class_pool_free_func_t free_func,
+        uint64_t max_cached_bytes
+    ) : _alloc_func(alloc_func), _free_func(free_func), _max_cached_bytes(max_cached_bytes),
+        _cached_bytes(0), _nb_hits(0), _nb_misses(0)
+    {
+        POS_CHECK_POINTER(alloc_func);
+        POS_CHECK_POINTER(free_func);
+    }
+
+
+    /*!
+     *  \brief  deconstructor
+     *  \note   only cached blocks are released, blocks still held by users are left untouched
+     */
+    ~POSUtilSizeClassPool(){ this->trim(0); }
+
+
+    /*!
+     *  \brief  obtain the size class of the given size
+     *  \param  size    the given size
+     *  \return size of the class
+     */
+    static inline uint64_t get_class_size(uint64_t size){
+        uint64_t step;
+        if(size <= kMinClassSize){ return kMinClassSize; }
+        step = std::max<uint64_t>((1ul << (63 - __builtin_clzl(size - 1))) >> 2, kMinClassSize);
+        return (size + step - 1) / step * step;
+    }
+
+
+    /*!
+     *  \brief  allocate a block from the pool
+     *  \param  size    size of the block to be allocated
+     *  \return pointer to the block, nullptr for zero size or backend failure
+     */
+    inline void* allocate(uint64_t size){
+        std::multimap<uint64_t, void*>::iterator block_iter;
+        uint64_t class_size;
+        void *ptr = nullptr;
+
+        if(unlikely(size == 0)){ return nullptr; }
+        class_size = get_class_size(size);
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            block_iter = this->_free_blocks.lower_bound(class_size);
+            if(block_iter != this->_free_blocks.end() && block_iter->first - class_size <= class_size / 4){
+                ptr = block_iter->second;
+                this->_cached_bytes -= block_iter->first;
+                this->_free_blocks.erase(block_iter);
+                this->_nb_hits += 1;
+                return ptr;
+            }
+            this->_nb_misses += 1;
+        }
+
+        // the backend could be slow (e.g., pinning pages), so we don't hold the lock here
+        if(unlikely(nullptr == (ptr = this->_alloc_func(class_size)))){
+            // the backend might be out of memory, give back all cached blocks and retry
+            this->trim(0);
+            if(unlikely(nullptr == (ptr = this->_alloc_func(class_size)))){
+                POS_WARN_C("failed to allocate block from backend: size(%lu)", class_size);
+                return nullptr;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_block_sizes[ptr] = class_size;
+        return ptr;
+    }
+
+
+    /*!
+     *  \brief  return a block to the pool
+     *  \param  ptr pointer to the block to be returned
+     *  \return POS_SUCCESS for successfully returned;
+     *          POS_FAILED_NOT_EXIST for the block isn't allocated from this pool
+     */
+    inline pos_retval_t deallocate(void* ptr){
+        std::unordered_map<void*, uint64_t>::iterator size_iter;
+        uint64_t block_size;
+
+        if(unlikely(ptr == nullptr)){ return POS_SUCCESS; }
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            size_iter = this->_block_sizes.find(ptr);
+            if(unlikely(size_iter == this->_block_sizes.end())){ return POS_FAILED_NOT_EXIST; }
+            block_size = size_iter->second;
+            if(likely(this->_cached_bytes + block_size <= this->_max_cached_bytes)){
+                this->_free_blocks.emplace(block_size, ptr);
+                this->_cached_bytes += block_size;
+                return POS_SUCCESS;
+            }
+            this->_block_sizes.erase(size_iter);
+        }
+
+        this->_free_func(ptr, block_size);
+        return POS_SUCCESS;
+    }
+
+
+    /*!
+     *  \brief  fill the pool with blocks of the given size in advance, so that later
+     *          allocations with similar sizes won't reach the backend
+     *  \note   blocks of the same size class that are already cached are counted in
+     *  \param  size        size of the blocks
+     *  \param  nb_blocks   number of blocks to be cached
+     *  \return POS_SUCCESS for successfully prewarmed;
+     *          POS_FAILED_DRAIN for exceeding the capacity of the pool or failed backend allocation
+     */
+    inline pos_retval_t prewarm(uint64_t size, uint64_t nb_blocks){
+        uint64_t class_size, nb_existing;
+        void *ptr;
+
+        if(unlikely(size == 0 || nb_blocks == 0)){ return POS_SUCCESS; }
+        class_size = get_class_size(size);
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            nb_existing = this->_free_blocks.count(class_size);
+        }
+
+        for(; nb_existing < nb_blocks; nb_existing++){
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                if(this->_cached_bytes + class_size > this->_max_cached_bytes){ return POS_FAILED_DRAIN; }
+            }
+            if(unlikely(nullptr == (ptr = this->_alloc_func(class_size)))){ return POS_FAILED_DRAIN; }
+
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_block_sizes[ptr] = class_size;
+            this->_free_blocks.emplace(class_size, ptr);
+            this->_cached_bytes += class_size;
+        }
+
+        return POS_SUCCESS;
+    }
+
+
+    /*!
+     *  \brief  parse a prewarm specification (e.g., "256x4,64x16") into blocks to be prewarmed
+     *  \param  spec    the specification, each item is "<size of block in MB>x<number of blocks>"
+     *  \param  blocks  the parsed list of (size of block in bytes, number of blocks)
+     *  \return POS_SUCCESS for successfully parsing;
+     *          POS_FAILED_INVALID_INPUT for malformed specification
+     */
+    static pos_retval_t parse_prewarm_spec(const std::string& spec, std::vector<std::pair<uint64_t, uint64_t>>& blocks){
+        pos_retval_t retval = POS_SUCCESS;
+        std::stringstream ss(spec);
+        std::string item;
+        uint64_t x_pos, size_mb, nb_blocks;
+
+        blocks.clear();
+        while(std::getline(ss, item, ',')){
+            item.erase(0, item.find_first_not_of(" \t\n"));
+            item.erase(item.find_last_not_of(" \t\n") + 1);
+            if(item.empty()){ continue; }
+
+            x_pos = item.find('x');
+            if(unlikely(x_pos == std::string::npos)){
+                POS_WARN("invalid item inside prewarm specification: spec(%s), item(%s)", spec.c_str(), item.c_str());
+                retval = POS_FAILED_INVALID_INPUT;
+                goto exit;
+            }
+
+            try {
+                size_mb = std::stoul(item.substr(0, x_pos));
+                nb_blocks = std::stoul(item.substr(x_pos + 1));
+            } catch (const std::exception& e) {
+                POS_WARN("failed to parse prewarm specification: spec(%s), error(%s)", spec.c_str(), e.what());
+                retval = POS_FAILED_INVALID_INPUT;
+                goto exit;
+            }
+
+            if(unlikely(size_mb == 0)){
+                POS_WARN("invalid block size inside prewarm specification: spec(%s), item(%s)", spec.c_str(), item.c_str());
+                retval = POS_FAILED_INVALID_INPUT;
+                goto exit;
+            }
+            blocks.push_back({ size_mb << 20, nb_blocks });
+        }
+
+    exit:
+        if(unlikely(retval != POS_SUCCESS)){ blocks.clear(); }
+        return retval;
+    }
+
+
+    /*!
+     *  \brief  release cached blocks back to the backend, largest first
+     *  \param  keep_bytes  number of cached bytes to be kept
+     */
+    inline void trim(uint64_t keep_bytes){
+        std::multimap<uint64_t, void*> released;
+        std::multimap<uint64_t, void*>::iterator block_iter;
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            while(this->_cached_bytes > keep_bytes && this->_free_blocks.size() > 0){
+                block_iter = std::prev(this->_free_blocks.end());
+                this->_cached_bytes -= block_iter->first;
+                this->_block_sizes.erase(block_iter->second);
+                released.insert(*block_iter);
+                this->_free_blocks.erase(block_iter);
+            }
+        }
+
+        for(auto& block : released){ this->_free_func(block.second, block.first); }
+    }
+
+
+    /*!
+     *  \brief  statistics of the pool
+     */
+    inline uint64_t get_cached_bytes(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_cached_bytes;
+    }
+    inline uint64_t get_nb_hits(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_nb_hits;
+    }
+    inline uint64_t get_nb_misses(){
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_nb_misses;
+    }
+
+    // minimum size class (and the granularity of large classes)
+    static constexpr uint64_t kMinClassSize = 4096;
+
+ private:
+    std::mutex _mutex;
+
+    // backend functions
+    pos_size_class_pool_alloc_func_t _alloc_func;
+    pos_size_class_pool_free_func_t _free_func;
+
+    // cached blocks, indexed by their sizes for best-fit search
+    std::multimap<uint64_t, void*> _free_blocks;
+
+    // sizes of all blocks allocated from the backend and not yet released, either cached or held by users
+    std::unordered_map<void*, uint64_t> _block_sizes;
+
+    uint64_t _max_cached_bytes;
+    uint64_t _cached_bytes;
+    uint64_t _nb_hits;
+    uint64_t _nb_misses;
+};
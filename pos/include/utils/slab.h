@@ -0,0 +1,138 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+#include <new>
+#include <utility>
+
+#include <stdint.h>
+
+#include "pos/include/common.h"
+
+
+/*!
+ *  \brief  default number of objects per slab
+ */
+#define POS_UTIL_SLAB_DEFAULT_NB_OBJS   64
+
+
+/*!
+ *  \brief  slab allocator of objects with the same type, whose memory is only returned to the
+ *          system all together with the allocator (e.g., handles within a handle manager)
+ *  \note   objects are constructed in place within slabs of t_nb_objs objects, so that
+ *          consecutively created objects are contiguous in memory, and each creation saves
+ *          a malloc call together with its per-chunk header
+ *  \note   an object could be destroyed individually, whose place is reused by later creation
+ *  \note   not thread-safe
+ *  \tparam T           type of the object
+ *  \tparam t_nb_objs   number of objects per slab
+ */
+template<typename T, uint64_t t_nb_objs = POS_UTIL_SLAB_DEFAULT_NB_OBJS>
+class POSUtilSlab {
+ public:
+    POSUtilSlab() : _nb_objs(0) {}
+
+    ~POSUtilSlab(){
+        uint64_t i;
+        std::unordered_set<T*> destroyed_objs(this->_free_objs.begin(), this->_free_objs.end());
+        for(i=0; i<this->_nb_objs; i++){
+            if(destroyed_objs.count(this->__get(i)) > 0){ continue; }
+            this->__get(i)->~T();
+        }
+        for(auto slab : this->_slabs){
+            ::operator delete(slab, std::align_val_t(alignof(T)));
+        }
+    }
+
+    POSUtilSlab(const POSUtilSlab&) = delete;
+    POSUtilSlab& operator=(const POSUtilSlab&) = delete;
+
+
+    /*!
+     *  \brief  create a new object within the slab
+     *  \param  args    arguments to construct the object
+     *  \return pointer to the created object
+     */
+    template<typename... T_Args>
+    inline T* create(T_Args&&... args){
+        void *slab;
+        T *obj;
+
+        // reuse the place of a destroyed object
+        if(this->_free_objs.size() > 0){
+            obj = this->_free_objs.back();
+            this->_free_objs.pop_back();
+            return new (obj) T(std::forward<T_Args>(args)...);
+        }
+
+        if(unlikely(this->_nb_objs == this->_slabs.size() * t_nb_objs)){
+            POS_CHECK_POINTER(slab = ::operator new(sizeof(T) * t_nb_objs, std::align_val_t(alignof(T))));
+            this->_slabs.push_back(slab);
+        }
+
+        obj = new (this->__get(this->_nb_objs)) T(std::forward<T_Args>(args)...);
+        this->_nb_objs += 1;
+
+        return obj;
+    }
+
+
+    /*!
+     *  \brief  destroy an object created from the slab, its place would be reused by later creation
+     *  \param  obj the object to be destroyed
+     */
+    inline void destroy(T* obj){
+        POS_CHECK_POINTER(obj);
+        obj->~T();
+        this->_free_objs.push_back(obj);
+    }
+
+
+    /*!
+     *  \brief  obtain the number of live objects, i.e., created but not yet destroyed
+     *  \return number of live objects
+     */
+    inline uint64_t get_nb_objs() const { return this->_nb_objs - this->_free_objs.size(); }
+
+
+    /*!
+     *  \brief  obtain the number of bytes occupied by all slabs
+     *  \return number of occupied bytes
+     */
+    inline uint64_t get_nb_bytes() const { return this->_slabs.size() * t_nb_objs * sizeof(T); }
+
+ private:
+    /*!
+     *  \brief  obtain the address of the object with specified index
+     *  \param  index   index of the object
+     *  \return address of the object
+     */
+    inline T* __get(uint64_t index) const {
+        return (T*)((uint8_t*)(this->_slabs[index / t_nb_objs]) + (index % t_nb_objs) * sizeof(T));
+    }
+
+    // all allocated slabs
+    std::vector<void*> _slabs;
+
+    // number of places ever used within the slabs
+    uint64_t _nb_objs;
+
+    // places of destroyed objects, to be reused by later creation
+    std::vector<T*> _free_objs;
+};
@@ -23,7 +23,10 @@
 #include <fstream>
 #include <cmath>
 #include <filesystem>
+#include <algorithm>
 
+#include <sched.h>
+#include <pthread.h>
 
 #include "pos/include/common.h"
 #include "pos/include/log.h"
@@ -82,4 +85,108 @@ class POSUtilSystem {
         return std::to_string(static_cast<int>(bytes_d)) + suffixes[index];
     }    
     /* ======================== Memory ======================== */
+
+
+    /* ========================= CPU ========================== */
+ public:
+    /*!
+     *  \brief  parse a CPU list string (e.g., "0-3,8,10-11") into CPU indices
+     *  \param  cpu_list    the CPU list string, in the format of sysfs cpulist
+     *  \param  cpus        the parsed CPU indices
+     *  \return POS_SUCCESS for successfully parsing;
+     *          POS_FAILED_INVALID_INPUT for malformed CPU list
+     */
+    static pos_retval_t parse_cpu_list(const std::string& cpu_list, std::vector<uint32_t>& cpus){
+        pos_retval_t retval = POS_SUCCESS;
+        std::stringstream ss(cpu_list);
+        std::string range;
+        uint64_t dash_pos, begin, end, i;
+
+        cpus.clear();
+        while(std::getline(ss, range, ',')){
+            range.erase(0, range.find_first_not_of(" \t\n"));
+            range.erase(range.find_last_not_of(" \t\n") + 1);
+            if(range.empty()){ continue; }
+
+            try {
+                dash_pos = range.find('-');
+                if(dash_pos == std::string::npos){
+                    begin = end = std::stoul(range);
+                } else {
+                    begin = std::stoul(range.substr(0, dash_pos));
+                    end = std::stoul(range.substr(dash_pos + 1));
+                }
+            } catch (const std::exception& e) {
+                POS_WARN("failed to parse CPU list: cpu_list(%s), error(%s)", cpu_list.c_str(), e.what());
+                retval = POS_FAILED_INVALID_INPUT;
+                goto exit;
+            }
+
+            if(unlikely(begin > end || end >= CPU_SETSIZE)){
+                POS_WARN("invalid CPU range inside CPU list: cpu_list(%s), range(%s)", cpu_list.c_str(), range.c_str());
+                retval = POS_FAILED_INVALID_INPUT;
+                goto exit;
+            }
+            for(i=begin; i<=end; i++){ cpus.push_back(i); }
+        }
+
+    exit:
+        if(unlikely(retval != POS_SUCCESS)){ cpus.clear(); }
+        return retval;
+    }
+
+    /*!
+     *  \brief  obtain CPUs that are NUMA-local to a PCIe device
+     *  \param  pci_bus_id  PCIe bus id of the device (e.g., "0000:3B:00.0")
+     *  \param  cpus        the obtained CPU indices
+     *  \return POS_SUCCESS for successfully obtaining;
+     *          POS_FAILED_NOT_EXIST for no locality information is exposed by sysfs
+     */
+    static pos_retval_t get_pci_local_cpus(std::string pci_bus_id, std::vector<uint32_t>& cpus){
+        pos_retval_t retval = POS_SUCCESS;
+        std::string path, cpu_list;
+        std::ifstream file;
+
+        // sysfs names the device with lowercase hex digits
+        std::transform(pci_bus_id.begin(), pci_bus_id.end(), pci_bus_id.begin(), ::tolower);
+        path = std::string("/sys/bus/pci/devices/") + pci_bus_id + std::string("/local_cpulist");
+
+        file.open(path);
+        if(unlikely(!file.is_open())){
+            POS_WARN("failed to obtain local CPUs of PCIe device, %s not exists", path.c_str());
+            retval = POS_FAILED_NOT_EXIST;
+            goto exit;
+        }
+        std::getline(file, cpu_list);
+        retval = POSUtilSystem::parse_cpu_list(cpu_list, cpus);
+
+    exit:
+        return retval;
+    }
+
+    /*!
+     *  \brief  bind the calling thread to the given CPUs
+     *  \param  cpus    CPU indices to be bound, empty for no binding
+     *  \return POS_SUCCESS for successfully binding
+     */
+    static pos_retval_t bind_current_thread_to_cpus(const std::vector<uint32_t>& cpus){
+        pos_retval_t retval = POS_SUCCESS;
+        cpu_set_t cpu_set;
+        int rc;
+
+        if(cpus.size() == 0){ goto exit; }
+
+        CPU_ZERO(&cpu_set);
+        for(uint32_t cpu : cpus){ CPU_SET(cpu, &cpu_set); }
+
+        rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+        if(unlikely(rc != 0)){
+            POS_WARN("failed to bind thread to CPUs: rc(%d)", rc);
+            retval = POS_FAILED;
+        }
+
+    exit:
+        return retval;
+    }
+    /* ========================= CPU ========================== */
 };
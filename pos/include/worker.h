@@ -21,6 +21,8 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <deque>
+#include <atomic>
 #include <sched.h>
 #include <pthread.h>
 
@@ -28,6 +30,10 @@
 #include "pos/include/log.h"
 #include "pos/include/trace.h"
 #include "pos/include/metrics.h"
+#include "pos/include/utils/lockfree_queue.h"
+#include "pos/include/utils/dispatch_table.h"
+#include "pos/include/daemon_pool.h"
+#include "pos/include/persist_pool.h"
 
 
 // forward declaration
@@ -85,19 +91,15 @@ typedef struct checkpoint_async_cxt {
     POSCommand_QE_t *cmd;
 
     // (latest) version of each handle to be checkpointed
-    std::map<POSHandle*, pos_u64id_t> checkpoint_version_map;
+    POSHandleBitmap<pos_u64id_t> checkpoint_version_map;
 
-    // all handles persisted in async checkpoint thread
-    std::set<POSHandle*> persist_handles;
+    // completion of all persisting raised by the checkpoint command, within the persist pool
+    POSPersistGroup persist_group;
 
     // all dirty handles since start of concurrent checkpoint
-    std::set<POSHandle*> dirty_handles;
+    POSHandleBitmap<> dirty_handles;
     uint64_t dirty_handle_state_size;
 
-    //  this flag should be raise by memcpy API worker function, to avoid slow down by
-    //  overlapped checkpoint process
-    volatile bool membus_lock;
-
     // thread handle
     std::thread *thread;
 
@@ -137,7 +139,51 @@ typedef struct checkpoint_async_cxt {
             PERSIST_wqe_ticks
         };
         POSMetrics_TickerList<metrics_ticker_type_t> metric_tickers;
+    #endif
+
+    /*!
+     *  \brief  commit lane of the top-half, i.e., a thread with dedicated copy streams that
+     *          commits (and then raises persisting of) a subset of stateful handles
+     */
+    typedef struct commit_lane {
+        // handles assigned to this lane, with their checkpoint versions
+        std::vector<std::pair<POSHandle*, pos_u64id_t>> handles;
+
+        // overall state size of the assigned handles
+        uint64_t nb_bytes;
+
+        // handles whose persisting was raised by this lane and not yet synchronized
+        std::deque<POSHandle*> persisting_handles;
+
+        // result of the lane
+        pos_retval_t retval;
+
+        #if POS_CONF_RUNTIME_EnableTrace
+            // metrics recorded within the lane, merged into the context once all lanes finished,
+            // as the metric lists aren't thread-safe
+            std::vector<std::pair<metrics_ticker_type_t, uint64_t>> ticks;
+            std::vector<std::pair<metrics_counter_type_t, uint64_t>> counters;
+            std::vector<std::pair<metrics_reducer_type_t, uint64_t>> reduces;
+        #endif
+
+        inline void reset(){
+            handles.clear();
+            nb_bytes = 0;
+            persisting_handles.clear();
+            retval = POS_SUCCESS;
+            #if POS_CONF_RUNTIME_EnableTrace
+                ticks.clear();
+                counters.clear();
+                reduces.clear();
+            #endif
+        }
+    } commit_lane_t;
+    commit_lane_t lanes[POS_CONF_EVAL_CkptCommitLanes];
 
+    // overall state size that has been committed by all lanes but not yet persisted
+    std::atomic<uint64_t> inflight_bytes;
+
+    #if POS_CONF_RUNTIME_EnableTrace
         
         /*!
          *  \brief  print the metrics of the async checkpoint context
@@ -184,7 +230,7 @@ typedef struct checkpoint_async_cxt {
         }
     #endif
 
-    checkpoint_async_cxt() : TH_actve(false), BH_active(false), dirty_handle_state_size(0) {}
+    checkpoint_async_cxt() : TH_actve(false), BH_active(false), dirty_handle_state_size(0), inflight_bytes(0) {}
 } checkpoint_async_cxt_t;
 
 #endif // POS_CONF_EVAL_CkptOptLevel == 2
@@ -192,8 +238,10 @@ typedef struct checkpoint_async_cxt {
 
 /*!
  *  \brief  POS Worker
+ *  \note   the worker is driven by either its dedicated daemon thread, or the shared
+ *          daemon pool of the workspace (see POSDaemonPool)
  */
-class POSWorker {
+class POSWorker : public POSDaemonTask {
  public:
     /*!
      *  \brief  constructor
@@ -273,22 +321,31 @@ class POSWorker {
     // worker function map
     std::map<uint64_t, pos_worker_launch_function_t> _launch_functions;
 
+    // flat table of worker functions, indexed by api_id
+    POSDispatchTable<pos_worker_launch_function_t> _launch_function_table;
+
+    // buffers of polled elements, reused across polling iterations
+    POSCommand_QE_t* _cmd_wqes[POS_LOCKLESS_QUEUE_POLL_BATCH];
+    POSAPIContext_QE_t* _apicxt_wqes[POS_LOCKLESS_QUEUE_POLL_BATCH];
+
     #if POS_CONF_EVAL_CkptOptLevel == 2
-        // stream for overlapped memcpy while computing happens
-        uint64_t _ckpt_stream_id;
+        // streams for overlapped memcpy while computing happens, one per commit lane
+        uint64_t _ckpt_stream_ids[POS_CONF_EVAL_CkptCommitLanes];
 
         // stream for doing CoW
         uint64_t _cow_stream_id;
     #endif
 
     #if POS_CONF_EVAL_CkptOptLevel == 2 && POS_CONF_EVAL_CkptEnablePipeline == 1
-        // stream for commiting checkpoint from device
-        uint64_t _ckpt_commit_stream_id;
+        // streams for commiting checkpoint from device, one per commit lane
+        uint64_t _ckpt_commit_stream_ids[POS_CONF_EVAL_CkptCommitLanes];
     #endif
 
 
     /*!
      *  \brief  insertion of worker functions
+     *  \note   the implementation could either insert to _launch_functions, or directly
+     *          bind _launch_function_table to a flat array generated at compile time
      *  \return POS_SUCCESS for succefully insertion
      */
     virtual pos_retval_t init_wk_functions(){ 
@@ -296,12 +353,11 @@ class POSWorker {
     }
 
     /*!
-     *  \brief      initialization of the worker daemon thread
-     *  \example    for CUDA, one need to call API e.g. cudaSetDevice first to setup the context for a thread
+     *  \brief  one polling iteration of the worker
+     *  \return number of digested elements (or conducted checkpoint procedures),
+     *          0 for all queues are empty
      */
-    virtual pos_retval_t daemon_init(){
-        return POS_SUCCESS; 
-    }
+    uint64_t daemon_poll() override;
 
  protected:
     /*!
@@ -330,17 +386,40 @@ class POSWorker {
 
  private:
     /*!
-     *  \brief  processing daemon of the worker
+     *  \brief  processing daemon of the worker, which drives daemon_poll on the dedicated thread
      */
     void __daemon();
 
+    /*!
+     *  \brief  record the busy / idle statistics of the stopped daemon into metrics
+     */
+    void __record_daemon_metrics();
+
+
+    /*!
+     *  \brief  reference those stateful handles unchanged since the base image of an
+     *          incremental checkpoint, instead of committing and persisting them again
+     *  \note   handles that can't be referenced (e.g., missing from the base image) are
+     *          moved to the stateful handles of the command, to be persisted as usual
+     *  \param  cmd     the checkpoint command
+     */
+    void __checkpoint_reference_unchanged_handles(POSCommand_QE_t *cmd);
+
+
+    /*!
+     *  \brief  mark the state ranges written by the launched API as dirty, so that the next
+     *          checkpoint round only copies modified chunks of those large handles
+     *  \param  wqe     the launched API context
+     */
+    void __mark_dirty_state(POSAPIContext_QE *wqe);
 
     #if POS_CONF_EVAL_CkptOptLevel == 0 || POS_CONF_EVAL_CkptOptLevel == 1
         /*!
-         *  \brief  worker daemon with / without SYNC checkpoint support 
+         *  \brief  polling iteration of the worker with / without SYNC checkpoint support 
          *          (checkpoint optimization level 0 and 1)
+         *  \return number of digested elements, 0 for all queues are empty
          */
-        void __daemon_ckpt_sync();
+        uint64_t __poll_ckpt_sync();
 
         /*!
          *  \brief  checkpoint procedure, should be implemented by each platform
@@ -351,9 +430,11 @@ class POSWorker {
         pos_retval_t __checkpoint_handle_sync(POSCommand_QE_t *cmd);
     #elif POS_CONF_EVAL_CkptOptLevel == 2
         /*!
-         *  \brief  worker daemon with ASYNC checkpoint support (checkpoint optimization level 2)
+         *  \brief  polling iteration of the worker with ASYNC checkpoint support
+         *          (checkpoint optimization level 2)
+         *  \return number of digested elements, 0 for all queues are empty
          */
-        void __daemon_ckpt_async();
+        uint64_t __poll_ckpt_async();
 
         /*!
          *  \brief  [Top-half] overlapped checkpoint procedure, should be implemented by each platform
@@ -363,6 +444,16 @@ class POSWorker {
          */
         void __checkpoint_TH_async_thread();
 
+        /*!
+         *  \brief  [Top-half] commit all handles assigned to the given lane on its own streams, and
+         *          raise persisting of committed handles batch by batch, so that persisting overlaps
+         *          with the commit of the rest
+         *  \note   the overall state committed but not yet persisted by all lanes is bounded by
+         *          POS_CONF_EVAL_CkptInflightMb
+         *  \param  lane_id index of the lane
+         */
+        void __checkpoint_TH_commit_lane(uint64_t lane_id);
+
         /*!
          *  \brief  [Bottom-Half] 
          *  \return ?
@@ -372,9 +463,10 @@ class POSWorker {
 
     #if POS_CONF_EVAL_MigrOptLevel > 0
         /*!
-         *  \brief  worker daemon with optimized migration support (POS)
+         *  \brief  polling iteration of the worker with optimized migration support (POS)
+         *  \return number of digested elements, 0 for all queues are empty
          */
-        void __daemon_migration_opt();
+        uint64_t __poll_migration_opt();
     #endif
 
     /*!
@@ -390,7 +482,10 @@ class POSWorker {
      *  \param  api_meta    metadata of the called API
      *  \return POS_SUCCESS for successfully checking and restoring
      */
-    pos_retval_t __restore_broken_handles(POSAPIContext_QE_t* wqe, POSAPIMeta_t *api_meta); 
+    pos_retval_t __restore_broken_handles(POSAPIContext_QE_t* wqe, const POSAPIMeta_t *api_meta); 
+
+    // list of broken handles, reused across ops within __restore_broken_handles
+    POSHandle::pos_broken_handle_list_t _broken_handle_list;
 
     // maximum index of processed wqe index
     uint64_t _max_wqe_id;
@@ -425,6 +520,7 @@ class POSWorker {
             #endif
             RESTORE_nb_ondemand_reload_handles,
             RESTORE_nb_ondemand_reload_state_handles,
+            DAEMON_nb_parks,
         };
         POSMetrics_CounterList<metrics_counter_type_t> _metric_counters;
 
@@ -441,6 +537,8 @@ class POSWorker {
             #endif
             RESTORE_ondemand_reload_ticks,
             RESTORE_ondemand_reload_state_ticks,
+            DAEMON_busy_ticks,
+            DAEMON_idle_ticks,
         };
         POSMetrics_TickerList<metrics_ticker_type_t> _metric_tickers;
         
@@ -21,6 +21,7 @@
 #include <map>
 #include <string>
 #include <mutex>
+#include <thread>
 #include <atomic>
 #include <stdint.h>
 #include <unistd.h>
@@ -36,6 +37,7 @@
 #include "pos/include/transport.h"
 #include "pos/include/oob.h"
 #include "pos/include/api_context.h"
+#include "pos/include/persist_pool.h"
 #include "pos/include/utils/timer.h"
 
 
@@ -43,6 +45,19 @@
 class POSWorkspace;
 
 
+/*!
+ *  \brief  maximum number of clients that can be concurrently served by the workspace
+ */
+#define POS_WORKSPACE_MAX_NB_CLIENTS    1024
+
+
+/*!
+ *  \brief  interval (ms) of the background reclaimer, which retires the returned async
+ *          apicxts of those clients whose RPC thread stays idle
+ */
+#define POS_WORKSPACE_RECLAIM_INTERVAL_MS   100
+
+
 /*!
  *  \brief  function prototypes for cli oob server
  */
@@ -53,6 +68,7 @@ namespace oob_functions {
     POS_OOB_DECLARE_SVR_FUNCTIONS(cli_ckpt_dump);
     POS_OOB_DECLARE_SVR_FUNCTIONS(cli_restore);
     POS_OOB_DECLARE_SVR_FUNCTIONS(cli_trace_resource);
+    POS_OOB_DECLARE_SVR_FUNCTIONS(cli_trace_performance);
 }; // namespace oob_functions
 
 
@@ -71,6 +87,8 @@ class POSWorkspaceConf {
         kRuntimeTraceResourceEnabled,
         kRuntimeTracePerformanceEnabled,
         kRuntimeTraceDir,
+        kRuntimeDaemonCpuList,
+        kRuntimeCkptPoolPrewarm,
         kEvalCkptIntervfalMs,
         kUnknown
     }; 
@@ -103,6 +121,13 @@ class POSWorkspaceConf {
     bool _runtime_trace_resource;
     bool _runtime_trace_performance;
     std::string _runtime_trace_dir;
+    // CPUs to pin parser and worker daemons of each client (in sysfs cpulist format),
+    // empty for no pinning
+    std::string _runtime_daemon_cpu_list;
+    // pinned host blocks to prewarm for checkpoint slots on client start (e.g., "256x4,64x16",
+    // i.e., <size of block in MB>x<number of blocks>), empty for no prewarming; defaults to
+    // runtime_default_ckpt_pool_prewarm in the build configs
+    std::string _runtime_ckpt_pool_prewarm;
 
     // ====== evaluation configurations ======
     // continuous checkpoint interval (ticks)
@@ -173,19 +198,13 @@ class POSWorkspace {
 
     /*!
      *  \brief  obtain client by given uuid
+     *  \note   lock-free, safe to be called while other clients are being created / removed
      *  \param  uuid    uuid of the client
-     *  \return pointer to the corresponding POSClient
+     *  \return pointer to the corresponding POSClient, nullptr for no client with the given uuid
      */
     inline POSClient* get_client_by_uuid(pos_client_uuid_t uuid){
-        POSClient *retval = nullptr;
-
-        if(uuid >= this->_client_list.size()){
-            goto exit;
-        }
-        retval = this->_client_list[uuid];
-        
-    exit:
-        return retval;
+        if(unlikely(uuid >= POS_WORKSPACE_MAX_NB_CLIENTS)){ return nullptr; }
+        return this->_client_list[uuid].load(std::memory_order_acquire);
     }
 
 
@@ -196,6 +215,18 @@ class POSWorkspace {
      */
     POSClient* get_client_by_pid(__pid_t pid);
 
+
+    /*!
+     *  \brief  dump the per-API latency histograms, along with the number / bytes of live
+     *          WQEs of all clients into a report file
+     *  \note   histograms are merged on the calling thread, while the parsers and workers
+     *          keep recording, so the report is a (slightly stale) snapshot
+     *  \param  file_path   path of the report file
+     *  \return POS_SUCCESS for successfully dumped
+     *          POS_FAILED for failed to open the report file
+     */
+    pos_retval_t dump_api_latency(const std::string& file_path);
+
  protected:
     /*!
      *  \brief  create a specific-implemented client
@@ -217,13 +248,58 @@ class POSWorkspace {
     }
 
 
-    // map of clients
-    std::vector<POSClient*> _client_list;
+    /*!
+     *  \brief  table of clients indexed by uuid
+     *  \note   slots are only updated under _client_mutex, and read lock-free by the RPC frontend
+     */
+    std::atomic<POSClient*> _client_list[POS_WORKSPACE_MAX_NB_CLIENTS];
+
+    // map of clients indexed by pid, protected by _client_mutex
     std::map<__pid_t, POSClient*> _pid_client_map;
 
-    // the max uuid that has been recorded
+    // cursor to allocate the uuid of the next client, protected by _client_mutex
     pos_client_uuid_t _current_max_uuid;
 
+    // mutex to serialize creation / removal of clients
+    std::mutex _client_mutex;
+
+    // registered clients in the order of registration, protected by _client_mutex
+    std::vector<POSClient*> _clients_by_age;
+
+    /*!
+     *  \brief  the earliest registered client that is still alive, nullptr for none
+     *  \note   updated under _client_mutex, used to route calls from remoting frontends
+     *          that don't piggyback the uuid yet (see __get_client_of_call)
+     */
+    std::atomic<POSClient*> _default_client;
+
+    /*!
+     *  \brief  refresh _default_client after the set of clients changed
+     *  \note   should be called with _client_mutex held
+     */
+    inline void __update_default_client(){
+        this->_default_client.store(
+            this->_clients_by_age.size() > 0 ? this->_clients_by_age.front() : nullptr,
+            std::memory_order_release
+        );
+    }
+
+    /*!
+     *  \brief  resolve the client that issues an API call
+     *  \note   remoting frontends that don't piggyback the uuid always send uuid 0, such call is
+     *          routed to the earliest registered client that is still alive if no client owns uuid 0,
+     *          which is the client that used to own uuid 0 before uuids were allocated by a cursor
+     *  \param  uuid    uuid carried in the call
+     *  \return pointer to the client, nullptr for no client could be resolved
+     */
+    inline POSClient* __get_client_of_call(pos_client_uuid_t uuid){
+        POSClient *client = this->get_client_by_uuid(uuid);
+        if(unlikely(client == nullptr && uuid == 0)){
+            client = this->_default_client.load(std::memory_order_acquire);
+        }
+        return client;
+    }
+
     /* ============ end of client management functions =========== */
 
  public:
@@ -238,10 +314,27 @@ class POSWorkspace {
      *  \return return code on specific XPU platform
      */
     int pos_process(
-        uint64_t api_id, pos_client_uuid_t uuid, std::vector<POSAPIParamDesp_t> param_desps,
+        uint64_t api_id, pos_client_uuid_t uuid, const std::vector<POSAPIParamDesp_t>& param_desps,
         void* ret_data=nullptr, uint64_t ret_data_len=0
     );
 
+    /*!
+     *  \brief  batched entrance of POS, submit multiple API calls of the same client in one go
+     *  \note   the client lookup is conducted once per batch, and the API metadata is only
+     *          looked up again when the api_id changes between adjacent calls; calls are
+     *          submitted in order, and a sync call within the batch blocks until it's finished
+     *  \param  uuid        uuid of the remote client
+     *  \param  call_desps  descriptors of all calls within the batch
+     *  \param  nb_calls    number of calls within the batch
+     *  \param  retvals     per-call return codes on specific XPU platform, should be able
+     *                      to contain nb_calls elements
+     *  \return POS_SUCCESS for all calls are successfully submitted;
+     *          POS_FAILED_INVALID_INPUT for some calls are rejected (see retvals)
+     */
+    pos_retval_t pos_process_batch(
+        pos_client_uuid_t uuid, const POSAPICallDesp_t* call_desps, uint64_t nb_calls, int* retvals
+    );
+
     /*!
      *  \brief  try obtain the aliveness of the client, if it isn't ready, the remoting framework should stop receiving request
      *  \param  uuid    uuid of the client
@@ -252,12 +345,7 @@ class POSWorkspace {
         volatile POSClient *client;
         int retval = 1;
 
-        if(unlikely(this->_client_list.size() <= uuid)){
-            // POS_WARN_C("try to require access to non-exist client: uuid(%lu)", uuid);
-            return 0;
-        }
-
-        client = this->_client_list[uuid];
+        client = this->get_client_by_uuid(uuid);
         if(unlikely(client == nullptr)){
             // POS_WARN_C("try to require access to non-exist client: uuid(%lu)", uuid);
             retval = 0; goto exit;
@@ -294,6 +382,18 @@ class POSWorkspace {
     // TSC timer of the workspace
     POSUtilTscTimer tsc_timer;
 
+    // shared daemon pool that drives the parsers and workers of clients,
+    // nullptr for each client runs its own daemon threads
+    POSDaemonPool *daemon_pool;
+
+    // shared thread pool that persists checkpoints of handles of all clients
+    POSPersistPool *persist_pool;
+
+    // cost model to decide between dirty copy and recomputation while dumping, shared by
+    // all clients as the bandwidths are properties of the machine, so that each dump
+    // learns from the previous ones
+    POSCheckpointCostModel ckpt_cost_model;
+
  protected:
     /*!
      *  \brief  out-of-band server
@@ -324,6 +424,39 @@ class POSWorkspace {
     virtual pos_retval_t preserve_resource(pos_resource_typeid_t rid, void *data){
         return POS_FAILED_NOT_IMPLEMENTED;
     }
+
+    /*!
+     *  \brief  block until the specified sync call is finished, spin for an adaptive
+     *          budget before parking the RPC thread
+     *  \note   the reference of the WQE owned by the RPC frontend is dropped after waiting
+     *  \param  client  the client that issues the sync call
+     *  \param  wqe     the WQE of the sync call
+     *  \return return code of the sync call on specific XPU platform, or the return code of
+     *          previous failed async call (if any)
+     */
+    int __wait_sync_call(POSClient *client, POSAPIContext_QE *wqe);
+
+    /*!
+     *  \brief  submit a WQE to the rpc2parser work queue of the client
+     *  \note   the RPC thread is back-pressured (i.e., blocked) while the queue is full,
+     *          the WQE is still owned by the caller if the submission failed
+     *  \param  client  the client that issues the call
+     *  \param  wqe     the WQE of the call
+     *  \return POS_SUCCESS for successfully submission
+     */
+    pos_retval_t __submit_wqe(POSClient *client, POSAPIContext_QE *wqe);
+
+    /*!
+     *  \brief  processing daemon of the background reclaimer
+     *  \note   the RPC thread only retires returned async apicxts while it's issuing calls,
+     *          so the reclaimer periodically retires them for all clients, in case some
+     *          client stays idle after a burst of async calls
+     */
+    void __reclaim_daemon();
+
+    // thread handle and stop flag of the background reclaimer
+    std::thread *_reclaimer;
+    volatile bool _reclaimer_stop_flag;
     
     void parse_command_line_options(int argc, char *argv[]);
 };
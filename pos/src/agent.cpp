@@ -22,7 +22,8 @@
 #include "yaml-cpp/yaml.h"
 
 
-POSAgentConf::POSAgentConf(POSAgent *root_agent) : _root_agent(root_agent), _pid(0) {}
+POSAgentConf::POSAgentConf(POSAgent *root_agent) 
+    : _root_agent(root_agent), _daemon_dedicated(false), _daemon_weight(POS_DAEMON_POOL_DEFAULT_WEIGHT), _pid(0) {}
 
 
 pos_retval_t POSAgentConf::load_config(std::string &&file_path){
@@ -86,6 +87,22 @@ pos_retval_t POSAgentConf::load_config(std::string &&file_path){
         } else {
             this->_daemon_addr = "127.0.0.1";
         }
+
+        // load daemon scheduling options, latency-critical jobs could request dedicated daemon threads
+        if(config["daemon_dedicated"]){
+            this->_daemon_dedicated = config["daemon_dedicated"].as<bool>();
+        }
+        if(config["daemon_weight"]){
+            this->_daemon_weight = config["daemon_weight"].as<uint32_t>();
+            if(unlikely(this->_daemon_weight == 0 || this->_daemon_weight > POS_DAEMON_POOL_MAX_WEIGHT)){
+                POS_WARN_C(
+                    "failed to load agent configuration, daemon weight out of range: daemon_weight(%u), max(%u)",
+                    this->_daemon_weight, POS_DAEMON_POOL_MAX_WEIGHT
+                );
+                retval = POS_FAILED_INVALID_INPUT;
+                goto exit;
+            }
+        }
     } catch (const YAML::Exception& e) {
         POS_WARN_C("failed to parse yaml file: path(%s), error(%s)", file_path.c_str(), e.what());
         retval = POS_FAILED_INVALID_INPUT;
@@ -137,6 +154,8 @@ POSAgent::POSAgent() : _agent_conf(this) {
     // register client
     call_data.job_name = this->_agent_conf._job_name;
     call_data.pid = this->_agent_conf._pid;
+    call_data.is_daemon_dedicated = this->_agent_conf._daemon_dedicated;
+    call_data.daemon_weight = this->_agent_conf._daemon_weight;
     if(POS_SUCCESS != this->_pos_oob_client->call(kPOS_OOB_Msg_Agent_Register_Client, &call_data)){
         POS_ERROR_C_DETAIL("failed to register the client");
     }
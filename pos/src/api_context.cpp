@@ -33,20 +33,20 @@
 #include "pos/include/proto/apicxt.pb.h"
 
 
+POSAPIContext::POSAPIContext()
+    : api_id(0), ret_data(nullptr), retval_size(0), return_code(0)
+{
+    params.reserve(16);
+}
+
+
 POSAPIContext::POSAPIContext(
     uint64_t api_id_, std::vector<POSAPIParamDesp_t>& param_desps, void* ret_data_, uint64_t retval_size_
 ) 
-    : api_id(api_id_), ret_data(ret_data_), retval_size(retval_size_)
+    : api_id(api_id_), ret_data(ret_data_), retval_size(retval_size_), return_code(0)
 {
-    POSAPIParam_t *param;
-
     params.reserve(16);
-
-    // insert parameters
-    for(auto& param_desp : param_desps){
-        POS_CHECK_POINTER(param = new POSAPIParam_t(param_desp.value, param_desp.size));
-        params.push_back(param);
-    }
+    this->load(api_id_, param_desps.data(), param_desps.size(), ret_data_, retval_size_);
 }
 
 
@@ -58,16 +58,51 @@ POSAPIContext::POSAPIContext(uint64_t api_id_, uint64_t retval_size)
 }
 
 
-POSAPIContext_QE::POSAPIContext_QE(
-    uint64_t api_id, pos_client_uuid_t uuid, std::vector<POSAPIParamDesp_t>& param_desps,
-    uint64_t inst_id, void* retval_data, uint64_t retval_size, POSClient* pos_client
-) : client_id(uuid), client(pos_client), id(inst_id), has_return(false),
-    status(kPOS_API_Execute_Status_Init), type(ApiCxt_TypeId_Normal)
+void POSAPIContext::load(
+    uint64_t api_id_, const POSAPIParamDesp_t* param_desps, uint64_t nb_params, void* ret_data_, uint64_t retval_size_
+){
+    uint64_t i;
+    POSAPIParam_t *param;
+
+    this->clear_params();
+
+    this->api_id = api_id_;
+    this->ret_data = ret_data_;
+    this->retval_size = retval_size_;
+    this->return_code = 0;
+
+    // insert parameters, only those beyond the embedded slots require heap allocation
+    for(i=0; i<nb_params; i++){
+        if(likely(i < POS_API_NB_EMBEDDED_PARAMS)){
+            param = &(this->embedded_params[i]);
+            param->load(param_desps[i].value, param_desps[i].size);
+        } else {
+            POS_CHECK_POINTER(param = new POSAPIParam_t(param_desps[i].value, param_desps[i].size));
+        }
+        this->params.push_back(param);
+    }
+}
+
+
+void POSAPIContext::clear_params(){
+    for(auto param : this->params){
+        POS_CHECK_POINTER(param);
+        if(param >= this->embedded_params && param < this->embedded_params + POS_API_NB_EMBEDDED_PARAMS){
+            param->release();
+        } else {
+            delete param;
+        }
+    }
+    this->params.clear();
+}
+
+
+POSAPIContext_QE::POSAPIContext_QE()
+    : client_id(0), client(nullptr), id(0), has_return(false), is_sync(false),
+    status(kPOS_API_Execute_Status_Init), type(ApiCxt_TypeId_Normal), nb_refs(0), arena(nullptr), nb_bytes(0), epoch(0)
 {
-    POS_CHECK_POINTER(pos_client);
-    this->api_cxt = new POSAPIContext_t(api_id, param_desps, retval_data, retval_size);
-    POS_CHECK_POINTER(this->api_cxt);
-    create_tick = POSUtilTscTimer::get_tsc();
+    POS_CHECK_POINTER(this->api_cxt = new POSAPIContext_t());
+    create_tick = return_tick = 0;
     parser_s_tick = parser_e_tick = worker_s_tick = worker_e_tick = 0;
 
     // reserve space
@@ -80,14 +115,80 @@ POSAPIContext_QE::POSAPIContext_QE(
 
 
 POSAPIContext_QE::POSAPIContext_QE(
-    POSClient* client, const std::string& ckpt_file, pos_apicxt_typeid_t type
+    uint64_t api_id, pos_client_uuid_t uuid, std::vector<POSAPIParamDesp_t>& param_desps,
+    uint64_t inst_id, void* retval_data, uint64_t retval_size, POSClient* pos_client
+) : POSAPIContext_QE()
+{
+    this->load(api_id, uuid, param_desps.data(), param_desps.size(), inst_id, retval_data, retval_size, pos_client);
+}
+
+
+void POSAPIContext_QE::load(
+    uint64_t api_id, pos_client_uuid_t uuid, const POSAPIParamDesp_t* param_desps, uint64_t nb_params,
+    uint64_t inst_id, void* retval_data, uint64_t retval_size, POSClient* pos_client
 ){
+    POS_CHECK_POINTER(pos_client);
+    POS_CHECK_POINTER(this->api_cxt);
+
+    this->client_id = uuid;
+    this->client = pos_client;
+    this->id = inst_id;
+    this->has_return = false;
+    this->is_sync = false;
+    this->completion.reset();
+    this->status = kPOS_API_Execute_Status_Init;
+    this->type = ApiCxt_TypeId_Normal;
+    this->nb_refs.store(1, std::memory_order_relaxed);
+
+    this->api_cxt->load(api_id, param_desps, nb_params, retval_data, retval_size);
+
+    // the embedded parameters and inline payloads are part of the context, only count heap spills
+    this->nb_bytes = sizeof(POSAPIContext_QE) + sizeof(POSAPIContext);
+    for(uint64_t i=0; i<nb_params; i++){
+        if(unlikely(i >= POS_API_NB_EMBEDDED_PARAMS)){ this->nb_bytes += sizeof(POSAPIParam_t); }
+        if(param_desps[i].size > POS_API_PARAM_INLINE_SIZE){ this->nb_bytes += param_desps[i].size; }
+    }
+    if(likely(this->arena != nullptr)){ this->arena->charge(this); }
+
+    // clear() keeps the reserved capacity of recycled WQE
+    input_handle_views.clear();
+    output_handle_views.clear();
+    inout_handle_views.clear();
+    create_handle_views.clear();
+    delete_handle_views.clear();
+
+    create_tick = POSUtilTscTimer::get_tsc();
+    return_tick = 0;
+    parser_s_tick = parser_e_tick = worker_s_tick = worker_e_tick = 0;
+}
+
+
+void POSAPIContext_QE::put_ref(){
+    POS_ASSERT(this->nb_refs.load(std::memory_order_relaxed) > 0);
+    if(this->nb_refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        if(likely(this->arena != nullptr)){
+            this->arena->recycle(this);
+        } else {
+            if(this->epoch != 0){
+                POS_CHECK_POINTER(this->client);
+                this->client->apicxt_arena.unpin(this);
+            }
+            delete this;
+        }
+    }
+}
+
+
+POSAPIContext_QE::POSAPIContext_QE(
+    POSClient* client, const std::string& ckpt_file, pos_apicxt_typeid_t type
+) : api_cxt(nullptr), is_sync(false), nb_refs(1), arena(nullptr), nb_bytes(0), epoch(0)
+{
     pos_retval_t retval = POS_SUCCESS;
     pos_protobuf::Bin_POSAPIContext apicxt_binary;
     POSHandleView_t hv;
     std::ifstream input;
     uint64_t i, param_size;
-    void *param_area;
+    const void *param_area;
     POSAPIParam_t *api_param;
 
     POS_CHECK_POINTER(client);
@@ -169,13 +270,7 @@ POSAPIContext_QE::POSAPIContext_QE(
 
     for(i=0; i<apicxt_binary.params_size(); i++){
         POS_ASSERT((param_size = apicxt_binary.params(i).size()) > 0);
-        POS_CHECK_POINTER(param_area = malloc(param_size));
-        memcpy(
-            param_area, 
-            reinterpret_cast<const void*>(apicxt_binary.params(i).state().c_str()),
-            param_size
-        );
-
+        param_area = reinterpret_cast<const void*>(apicxt_binary.params(i).state().c_str());
         POS_CHECK_POINTER(api_param = new POSAPIParam_t(param_area, param_size));
         this->api_cxt->params.push_back(api_param);
     }
@@ -191,7 +286,7 @@ exit:
 
 
 POSAPIContext_QE::~POSAPIContext_QE(){
-    // TODO: release handle views
+    if(likely(this->api_cxt != nullptr)){ delete this->api_cxt; }
 }
 
 
@@ -312,3 +407,118 @@ template pos_retval_t POSAPIContext_QE::persist<true, ApiCxt_TypeId_Unexecuted>(
 template pos_retval_t POSAPIContext_QE::persist<false, ApiCxt_TypeId_Unexecuted>(std::string ckpt_dir);
 template pos_retval_t POSAPIContext_QE::persist<true, ApiCxt_TypeId_Recomputation>(std::string ckpt_dir);
 template pos_retval_t POSAPIContext_QE::persist<false, ApiCxt_TypeId_Recomputation>(std::string ckpt_dir);
+
+
+POSAPIContextArena::~POSAPIContextArena(){
+    for(auto slab : this->_slabs){
+        POS_CHECK_POINTER(slab);
+        delete[] slab;
+    }
+}
+
+
+void POSAPIContextArena::__allocate_slab(){
+    uint64_t i;
+    POSAPIContext_QE *slab;
+
+    POS_CHECK_POINTER(slab = new POSAPIContext_QE[POS_APICXT_ARENA_SLAB_SIZE]);
+    this->_slabs.push_back(slab);
+    this->nb_slabs += 1;
+
+    this->_free_list.reserve(this->_free_list.size() + POS_APICXT_ARENA_SLAB_SIZE);
+    for(i=0; i<POS_APICXT_ARENA_SLAB_SIZE; i++){
+        slab[i].arena = this;
+        this->_free_list.push_back(&(slab[i]));
+    }
+}
+
+
+POSAPIContext_QE* POSAPIContextArena::acquire(){
+    POSAPIContext_QE *wqe;
+    uint64_t epoch;
+
+    if(unlikely(this->_owner_tid == std::thread::id())){
+        this->_owner_tid = std::this_thread::get_id();
+    }
+
+    #if POS_CONF_RUNTIME_EnableDebugCheck
+        if(unlikely(this->_owner_tid != std::this_thread::get_id())){
+            POS_ERROR_C_DETAIL("acquire WQE from non-owner thread, this is a bug");
+        }
+    #endif
+
+    if(unlikely(this->_free_list.size() == 0)){
+        // collect WQEs recycled by other threads
+        this->_recycle_mutex.lock();
+        this->_free_list.swap(this->_recycle_list);
+        this->_recycle_mutex.unlock();
+
+        if(unlikely(this->_free_list.size() == 0)){
+            this->__allocate_slab();
+        }
+    }
+
+    wqe = this->_free_list.back();
+    this->_free_list.pop_back();
+    POS_CHECK_POINTER(wqe);
+
+    wqe->nb_refs.store(1, std::memory_order_relaxed);
+    wqe->nb_bytes = 0;
+
+    // advance the epoch once all WQEs of the previous epoch are recycled
+    epoch = this->_epoch.load(std::memory_order_relaxed);
+    if(this->_epoch_nb_live[(epoch + 1) & 1].load(std::memory_order_acquire) == 0){
+        epoch += 1;
+        this->_epoch.store(epoch, std::memory_order_release);
+    }
+    wqe->epoch = epoch;
+    this->_epoch_nb_live[epoch & 1].fetch_add(1, std::memory_order_relaxed);
+
+    this->nb_acquired += 1;
+    __add(this->_acquired_cnt, 1);
+
+    return wqe;
+}
+
+
+void POSAPIContextArena::recycle(POSAPIContext_QE* wqe){
+    POS_CHECK_POINTER(wqe);
+    POS_ASSERT(wqe->arena == this);
+    POS_CHECK_POINTER(wqe->api_cxt);
+
+    // release heap-allocated parameters in advance, so that large payloads
+    // won't be kept by idle WQEs
+    wqe->api_cxt->clear_params();
+
+    this->_epoch_nb_live[wqe->epoch & 1].fetch_sub(1, std::memory_order_release);
+
+    if(likely(std::this_thread::get_id() == this->_owner_tid)){
+        this->_free_list.push_back(wqe);
+        __add(this->_local_recycled_cnt, 1);
+        __add(this->_local_recycled_bytes, wqe->nb_bytes);
+    } else {
+        this->_recycle_mutex.lock();
+        this->_recycle_list.push_back(wqe);
+        __add(this->_remote_recycled_cnt, 1);
+        __add(this->_remote_recycled_bytes, wqe->nb_bytes);
+        this->_recycle_mutex.unlock();
+    }
+}
+
+
+void POSAPIContextArena::pin(POSAPIContext_QE* wqe){
+    POS_CHECK_POINTER(wqe);
+    POS_ASSERT(wqe->arena == nullptr);
+
+    wqe->epoch = this->_epoch.load(std::memory_order_acquire);
+    this->_epoch_nb_live[wqe->epoch & 1].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void POSAPIContextArena::unpin(POSAPIContext_QE* wqe){
+    POS_CHECK_POINTER(wqe);
+    POS_ASSERT(wqe->arena == nullptr && wqe->epoch != 0);
+
+    this->_epoch_nb_live[wqe->epoch & 1].fetch_sub(1, std::memory_order_release);
+    wqe->epoch = 0;
+}
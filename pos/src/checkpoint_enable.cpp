@@ -160,25 +160,37 @@ pos_retval_t POSCheckpointBag::apply_checkpoint_slot(
         deallocate_func = nullptr;  // the slot will use free
     }
 
-    if(likely(cached_map->size() > 0)){
-        // TODO:
-        // here we select the oldest one but for device slot for device state we need to 
-        // implement a memory allocation mechanism to choose the one with closest size
-        // i.e., deal with dynamic_state_size > 0 && force_overwrite == true
-        map_iter = cached_map->begin();
-        POS_CHECK_POINTER(*ptr = map_iter->second);
-        cached_map->erase(map_iter);
-    } else {
-        if(force_overwrite == true && active_map->size() > 0){
-            map_iter = active_map->begin();
+    // pick a cached slot with exactly the requested size; cached slots with other sizes (e.g., left
+    // by a state with dynamic size) are released, so that their memory goes back to the allocator,
+    // which reuses it across handles in a best-fit manner (e.g., the pools of POSHandle_CUDA_Memory)
+    *ptr = nullptr;
+    for(map_iter = cached_map->begin(); map_iter != cached_map->end(); map_iter++){
+        if(map_iter->second->get_state_size() == state_size){
+            POS_CHECK_POINTER(*ptr = map_iter->second);
+            cached_map->erase(map_iter);
+            break;
+        }
+    }
+    if(*ptr == nullptr){
+        for(map_iter = cached_map->begin(); map_iter != cached_map->end(); map_iter++){
+            delete map_iter->second;
+        }
+        cached_map->clear();
+    }
+
+    if(*ptr == nullptr && force_overwrite == true && active_map->size() > 0){
+        map_iter = active_map->begin();
+        if(map_iter->second->get_state_size() == state_size){
             old_version = map_iter->first;
             POS_CHECK_POINTER(*ptr = map_iter->second);
             active_map->erase(map_iter);
             version_set->erase(old_version);
-        } else { 
-            POS_CHECK_POINTER(*ptr = new POSCheckpointSlot(state_size, allocate_func, deallocate_func, ckpt_slot_pos, ckpt_state_type));
         }
     }
+
+    if(*ptr == nullptr){
+        POS_CHECK_POINTER(*ptr = new POSCheckpointSlot(state_size, allocate_func, deallocate_func, ckpt_slot_pos, ckpt_state_type));
+    }
     active_map->insert(std::pair<uint64_t, POSCheckpointSlot*>(version, *ptr));
     version_set->insert(version);
 
@@ -39,10 +39,26 @@ POSClient::POSClient(pos_client_uuid_t id, __pid_t pid, pos_client_cxt_t cxt, PO
         status(kPOS_ClientStatus_CreatePending),
         is_under_sync_call(false),
         offline_counter(0),
+        has_async_error(false),
+        async_error_code(0),
         _api_inst_pc(0), 
         _cxt(cxt),
-        _ws(ws)
-{}
+        _ws(ws),
+        _is_retiring(false),
+        nb_nonactive_handles(0)
+{
+    uint64_t nb_apis;
+
+    POS_CHECK_POINTER(ws);
+    POS_CHECK_POINTER(ws->api_mgnr);
+    this->sync_spin_ticks = ws->tsc_timer.us_to_tick(POS_CLIENT_SYNC_SPIN_INIT_US);
+    this->sync_spin_min_ticks = ws->tsc_timer.us_to_tick(POS_CLIENT_SYNC_SPIN_MIN_US);
+    this->sync_spin_max_ticks = ws->tsc_timer.us_to_tick(POS_CLIENT_SYNC_SPIN_MAX_US);
+
+    nb_apis = ws->api_mgnr->api_metas.empty() ? 0 : ws->api_mgnr->api_metas.rbegin()->first + 1;
+    POS_CHECK_POINTER(this->parser_api_latency = new pos_api_latency_table_t(nb_apis));
+    POS_CHECK_POINTER(this->worker_api_latency = new pos_api_latency_table_t(nb_apis));
+}
 
 
 POSClient::POSClient() 
@@ -51,7 +67,16 @@ POSClient::POSClient()
         status(kPOS_ClientStatus_CreatePending),
         is_under_sync_call(false),
         offline_counter(0),
-        _ws(nullptr)
+        sync_spin_ticks(0),
+        sync_spin_min_ticks(0),
+        sync_spin_max_ticks(0),
+        has_async_error(false),
+        async_error_code(0),
+        parser_api_latency(nullptr),
+        worker_api_latency(nullptr),
+        _ws(nullptr),
+        _is_retiring(false),
+        nb_nonactive_handles(0)
 {
     POS_ERROR_C("shouldn't call, just for passing compilation");
 }
@@ -68,6 +93,14 @@ void POSClient::init(bool is_restoring){
         POS_WARN_C("failed to initialize handle managers");
         goto exit;
     }
+
+    // count non-active handles of all handle managers into the client, and let them learn
+    // when deleted handles are no longer referred by any WQE
+    for(auto& hm_pair : this->handle_managers){
+        POS_CHECK_POINTER(hm_pair.second);
+        hm_pair.second->bind_nonactive_counter(&(this->nb_nonactive_handles));
+        hm_pair.second->bind_apicxt_epoch(this->apicxt_arena.get_epoch_counter());
+    }
     
     if(unlikely(POS_SUCCESS != (
         retval = this->__create_qgroup()
@@ -90,6 +123,8 @@ exit:
             this->status = kPOS_ClientStatus_Hang;
         } else {
             this->status = kPOS_ClientStatus_Active;
+            this->parser_doorbell.ring();
+            this->worker_doorbell.ring();
         }
     }
 }
@@ -109,13 +144,16 @@ void POSClient::deinit(){
     // stop parser and worker to poll
     this->status = kPOS_ClientStatus_Hang;
 
-    // destory queue group
-    this->__destory_qgroup();
-
-    // shutdown parser and worker
+    // shutdown parser and worker, so that no one would consume the queues while destorying them
     if(this->parser != nullptr){ delete this->parser; }
     if(this->worker != nullptr){ delete this->worker; }
 
+    // keep the background reclaimer away from the queues to be destoryed
+    while(this->_is_retiring.exchange(true, std::memory_order_acquire) == true){ pos_cpu_relax(); }
+
+    // destory queue group
+    this->__destory_qgroup();
+
 exit:
     ;
 }
@@ -413,9 +451,11 @@ pos_retval_t POSClient::push_q(void *qe){
         );
 
         if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
-            this->_apicxt_rpc2parser_wq->push(apictx_qe);
+            retval = this->_apicxt_rpc2parser_wq->push(apictx_qe);
+            if(likely(retval == POS_SUCCESS)){ this->parser_doorbell.ring(); }
         } else { // qdir == kPOS_QueueDirection_Parser2Worker
-            this->_apicxt_parser2worker_wq->push(apictx_qe);
+            retval = this->_apicxt_parser2worker_wq->push(apictx_qe);
+            if(likely(retval == POS_SUCCESS)){ this->worker_doorbell.ring(); }
         }
     }
 
@@ -429,9 +469,9 @@ pos_retval_t POSClient::push_q(void *qe){
         );
 
         if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
-            this->_apicxt_rpc2parser_cq->push(apictx_qe);
+            retval = this->_apicxt_rpc2parser_cq->push(apictx_qe);
         } else { // qdir == kPOS_QueueDirection_Rpc2Worker
-            this->_apicxt_rpc2worker_cq->push(apictx_qe);
+            retval = this->_apicxt_rpc2worker_cq->push(apictx_qe);
         }
     }
 
@@ -444,7 +484,7 @@ pos_retval_t POSClient::push_q(void *qe){
             "ApiCxt_CkptDag_WQE can only be pushed to worker local queue"
         );
 
-        this->_apicxt_workerlocal_ckptdag_wq->push(apictx_qe);
+        retval = this->_apicxt_workerlocal_ckptdag_wq->push(apictx_qe);
     }
 
     // api context trace queue 
@@ -456,7 +496,7 @@ pos_retval_t POSClient::push_q(void *qe){
             "ApiCxt_Trace_WQE can only be pushed to parser local queue"
         );
 
-        this->_apicxt_parserlocal_trace_wq->push(apictx_qe);
+        retval = this->_apicxt_parserlocal_trace_wq->push(apictx_qe);
     }
 
     // command work queue
@@ -469,9 +509,11 @@ pos_retval_t POSClient::push_q(void *qe){
         );
 
         if constexpr (qdir == kPOS_QueueDirection_Parser2Worker){
-            this->_cmd_parser2worker_wq->push(cmd_qe);
+            retval = this->_cmd_parser2worker_wq->push(cmd_qe);
+            if(likely(retval == POS_SUCCESS)){ this->worker_doorbell.ring(); }
         } else { // qdir == kPOS_QueueDirection_Oob2Parser
-            this->_cmd_oob2parser_wq->push(cmd_qe);
+            retval = this->_cmd_oob2parser_wq->push(cmd_qe);
+            if(likely(retval == POS_SUCCESS)){ this->parser_doorbell.ring(); }
         }
     }
 
@@ -485,9 +527,10 @@ pos_retval_t POSClient::push_q(void *qe){
         );
 
         if constexpr (qdir == kPOS_QueueDirection_Parser2Worker){
-            this->_cmd_parser2worker_cq->push(cmd_qe);
+            retval = this->_cmd_parser2worker_cq->push(cmd_qe);
+            if(likely(retval == POS_SUCCESS)){ this->parser_doorbell.ring(); }
         } else { // qdir == kPOS_QueueDirection_Oob2Parser
-            this->_cmd_oob2parser_cq->push(cmd_qe);
+            retval = this->_cmd_oob2parser_cq->push(cmd_qe);
         }
     }
 
@@ -509,88 +552,33 @@ template pos_retval_t POSClient::push_q<kPOS_QueueDirection_Oob2Parser, kPOS_Que
 template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
 pos_retval_t POSClient::clear_q(){
     pos_retval_t retval = POS_SUCCESS;
-
-    static_assert(
-            qtype == kPOS_QueueType_ApiCxt_WQ || qtype == kPOS_QueueType_ApiCxt_CQ
-        ||  qtype == kPOS_QueueType_ApiCxt_CkptDag_WQ
-        ||  qtype == kPOS_QueueType_ApiCxt_Trace_WQ
-        ||  qtype == kPOS_QueueType_Cmd_WQ || qtype == kPOS_QueueType_Cmd_CQ,
-        "unknown queue type obtained"
-    );
-
-    // api context worker queue 
-    if constexpr (qtype == kPOS_QueueType_ApiCxt_WQ){
-        static_assert(
-            qdir == kPOS_QueueDirection_Rpc2Parser || qdir == kPOS_QueueDirection_Parser2Worker,
-            "ApiCxt_WQE can only be located within rpc2parser or parser2worker queue"
-        );
-        if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
-            this->_apicxt_rpc2parser_wq->drain();
-        } else { // qdir == kPOS_QueueDirection_Parser2Worker
-            this->_apicxt_parser2worker_wq->drain();
-        }
-    }
-
-    // api context completion queue 
-    if constexpr (qtype == kPOS_QueueType_ApiCxt_CQ){
-        static_assert(
-            qdir == kPOS_QueueDirection_Rpc2Parser || qdir == kPOS_QueueDirection_Rpc2Worker,
-            "ApiCxt_CQE can only be located within rpc2parser or rpc2worker queue"
-        );
-        if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
-            this->_apicxt_rpc2parser_cq->drain();
-        } else { // qdir == kPOS_QueueDirection_Rpc2Worker
-            this->_apicxt_rpc2worker_cq->drain();
-        }
-    }
-
-    // api context ckptdag queue 
-    if constexpr (qtype == kPOS_QueueType_ApiCxt_CkptDag_WQ) {
-        static_assert(
-            qdir == kPOS_QueueDirection_WorkerLocal,
-            "ApiCxt_CkptDag_WQE can only be located within worker local queue"
-        );
-        this->_apicxt_workerlocal_ckptdag_wq->drain();
-    }
-
-    // api context trace queue 
-    if constexpr (qtype == kPOS_QueueType_ApiCxt_Trace_WQ) {
-        static_assert(
-            qdir == kPOS_QueueDirection_ParserLocal,
-            "ApiCxt_CkptDag_WQE can only be located within parser local queue"
-        );
-        this->_apicxt_parserlocal_trace_wq->drain();
-    }
-
-    // command work queue
-    if constexpr (qtype == kPOS_QueueType_Cmd_WQ){
-        static_assert(
-            qdir == kPOS_QueueDirection_Parser2Worker || qdir == kPOS_QueueDirection_Oob2Parser,
-            "Cmd_WQE can only be located within parser2worker or oob2parser queue"
-        );
-
-        if constexpr (qdir == kPOS_QueueDirection_Parser2Worker){
-            this->_cmd_parser2worker_wq->drain();
-        } else { // qdir == kPOS_QueueDirection_Oob2Parser
-            this->_cmd_oob2parser_wq->drain();
-        }
+    POSLockFreeQueue<POSAPIContext_QE_t*> *apicxt_q;
+    POSLockFreeQueue<POSCommand_QE_t*> *cmd_q;
+    uint64_t nb_drained;
+
+    if constexpr (qtype == kPOS_QueueType_Cmd_WQ || qtype == kPOS_QueueType_Cmd_CQ){
+        POS_CHECK_POINTER(cmd_q = (this->template __get_cmd_q<qdir, qtype>()));
+        nb_drained = cmd_q->drain([](POSCommand_QE_t* cmd){
+            // the command is owned by its issuer, just mark it as failed
+            cmd->retval = POS_FAILED_DRAIN;
+        });
+    } else if constexpr (qtype == kPOS_QueueType_ApiCxt_WQ){
+        POS_CHECK_POINTER(apicxt_q = (this->template __get_apicxt_q<qdir, qtype>()));
+        nb_drained = apicxt_q->drain([this](POSAPIContext_QE_t* wqe){
+            this->__reclaim_apicxt(wqe);
+        });
+    } else {
+        // completion / ckptdag / trace queues own a reference of each apicxt
+        POS_CHECK_POINTER(apicxt_q = (this->template __get_apicxt_q<qdir, qtype>()));
+        nb_drained = apicxt_q->drain([](POSAPIContext_QE_t* qe){
+            qe->put_ref();
+        });
     }
 
-    // command completion queue
-    if constexpr (qtype == kPOS_QueueType_Cmd_CQ){
-        static_assert(
-            qdir == kPOS_QueueDirection_Parser2Worker || qdir == kPOS_QueueDirection_Oob2Parser,
-            "Cmd_CQE can only be located within parser2worker or oob2parser queue"
-        );
-
-        if constexpr (qdir == kPOS_QueueDirection_Parser2Worker){
-            this->_cmd_parser2worker_cq->drain();
-        } else { // qdir == kPOS_QueueDirection_Oob2Parser
-            this->_cmd_oob2parser_cq->drain();
-        }
+    if(nb_drained > 0){
+        POS_DEBUG_C("drained queue: qdir(%u), qtype(%u), nb_drained(%lu)", qdir, qtype, nb_drained);
     }
 
-exit:
     return retval;
 }
 template pos_retval_t POSClient::clear_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>();
@@ -606,11 +594,7 @@ template pos_retval_t POSClient::clear_q<kPOS_QueueDirection_Oob2Parser, kPOS_Qu
 
 
 template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
-pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
-    pos_retval_t retval = POS_SUCCESS;
-    POSAPIContext_QE *apicxt_qe;
-    POSLockFreeQueue<POSAPIContext_QE_t*> *apicxt_q;
-
+POSLockFreeQueue<POSAPIContext_QE_t*>* POSClient::__get_apicxt_q(){
     static_assert(
             qtype == kPOS_QueueType_ApiCxt_WQ 
         ||  qtype == kPOS_QueueType_ApiCxt_CQ 
@@ -619,8 +603,6 @@ pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
         "invalid queue type obtained"
     );
 
-    POS_CHECK_POINTER(qes);
-
     // api context work queue
     if constexpr (qtype == kPOS_QueueType_ApiCxt_WQ){
         static_assert(
@@ -628,9 +610,9 @@ pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
             "POSAPIContext_WQE can only be poll from rpc2parser or parser2worker queue"
         );
         if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
-            apicxt_q = this->_apicxt_rpc2parser_wq;
+            return this->_apicxt_rpc2parser_wq;
         } else { // kPOS_QueueDirection_Parser2Worker
-            apicxt_q = this->_apicxt_parser2worker_wq;
+            return this->_apicxt_parser2worker_wq;
         }
     }
 
@@ -641,9 +623,9 @@ pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
             "POSAPIContext_CQE can only be poll from rpc2parser or parser2worker queue"
         );
         if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
-            apicxt_q = this->_apicxt_rpc2parser_cq;
+            return this->_apicxt_rpc2parser_cq;
         } else { // kPOS_QueueDirection_Rpc2Worker
-            apicxt_q = this->_apicxt_rpc2worker_cq;
+            return this->_apicxt_rpc2worker_cq;
         }
     }
 
@@ -653,7 +635,7 @@ pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
             qdir == kPOS_QueueDirection_WorkerLocal,
             "ApiCxt_CkptDag_WQE can only be passed within worker local queue"
         );
-        apicxt_q = this->_apicxt_workerlocal_ckptdag_wq;
+        return this->_apicxt_workerlocal_ckptdag_wq;
     }
 
     // api context trace work queue
@@ -662,15 +644,28 @@ pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
             qdir == kPOS_QueueDirection_ParserLocal,
             "ApiCxt_CkptDag_WQE can only be passed within parser local queue"
         );
-        apicxt_q = this->_apicxt_parserlocal_trace_wq;
+        return this->_apicxt_parserlocal_trace_wq;
     }
+}
 
-    POS_CHECK_POINTER(apicxt_q);
-    while(POS_SUCCESS == apicxt_q->dequeue(apicxt_qe)){
-        qes->push_back(apicxt_qe);
-    }
 
-exit:
+template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+pos_retval_t POSClient::poll_q(std::vector<POSAPIContext_QE*>* qes){
+    pos_retval_t retval = POS_SUCCESS;
+    POSLockFreeQueue<POSAPIContext_QE_t*> *apicxt_q;
+    uint64_t len, nb_polled;
+
+    POS_CHECK_POINTER(qes);
+    POS_CHECK_POINTER(apicxt_q = (this->template __get_apicxt_q<qdir, qtype>()));
+
+    // dequeue batch-by-batch directly into the tail of the vector
+    do {
+        len = qes->size();
+        qes->resize(len + POS_LOCKLESS_QUEUE_POLL_BATCH);
+        nb_polled = apicxt_q->dequeue_bulk(qes->data() + len, POS_LOCKLESS_QUEUE_POLL_BATCH);
+        qes->resize(len + nb_polled);
+    } while(nb_polled == POS_LOCKLESS_QUEUE_POLL_BATCH);
+
     return retval;
 }
 template pos_retval_t POSClient::poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>(std::vector<POSAPIContext_QE*>* qes);
@@ -681,19 +676,77 @@ template pos_retval_t POSClient::poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_Que
 template pos_retval_t POSClient::poll_q<kPOS_QueueDirection_Rpc2Worker, kPOS_QueueType_ApiCxt_CQ>(std::vector<POSAPIContext_QE*>* qes);
 
 
-template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
-pos_retval_t POSClient::poll_q(std::vector<POSCommand_QE_t*>* qes){
+template<pos_queue_direction_t qdir>
+pos_retval_t POSClient::complete_apicxt(POSAPIContext_QE* wqe){
     pos_retval_t retval = POS_SUCCESS;
-    POSCommand_QE_t *cmd_qe;
-    POSLockFreeQueue<POSCommand_QE_t*> *cmd_q;
-    
+
+    static_assert(
+        qdir == kPOS_QueueDirection_Rpc2Parser || qdir == kPOS_QueueDirection_Rpc2Worker,
+        "POSAPIContext can only be completed to rpc2parser or rpc2worker queue"
+    );
+
+    POS_CHECK_POINTER(wqe);
+
+    // record end-to-end latency, restored apicxts carry ticks of the previous process
+    if(likely(wqe->return_tick >= wqe->create_tick)){
+        if constexpr (qdir == kPOS_QueueDirection_Rpc2Parser){
+            this->parser_api_latency->record(
+                wqe->api_cxt->api_id, kPOS_APILatencyStage_EndToEnd, wqe->return_tick - wqe->create_tick
+            );
+        } else { // kPOS_QueueDirection_Rpc2Worker
+            this->worker_api_latency->record(
+                wqe->api_cxt->api_id, kPOS_APILatencyStage_EndToEnd, wqe->return_tick - wqe->create_tick
+            );
+        }
+    }
+
+    if(wqe->is_sync == true){
+        // the RPC thread is waiting on this wqe, wake it up without going through the CQ
+        wqe->completion.complete();
+    } else {
+        // record the error of async call, which would be reported by the next sync call
+        if(unlikely(
+            wqe->status == kPOS_API_Execute_Status_Parser_Failed
+            || wqe->status == kPOS_API_Execute_Status_Worker_Failed
+        )){
+            this->async_error_code.store(wqe->api_cxt->return_code, std::memory_order_relaxed);
+            this->has_async_error.store(true, std::memory_order_release);
+        }
+        retval = this->template push_q<qdir, kPOS_QueueType_ApiCxt_CQ>(wqe);
+    }
+
+    return retval;
+}
+template pos_retval_t POSClient::complete_apicxt<kPOS_QueueDirection_Rpc2Parser>(POSAPIContext_QE* wqe);
+template pos_retval_t POSClient::complete_apicxt<kPOS_QueueDirection_Rpc2Worker>(POSAPIContext_QE* wqe);
+
+
+void POSClient::retire_apicxts(){
+    uint64_t i;
+
+    if(this->_is_retiring.exchange(true, std::memory_order_acquire) == true){ return; }
+
+    this->template poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_CQ>(&this->_retired_apicxts);
+    this->template poll_q<kPOS_QueueDirection_Rpc2Worker, kPOS_QueueType_ApiCxt_CQ>(&this->_retired_apicxts);
+
+    for(i=0; i<this->_retired_apicxts.size(); i++){
+        POS_CHECK_POINTER(this->_retired_apicxts[i]);
+        // the cqe is digested, drop the reference owned by the rpc frontend
+        this->_retired_apicxts[i]->put_ref();
+    }
+    this->_retired_apicxts.clear();
+
+    this->_is_retiring.store(false, std::memory_order_release);
+}
+
+
+template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+POSLockFreeQueue<POSCommand_QE_t*>* POSClient::__get_cmd_q(){
     static_assert(
         qtype == kPOS_QueueType_Cmd_WQ || qtype == kPOS_QueueType_Cmd_CQ,
         "invalid queue type obtained"
     );
 
-    POS_CHECK_POINTER(qes);
-
     // command work queue
     if constexpr (qtype == kPOS_QueueType_Cmd_WQ){
         static_assert(
@@ -701,9 +754,9 @@ pos_retval_t POSClient::poll_q(std::vector<POSCommand_QE_t*>* qes){
             "POSCommand_WQE can only be polled from parser2worker or oob2parser queue"
         );
         if constexpr (qdir == kPOS_QueueDirection_Parser2Worker){
-            cmd_q = this->_cmd_parser2worker_wq;
+            return this->_cmd_parser2worker_wq;
         } else { // kPOS_QueueDirection_Oob2Parser
-            cmd_q = this->_cmd_oob2parser_wq;
+            return this->_cmd_oob2parser_wq;
         }
     }
 
@@ -714,18 +767,31 @@ pos_retval_t POSClient::poll_q(std::vector<POSCommand_QE_t*>* qes){
             "POSCommand_CQE can only be polled from parser2worker or oob2parser queue"
         );
         if constexpr (qdir == kPOS_QueueDirection_Parser2Worker){
-            cmd_q = this->_cmd_parser2worker_cq;
+            return this->_cmd_parser2worker_cq;
         } else { // kPOS_QueueDirection_Oob2Parser
-            cmd_q = this->_cmd_oob2parser_cq;
+            return this->_cmd_oob2parser_cq;
         }
     }
+}
 
-    POS_CHECK_POINTER(cmd_q);
-    while(POS_SUCCESS == cmd_q->dequeue(cmd_qe)){
-        qes->push_back(cmd_qe);
-    }
 
-exit:
+template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+pos_retval_t POSClient::poll_q(std::vector<POSCommand_QE_t*>* qes){
+    pos_retval_t retval = POS_SUCCESS;
+    POSLockFreeQueue<POSCommand_QE_t*> *cmd_q;
+    uint64_t len, nb_polled;
+
+    POS_CHECK_POINTER(qes);
+    POS_CHECK_POINTER(cmd_q = (this->template __get_cmd_q<qdir, qtype>()));
+
+    // dequeue batch-by-batch directly into the tail of the vector
+    do {
+        len = qes->size();
+        qes->resize(len + POS_LOCKLESS_QUEUE_POLL_BATCH);
+        nb_polled = cmd_q->dequeue_bulk(qes->data() + len, POS_LOCKLESS_QUEUE_POLL_BATCH);
+        qes->resize(len + nb_polled);
+    } while(nb_polled == POS_LOCKLESS_QUEUE_POLL_BATCH);
+
     return retval;
 }
 template pos_retval_t POSClient::poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>(std::vector<POSCommand_QE_t*>* qes);
@@ -734,11 +800,72 @@ template pos_retval_t POSClient::poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_
 template pos_retval_t POSClient::poll_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_CQ>(std::vector<POSCommand_QE_t*>* qes);
 
 
+template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+uint64_t POSClient::poll_q(POSAPIContext_QE** qes, uint64_t max_nb){
+    POSLockFreeQueue<POSAPIContext_QE_t*> *apicxt_q;
+
+    POS_CHECK_POINTER(qes);
+    POS_CHECK_POINTER(apicxt_q = (this->template __get_apicxt_q<qdir, qtype>()));
+    return apicxt_q->dequeue_bulk(qes, max_nb);
+}
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>(POSAPIContext_QE** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(POSAPIContext_QE** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>(POSAPIContext_QE** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_ParserLocal, kPOS_QueueType_ApiCxt_Trace_WQ>(POSAPIContext_QE** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_CQ>(POSAPIContext_QE** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Rpc2Worker, kPOS_QueueType_ApiCxt_CQ>(POSAPIContext_QE** qes, uint64_t max_nb);
+
+
+template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+uint64_t POSClient::poll_q(POSCommand_QE_t** qes, uint64_t max_nb){
+    POSLockFreeQueue<POSCommand_QE_t*> *cmd_q;
+
+    POS_CHECK_POINTER(qes);
+    POS_CHECK_POINTER(cmd_q = (this->template __get_cmd_q<qdir, qtype>()));
+    return cmd_q->dequeue_bulk(qes, max_nb);
+}
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>(POSCommand_QE_t** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_WQ>(POSCommand_QE_t** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_CQ>(POSCommand_QE_t** qes, uint64_t max_nb);
+template uint64_t POSClient::poll_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_CQ>(POSCommand_QE_t** qes, uint64_t max_nb);
+
+
+template<pos_queue_direction_t qdir, pos_queue_type_t qtype>
+uint64_t POSClient::get_q_len(){
+    if constexpr (qtype == kPOS_QueueType_Cmd_WQ || qtype == kPOS_QueueType_Cmd_CQ){
+        return this->template __get_cmd_q<qdir, qtype>()->len();
+    } else {
+        return this->template __get_apicxt_q<qdir, qtype>()->len();
+    }
+}
+template uint64_t POSClient::get_q_len<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>();
+template uint64_t POSClient::get_q_len<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>();
+
+
+void POSClient::__reclaim_apicxt(POSAPIContext_QE* wqe){
+    const POSAPIMeta_t *api_meta;
+
+    POS_CHECK_POINTER(wqe);
+
+    if(wqe->is_sync == true && wqe->has_return == false){
+        // the RPC thread is still waiting on this wqe, and it would drop its own reference
+        POS_CHECK_POINTER(wqe->api_cxt);
+        POS_CHECK_POINTER(api_meta = this->_ws->api_mgnr->get_api_meta(wqe->api_cxt->api_id));
+        wqe->status = kPOS_API_Execute_Status_Parser_Failed;
+        wqe->api_cxt->return_code = this->_ws->api_mgnr->cast_pos_retval(POS_FAILED_DRAIN, api_meta->library_id);
+        wqe->has_return = true;
+        wqe->completion.complete();
+    } else {
+        wqe->put_ref();
+    }
+}
+
+
 pos_retval_t POSClient::__create_qgroup(){
     pos_retval_t retval = POS_SUCCESS;
 
     // rpc2parser apicxt work queue
-    this->_apicxt_rpc2parser_wq = new POSLockFreeQueue<POSAPIContext_QE_t*>();
+    this->_apicxt_rpc2parser_wq = new POSLockFreeQueue<POSAPIContext_QE_t*>(POS_CLIENT_RPC2PARSER_WQ_LEN);
     POS_CHECK_POINTER(this->_apicxt_rpc2parser_wq);
     POS_DEBUG_C("created rpc2parser apicxt WQ: uuid(%lu)", this->id);
 
@@ -797,60 +924,70 @@ pos_retval_t POSClient::__destory_qgroup(){
     // rpc2parser apicxt work queue
     POS_CHECK_POINTER(this->_apicxt_rpc2parser_wq);
     this->_apicxt_rpc2parser_wq->lock();
+    this->template clear_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>();
     delete this->_apicxt_rpc2parser_wq;
     POS_DEBUG_C("destoryed rpc2parser apicxt WQ: uuid(%lu)", this->id);
 
     // rpc2parser apicxt completion queue
     POS_CHECK_POINTER(this->_apicxt_rpc2parser_cq);
     this->_apicxt_rpc2parser_cq->lock();
+    this->template clear_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_CQ>();
     delete this->_apicxt_rpc2parser_cq;
     POS_DEBUG_C("destoryed rpc2parser apicxt CQ: uuid(%lu)", this->id);
 
     // parser2worker apicxt work queue
     POS_CHECK_POINTER(this->_apicxt_parser2worker_wq);
     this->_apicxt_parser2worker_wq->lock();
+    this->template clear_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>();
     delete this->_apicxt_parser2worker_wq;
     POS_DEBUG_C("destoryed parser2worker apicxt WQ: uuid(%lu)", this->id);
 
     // rpc2worker apicxt completion queue
     POS_CHECK_POINTER(this->_apicxt_rpc2worker_cq);
     this->_apicxt_rpc2worker_cq->lock();
+    this->template clear_q<kPOS_QueueDirection_Rpc2Worker, kPOS_QueueType_ApiCxt_CQ>();
     delete this->_apicxt_rpc2worker_cq;
     POS_DEBUG_C("destoryed rpc2worker apicxt CQ: uuid(%lu)", this->id);
 
     // workerlocal ckptdag apicxt work queue
     POS_CHECK_POINTER(this->_apicxt_workerlocal_ckptdag_wq);
     this->_apicxt_workerlocal_ckptdag_wq->lock();
+    this->template clear_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>();
     delete this->_apicxt_workerlocal_ckptdag_wq;
     POS_DEBUG_C("destoryed workerlocal_ckptdag apicxt WQ: uuid(%lu)", this->id);
 
     // parserlocal trace apicxt work queue
     POS_CHECK_POINTER(this->_apicxt_parserlocal_trace_wq);
     this->_apicxt_parserlocal_trace_wq->lock();
+    this->template clear_q<kPOS_QueueDirection_ParserLocal, kPOS_QueueType_ApiCxt_Trace_WQ>();
     delete this->_apicxt_parserlocal_trace_wq;
     POS_DEBUG_C("destoryed parserlocal trace apicxt WQ: uuid(%lu)", this->id);
 
     // parser2worker cmd work queue
     POS_CHECK_POINTER(this->_cmd_parser2worker_wq);
     this->_cmd_parser2worker_wq->lock();
+    this->template clear_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>();
     delete this->_cmd_parser2worker_wq;
     POS_DEBUG_C("destoryed parser2worker apicxt WQ: uuid(%lu)", this->id);
 
     // parser2worker cmd completion queue
     POS_CHECK_POINTER(this->_cmd_parser2worker_cq);
     this->_cmd_parser2worker_cq->lock();
+    this->template clear_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_CQ>();
     delete this->_cmd_parser2worker_cq;
     POS_DEBUG_C("destoryed parser2worker cmd CQ: uuid(%lu)", this->id);
 
     // oob2parser cmd work queue
     POS_CHECK_POINTER(this->_cmd_oob2parser_wq);
     this->_cmd_oob2parser_wq->lock();
+    this->template clear_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_WQ>();
     delete this->_cmd_oob2parser_wq;
     POS_DEBUG_C("destoryed oob2parser cmd WQ: uuid(%lu)", this->id);
 
     // oob2parser cmd completion queue
     POS_CHECK_POINTER(this->_cmd_oob2parser_cq);
     this->_cmd_oob2parser_cq->lock();
+    this->template clear_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_CQ>();
     delete this->_cmd_oob2parser_cq;
     POS_DEBUG_C("destoryed oob2parser cmd CQ: uuid(%lu)", this->id);
 
@@ -916,6 +1053,9 @@ pos_retval_t POSClient::__reload_apicxt(const std::string& ckpt_file, pos_apicxt
         apicxt->delete_handle_views[i].handle = handle;
     }
 
+    // keep handles referred by this wqe from being recycled until it's released
+    this->apicxt_arena.pin(apicxt);
+
     // push this wqe to worker
     this->template push_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(apicxt);
 
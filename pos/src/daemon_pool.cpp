@@ -0,0 +1,359 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <unistd.h>
+
+#include "pos/include/common.h"
+#include "pos/include/log.h"
+#include "pos/include/daemon_pool.h"
+#include "pos/include/utils/daemon_poller.h"
+#include "pos/include/utils/system.h"
+
+
+POSDaemonTask::POSDaemonTask(POSDoorbell* doorbell)
+    :   daemon_busy_ticks(0),
+        daemon_idle_ticks(0),
+        daemon_nb_parks(0),
+        _doorbell(doorbell),
+        _daemon_pool(nullptr),
+        _pool_state(kPool_Detached),
+        _pool_weight(POS_DAEMON_POOL_DEFAULT_WEIGHT),
+        _pool_vruntime(0),
+        _pool_thread_id(-1),
+        _pool_is_inited(false),
+        _pool_is_removing(false)
+{
+    POS_CHECK_POINTER(doorbell);
+}
+
+
+void POSDaemonTask::on_ring(){
+    POSDaemonPool *pool = this->_daemon_pool;
+    if(likely(pool != nullptr)){ pool->notify(this); }
+}
+
+
+POSDaemonPool::POSDaemonPool(POSUtilTscTimer* tsc_timer, uint32_t nb_threads, const std::vector<uint32_t>& cpus)
+    :   _tsc_timer(tsc_timer), _cpus(cpus), _min_vruntime(0), _last_sweep_tick(0), _stop_flag(false)
+{
+    uint64_t i;
+    pool_thread_cxt_t *cxt;
+
+    POS_CHECK_POINTER(tsc_timer);
+    POS_ASSERT(nb_threads > 0);
+
+    this->_slice_ticks = tsc_timer->us_to_tick(POS_DAEMON_POOL_SLICE_US);
+    this->_sweep_ticks = tsc_timer->us_to_tick(POS_DAEMON_POLL_PARK_TIMEOUT_US);
+
+    for(i=0; i<nb_threads; i++){
+        POS_CHECK_POINTER(cxt = new pool_thread_cxt_t());
+        this->_threads.push_back(cxt);
+    }
+
+    // raise pool threads after all contexts are ready, as threads steal from each other
+    for(i=0; i<nb_threads; i++){
+        this->_threads[i]->thread = new std::thread(&POSDaemonPool::__daemon, this, i);
+        POS_CHECK_POINTER(this->_threads[i]->thread);
+    }
+
+    POS_LOG_C("daemon pool started: #threads(%u)", nb_threads);
+}
+
+
+POSDaemonPool::~POSDaemonPool(){
+    this->_stop_flag = true;
+    for(auto cxt : this->_threads){ cxt->doorbell.ring(); }
+    for(auto cxt : this->_threads){
+        if(cxt->thread != nullptr){
+            if(cxt->thread->joinable()){ cxt->thread->join(); }
+            delete cxt->thread;
+        }
+        delete cxt;
+    }
+    this->_threads.clear();
+    POS_LOG_C("daemon pool shutdown");
+}
+
+
+void POSDaemonPool::add(POSDaemonTask* task, uint32_t weight){
+    POS_CHECK_POINTER(task);
+
+    task->_pool_weight = std::clamp<uint32_t>(weight, 1, POS_DAEMON_POOL_MAX_WEIGHT);
+    task->_pool_vruntime = this->_min_vruntime.load(std::memory_order_relaxed);
+    task->_pool_is_removing.store(false, std::memory_order_relaxed);
+    task->_daemon_pool = this;
+    task->_pool_state.store(POSDaemonTask::kPool_Sleeping, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+    this->_tasks.insert(task);
+    task->_doorbell->set_listener(task);
+}
+
+
+void POSDaemonPool::remove(POSDaemonTask* task){
+    POS_CHECK_POINTER(task);
+
+    {
+        std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+        if(unlikely(this->_tasks.erase(task) == 0)){ return; }
+    }
+
+    // let a pool thread observe the removing flag, after it finishes the current slice (if any)
+    task->_pool_is_removing.store(true, std::memory_order_seq_cst);
+    this->notify(task);
+    while(task->_pool_state.load(std::memory_order_acquire) != POSDaemonTask::kPool_Detached){
+        usleep(100);
+    }
+
+    task->_doorbell->set_listener(nullptr);
+    task->_daemon_pool = nullptr;
+}
+
+
+void POSDaemonPool::notify(POSDaemonTask* task){
+    uint8_t state;
+    uint64_t min_vruntime;
+
+    state = task->_pool_state.load(std::memory_order_acquire);
+    while(true){
+        switch(state){
+        case POSDaemonTask::kPool_Sleeping:
+            if(task->_pool_state.compare_exchange_weak(state, POSDaemonTask::kPool_Queued, std::memory_order_acq_rel)){
+                // a task waking up from sleep can't claim more than one slice of credit
+                min_vruntime = this->_min_vruntime.load(std::memory_order_relaxed);
+                if(min_vruntime > this->_slice_ticks){ min_vruntime -= this->_slice_ticks; }
+                task->_pool_vruntime = std::max(task->_pool_vruntime, min_vruntime);
+                this->__enqueue(task);
+                return;
+            }
+            break;
+
+        case POSDaemonTask::kPool_Running:
+            if(task->_pool_state.compare_exchange_weak(state, POSDaemonTask::kPool_RunningNotified, std::memory_order_acq_rel)){
+                return;
+            }
+            break;
+
+        default:
+            // already queued / notified / detached
+            return;
+        }
+    }
+}
+
+
+void POSDaemonPool::__daemon(uint64_t thread_id){
+    POSDaemonTask *task;
+    pool_thread_cxt_t *cxt;
+    uint64_t now_tick;
+    POSDaemonPoller poller(
+        /* doorbell */ &this->_threads[thread_id]->doorbell,
+        /* policy */ static_cast<pos_daemon_poll_policy_t>(POS_CONF_RUNTIME_DaemonPollPolicy),
+        /* spin_ticks */ this->_tsc_timer->us_to_tick(POS_CONF_RUNTIME_DaemonPollSpinUs)
+    );
+
+    POS_CHECK_POINTER(cxt = this->_threads[thread_id]);
+
+    if(unlikely(POS_SUCCESS != POSUtilSystem::bind_current_thread_to_cpus(this->_cpus))){
+        POS_WARN_C("failed to pin daemon pool thread to CPUs, run without pinning: thread_id(%lu)", thread_id);
+    }
+
+    while(!this->_stop_flag){
+        now_tick = POSUtilTscTimer::get_tsc();
+        if(unlikely(now_tick - this->_last_sweep_tick.load(std::memory_order_relaxed) >= this->_sweep_ticks)){
+            this->__sweep(now_tick);
+        }
+
+        if((task = this->__pick(thread_id)) == nullptr){
+            cxt->is_idle.store(true, std::memory_order_relaxed);
+            poller.on_idle();
+            continue;
+        }
+
+        cxt->is_idle.store(false, std::memory_order_relaxed);
+        this->__run(task, thread_id);
+        poller.on_busy();
+    }
+}
+
+
+void POSDaemonPool::__run(POSDaemonTask* task, uint64_t thread_id){
+    uint64_t s_tick, e_tick, nb_polled;
+    uint8_t expected;
+
+    task->_pool_state.store(POSDaemonTask::kPool_Running, std::memory_order_release);
+    task->_doorbell->cancel_park();
+
+    if(unlikely(task->_pool_is_removing.load(std::memory_order_seq_cst))){
+        goto detach;
+    }
+
+    // (re)bind the pool thread to the context of the task
+    if(task->_pool_thread_id != static_cast<int64_t>(thread_id)){
+        if(unlikely(POS_SUCCESS != task->daemon_attach())){
+            POS_WARN_C("failed to attach daemon task to pool thread, task detached: thread_id(%lu)", thread_id);
+            goto detach;
+        }
+        task->_pool_thread_id = thread_id;
+    }
+    if(unlikely(task->_pool_is_inited == false)){
+        if(unlikely(POS_SUCCESS != task->daemon_init())){
+            POS_WARN_C("failed to init daemon task, task detached");
+            goto detach;
+        }
+        task->_pool_is_inited = true;
+    }
+
+    // run the task until its queues are empty, or the time slice is exhausted
+    s_tick = POSUtilTscTimer::get_tsc();
+    do {
+        nb_polled = task->daemon_poll();
+        e_tick = POSUtilTscTimer::get_tsc();
+    } while(nb_polled > 0 && e_tick - s_tick < this->_slice_ticks);
+
+    // announce the sleep, then re-poll to catch elements pushed before the announcement
+    if(nb_polled == 0){
+        task->_doorbell->prepare_park();
+        nb_polled = task->daemon_poll();
+        e_tick = POSUtilTscTimer::get_tsc();
+    }
+
+    task->daemon_busy_ticks += e_tick - s_tick;
+    task->_pool_vruntime += (e_tick - s_tick) / task->_pool_weight;
+
+    if(nb_polled == 0){
+        // note: the task might be picked by another pool thread right after it's sleeping
+        task->daemon_nb_parks += 1;
+        expected = POSDaemonTask::kPool_Running;
+        if(task->_pool_state.compare_exchange_strong(expected, POSDaemonTask::kPool_Sleeping, std::memory_order_acq_rel)){
+            return;
+        }
+        // rung while running, fall through to requeue
+        task->daemon_nb_parks -= 1;
+    }
+
+    task->_doorbell->cancel_park();
+    task->_pool_state.store(POSDaemonTask::kPool_Queued, std::memory_order_release);
+    this->__enqueue(task);
+    return;
+
+detach:
+    task->_pool_state.store(POSDaemonTask::kPool_Detached, std::memory_order_release);
+}
+
+
+POSDaemonTask* POSDaemonPool::__pick(uint64_t thread_id){
+    POSDaemonTask *task = nullptr;
+    pool_thread_cxt_t *cxt;
+    uint64_t i, victim_id, vruntime, min_vruntime;
+    int64_t index;
+
+    // find the run queue that holds the task with minimum virtual runtime, so that tasks are
+    // fairly scheduled across pool threads; the local run queue wins the tie, and those
+    // contended run queues are skipped
+    victim_id = thread_id;
+    min_vruntime = UINT64_MAX;
+    for(i=0; i<this->_threads.size(); i++){
+        cxt = this->_threads[(thread_id + i) % this->_threads.size()];
+        std::unique_lock<std::mutex> lock(cxt->mutex, std::defer_lock);
+        if(i == 0){
+            lock.lock();
+        } else if(!lock.try_lock()){
+            continue;
+        }
+        if((index = this->__find_min_vruntime(cxt)) >= 0 && cxt->runq[index]->_pool_vruntime < min_vruntime){
+            min_vruntime = cxt->runq[index]->_pool_vruntime;
+            victim_id = (thread_id + i) % this->_threads.size();
+        }
+    }
+    if(min_vruntime == UINT64_MAX){ return nullptr; }
+
+    // pop from the selected run queue, note that it might be drained by others in the meantime
+    cxt = this->_threads[victim_id];
+    {
+        std::lock_guard<std::mutex> lock(cxt->mutex);
+        if((index = this->__find_min_vruntime(cxt)) >= 0){
+            task = cxt->runq[index];
+            cxt->runq[index] = cxt->runq.back();
+            cxt->runq.pop_back();
+        }
+    }
+
+    // advance the virtual clock of the pool
+    if(task != nullptr){
+        vruntime = task->_pool_vruntime;
+        min_vruntime = this->_min_vruntime.load(std::memory_order_relaxed);
+        while(vruntime > min_vruntime){
+            if(this->_min_vruntime.compare_exchange_weak(min_vruntime, vruntime, std::memory_order_relaxed)){ break; }
+        }
+    }
+
+    return task;
+}
+
+
+int64_t POSDaemonPool::__find_min_vruntime(pool_thread_cxt_t* cxt){
+    uint64_t i;
+    int64_t min_index = -1;
+
+    for(i=0; i<cxt->runq.size(); i++){
+        if(min_index < 0 || cxt->runq[i]->_pool_vruntime < cxt->runq[min_index]->_pool_vruntime){ min_index = i; }
+    }
+
+    return min_index;
+}
+
+
+void POSDaemonPool::__enqueue(POSDaemonTask* task){
+    uint64_t i, thread_id;
+    pool_thread_cxt_t *cxt;
+
+    thread_id = task->_pool_thread_id >= 0 ? task->_pool_thread_id : reinterpret_cast<uintptr_t>(task) / 64;
+    thread_id %= this->_threads.size();
+
+    // prefer an idle thread if the last thread is busy
+    if(this->_threads[thread_id]->is_idle.load(std::memory_order_relaxed) == false){
+        for(i=1; i<this->_threads.size(); i++){
+            if(this->_threads[(thread_id + i) % this->_threads.size()]->is_idle.load(std::memory_order_relaxed)){
+                thread_id = (thread_id + i) % this->_threads.size();
+                break;
+            }
+        }
+    }
+
+    cxt = this->_threads[thread_id];
+    {
+        std::lock_guard<std::mutex> lock(cxt->mutex);
+        cxt->runq.push_back(task);
+    }
+    cxt->doorbell.ring();
+}
+
+
+void POSDaemonPool::__sweep(uint64_t now_tick){
+    uint64_t last_sweep_tick;
+
+    last_sweep_tick = this->_last_sweep_tick.load(std::memory_order_relaxed);
+    if(!this->_last_sweep_tick.compare_exchange_strong(last_sweep_tick, now_tick, std::memory_order_relaxed)){
+        // another pool thread is sweeping
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->_tasks_mutex);
+    for(auto task : this->_tasks){ this->notify(task); }
+}
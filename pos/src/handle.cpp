@@ -63,7 +63,8 @@ void POSHandle::mark_status(pos_handle_status_t status){
 
 
 void POSHandle::reset_preserve_counter(){ 
-    this->_state_preserve_counter.store(0); 
+    this->_state_preserve_counter.store(0, std::memory_order_relaxed);
+    this->_state_preserve_completion.reset();
 }
 
 
@@ -87,25 +88,26 @@ pos_retval_t POSHandle::checkpoint_add(uint64_t version_id, uint64_t stream_id)
     /*!
      *  \brief  [case]  the adding has been finished, nothing need to do
      */
-    if(this->_state_preserve_counter >= 2){
+    if(this->_state_preserve_counter.load(std::memory_order_acquire) >= 2){
         retval = POS_FAILED_ALREADY_EXIST;
         goto exit;
     }
 
-    old_counter = this->_state_preserve_counter.fetch_add(1, std::memory_order_relaxed);
+    old_counter = this->_state_preserve_counter.fetch_add(1, std::memory_order_acq_rel);
     if (old_counter == 0) {
         /*!
          *  \brief  [case]  no adding on this handle yet, we conduct sync on-device copy from the origin buffer
          *  \note   this process must be sync, as there could have commit process waiting on this adding to be finished
          */
         retval = this->__add(version_id, stream_id);
-        this->_state_preserve_counter.store(3, std::memory_order_relaxed);
+        this->_state_preserve_counter.store(3, std::memory_order_release);
+        this->_state_preserve_completion.complete();
     } else if (old_counter == 1) {
         /*!
          *  \brief  [case]  there's non-finished adding on this handle, we need to wait until the adding finished
          */
         retval = POS_WARN_ABANDONED;
-        while(this->_state_preserve_counter < 3){}
+        this->__wait_state_preserve();
     }
 
 exit:
@@ -113,8 +115,10 @@ exit:
 }
 
 
-pos_retval_t POSHandle::checkpoint_commit_async(uint64_t version_id, uint64_t stream_id){ 
+pos_retval_t POSHandle::checkpoint_commit_async(uint64_t version_id, uint64_t stream_id, bool* is_blocked){ 
     pos_retval_t retval = POS_SUCCESS;
+
+    if(is_blocked != nullptr){ *is_blocked = false; }
     
     #if POS_CONF_EVAL_CkptEnablePipeline == 1
         //  if the on-device cache is enabled, the cache should be added previously by checkpoint_add,
@@ -122,7 +126,7 @@ pos_retval_t POSHandle::checkpoint_commit_async(uint64_t version_id, uint64_t st
         retval = this->__commit(version_id, stream_id, /* from_cache */ true, /* is_sync */ false);
     #else
         uint8_t old_counter;
-        old_counter = this->_state_preserve_counter.fetch_add(1, std::memory_order_relaxed);
+        old_counter = this->_state_preserve_counter.fetch_add(1, std::memory_order_acq_rel);
         if (old_counter == 0) {
             /*!
                 *  \brief  [case]  no CoW on this handle yet, we directly commit this buffer
@@ -130,7 +134,8 @@ pos_retval_t POSHandle::checkpoint_commit_async(uint64_t version_id, uint64_t st
                 *          commit must be sync, as there could have CoW waiting on this commit to be finished
                 */
             retval = this->__commit(version_id, stream_id, /* from_cache */ false, /* is_sync */ true);
-            this->_state_preserve_counter.store(3, std::memory_order_relaxed);
+            this->_state_preserve_counter.store(3, std::memory_order_release);
+            this->_state_preserve_completion.complete();
         } else if (old_counter == 1) {
             /*!
                 *  \brief  [case]  there's non-finished CoW on this handle, we need to wait until the CoW finished and
@@ -138,7 +143,8 @@ pos_retval_t POSHandle::checkpoint_commit_async(uint64_t version_id, uint64_t st
                 *  \note   we commit from the cache under this hood, and the commit process is async as there's no CoW 
                 *          on this handle anymore
                 */
-            while(this->_state_preserve_counter < 3){}
+            if(is_blocked != nullptr){ *is_blocked = true; }
+            this->__wait_state_preserve();
             retval = this->__commit(version_id, stream_id, /* from_cache */ true, /* is_sync */ false);
         } else {
             /*!
@@ -153,6 +159,18 @@ pos_retval_t POSHandle::checkpoint_commit_async(uint64_t version_id, uint64_t st
 }
 
 
+void POSHandle::__wait_state_preserve(){
+    uint64_t spin_ticks = POS_HANDLE_PRESERVE_SPIN_TICKS;
+
+    this->_state_preserve_completion.wait(
+        /* spin_ticks */ spin_ticks,
+        /* min_ticks */ POS_HANDLE_PRESERVE_SPIN_TICKS,
+        /* max_ticks */ POS_HANDLE_PRESERVE_SPIN_TICKS
+    );
+    POS_ASSERT(this->_state_preserve_counter.load(std::memory_order_acquire) >= 3);
+}
+
+
 pos_retval_t POSHandle::checkpoint_commit_sync(uint64_t version_id, uint64_t stream_id) {
     return this->__commit(version_id, stream_id, /* from_cache */ false, /* is_sync */ true);
 }
@@ -189,25 +207,14 @@ exit:
 
 pos_retval_t POSHandle::sync_persist(){
     pos_retval_t retval = POS_SUCCESS;
-    std::future<pos_retval_t> persist_future;
-
-    if(this->_persist_thread != nullptr){
-        POS_ASSERT(this->_persist_promise != nullptr);
-        persist_future = this->_persist_promise->get_future();
-        persist_future.wait();
-        retval = persist_future.get();
-
-        // ref: https://en.cppreference.com/w/cpp/thread/thread/%7Ethread
-        if(this->_persist_thread->joinable()){
-            this->_persist_thread->join();
-        }
-
-        delete this->_persist_thread;
-        this->_persist_thread = nullptr;
-        delete this->_persist_promise;
-        this->_persist_promise = nullptr;
-
-        POS_DEBUG("persist thread finished: hid(%lu), retval(%d)", this->id, retval);
+    uint64_t spin_ticks = 0;
+
+    if(this->_is_persisting.load(std::memory_order_acquire) == true){
+        // persisting of a handle lasts for at least a file write, so we park immediately
+        this->_persist_completion.wait(spin_ticks, /* min_ticks */ 0, /* max_ticks */ 0);
+        retval = this->_persist_retval;
+        this->_is_persisting.store(false, std::memory_order_release);
+        POS_DEBUG("persisting finished: hid(%lu), retval(%d)", this->id, retval);
     } else {
         retval = POS_FAILED_NOT_EXIST;
     }
@@ -217,9 +224,11 @@ exit:
 }
 
 
-pos_retval_t POSHandle::checkpoint_persist_async(std::string ckpt_dir, bool with_state, uint64_t version_id){
-    pos_retval_t retval = POS_SUCCESS, prev_retval;
-    std::future<pos_retval_t> persist_future;
+pos_retval_t POSHandle::checkpoint_persist_async(
+    std::string ckpt_dir, bool with_state, uint64_t version_id,
+    POSPersistPool* persist_pool, POSPersistGroup* persist_group
+){
+    pos_retval_t retval = POS_SUCCESS, prev_retval, persist_retval;
     POSCheckpointSlot *ckpt_slot = nullptr;
 
     POS_ASSERT(ckpt_dir.size() > 0);
@@ -248,32 +257,37 @@ pos_retval_t POSHandle::checkpoint_persist_async(std::string ckpt_dir, bool with
         POS_CHECK_POINTER(ckpt_slot);
     }
 
-    // collect previous persisting thread if any
-    if(this->_persist_thread != nullptr){
+    // collect previous persisting if any
+    if(this->_is_persisting.load(std::memory_order_acquire) == true){
         if(unlikely(POS_SUCCESS != (prev_retval = this->sync_persist()))){
             POS_WARN_C("pervious handle persisting is failed: hid(%lu), retval(%u)", this->id, prev_retval);
         }
     }
 
-    this->_persist_promise = new std::promise<pos_retval_t>;
-    POS_CHECK_POINTER(this->_persist_promise);
-
-    // persist asynchronously
-    this->_persist_thread = new std::thread(
-        [](POSHandle* handle, POSCheckpointSlot* ckpt_slot, std::string ckpt_dir){
-            pos_retval_t retval = handle->__persist_async_thread(ckpt_slot, ckpt_dir);
-            handle->_persist_promise->set_value(retval);
-        },
-        this, ckpt_slot, ckpt_dir
-    );
-    POS_CHECK_POINTER(this->_persist_thread);
+    this->_is_persisting.store(true, std::memory_order_release);
+    this->_persist_completion.reset();
 
-    POS_DEBUG(
-        "persist thread started: hid(%lu), with_state(%s), ckpt_dir(%s)",
-        this->id,
-        ckpt_slot != nullptr ? "true" : "false",
-        ckpt_dir.c_str()
-    );
+    if(persist_pool != nullptr){
+        persist_pool->submit(
+            /* handle */ this,
+            /* ckpt_slot */ ckpt_slot,
+            /* ckpt_dir */ ckpt_dir,
+            /* size */ ckpt_slot != nullptr ? ckpt_slot->get_state_size() : 0,
+            /* group */ persist_group
+        );
+        POS_DEBUG(
+            "persisting submitted: hid(%lu), with_state(%s), ckpt_dir(%s)",
+            this->id,
+            ckpt_slot != nullptr ? "true" : "false",
+            ckpt_dir.c_str()
+        );
+    } else {
+        // the result is collected by sync_persist, same as persisting within the pool
+        if(persist_group != nullptr){ persist_group->add(); }
+        persist_retval = this->__persist(ckpt_slot, ckpt_dir);
+        this->__finish_persist(persist_retval);
+        if(persist_group != nullptr){ persist_group->done(persist_retval); }
+    }
 
 exit:
     return retval;
@@ -283,13 +297,13 @@ exit:
 pos_retval_t POSHandle::checkpoint_persist_sync(std::string ckpt_dir, bool with_state, uint64_t version_id){
     pos_retval_t retval = POS_SUCCESS;
 
-    // raise persist thread
-    retval = this->checkpoint_persist_async(ckpt_dir, with_state, version_id);
+    // persist on the calling thread
+    retval = this->checkpoint_persist_async(ckpt_dir, with_state, version_id, /* persist_pool */ nullptr);
     if(unlikely(retval != POS_SUCCESS)){
         goto exit;
     }
 
-    // sync the persist thread
+    // collect the result
     retval = this->sync_persist();
     if(unlikely(retval != POS_SUCCESS)){
         goto exit;
@@ -300,7 +314,44 @@ exit:
 }
 
 
-pos_retval_t POSHandle::__persist_async_thread(POSCheckpointSlot* ckpt_slot, std::string ckpt_dir){
+pos_retval_t POSHandle::checkpoint_persist_reference(std::string ckpt_dir, std::string base_ckpt_dir){
+    pos_retval_t retval = POS_SUCCESS;
+    std::string ckpt_file_name;
+    std::filesystem::path base_file_path;
+    std::error_code ec;
+
+    POS_ASSERT(ckpt_dir.size() > 0);
+    POS_ASSERT(base_ckpt_dir.size() > 0);
+
+    ckpt_file_name = std::string("/h-")
+                    + std::to_string(this->resource_type_id)
+                    + std::string("-")
+                    + std::to_string(this->id)
+                    + std::string(".bin");
+
+    // resolve the file that stores the state, as the previous image might reference an earlier one as well
+    base_file_path = std::filesystem::canonical(base_ckpt_dir + ckpt_file_name, ec);
+    if(ec){
+        retval = POS_FAILED_NOT_EXIST;
+        goto exit;
+    }
+
+    std::filesystem::create_symlink(base_file_path, ckpt_dir + ckpt_file_name, ec);
+    if(unlikely(ec)){
+        POS_WARN_C(
+            "failed to reference checkpoint file within previous image: path(%s), error(%s)",
+            base_file_path.c_str(), ec.message().c_str()
+        );
+        retval = POS_FAILED;
+        goto exit;
+    }
+
+exit:
+    return retval;
+}
+
+
+pos_retval_t POSHandle::__persist(POSCheckpointSlot* ckpt_slot, const std::string& ckpt_dir){
     pos_retval_t retval = POS_SUCCESS;
     uint64_t i, actual_state_size;
     std::string ckpt_file_path;
@@ -365,6 +416,11 @@ pos_retval_t POSHandle::__persist_async_thread(POSCheckpointSlot* ckpt_slot, std
                     + std::to_string(this->id)
                     + std::string(".bin");
 
+    // drop the reference to the previous image (see checkpoint_persist_reference), instead of writing through it
+    if(unlikely(std::filesystem::is_symlink(ckpt_file_path))){
+        std::filesystem::remove(ckpt_file_path);
+    }
+
     // write to file
     ckpt_file_stream.open(ckpt_file_path, std::ios::binary | std::ios::out);
     if(!ckpt_file_stream){
@@ -437,18 +493,35 @@ exit:
 }
 
 
-void POSHandle::collect_broken_handles(pos_broken_handle_list_t *broken_handle_list, uint16_t layer_id){
-    uint64_t i;
+void POSHandle::collect_broken_handles(pos_broken_handle_list_t *broken_handle_list){
+    POSHandle *handle, *parent;
+    std::vector<std::pair<POSHandle*, uint64_t>> *stack;
 
     POS_CHECK_POINTER(broken_handle_list);
+    stack = &(broken_handle_list->_stack);
 
-    // insert itself to the nonactive_handles map if itsn't active
-    if(unlikely(status != kPOS_HandleStatus_Active && status != kPOS_HandleStatus_Delete_Pending)){
-        broken_handle_list->add_handle(layer_id, this);
+    if(unlikely(broken_handle_list->_visited.insert(this).second == false)){
+        return;
     }
 
-    // iterate over its parent
-    for(i=0; i<parent_handles.size(); i++){
-        parent_handles[i]->collect_broken_handles(broken_handle_list, layer_id+1);
+    // iterative post-order walk over parents, so that parents are emitted before their children
+    stack->clear();
+    stack->push_back({ this, 0 });
+    while(!stack->empty()){
+        handle = stack->back().first;
+        if(stack->back().second < handle->parent_handles.size()){
+            parent = handle->parent_handles[stack->back().second];
+            stack->back().second += 1;
+            POS_CHECK_POINTER(parent);
+            if(broken_handle_list->_visited.insert(parent).second == true){
+                stack->push_back({ parent, 0 });
+            }
+        } else {
+            // record the handle if it isn't active
+            if(unlikely(handle->status != kPOS_HandleStatus_Active && handle->status != kPOS_HandleStatus_Delete_Pending)){
+                broken_handle_list->broken_handles.push_back(handle);
+            }
+            stack->pop_back();
+        }
     }
 }
@@ -49,6 +49,8 @@ namespace agent_register_client {
         payload = (oob_payload_t*)msg->payload;
         create_param.job_name = std::string(payload->job_name);
         create_param.pid = payload->pid;
+        create_param.is_daemon_dedicated = payload->is_daemon_dedicated;
+        create_param.daemon_weight = payload->daemon_weight;
 
         // create client
         if(unlikely(POS_SUCCESS != (
@@ -91,6 +93,8 @@ namespace agent_register_client {
         payload = (oob_payload_t*)msg->payload;
         memcpy(payload->job_name, call_data_->job_name.c_str(), call_data_->job_name.size()+1);
         payload->pid = call_data_->pid;
+        payload->is_daemon_dedicated = call_data_->is_daemon_dedicated;
+        payload->daemon_weight = call_data_->daemon_weight;
         __POS_OOB_SEND();
 
         __POS_OOB_RECV();
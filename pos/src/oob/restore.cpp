@@ -94,6 +94,8 @@ namespace cli_restore {
 
         // now it's time to let client start to work
         client->status = kPOS_ClientStatus_Active;  // start polling its internal queue
+        client->parser_doorbell.ring();
+        client->worker_doorbell.ring();
         POS_LOG("resumed execution of client");
 
     response:
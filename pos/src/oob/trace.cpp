@@ -18,6 +18,7 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <algorithm>
 
 #include "pos/include/common.h"
 #include "pos/include/oob.h"
@@ -122,4 +123,84 @@ namespace cli_trace_resource {
 
 } // namespace cli_trace_resource
 
+
+/*!
+ *  \related    kPOS_OOB_Msg_CLI_Trace_Performance
+ *  \brief      signal for dumping the per-API latency histograms of all clients
+ */
+namespace cli_trace_performance {
+    // server
+    pos_retval_t sv(int fd, struct sockaddr_in* remote, POSOobMsg_t* msg, POSWorkspace* ws, POSOobServer* oob_server){
+        pos_retval_t retval = POS_SUCCESS;
+        oob_payload_t *payload;
+        std::string retmsg;
+        std::string trace_dir, report_path;
+
+        payload = (oob_payload_t*)msg->payload;
+
+        // make sure the directory exist
+        trace_dir = std::string(payload->trace_dir);
+        if (!std::filesystem::exists(trace_dir)) {
+            try {
+                std::filesystem::create_directories(trace_dir);
+            } catch (const std::filesystem::filesystem_error& e) {
+                retmsg = std::string("failed to create dir: ") + e.what();
+                retmsg.resize(std::min<size_t>(retmsg.size(), kServerRetMsgMaxLen - 1));
+                payload->retval = POS_FAILED;
+                memcpy(payload->retmsg, retmsg.c_str(), retmsg.size());
+                goto response;
+            }
+            POS_LOG("create performance trace dir: %s", trace_dir.c_str());
+        }
+
+        report_path = trace_dir + std::string("/") + std::string(kAPILatencyFileName);
+        payload->retval = ws->dump_api_latency(report_path);
+        if(unlikely(payload->retval != POS_SUCCESS)){
+            retmsg = std::string("failed to dump api latency report");
+        } else {
+            retmsg = report_path;
+        }
+        retmsg.resize(std::min<size_t>(retmsg.size(), kServerRetMsgMaxLen - 1));
+        memcpy(payload->retmsg, retmsg.c_str(), retmsg.size());
+
+    response:
+        POS_ASSERT(retmsg.size() < kServerRetMsgMaxLen);
+        __POS_OOB_SEND();
+
+    exit:
+        return retval;
+    }
+
+    // client
+    pos_retval_t clnt(
+        int fd, struct sockaddr_in* remote, POSOobMsg_t* msg, POSAgent* agent, POSOobClient* oob_clnt, void* call_data
+    ){
+        pos_retval_t retval = POS_SUCCESS;
+        oob_call_data_t *cm;
+        oob_payload_t *payload;
+
+        msg->msg_type = kPOS_OOB_Msg_CLI_Trace_Performance;
+
+        POS_CHECK_POINTER(call_data);
+        cm = (oob_call_data_t*)call_data;
+
+        // setup payload
+        memset(msg->payload, 0, sizeof(msg->payload));
+        payload = (oob_payload_t*)msg->payload;
+        memcpy(payload->trace_dir, cm->trace_dir, kTraceFilePathMaxLen);
+
+        __POS_OOB_SEND();
+
+        // wait until the posd finished 
+        __POS_OOB_RECV();
+        cm->retval = payload->retval;
+        memcpy(cm->retmsg, payload->retmsg, kServerRetMsgMaxLen);
+
+    exit:
+        return retval;
+    }
+
+
+} // namespace cli_trace_performance
+
 } // namespace oob_functions
@@ -16,22 +16,28 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "pos/include/common.h"
 #include "pos/include/workspace.h"
 #include "pos/include/client.h"
 #include "pos/include/transport.h"
 #include "pos/include/parser.h"
+#include "pos/include/utils/daemon_poller.h"
+#include "pos/include/utils/system.h"
 
 
 POSParser::POSParser(POSWorkspace* ws, POSClient* client) 
-    : _ws(ws), _client(client), _stop_flag(false)
+    : POSDaemonTask(&client->parser_doorbell), _ws(ws), _client(client), _stop_flag(false), _daemon_thread(nullptr)
 {
     POS_CHECK_POINTER(ws);
     POS_CHECK_POINTER(client);
 
-    // start daemon thread
-    this->_daemon_thread = new std::thread(&POSParser::__daemon, this);
-    POS_CHECK_POINTER(this->_daemon_thread);
+    // start daemon thread, unless the parser would be driven by the daemon pool (see init)
+    if(ws->daemon_pool == nullptr || client->_cxt.is_daemon_dedicated == true){
+        this->_daemon_thread = new std::thread(&POSParser::__daemon, this);
+        POS_CHECK_POINTER(this->_daemon_thread);
+    }
 
     POS_LOG_C("parser started");
 };
@@ -47,20 +53,39 @@ pos_retval_t POSParser::init(){
     if(unlikely(POS_SUCCESS != (retval = this->init_ps_functions()))){
         POS_ERROR_C_DETAIL("failed to insert functions: retval(%u)", retval);
     }
+
+    // flatten the parser functions if the table isn't bound during insertion
+    if(this->_parser_function_table.size() == 0){
+        this->_parser_function_table.build(this->_parser_functions);
+    }
+
+    // hand over the parser to the daemon pool, after the derived parser is constructed
+    if(this->_daemon_thread == nullptr){
+        POS_CHECK_POINTER(this->_ws->daemon_pool);
+        this->_ws->daemon_pool->add(this, this->_client->_cxt.daemon_weight);
+    }
+
     return retval;
 }
 
 
 void POSParser::shutdown(){ 
     this->_stop_flag = true;
+    this->_client->parser_doorbell.ring();
     if(this->_daemon_thread != nullptr){
         if(this->_daemon_thread->joinable()){
             this->_daemon_thread->join();
         }
         delete this->_daemon_thread;
         this->_daemon_thread = nullptr;
+        this->__record_daemon_metrics();
         POS_LOG_C("parser daemon thread shutdown");
     }
+    if(this->_daemon_pool != nullptr){
+        this->_daemon_pool->remove(this);
+        this->__record_daemon_metrics();
+        POS_LOG_C("parser removed from daemon pool");
+    }
 
     #if POS_CONF_RUNTIME_EnableTrace
         static std::unordered_map<metrics_reducer_type_t, std::string> reducer_names = {
@@ -69,141 +94,223 @@ void POSParser::shutdown(){
         };
         static std::unordered_map<metrics_counter_type_t, std::string> counter_names = {
             { KERNEL_number_of_user_kernels, "KERNEL_number_of_user_kernels" },
-            { KERNEL_number_of_vendor_kernels, "KERNEL_number_of_vendor_kernels" }
+            { KERNEL_number_of_vendor_kernels, "KERNEL_number_of_vendor_kernels" },
+            { KERNEL_number_of_memoized_launches, "KERNEL_number_of_memoized_launches" },
+            { DAEMON_nb_parks, "DAEMON_nb_parks" }
+        };
+        static std::unordered_map<metrics_ticker_type_t, std::string> ticker_names = {
+            { DAEMON_busy_ticks, "DAEMON_busy_ticks" },
+            { DAEMON_idle_ticks, "DAEMON_idle_ticks" }
         };
 
         POS_LOG(
-            "[Parser Metrics]:\n%s\n%s",
+            "[Parser Metrics]:\n%s\n%s\n%s",
             this->metric_reducers.str(reducer_names).c_str(),
-            this->metric_counters.str(counter_names).c_str()
+            this->metric_counters.str(counter_names).c_str(),
+            this->metric_tickers.str(ticker_names).c_str()
         );
     #endif
 }
 
 
+void POSParser::__record_daemon_metrics(){
+    #if POS_CONF_RUNTIME_EnableTrace
+        this->metric_tickers.add(DAEMON_busy_ticks, this->daemon_busy_ticks);
+        this->metric_tickers.add(DAEMON_idle_ticks, this->daemon_idle_ticks);
+        this->metric_counters.add_counter(DAEMON_nb_parks, this->daemon_nb_parks);
+    #endif
+}
+
+
 void POSParser::__daemon(){
-    uint64_t i, api_id;
-    pos_retval_t parser_retval, cmd_retval;
-    POSAPIMeta_t api_meta;
-    uint64_t last_ckpt_tick = 0, current_tick;
-    POSAPIContext_QE* apicxt_wqe;
-    std::vector<POSAPIContext_QE*> apicxt_wqes;
-    POSCommand_QE_t *cmd_wqe;
-    std::vector<POSCommand_QE_t*> cmd_wqes;
+    POSDaemonPoller poller(
+        /* doorbell */ &this->_client->parser_doorbell,
+        /* policy */ static_cast<pos_daemon_poll_policy_t>(POS_CONF_RUNTIME_DaemonPollPolicy),
+        /* spin_ticks */ this->_ws->tsc_timer.us_to_tick(POS_CONF_RUNTIME_DaemonPollSpinUs)
+    );
+
+    // pin the daemon to the configured CPUs, which are NUMA-local to the device by default
+    if(unlikely(POS_SUCCESS != POSUtilSystem::bind_current_thread_to_cpus(this->_client->_cxt.daemon_cpus))){
+        POS_WARN_C("failed to pin parser daemon to CPUs, run without pinning");
+    }
 
-    if(unlikely(POS_SUCCESS != this->daemon_init())){
-        POS_WARN_C("failed to init daemon, worker daemon exit");
+    if(unlikely(POS_SUCCESS != this->daemon_attach() || POS_SUCCESS != this->daemon_init())){
+        POS_WARN_C("failed to init daemon, parser daemon exit");
         goto exit;
     }
 
     while(!this->_stop_flag){
-        // if the client isn't ready, the queue might not exist, we can't do any queue operation
-        if(this->_client->status != kPOS_ClientStatus_Active){ continue; }
-
-        // step 1: digest cmd from oob work queue
-        cmd_wqes.clear();
-        this->_client->poll_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_WQ>(&cmd_wqes);
-        for(i=0; i<cmd_wqes.size(); i++){
-            POS_CHECK_POINTER(cmd_wqe = cmd_wqes[i]);
-            this->__process_cmd(cmd_wqe);
+        // spin / yield / park based on the polling policy if all queues are empty
+        if(this->daemon_poll() > 0){
+            poller.on_busy();
+        } else {
+            poller.on_idle();
         }
+    }
 
-        // step 2: digest cmd from worker completion queue
-        cmd_wqes.clear();
-        this->_client->poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_CQ>(&cmd_wqes);
-        for(i=0; i<cmd_wqes.size(); i++){
-            POS_CHECK_POINTER(cmd_wqe = cmd_wqes[i]);
-            this->__process_cmd(cmd_wqe);
-        }
+exit:
+    this->daemon_busy_ticks = poller.busy_ticks;
+    this->daemon_idle_ticks = poller.idle_ticks;
+    this->daemon_nb_parks = poller.nb_parks;
+    return;
+}
 
-        // step 3: digest apicxt from rpc work queue
-        apicxt_wqes.clear();
-        this->_client->poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>(&apicxt_wqes);
 
-        for(i=0; i<apicxt_wqes.size(); i++){
-            POS_CHECK_POINTER(apicxt_wqe = apicxt_wqes[i]);
+uint64_t POSParser::daemon_poll(){
+    uint64_t i, api_id;
+    pos_retval_t parser_retval;
+    const POSAPIMeta_t *api_meta;
+    pos_runtime_parser_function_t parser_function;
+    POSAPIContext_QE* apicxt_wqe;
+    POSCommand_QE_t *cmd_wqe;
+    uint64_t nb_polled, nb_wqes;
 
-            api_id = apicxt_wqe->api_cxt->api_id;
-            api_meta = _ws->api_mgnr->api_metas[api_id];
+    // if the client isn't ready, the queue might not exist, we can't do any queue operation
+    if(this->_client->status != kPOS_ClientStatus_Active){
+        return 0;
+    }
 
-        #if POS_CONF_RUNTIME_EnableDebugCheck
-            if(unlikely(_parser_functions.count(api_id) == 0)){
-                POS_ERROR_C_DETAIL(
-                    "runtime has no parser function for api %lu, need to implement", api_id
-                );
-            }
-        #endif
+    // step 1: digest cmd from oob work queue
+    nb_wqes = this->_client->poll_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_WQ>(this->_cmd_wqes, POS_LOCKLESS_QUEUE_POLL_BATCH);
+    nb_polled = nb_wqes;
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(cmd_wqe = this->_cmd_wqes[i]);
+        this->__process_cmd(cmd_wqe);
+    }
 
-            apicxt_wqe->parser_s_tick = POSUtilTscTimer::get_tsc();
-            parser_retval = (*(this->_parser_functions[api_id]))(this->_ws, this, apicxt_wqe);
-            apicxt_wqe->parser_e_tick = POSUtilTscTimer::get_tsc();
+    // step 2: digest cmd from worker completion queue
+    nb_wqes = this->_client->poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_CQ>(this->_cmd_wqes, POS_LOCKLESS_QUEUE_POLL_BATCH);
+    nb_polled += nb_wqes;
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(cmd_wqe = this->_cmd_wqes[i]);
+        this->__process_cmd(cmd_wqe);
+    }
 
-            // set the return code
+    // step 3: digest apicxt from rpc work queue, as long as the worker keeps up
+    nb_wqes = this->_client->template get_q_len<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>();
+    if(unlikely(nb_wqes >= POS_CLIENT_PARSER2WORKER_WQ_HIGH_WATERMARK)){
+        /*!
+         *  \note  leave the apicxts inside the rpc2parser queue, so that the RPC thread is back-pressured
+         *         once the queue is full; we keep polling instead of parking meanwhile, as the blocked RPC
+         *         thread won't push (and ring) until we consume the queue
+         */
+        if(this->_client->template get_q_len<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>() > 0){
+            nb_polled += 1;
+        }
+        return nb_polled;
+    }
+    nb_wqes = this->_client->poll_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>(
+        this->_apicxt_wqes,
+        std::min<uint64_t>(POS_LOCKLESS_QUEUE_POLL_BATCH, POS_CLIENT_PARSER2WORKER_WQ_HIGH_WATERMARK - nb_wqes)
+    );
+    nb_polled += nb_wqes;
+
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(apicxt_wqe = this->_apicxt_wqes[i]);
+
+        api_id = apicxt_wqe->api_cxt->api_id;
+        api_meta = this->_ws->api_mgnr->get_api_meta(api_id);
+        parser_function = this->_parser_function_table.get(api_id);
+
+        // unregistered / unimplemented api, fail the call instead of crashing the daemon
+        if(unlikely(api_meta == nullptr || parser_function == nullptr)){
+            POS_WARN_C_DETAIL(
+                "runtime has no api metadata or parser function for api %lu, need to implement", api_id
+            );
             apicxt_wqe->api_cxt->return_code = this->_ws->api_mgnr->cast_pos_retval(
-                /* pos_retval */ parser_retval, 
-                /* library_id */ api_meta.library_id
+                /* pos_retval */ POS_FAILED_NOT_IMPLEMENTED,
+                /* library_id */ api_meta != nullptr ? api_meta->library_id : this->_ws->api_mgnr->get_default_library_id()
             );
+            apicxt_wqe->status = kPOS_API_Execute_Status_Parser_Failed;
+            apicxt_wqe->return_tick = POSUtilTscTimer::get_tsc();
+            this->_client->template complete_apicxt<kPOS_QueueDirection_Rpc2Parser>(apicxt_wqe);
+            continue;
+        }
 
-            if(unlikely(POS_SUCCESS != parser_retval)){
-                // note:    some trash programs (e.g., inside torch) can cause parser failed (on purpose)
-                //          so we ignore parser failed warning
-                // POS_WARN_C(
-                //     "failed to execute parser function: client_id(%lu), api_id(%lu)",
-                //     apicxt_wqe->client_id, api_id
-                // );
-                apicxt_wqe->status = kPOS_API_Execute_Status_Parser_Failed;
-                apicxt_wqe->return_tick = POSUtilTscTimer::get_tsc();
-                this->_client->template push_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_CQ>(apicxt_wqe);
-                continue;
-            }
+        apicxt_wqe->parser_s_tick = POSUtilTscTimer::get_tsc();
+        parser_retval = (*parser_function)(this->_ws, this, apicxt_wqe);
+        apicxt_wqe->parser_e_tick = POSUtilTscTimer::get_tsc();
 
-            /*!
-             *  \note       for api in type of Delete_Resource, one can directly send
-             *              response to the client right after operating on mocked resources
-             *  \warning    we can't apply this rule for all Create_Resource, consider the memory
-             *              situation, which is passthrough addressed
-             *  TODO: delete this block, should be implement in autogen system
-             */
-            if(unlikely(api_meta.api_type == kPOS_API_Type_Delete_Resource)){
-                POS_DEBUG_C("api(%lu) is type of Delete_Resource, set as \"Return_After_Parse\"", api_id);
-                apicxt_wqe->status = kPOS_API_Execute_Status_Return_After_Parse;
-            }
+        this->_client->parser_api_latency->record(
+            api_id, kPOS_APILatencyStage_Parse, apicxt_wqe->parser_e_tick - apicxt_wqe->parser_s_tick
+        );
+        if(likely(apicxt_wqe->parser_s_tick >= apicxt_wqe->create_tick)){
+            this->_client->parser_api_latency->record(
+                api_id, kPOS_APILatencyStage_Queueing, apicxt_wqe->parser_s_tick - apicxt_wqe->create_tick
+            );
+        }
 
-            /*!
-             *  \note       for sync api that mark as kPOS_API_Execute_Status_Return_After_Parse,
-             *              we directly return the result back to the frontend side
-             */
-            if(     apicxt_wqe->status == kPOS_API_Execute_Status_Return_After_Parse 
-                ||  apicxt_wqe->status == kPOS_API_Execute_Status_Return_Without_Worker
-            ){
-                apicxt_wqe->return_tick = POSUtilTscTimer::get_tsc();
-                this->_client->template push_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_CQ>(apicxt_wqe);
-                apicxt_wqe->has_return = true;
-            }
+        // set the return code
+        apicxt_wqe->api_cxt->return_code = this->_ws->api_mgnr->cast_pos_retval(
+            /* pos_retval */ parser_retval, 
+            /* library_id */ api_meta->library_id
+        );
 
-            // launch the wqe to parser trace queue, if in resource trace mode
-            if(this->_client->_cxt.trace_resource == true){
-                this->_client->template push_q<kPOS_QueueDirection_ParserLocal, kPOS_QueueType_ApiCxt_Trace_WQ>(apicxt_wqe);
-            }
+        if(unlikely(POS_SUCCESS != parser_retval)){
+            // note:    some trash programs (e.g., inside torch) can cause parser failed (on purpose)
+            //          so we ignore parser failed warning
+            // POS_WARN_C(
+            //     "failed to execute parser function: client_id(%lu), api_id(%lu)",
+            //     apicxt_wqe->client_id, api_id
+            // );
+            apicxt_wqe->status = kPOS_API_Execute_Status_Parser_Failed;
+            apicxt_wqe->return_tick = POSUtilTscTimer::get_tsc();
+            this->_client->template complete_apicxt<kPOS_QueueDirection_Rpc2Parser>(apicxt_wqe);
+            continue;
+        }
+
+        /*!
+         *  \note       for api in type of Delete_Resource, one can directly send
+         *              response to the client right after operating on mocked resources
+         *  \warning    we can't apply this rule for all Create_Resource, consider the memory
+         *              situation, which is passthrough addressed
+         *  TODO: delete this block, should be implement in autogen system
+         */
+        if(unlikely(api_meta->api_type == kPOS_API_Type_Delete_Resource)){
+            POS_DEBUG_C("api(%lu) is type of Delete_Resource, set as \"Return_After_Parse\"", api_id);
+            apicxt_wqe->status = kPOS_API_Execute_Status_Return_After_Parse;
+        }
+
+        // launch the wqe to parser trace queue, if in resource trace mode
+        if(this->_client->_cxt.trace_resource == true){
+            // the trace queue holds its own reference until the trace is dumped
+            apicxt_wqe->get_ref();
+            this->_client->template push_q<kPOS_QueueDirection_ParserLocal, kPOS_QueueType_ApiCxt_Trace_WQ>(apicxt_wqe);
+        }
+
+        /*!
+         *  \note       for sync api that mark as kPOS_API_Execute_Status_Return_After_Parse,
+         *              we directly return the result back to the frontend side
+         *  \warning    the wqe might be recycled right after it's returned to the RPC frontend,
+         *              so the worker must hold its own reference for Return_After_Parse wqe,
+         *              and we can't touch Return_Without_Worker wqe after returning it
+         */
+        if(     apicxt_wqe->status == kPOS_API_Execute_Status_Return_After_Parse 
+            ||  apicxt_wqe->status == kPOS_API_Execute_Status_Return_Without_Worker
+        ){
+            apicxt_wqe->return_tick = POSUtilTscTimer::get_tsc();
+            apicxt_wqe->has_return = true;
 
             // skip those APIs that doesn't need worker support
-            if(apicxt_wqe->status == kPOS_API_Execute_Status_Return_Without_Worker){ continue; }
+            if(apicxt_wqe->status == kPOS_API_Execute_Status_Return_Without_Worker){
+                this->_client->template complete_apicxt<kPOS_QueueDirection_Rpc2Parser>(apicxt_wqe);
+                continue;
+            }
 
-            // insert apicxt_wqe to worker queue
-            this->_client->template push_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(apicxt_wqe);
+            apicxt_wqe->get_ref();
+            this->_client->template complete_apicxt<kPOS_QueueDirection_Rpc2Parser>(apicxt_wqe);
         }
+
+        // insert apicxt_wqe to worker queue
+        this->_client->template push_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(apicxt_wqe);
     }
 
-exit:
-    return;
+    return nb_polled;
 }
 
 
 pos_retval_t POSParser::__process_cmd(POSCommand_QE_t *cmd){
     pos_retval_t retval = POS_SUCCESS;
-    POSHandleManager<POSHandle>* hm;
-    POSHandle *handle;
-    uint64_t i;
 
     POS_CHECK_POINTER(cmd);
 
@@ -213,28 +320,12 @@ pos_retval_t POSParser::__process_cmd(POSCommand_QE_t *cmd){
     case kPOS_Command_Oob2Parser_Dump:
     case kPOS_Command_Oob2Parser_PreDump:
         #if POS_CONF_EVAL_CkptOptLevel > 0
-            // collect all stateful handles at this timespot to be (pre)dumped
-            for(auto &handle_id : this->_ws->stateless_resource_type_idx){
-                if(cmd->target_resource_type_idx.count(handle_id) == 0){ continue; }
-                POS_CHECK_POINTER(
-                    hm = pos_get_client_typed_hm(this->_client, handle_id, POSHandleManager<POSHandle>)
-                );
-                for(i=0; i<hm->get_nb_handles(); i++){
-                    POS_CHECK_POINTER(handle = hm->get_handle_by_id(i));
-                    cmd->record_stateless_handles(handle);
-                }
-            }
-
-            // collect all stateless handles at this timespot to be (pre)dumped
-            for(auto &handle_id : this->_ws->stateful_resource_type_idx){
-                if(cmd->target_resource_type_idx.count(handle_id) == 0){ continue; }
-                POS_CHECK_POINTER(
-                    hm = pos_get_client_typed_hm(this->_client, handle_id, POSHandleManager<POSHandle>)
-                );
-                for(i=0; i<hm->get_nb_handles(); i++){
-                    POS_CHECK_POINTER(handle = hm->get_handle_by_id(i));
-                    cmd->record_stateful_handles(handle);
-                }
+            // collect all handles at this timespot to be (pre)dumped
+            if(unlikely(POS_SUCCESS != (retval = this->__checkpoint_insertion(cmd)))){
+                POS_WARN_C("failed to insert checkpoint op: retval(%u)", retval);
+                cmd->retval = retval;
+                this->_client->template push_q<kPOS_QueueDirection_Oob2Parser, kPOS_QueueType_Cmd_CQ>(cmd);
+                break;
             }
             cmd->type = cmd->type == kPOS_Command_Oob2Parser_PreDump 
                         ? kPOS_Command_Parser2Worker_PreDump
@@ -249,6 +340,7 @@ pos_retval_t POSParser::__process_cmd(POSCommand_QE_t *cmd){
     /* ========== Ckpt CQ Command from worker thread ========== */
     case kPOS_Command_Parser2Worker_PreDump:
     case kPOS_Command_Parser2Worker_Dump:
+        this->__checkpoint_insertion_finished(cmd);
         cmd->type = cmd->type == kPOS_Command_Parser2Worker_PreDump 
                     ? kPOS_Command_Oob2Parser_PreDump
                     : kPOS_Command_Oob2Parser_Dump;
@@ -262,3 +354,159 @@ pos_retval_t POSParser::__process_cmd(POSCommand_QE_t *cmd){
 exit:
     return retval;
 }
+
+
+pos_retval_t POSParser::__checkpoint_insertion(POSCommand_QE_t *cmd){
+    pos_retval_t retval;
+
+    #if POS_CONF_EVAL_CkptEnableIncremental == 1
+        retval = this->__checkpoint_insertion_incremental(cmd);
+    #else
+        retval = this->__checkpoint_insertion_naive(cmd);
+    #endif
+
+    // the checkpoint holds handles on its own, so deleted handles mustn't be freed until it finished
+    if(likely(retval == POS_SUCCESS)){
+        for(auto& hm_pair : this->_client->handle_managers){
+            POS_CHECK_POINTER(hm_pair.second);
+            hm_pair.second->pause_handle_recycle();
+        }
+    }
+
+    return retval;
+}
+
+
+pos_retval_t POSParser::__checkpoint_insertion_naive(POSCommand_QE_t *cmd){
+    pos_retval_t retval = POS_SUCCESS;
+    POSHandleManager<POSHandle>* hm;
+
+    POS_CHECK_POINTER(cmd);
+
+    // collect all stateless handles
+    for(auto &rid : this->_ws->stateless_resource_type_idx){
+        if(cmd->target_resource_type_idx.count(rid) == 0){ continue; }
+        POS_CHECK_POINTER(hm = pos_get_client_typed_hm(this->_client, rid, POSHandleManager<POSHandle>));
+        hm->for_each_live_handle([&](POSHandle *handle){
+            POS_CHECK_POINTER(handle);
+            cmd->record_stateless_handles(handle);
+        });
+    }
+
+    // collect all stateful handles
+    for(auto &rid : this->_ws->stateful_resource_type_idx){
+        if(cmd->target_resource_type_idx.count(rid) == 0){ continue; }
+        POS_CHECK_POINTER(hm = pos_get_client_typed_hm(this->_client, rid, POSHandleManager<POSHandle>));
+        hm->for_each_live_handle([&](POSHandle *handle){
+            POS_CHECK_POINTER(handle);
+            cmd->record_stateful_handles(handle);
+        });
+    }
+
+    return retval;
+}
+
+
+pos_retval_t POSParser::__checkpoint_insertion_incremental(POSCommand_QE_t *cmd){
+    pos_retval_t retval = POS_SUCCESS;
+    POSHandleManager<POSHandle>* hm;
+    uint64_t nb_handles, base_nb_handles;
+    incremental_ckpt_cxt_t &cxt = this->_incremental_ckpt_cxt;
+
+    POS_CHECK_POINTER(cmd);
+
+    /*!
+     *  \note  the modified records consumed by the in-flight checkpoint are only settled once it
+     *         finished, so we take a full image if the previous one is still in flight
+     */
+    if(unlikely(cxt.inflight_cmd != nullptr)){
+        POS_WARN_C("previous checkpoint is still in flight, fallback to full checkpoint");
+        retval = this->__checkpoint_insertion_naive(cmd);
+        goto exit;
+    }
+
+    // collect all stateless handles, which carry no state
+    for(auto &rid : this->_ws->stateless_resource_type_idx){
+        if(cmd->target_resource_type_idx.count(rid) == 0){ continue; }
+        POS_CHECK_POINTER(hm = pos_get_client_typed_hm(this->_client, rid, POSHandleManager<POSHandle>));
+        hm->for_each_live_handle([&](POSHandle *handle){
+            POS_CHECK_POINTER(handle);
+            cmd->record_stateless_handles(handle);
+        });
+    }
+
+    // collect stateful handles that been modified or created since the base image
+    cxt.inflight_nb_handles.clear();
+    for(auto &rid : this->_ws->stateful_resource_type_idx){
+        if(cmd->target_resource_type_idx.count(rid) == 0){ continue; }
+        POS_CHECK_POINTER(hm = pos_get_client_typed_hm(this->_client, rid, POSHandleManager<POSHandle>));
+
+        nb_handles = hm->get_nb_handles();
+        base_nb_handles = 0;
+        if(cxt.base_ckpt_dir.size() > 0 && cxt.base_nb_handles.count(rid) > 0){
+            base_nb_handles = std::min<uint64_t>(cxt.base_nb_handles[rid], nb_handles);
+        }
+
+        // handles with smaller id than the base count exist in the base image, unless they took the id
+        // of a freed handle afterwards, which are recorded as modified once allocated
+        hm->for_each_live_handle([&](POSHandle *handle){
+            POS_CHECK_POINTER(handle);
+            if(handle->id < base_nb_handles && !hm->is_modified_handle(handle)){
+                cmd->record_unchanged_stateful_handles(handle);
+            } else {
+                cmd->record_stateful_handles(handle);
+            }
+        });
+
+        // modification from now on goes to the next image
+        hm->clear_modified_handle();
+        cxt.inflight_nb_handles[rid] = nb_handles;
+    }
+
+    if(cmd->unchanged_stateful_handles.size() > 0){
+        cmd->base_ckpt_dir = cxt.base_ckpt_dir;
+    }
+    cxt.inflight_cmd = cmd;
+
+    POS_LOG_C(
+        "incremental checkpoint: #stateful handles(%lu), #unchanged stateful handles(%lu), base(%s)",
+        cmd->stateful_handles.size(),
+        cmd->unchanged_stateful_handles.size(),
+        cmd->base_ckpt_dir.size() > 0 ? cmd->base_ckpt_dir.c_str() : "none"
+    );
+
+exit:
+    return retval;
+}
+
+
+void POSParser::__checkpoint_insertion_finished(POSCommand_QE_t *cmd){
+    POSHandleManager<POSHandle>* hm;
+    incremental_ckpt_cxt_t &cxt = this->_incremental_ckpt_cxt;
+
+    POS_CHECK_POINTER(cmd);
+
+    for(auto& hm_pair : this->_client->handle_managers){
+        POS_CHECK_POINTER(hm_pair.second);
+        hm_pair.second->resume_handle_recycle();
+    }
+
+    // a full checkpoint taken while another one in flight, nothing to settle
+    if(cmd != cxt.inflight_cmd){ return; }
+
+    if(cmd->retval == POS_SUCCESS){
+        cxt.base_ckpt_dir = cmd->ckpt_dir;
+        cxt.base_nb_handles = cxt.inflight_nb_handles;
+    } else {
+        // the image isn't usable, so handles recorded by it would still differ from the base image
+        for(auto &handle : cmd->stateful_handles){
+            POS_CHECK_POINTER(
+                hm = pos_get_client_typed_hm(this->_client, handle->resource_type_id, POSHandleManager<POSHandle>)
+            );
+            hm->record_modified_handle(handle);
+        }
+    }
+
+    cxt.inflight_cmd = nullptr;
+    cxt.inflight_nb_handles.clear();
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "pos/include/common.h"
+#include "pos/include/log.h"
+#include "pos/include/handle.h"
+#include "pos/include/persist_pool.h"
+
+
+POSPersistPool::POSPersistPool(uint32_t nb_threads) : _next_seq(0), _stop_flag(false) {
+    uint32_t i;
+
+    POS_ASSERT(nb_threads > 0);
+    for(i=0; i<nb_threads; i++){
+        POS_CHECK_POINTER(this->_threads.emplace_back(new std::thread(&POSPersistPool::__thread_main, this)));
+    }
+
+    POS_DEBUG_C("persist pool started: #threads(%u)", nb_threads);
+}
+
+
+POSPersistPool::~POSPersistPool(){
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stop_flag = true;
+    }
+    this->_cv.notify_all();
+
+    for(std::thread *thread : this->_threads){
+        if(thread->joinable()){ thread->join(); }
+        delete thread;
+    }
+    this->_threads.clear();
+}
+
+
+void POSPersistPool::submit(
+    POSHandle* handle, POSCheckpointSlot* ckpt_slot, const std::string& ckpt_dir,
+    uint64_t size, POSPersistGroup* group
+){
+    POS_CHECK_POINTER(handle);
+
+    if(group != nullptr){ group->add(); }
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_jobs.push({
+            /* handle */ handle,
+            /* ckpt_slot */ ckpt_slot,
+            /* ckpt_dir */ ckpt_dir,
+            /* size */ size,
+            /* seq */ this->_next_seq++,
+            /* group */ group
+        });
+    }
+    this->_cv.notify_one();
+}
+
+
+void POSPersistPool::__thread_main(){
+    pos_retval_t retval;
+    std::vector<persist_job_t> batch;
+    uint64_t batch_bytes;
+
+    while(true){
+        batch.clear();
+
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_cv.wait(lock, [this]{ return this->_stop_flag || !this->_jobs.empty(); });
+            if(unlikely(this->_jobs.empty())){
+                // stopped, and all pending jobs are drained
+                break;
+            }
+
+            // the largest pending job is small, so as the rest of them, take a batch of them at once
+            batch.push_back(this->_jobs.top());
+            this->_jobs.pop();
+            batch_bytes = batch.back().size;
+            if(batch_bytes < POS_PERSIST_POOL_SMALL_JOB_BYTES){
+                while(   !this->_jobs.empty()
+                      && batch.size() < POS_PERSIST_POOL_BATCH_MAX_NB_JOBS
+                      && batch_bytes + this->_jobs.top().size <= POS_PERSIST_POOL_BATCH_BYTES
+                ){
+                    batch_bytes += this->_jobs.top().size;
+                    batch.push_back(this->_jobs.top());
+                    this->_jobs.pop();
+                }
+            }
+        }
+
+        for(persist_job_t& job : batch){
+            retval = job.handle->__persist(job.ckpt_slot, job.ckpt_dir);
+            if(unlikely(retval != POS_SUCCESS)){
+                POS_WARN_C("failed to persist handle: hid(%lu), retval(%d)", job.handle->id, retval);
+            }
+
+            // the handle might be persisted again by its owner once completed, so we don't touch it afterwards
+            job.handle->__finish_persist(retval);
+            if(job.group != nullptr){ job.group->done(retval); }
+        }
+    }
+}
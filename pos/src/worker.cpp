@@ -20,6 +20,7 @@
 #include <thread>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <sched.h>
 #include <pthread.h>
 #include "pos/include/common.h"
@@ -29,29 +30,33 @@
 #include "pos/include/client.h"
 #include "pos/include/worker.h"
 #include "pos/include/utils/lockfree_queue.h"
+#include "pos/include/utils/daemon_poller.h"
 #include "pos/include/utils/system.h"
 #include "pos/include/api_context.h"
 #include "pos/include/trace.h"
 
 
 POSWorker::POSWorker(POSWorkspace* ws, POSClient* client) 
-    : _max_wqe_id(0)
+    : POSDaemonTask(&client->worker_doorbell), _max_wqe_id(0)
 {
     POS_CHECK_POINTER(this->_ws = ws);
     POS_CHECK_POINTER(this->_client = client);
     this->_stop_flag = false;
+    this->_daemon_thread = nullptr;
 
-    // start daemon thread
-    this->_daemon_thread = new std::thread(&POSWorker::__daemon, this);
-    POS_CHECK_POINTER(this->_daemon_thread);
+    // start daemon thread, unless the worker would be driven by the daemon pool (see init)
+    if(ws->daemon_pool == nullptr || client->_cxt.is_daemon_dedicated == true){
+        this->_daemon_thread = new std::thread(&POSWorker::__daemon, this);
+        POS_CHECK_POINTER(this->_daemon_thread);
+    }
     
     #if POS_CONF_EVAL_CkptOptLevel == 2
-        this->_ckpt_stream_id = 0;
+        for(auto& stream_id : this->_ckpt_stream_ids){ stream_id = 0; }
         this->_cow_stream_id = 0;
     #endif
 
     #if POS_CONF_EVAL_CkptOptLevel == 2 && POS_CONF_EVAL_CkptEnablePipeline == 1
-        this->_ckpt_commit_stream_id = 0;
+        for(auto& stream_id : this->_ckpt_commit_stream_ids){ stream_id = 0; }
     #endif
 
     #if POS_CONF_EVAL_MigrOptLevel > 0
@@ -79,20 +84,39 @@ pos_retval_t POSWorker::init(){
     ))){
         POS_ERROR_C_DETAIL("failed to insert functions: retval(%u)", retval);
     }
+
+    // flatten the worker functions if the table isn't bound during insertion
+    if(this->_launch_function_table.size() == 0){
+        this->_launch_function_table.build(this->_launch_functions);
+    }
+
+    // hand over the worker to the daemon pool, after the derived worker is constructed
+    if(this->_daemon_thread == nullptr){
+        POS_CHECK_POINTER(this->_ws->daemon_pool);
+        this->_ws->daemon_pool->add(this, this->_client->_cxt.daemon_weight);
+    }
+
     return retval;
 }
 
 
 void POSWorker::shutdown(){ 
     this->_stop_flag = true;
+    this->_client->worker_doorbell.ring();
     if(this->_daemon_thread != nullptr){
         if(this->_daemon_thread->joinable()){
             this->_daemon_thread->join();
         }
         delete this->_daemon_thread;
         this->_daemon_thread = nullptr;
+        this->__record_daemon_metrics();
         POS_LOG_C("worker daemon thread shutdown");
     }
+    if(this->_daemon_pool != nullptr){
+        this->_daemon_pool->remove(this);
+        this->__record_daemon_metrics();
+        POS_LOG_C("worker removed from daemon pool");
+    }
 }
 
 
@@ -125,117 +149,217 @@ void POSWorker::__done(POSWorkspace* ws, POSAPIContext_QE* wqe){
 }
 
 
+void POSWorker::__record_daemon_metrics(){
+    #if POS_CONF_RUNTIME_EnableTrace
+        this->_metric_tickers.add(DAEMON_busy_ticks, this->daemon_busy_ticks);
+        this->_metric_tickers.add(DAEMON_idle_ticks, this->daemon_idle_ticks);
+        this->_metric_counters.add_counter(DAEMON_nb_parks, this->daemon_nb_parks);
+    #endif
+}
+
+
 void POSWorker::__daemon(){
-    if(unlikely(POS_SUCCESS != this->daemon_init())){
+    POSDaemonPoller poller(
+        /* doorbell */ &this->_client->worker_doorbell,
+        /* policy */ static_cast<pos_daemon_poll_policy_t>(POS_CONF_RUNTIME_DaemonPollPolicy),
+        /* spin_ticks */ this->_ws->tsc_timer.us_to_tick(POS_CONF_RUNTIME_DaemonPollSpinUs)
+    );
+
+    // pin the daemon to the configured CPUs, which are NUMA-local to the device by default
+    if(unlikely(POS_SUCCESS != POSUtilSystem::bind_current_thread_to_cpus(this->_client->_cxt.daemon_cpus))){
+        POS_WARN_C("failed to pin worker daemon to CPUs, run without pinning");
+    }
+
+    if(unlikely(POS_SUCCESS != this->daemon_attach() || POS_SUCCESS != this->daemon_init())){
         POS_WARN_C("failed to init daemon, worker daemon exit");
         goto exit;
     }
 
+    while(!this->_stop_flag){
+        // spin / yield / park based on the polling policy if all queues are empty
+        if(this->daemon_poll() > 0){
+            poller.on_busy();
+        } else {
+            poller.on_idle();
+        }
+    }
+
+exit:
+    this->daemon_busy_ticks = poller.busy_ticks;
+    this->daemon_idle_ticks = poller.idle_ticks;
+    this->daemon_nb_parks = poller.nb_parks;
+    return;
+}
+
+
+uint64_t POSWorker::daemon_poll(){
+    // if the client isn't ready, the queue might not exist, we can't do any queue operation
+    if(this->_client->status != kPOS_ClientStatus_Active){
+        return 0;
+    }
+
     #if POS_CONF_EVAL_MigrOptLevel == 0
         // case: continuous checkpoint
         #if POS_CONF_EVAL_CkptOptLevel <= 1
-            this->__daemon_ckpt_sync();
+            return this->__poll_ckpt_sync();
         #elif POS_CONF_EVAL_CkptOptLevel == 2
-            this->__daemon_ckpt_async();
+            return this->__poll_ckpt_async();
         #endif
     #else
-        this->__daemon_migration_opt();
+        return this->__poll_migration_opt();
     #endif
+}
 
-exit:
-    return;
+
+void POSWorker::__checkpoint_reference_unchanged_handles(POSCommand_QE_t *cmd){
+    pos_retval_t retval;
+    uint64_t nb_referenced_handles = 0;
+
+    POS_CHECK_POINTER(cmd);
+
+    if(cmd->unchanged_stateful_handles.size() == 0){ return; }
+    POS_ASSERT(cmd->base_ckpt_dir.size() > 0);
+
+    for(auto &handle : cmd->unchanged_stateful_handles){
+        POS_CHECK_POINTER(handle);
+
+        if(unlikely(   handle->status == kPOS_HandleStatus_Deleted 
+                    || handle->status == kPOS_HandleStatus_Create_Pending
+                    || handle->status == kPOS_HandleStatus_Broken
+        )){
+            continue;
+        }
+
+        retval = handle->checkpoint_persist_reference(
+            /* ckpt_dir */ cmd->ckpt_dir,
+            /* base_ckpt_dir */ cmd->base_ckpt_dir
+        );
+        if(likely(retval == POS_SUCCESS)){
+            nb_referenced_handles += 1;
+            continue;
+        }
+
+        // e.g., the handle wasn't active while the base image was taken
+        cmd->record_stateful_handles(handle);
+    }
+
+    POS_LOG_C(
+        "referenced unchanged handles from base image: #handles(%lu), base(%s)",
+        nb_referenced_handles, cmd->base_ckpt_dir.c_str()
+    );
+}
+
+
+void POSWorker::__mark_dirty_state(POSAPIContext_QE *wqe){
+    POS_CHECK_POINTER(wqe);
+
+    for(auto &inout_handle_view : wqe->inout_handle_views){
+        POS_CHECK_POINTER(inout_handle_view.handle);
+        inout_handle_view.handle->mark_dirty_state(inout_handle_view.offset, inout_handle_view.size);
+    }
+    for(auto &out_handle_view : wqe->output_handle_views){
+        POS_CHECK_POINTER(out_handle_view.handle);
+        out_handle_view.handle->mark_dirty_state(out_handle_view.offset, out_handle_view.size);
+    }
 }
 
 
 #if POS_CONF_EVAL_CkptOptLevel == 0 || POS_CONF_EVAL_CkptOptLevel == 1
 
 
-void POSWorker::__daemon_ckpt_sync(){
+uint64_t POSWorker::__poll_ckpt_sync(){
     uint64_t i, api_id;
     pos_retval_t launch_retval, tmp_retval;
-    POSAPIMeta_t api_meta;
+    const POSAPIMeta_t *api_meta;
+    pos_worker_launch_function_t launch_function;
     POSAPIContext_QE *wqe;
-    std::vector<POSAPIContext_QE*> wqes;
     POSCommand_QE_t *cmd_wqe;
-    std::vector<POSCommand_QE_t*> cmd_wqes;
-
-    while(!this->_stop_flag){
-        // if the client isn't ready, the queue might not exist, we can't do any queue operation
-        if(this->_client->status != kPOS_ClientStatus_Active){ continue; }
-
-        // step 1: digest cmd from parser work queue
-        cmd_wqes.clear();
-        this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>(&cmd_wqes);
-        for(i=0; i<cmd_wqes.size(); i++){
-            POS_CHECK_POINTER(cmd_wqe = cmd_wqes[i]);
-            this->__process_cmd(cmd_wqe);
-        }
+    uint64_t nb_polled, nb_wqes;
+
+    // step 1: digest cmd from parser work queue
+    nb_wqes = this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>(this->_cmd_wqes, POS_LOCKLESS_QUEUE_POLL_BATCH);
+    nb_polled = nb_wqes;
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(cmd_wqe = this->_cmd_wqes[i]);
+        this->__process_cmd(cmd_wqe);
+    }
 
-        // step 2: check whether we need to run the bottom half of sync checkpoint
-        if(unlikely(this->sync_ckpt_cxt.ckpt_active == true) && this->_client->is_under_sync_call == false){
-            POS_CHECK_POINTER(this->sync_ckpt_cxt.cmd);
-            this->__process_cmd(this->sync_ckpt_cxt.cmd);
-            continue;
-        }
+    // step 2: check whether we need to run the bottom half of sync checkpoint
+    if(unlikely(this->sync_ckpt_cxt.ckpt_active == true) && this->_client->is_under_sync_call == false){
+        POS_CHECK_POINTER(this->sync_ckpt_cxt.cmd);
+        this->__process_cmd(this->sync_ckpt_cxt.cmd);
+        return 1;
+    }
 
-        // step 3: digest apicxt from parser work queue
-        wqes.clear();
-        this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(&wqes);
+    // step 3: digest apicxt from parser work queue
+    nb_wqes = this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(this->_apicxt_wqes, POS_LOCKLESS_QUEUE_POLL_BATCH);
+    nb_polled += nb_wqes;
 
-        for(i=0; i<wqes.size(); i++){
-            POS_CHECK_POINTER(wqe = wqes[i]);
-            POS_CHECK_POINTER(wqe->api_cxt);
-            
-            wqe->worker_s_tick = POSUtilTscTimer::get_tsc();
-            
-            api_id = wqe->api_cxt->api_id;
-            api_meta = this->_ws->api_mgnr->api_metas[api_id];
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(wqe = this->_apicxt_wqes[i]);
+        POS_CHECK_POINTER(wqe->api_cxt);
+        
+        wqe->worker_s_tick = POSUtilTscTimer::get_tsc();
+        
+        api_id = wqe->api_cxt->api_id;
+        api_meta = this->_ws->api_mgnr->get_api_meta(api_id);
+        launch_function = this->_launch_function_table.get(api_id);
 
-            // check and restore broken handles
-            if(unlikely(POS_SUCCESS != __restore_broken_handles(wqe, &api_meta))){
-                POS_WARN_C("failed to check / restore broken handles: api_id(%lu)", api_id);
-                continue;
-            }
+        // check and restore broken handles
+        if(unlikely(POS_SUCCESS != __restore_broken_handles(wqe, api_meta))){
+            POS_WARN_C("failed to check / restore broken handles: api_id(%lu)", api_id);
+            continue;
+        }
 
-        #if POS_CONF_RUNTIME_EnableDebugCheck
-            if(unlikely(this->_launch_functions.count(api_id) == 0)){
-                POS_ERROR_C_DETAIL(
-                    "runtime has no worker launch function for api %lu, need to implement", api_id
-                );
-            }
-        #endif
 
-            launch_retval = (*(this->_launch_functions[api_id]))(this->_ws, wqe);
-            wqe->worker_e_tick = POSUtilTscTimer::get_tsc();
+        if(likely(launch_function != nullptr)){
+            launch_retval = (*launch_function)(this->_ws, wqe);
+        } else {
+            POS_WARN_C_DETAIL("runtime has no worker launch function for api %lu, need to implement", api_id);
+            launch_retval = POS_FAILED_NOT_IMPLEMENTED;
+        }
+        wqe->worker_e_tick = POSUtilTscTimer::get_tsc();
+    #if POS_CONF_EVAL_CkptOptLevel == 1
+        this->__mark_dirty_state(wqe);
+    #endif
+        this->_client->worker_api_latency->record(
+            api_id, kPOS_APILatencyStage_Worker, wqe->worker_e_tick - wqe->worker_s_tick
+        );
 
-            // cast return code
-            wqe->api_cxt->return_code = _ws->api_mgnr->cast_pos_retval(
-                /* pos_retval */ launch_retval, 
-                /* library_id */ api_meta.library_id
-            );
+        // cast return code
+        wqe->api_cxt->return_code = _ws->api_mgnr->cast_pos_retval(
+            /* pos_retval */ launch_retval, 
+            /* library_id */ api_meta->library_id
+        );
 
-            // check whether the execution is success
-            if(unlikely(launch_retval != POS_SUCCESS)){
-                wqe->status = kPOS_API_Execute_Status_Worker_Failed;
-            }
+        // check whether the execution is success
+        if(unlikely(launch_retval != POS_SUCCESS)){
+            wqe->status = kPOS_API_Execute_Status_Worker_Failed;
+        }
 
-            // check whether we need to return to frontend
-            if(wqe->has_return == false){
-                // we only return the QE back to frontend when it hasn't been returned before
-                wqe->return_tick = POSUtilTscTimer::get_tsc();
-                this->_client->template push_q<kPOS_QueueDirection_Rpc2Worker, kPOS_QueueType_ApiCxt_CQ>(wqe);
-                wqe->has_return = true;
-            }
+        POS_ASSERT(wqe->id >= this->_max_wqe_id);
+        this->_max_wqe_id = wqe->id;
 
-            POS_ASSERT(wqe->id >= this->_max_wqe_id);
-            this->_max_wqe_id = wqe->id;
+        // check whether we need to return to frontend
+        if(wqe->has_return == false){
+            // we only return the QE back to frontend when it hasn't been returned before,
+            // note that the wqe might be recycled once it's returned
+            wqe->return_tick = POSUtilTscTimer::get_tsc();
+            wqe->has_return = true;
+            this->_client->template complete_apicxt<kPOS_QueueDirection_Rpc2Worker>(wqe);
+        } else {
+            // the QE was returned by the parser, drop the reference held by the worker
+            wqe->put_ref();
         }
     }
+
+    return nb_polled;
 }
 
 
 pos_retval_t POSWorker::__checkpoint_handle_sync(POSCommand_QE_t *cmd){
-    pos_retval_t retval = POS_SUCCESS;
+    pos_retval_t retval = POS_SUCCESS, persist_retval;
+    POSPersistGroup persist_group;
 
     POS_CHECK_POINTER(cmd);
 
@@ -255,7 +379,8 @@ pos_retval_t POSWorker::__checkpoint_handle_sync(POSCommand_QE_t *cmd){
             }
             
             if(with_state == true){
-                // commit the handle first
+                // commit the handle first, only those chunks modified since last commit are copied
+                handle->begin_checkpoint_round();
                 #if POS_CONF_RUNTIME_EnableTrace
                     this->_metric_tickers.start(CKPT_commit_ticks);
                 #endif
@@ -278,42 +403,55 @@ pos_retval_t POSWorker::__checkpoint_handle_sync(POSCommand_QE_t *cmd){
                 #endif
             }
 
-            // persist the handle
-            #if POS_CONF_RUNTIME_EnableTrace
-                this->_metric_tickers.start(PERSIST_handle_ticks);
-            #endif
-            retval = handle->checkpoint_persist_sync(
+            // persist the handle within the persist pool, overlapped with committing the rest
+            retval = handle->checkpoint_persist_async(
                 /* ckpt_dir */ cmd->ckpt_dir,
                 /* with_state */ with_state,
-                /* version_id */ handle->latest_version
+                /* version_id */ handle->latest_version,
+                /* persist_pool */ this->_ws->persist_pool,
+                /* persist_group */ &persist_group
             );
             if(unlikely(POS_SUCCESS != retval)){
                 POS_WARN_C("failed to persist handle: hid(%lu), retval(%d)", handle->id, retval);
                 retval = POS_FAILED;
                 goto exit;
             }
-            #if POS_CONF_RUNTIME_EnableTrace
-                this->_metric_tickers.end(PERSIST_handle_ticks);
-                this->_metric_counters.add_counter(PERSIST_handle_times);
-            #endif
         }
 
     exit:
         return retval;
     };
 
+    // reference unchanged handles from the base image, if this is an incremental checkpoint
+    this->__checkpoint_reference_unchanged_handles(cmd);
+
     // save statelful handles
     retval = __commit_and_persist_handles(cmd->stateful_handles, /* with_state */ true);
     if(unlikely(retval != POS_SUCCESS)){
         POS_WARN_C("failed to commit and persist stateful handles");
-        goto exit;
+        goto wait_persist;
     }
     // save stateless handles
     retval = __commit_and_persist_handles(cmd->stateless_handles, /* with_state */ false);
     if(unlikely(retval != POS_SUCCESS)){
         POS_WARN_C("failed to commit and persist stateful handles");
-        goto exit;
+        goto wait_persist;
+    }
+
+wait_persist:
+    // wait all persisting to be finished, also on failure, as the group lives on this stack
+    #if POS_CONF_RUNTIME_EnableTrace
+        this->_metric_tickers.start(PERSIST_handle_ticks);
+    #endif
+    if(unlikely(POS_SUCCESS != (persist_retval = persist_group.wait()))){
+        POS_WARN_C("failed to persist handles: retval(%d)", persist_retval);
+        retval = POS_FAILED;
     }
+    #if POS_CONF_RUNTIME_EnableTrace
+        this->_metric_tickers.end(PERSIST_handle_ticks);
+        this->_metric_counters.add_counter(PERSIST_handle_times, persist_group.get_nb_done());
+    #endif
+    if(unlikely(retval != POS_SUCCESS)){ goto exit; }
 
     // make sure the checkpoint is finished
     #if POS_CONF_RUNTIME_EnableTrace
@@ -456,316 +594,308 @@ exit:
 #elif POS_CONF_EVAL_CkptOptLevel == 2
 
 
-void POSWorker::__daemon_ckpt_async(){
+uint64_t POSWorker::__poll_ckpt_async(){
     uint64_t i, api_id, gpu_ticker;
     pos_retval_t launch_retval, tmp_retval;
-    POSAPIMeta_t api_meta;
+    const POSAPIMeta_t *api_meta;
+    pos_worker_launch_function_t launch_function;
     POSAPIContext_QE *wqe;
-    std::vector<POSAPIContext_QE*> wqes;
     POSCommand_QE_t *cmd_wqe;
-    std::vector<POSCommand_QE_t*> cmd_wqes;
     POSHandle *handle;
+    uint64_t nb_polled, nb_wqes;
 
     #if POS_CONF_RUNTIME_EnableTrace
         uint64_t nb_cow_handle = 0, nb_cow_stateful_handle = 0, cow_size = 0;
     #endif
 
-    while(!this->_stop_flag){
-        // if the client isn't ready, the queue might not exist, we can't do any queue operation
-        if(this->_client->status != kPOS_ClientStatus_Active){ continue; }
-
-        // step 1: digest cmd from parser work queue
-        cmd_wqes.clear();
-        this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>(&cmd_wqes);
-        for(i=0; i<cmd_wqes.size(); i++){
-            POS_CHECK_POINTER(cmd_wqe = cmd_wqes[i]);
-            this->__process_cmd(cmd_wqe);
-        }
+    // step 1: digest cmd from parser work queue
+    nb_wqes = this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_WQ>(this->_cmd_wqes, POS_LOCKLESS_QUEUE_POLL_BATCH);
+    nb_polled = nb_wqes;
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(cmd_wqe = this->_cmd_wqes[i]);
+        this->__process_cmd(cmd_wqe);
+    }
 
-        // step 2: check whether we need to run the bottom half of concurrent checkpoint
-        if(unlikely(this->async_ckpt_cxt.BH_active == true) && this->_client->is_under_sync_call == false){
-            tmp_retval = this->__checkpoint_BH_sync();
-            continue;
-        }
+    // step 2: check whether we need to run the bottom half of concurrent checkpoint
+    if(unlikely(this->async_ckpt_cxt.BH_active == true) && this->_client->is_under_sync_call == false){
+        tmp_retval = this->__checkpoint_BH_sync();
+        return 1;
+    }
 
-        // step 3: digest apicxt from parser work queue
-        wqes.clear();
-        this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(&wqes);
+    // step 3: digest apicxt from parser work queue
+    nb_wqes = this->_client->template poll_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_ApiCxt_WQ>(this->_apicxt_wqes, POS_LOCKLESS_QUEUE_POLL_BATCH);
+    nb_polled += nb_wqes;
 
-        for(i=0; i<wqes.size(); i++){
-            POS_CHECK_POINTER(wqe = wqes[i]);
+    for(i=0; i<nb_wqes; i++){
+        POS_CHECK_POINTER(wqe = this->_apicxt_wqes[i]);
 
-            #if POS_CONF_RUNTIME_EnableTrace
-                if(unlikely(this->_restoring_phrase < kPOS_WorkRestorePhrase_Normal)){
+        #if POS_CONF_RUNTIME_EnableTrace
+            if(unlikely(this->_restoring_phrase < kPOS_WorkRestorePhrase_Normal)){
 
-                    if(wqe->type == ApiCxt_TypeId_Recomputation){
+                if(wqe->type == ApiCxt_TypeId_Recomputation){
 
-                        if(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation_Init){
-                            // case 1: first recomputation API
-                            tmp_retval = this->start_gpu_ticker(/* stream_id */ 0);
-                            if(unlikely(tmp_retval != POS_SUCCESS)){
-                                POS_WARN("failed to start gpu ticker, restore measurement abandoned");
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                            } else {
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Recomputation;
-                            }
+                    if(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation_Init){
+                        // case 1: first recomputation API
+                        tmp_retval = this->start_gpu_ticker(/* stream_id */ 0);
+                        if(unlikely(tmp_retval != POS_SUCCESS)){
+                            POS_WARN("failed to start gpu ticker, restore measurement abandoned");
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
                         } else {
-                            // case 2: subsequent recomputation API
-                            POS_ASSERT(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation);
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Recomputation;
                         }
+                    } else {
+                        // case 2: subsequent recomputation API
+                        POS_ASSERT(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation);
+                    }
 
-                    } else if (wqe->type == ApiCxt_TypeId_Unexecuted){
+                } else if (wqe->type == ApiCxt_TypeId_Unexecuted){
 
-                        if(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation_Init){
-                            // case 3: no recomputation API, first unexecution API
+                    if(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation_Init){
+                        // case 3: no recomputation API, first unexecution API
+                        tmp_retval = this->start_gpu_ticker(/* stream_id */ 0);
+                        if(unlikely(tmp_retval != POS_SUCCESS)){
+                            POS_WARN("failed to start gpu ticker, restore measurement abandoned");
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
+                        } else {
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Unexecution;
+                        }
+                    } else if (this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation){
+                        // case 4: first unexecution API after recomputation API
+                        tmp_retval = this->stop_gpu_ticker(gpu_ticker, /* stream_id */ 0);
+                        if(unlikely(tmp_retval != POS_SUCCESS)){
+                            POS_WARN("failed to stop gpu ticker, restore measurement abandoned");
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
+                        } else {
+                            this->_metric_tickers.add(RESTORE_recomputation_ticks, gpu_ticker);
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Unexecution;
                             tmp_retval = this->start_gpu_ticker(/* stream_id */ 0);
                             if(unlikely(tmp_retval != POS_SUCCESS)){
                                 POS_WARN("failed to start gpu ticker, restore measurement abandoned");
                                 this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                            } else {
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Unexecution;
-                            }
-                        } else if (this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation){
-                            // case 4: first unexecution API after recomputation API
-                            tmp_retval = this->stop_gpu_ticker(gpu_ticker, /* stream_id */ 0);
-                            if(unlikely(tmp_retval != POS_SUCCESS)){
-                                POS_WARN("failed to stop gpu ticker, restore measurement abandoned");
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                            } else {
-                                this->_metric_tickers.add(RESTORE_recomputation_ticks, gpu_ticker);
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Unexecution;
-                                tmp_retval = this->start_gpu_ticker(/* stream_id */ 0);
-                                if(unlikely(tmp_retval != POS_SUCCESS)){
-                                    POS_WARN("failed to start gpu ticker, restore measurement abandoned");
-                                    this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                                }
                             }
-                        } else {
-                            // case 5: subsequent unexecution API
-                            POS_ASSERT(this->_restoring_phrase == kPOS_WorkRestorePhrase_Unexecution);
                         }
-
                     } else {
-                        POS_ASSERT(wqe->type == ApiCxt_TypeId_Normal);
+                        // case 5: subsequent unexecution API
+                        POS_ASSERT(this->_restoring_phrase == kPOS_WorkRestorePhrase_Unexecution);
+                    }
 
-                        if(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation_Init){
-                            // case 6: no recomputation API, no unexecution API
+                } else {
+                    POS_ASSERT(wqe->type == ApiCxt_TypeId_Normal);
+
+                    if(this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation_Init){
+                        // case 6: no recomputation API, no unexecution API
+                        this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
+                    } else if (this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation){
+                        // case 7: first normal API after recomputation API, no unexecution API
+                        tmp_retval = this->stop_gpu_ticker(gpu_ticker, /* stream_id */ 0);
+                        if(unlikely(tmp_retval != POS_SUCCESS)){
+                            POS_WARN("failed to stop gpu ticker, restore measurement abandoned");
                             this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                        } else if (this->_restoring_phrase == kPOS_WorkRestorePhrase_Recomputation){
-                            // case 7: first normal API after recomputation API, no unexecution API
-                            tmp_retval = this->stop_gpu_ticker(gpu_ticker, /* stream_id */ 0);
-                            if(unlikely(tmp_retval != POS_SUCCESS)){
-                                POS_WARN("failed to stop gpu ticker, restore measurement abandoned");
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                            } else {
-                                this->_metric_tickers.add(RESTORE_recomputation_ticks, gpu_ticker);
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                            }
-                        } else if (this->_restoring_phrase == kPOS_WorkRestorePhrase_Unexecution){
-                            // case 8: first normal API after unexecution API
-                            tmp_retval = this->stop_gpu_ticker(gpu_ticker, /* stream_id */ 0);
-                            if(unlikely(tmp_retval != POS_SUCCESS)){
-                                POS_WARN("failed to stop gpu ticker, restore measurement abandoned");
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                            } else {
-                                this->_metric_tickers.add(RESTORE_unexecution_ticks, gpu_ticker);
-                                this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
-                                this->__print_metrics();
-                            }
                         } else {
-                            POS_ERROR_C_DETAIL("shouldn't be here, this is a bug");
+                            this->_metric_tickers.add(RESTORE_recomputation_ticks, gpu_ticker);
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
                         }
-
+                    } else if (this->_restoring_phrase == kPOS_WorkRestorePhrase_Unexecution){
+                        // case 8: first normal API after unexecution API
+                        tmp_retval = this->stop_gpu_ticker(gpu_ticker, /* stream_id */ 0);
+                        if(unlikely(tmp_retval != POS_SUCCESS)){
+                            POS_WARN("failed to stop gpu ticker, restore measurement abandoned");
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
+                        } else {
+                            this->_metric_tickers.add(RESTORE_unexecution_ticks, gpu_ticker);
+                            this->_restoring_phrase = kPOS_WorkRestorePhrase_Normal;
+                            this->__print_metrics();
+                        }
+                    } else {
+                        POS_ERROR_C_DETAIL("shouldn't be here, this is a bug");
                     }
+
                 }
-            #endif
+            }
+        #endif
 
-            wqe->worker_s_tick = POSUtilTscTimer::get_tsc();
+        wqe->worker_s_tick = POSUtilTscTimer::get_tsc();
 
-            /*!
-             *  \brief  if the async ckpt thread is active, we cache this wqe for potential recomputation while restoring
-             */
-            if(unlikely(this->async_ckpt_cxt.TH_actve == true && this->async_ckpt_cxt.cmd->do_cow)){
-                this->_client->template push_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>(wqe);
-            }
+        /*!
+         *  \brief  if the async ckpt thread is active, we cache this wqe for potential recomputation while restoring
+         */
+        if(unlikely(this->async_ckpt_cxt.TH_actve == true && this->async_ckpt_cxt.cmd->do_cow)){
+            wqe->get_ref();
+            this->_client->template push_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>(wqe);
+        }
 
-            POS_CHECK_POINTER(wqe->api_cxt);
-            api_id = wqe->api_cxt->api_id;
-            api_meta = this->_ws->api_mgnr->api_metas[api_id];
+        POS_CHECK_POINTER(wqe->api_cxt);
+        api_id = wqe->api_cxt->api_id;
+        api_meta = this->_ws->api_mgnr->get_api_meta(api_id);
+        launch_function = this->_launch_function_table.get(api_id);
 
-            // check and restore broken handles
-            if(unlikely(POS_SUCCESS != __restore_broken_handles(wqe, &api_meta))){
-                POS_WARN_C("failed to check / restore broken handles: api_id(%lu)", api_id);
-                continue;
-            }
+        // check and restore broken handles
+        if(unlikely(POS_SUCCESS != __restore_broken_handles(wqe, api_meta))){
+            POS_WARN_C("failed to check / restore broken handles: api_id(%lu)", api_id);
+            continue;
+        }
 
-            #if POS_CONF_RUNTIME_EnableDebugCheck
-                if(unlikely(_launch_functions.count(api_id) == 0)){
-                    POS_ERROR_C_DETAIL(
-                        "runtime has no worker launch function for api %lu, need to implement", api_id
-                    );
-                }
-            #endif
 
-            if(unlikely(this->async_ckpt_cxt.TH_actve == true)){
-                #if POS_CONF_RUNTIME_EnableTrace
-                    nb_cow_handle = 0; nb_cow_stateful_handle = 0; cow_size = 0;
-                #endif
+        if(unlikely(this->async_ckpt_cxt.TH_actve == true)){
+            #if POS_CONF_RUNTIME_EnableTrace
+                nb_cow_handle = 0; nb_cow_stateful_handle = 0; cow_size = 0;
+            #endif
 
-                /*!
-                 *  \brief  before launching the API, we need to preserve the state of all stateful resources for checkpointing
-                 *  \note   there're serval cases handle in checkpoint_add:
-                 *          [1] the state hasn't been checkpoint yet, then it conducts CoW on the state
-                 *          [2] the state is under checkpointing, then it blocks until the checkpoint finished
-                 *          [3] the state is already checkpointed, then it directly returns
-                 */
-                for(auto &inout_handle_view : wqe->inout_handle_views){
-                    POS_CHECK_POINTER(handle = inout_handle_view.handle);
-                    if(unlikely(   handle->status == kPOS_HandleStatus_Deleted 
-                                || handle->status == kPOS_HandleStatus_Create_Pending
-                                || handle->status == kPOS_HandleStatus_Broken
-                    )){
-                        continue;
-                    }
-                    if( this->async_ckpt_cxt.cmd->do_cow 
-                        && this->async_ckpt_cxt.checkpoint_version_map.count(handle) > 0
-                        && this->async_ckpt_cxt.dirty_handles.count(handle) == 0
-                    ){
-                        #if POS_CONF_RUNTIME_EnableTrace
-                            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
-                            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
-                        #endif
-                        tmp_retval = handle->checkpoint_add(
-                            /* version_id */ this->async_ckpt_cxt.checkpoint_version_map[handle],
-                            /* stream_id */ this->_cow_stream_id
-                        );
-                        POS_ASSERT(tmp_retval == POS_SUCCESS || tmp_retval == POS_WARN_ABANDONED || tmp_retval == POS_FAILED_ALREADY_EXIST);
-                        #if POS_CONF_RUNTIME_EnableTrace
-                            if(tmp_retval == POS_SUCCESS){
-                                this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
-                                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_done_times_by_worker_thread);
-                                this->async_ckpt_cxt.metric_reducers.reduce(
-                                    /* index */ checkpoint_async_cxt_t::CKPT_cow_bytes_by_worker_thread,
-                                    /* value */ handle->state_size
-                                );
-                                if(handle->state_size > 0){ cow_size += handle->state_size; }
-                            } else if(tmp_retval == POS_WARN_ABANDONED){
-                                this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
-                                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_block_times_by_worker_thread);
-                            }
-                        #endif
-                    }
+            /*!
+             *  \brief  before launching the API, we need to preserve the state of all stateful resources for checkpointing
+             *  \note   there're serval cases handle in checkpoint_add:
+             *          [1] the state hasn't been checkpoint yet, then it conducts CoW on the state
+             *          [2] the state is under checkpointing, then it blocks until the checkpoint finished
+             *          [3] the state is already checkpointed, then it directly returns
+             */
+            for(auto &inout_handle_view : wqe->inout_handle_views){
+                POS_CHECK_POINTER(handle = inout_handle_view.handle);
+                if(unlikely(   handle->status == kPOS_HandleStatus_Deleted 
+                            || handle->status == kPOS_HandleStatus_Create_Pending
+                            || handle->status == kPOS_HandleStatus_Broken
+                )){
+                    continue;
+                }
+                if( this->async_ckpt_cxt.cmd->do_cow 
+                    && this->async_ckpt_cxt.checkpoint_version_map.contains(handle)
+                    && !this->async_ckpt_cxt.dirty_handles.contains(handle)
+                ){
+                    #if POS_CONF_RUNTIME_EnableTrace
+                        this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
+                        this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
+                    #endif
+                    tmp_retval = handle->checkpoint_add(
+                        /* version_id */ this->async_ckpt_cxt.checkpoint_version_map.get(handle),
+                        /* stream_id */ this->_cow_stream_id
+                    );
+                    POS_ASSERT(tmp_retval == POS_SUCCESS || tmp_retval == POS_WARN_ABANDONED || tmp_retval == POS_FAILED_ALREADY_EXIST);
+                    #if POS_CONF_RUNTIME_EnableTrace
+                        if(tmp_retval == POS_SUCCESS){
+                            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
+                            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_done_times_by_worker_thread);
+                            this->async_ckpt_cxt.metric_reducers.reduce(
+                                /* index */ checkpoint_async_cxt_t::CKPT_cow_bytes_by_worker_thread,
+                                /* value */ handle->state_size
+                            );
+                            if(handle->state_size > 0){ cow_size += handle->state_size; }
+                        } else if(tmp_retval == POS_WARN_ABANDONED){
+                            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
+                            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_block_times_by_worker_thread);
+                        }
+                    #endif
+                }
 
-                    // note: we also include those stateless handles here
-                    if(this->async_ckpt_cxt.dirty_handles.count(handle) == 0){
-                        this->async_ckpt_cxt.dirty_handles.insert(handle);
-                        this->async_ckpt_cxt.dirty_handle_state_size += handle->state_size;
-                    }
+                // note: we also include those stateless handles here
+                if(this->async_ckpt_cxt.dirty_handles.insert(handle)){
+                    this->async_ckpt_cxt.dirty_handle_state_size += handle->state_size;
+                }
+            }
+            for(auto &out_handle_view : wqe->output_handle_views){
+                POS_CHECK_POINTER(handle = out_handle_view.handle);
+                if(unlikely(   handle->status == kPOS_HandleStatus_Deleted 
+                            || handle->status == kPOS_HandleStatus_Create_Pending
+                            || handle->status == kPOS_HandleStatus_Broken
+                )){
+                    continue;
+                }
+                if( this->async_ckpt_cxt.cmd->do_cow 
+                    && this->async_ckpt_cxt.checkpoint_version_map.contains(handle)
+                    && !this->async_ckpt_cxt.dirty_handles.contains(handle)
+                ){
+                    #if POS_CONF_RUNTIME_EnableTrace
+                        this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
+                        this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
+                    #endif
+                    tmp_retval = handle->checkpoint_add(
+                        /* version_id */ this->async_ckpt_cxt.checkpoint_version_map.get(handle),
+                        /* stream_id */ this->_cow_stream_id
+                    );
+                    POS_ASSERT(tmp_retval == POS_SUCCESS || tmp_retval == POS_WARN_ABANDONED || tmp_retval == POS_FAILED_ALREADY_EXIST);
+                    #if POS_CONF_RUNTIME_EnableTrace
+                        if(tmp_retval == POS_SUCCESS){
+                            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
+                            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_done_times_by_worker_thread);
+                            this->async_ckpt_cxt.metric_reducers.reduce(
+                                /* index */ checkpoint_async_cxt_t::CKPT_cow_bytes_by_worker_thread,
+                                /* value */ handle->state_size
+                            );
+                            if(handle->state_size > 0){ cow_size += handle->state_size; }
+                        } else if(tmp_retval == POS_WARN_ABANDONED){
+                            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
+                            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_block_times_by_worker_thread);
+                        }
+                    #endif
                 }
-                for(auto &out_handle_view : wqe->output_handle_views){
-                    POS_CHECK_POINTER(handle = out_handle_view.handle);
-                    if(unlikely(   handle->status == kPOS_HandleStatus_Deleted 
-                                || handle->status == kPOS_HandleStatus_Create_Pending
-                                || handle->status == kPOS_HandleStatus_Broken
-                    )){
-                        continue;
-                    }
-                    if( this->async_ckpt_cxt.cmd->do_cow 
-                        && this->async_ckpt_cxt.checkpoint_version_map.count(handle) > 0
-                        && this->async_ckpt_cxt.dirty_handles.count(handle) == 0
-                    ){
-                        #if POS_CONF_RUNTIME_EnableTrace
-                            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
-                            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
-                        #endif
-                        tmp_retval = handle->checkpoint_add(
-                            /* version_id */ this->async_ckpt_cxt.checkpoint_version_map[handle],
-                            /* stream_id */ this->_cow_stream_id
-                        );
-                        POS_ASSERT(tmp_retval == POS_SUCCESS || tmp_retval == POS_WARN_ABANDONED || tmp_retval == POS_FAILED_ALREADY_EXIST);
-                        #if POS_CONF_RUNTIME_EnableTrace
-                            if(tmp_retval == POS_SUCCESS){
-                                this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_worker_thread);
-                                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_done_times_by_worker_thread);
-                                this->async_ckpt_cxt.metric_reducers.reduce(
-                                    /* index */ checkpoint_async_cxt_t::CKPT_cow_bytes_by_worker_thread,
-                                    /* value */ handle->state_size
-                                );
-                                if(handle->state_size > 0){ cow_size += handle->state_size; }
-                            } else if(tmp_retval == POS_WARN_ABANDONED){
-                                this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_worker_thread);
-                                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_block_times_by_worker_thread);
-                            }
-                        #endif
-                    }
 
-                    // note: we might also include those stateless handles here
-                    if(this->async_ckpt_cxt.dirty_handles.count(handle) == 0){
-                        this->async_ckpt_cxt.dirty_handles.insert(handle);
-                        this->async_ckpt_cxt.dirty_handle_state_size += handle->state_size;
-                    }
+                // note: we might also include those stateless handles here
+                if(this->async_ckpt_cxt.dirty_handles.insert(handle)){
+                    this->async_ckpt_cxt.dirty_handle_state_size += handle->state_size;
                 }
+            }
 
-                #if POS_CONF_RUNTIME_EnableTrace
-                    #if POS_CONF_RUNTIME_EnableMemoryTrace
-                        if(cow_size > 0)
-                            this->_metric_sequences.add_spot(CKPT_cow_size, cow_size);
-                    #endif
+            #if POS_CONF_RUNTIME_EnableTrace
+                #if POS_CONF_RUNTIME_EnableMemoryTrace
+                    if(cow_size > 0)
+                        this->_metric_sequences.add_spot(CKPT_cow_size, cow_size);
                 #endif
-            } // this->async_ckpt_cxt.TH_actve == true
+            #endif
+        } // this->async_ckpt_cxt.TH_actve == true
 
-            launch_retval = (*(_launch_functions[api_id]))(_ws, wqe);
-            wqe->worker_e_tick = POSUtilTscTimer::get_tsc();
+        if(likely(launch_function != nullptr)){
+            launch_retval = (*launch_function)(_ws, wqe);
+        } else {
+            POS_WARN_C_DETAIL("runtime has no worker launch function for api %lu, need to implement", api_id);
+            launch_retval = POS_FAILED_NOT_IMPLEMENTED;
+        }
+        wqe->worker_e_tick = POSUtilTscTimer::get_tsc();
+        this->__mark_dirty_state(wqe);
+        this->_client->worker_api_latency->record(
+            api_id, kPOS_APILatencyStage_Worker, wqe->worker_e_tick - wqe->worker_s_tick
+        );
 
-            // cast return code
-            wqe->api_cxt->return_code = _ws->api_mgnr->cast_pos_retval(
-                /* pos_retval */ launch_retval, 
-                /* library_id */ api_meta.library_id
-            );
+        // cast return code
+        wqe->api_cxt->return_code = _ws->api_mgnr->cast_pos_retval(
+            /* pos_retval */ launch_retval, 
+            /* library_id */ api_meta->library_id
+        );
 
-            // check whether the execution is success
-            if(unlikely(launch_retval != POS_SUCCESS)){
-                wqe->status = kPOS_API_Execute_Status_Worker_Failed;
-            }
+        // check whether the execution is success
+        if(unlikely(launch_retval != POS_SUCCESS)){
+            wqe->status = kPOS_API_Execute_Status_Worker_Failed;
+        }
 
-            // check whether we need to return to frontend
-            if(wqe->has_return == false){
-                // we only return the QE back to frontend when it hasn't been returned before
-                wqe->return_tick = POSUtilTscTimer::get_tsc();
-                this->_client->template push_q<kPOS_QueueDirection_Rpc2Worker, kPOS_QueueType_ApiCxt_CQ>(wqe);
-                wqe->has_return = true;
-            }
+        POS_ASSERT(wqe->id >= this->_max_wqe_id);
+        this->_max_wqe_id = wqe->id;
 
-            POS_ASSERT(wqe->id >= this->_max_wqe_id);
-            this->_max_wqe_id = wqe->id;
+        // check whether we need to return to frontend
+        if(wqe->has_return == false){
+            // we only return the QE back to frontend when it hasn't been returned before,
+            // note that the wqe might be recycled once it's returned
+            wqe->return_tick = POSUtilTscTimer::get_tsc();
+            wqe->has_return = true;
+            this->_client->template complete_apicxt<kPOS_QueueDirection_Rpc2Worker>(wqe);
+        } else {
+            // the QE was returned by the parser, drop the reference held by the worker
+            wqe->put_ref();
         }
     }
+
+    return nb_polled;
 }
 
 
 void POSWorker::__checkpoint_TH_async_thread() {
-    uint64_t i;
+    uint64_t i, lane_id;
     pos_u64id_t checkpoint_version;
     pos_retval_t retval = POS_SUCCESS, dirty_retval = POS_SUCCESS;
     POSCommand_QE_t *cmd;
-    POSHandle *handle;
-    uint64_t s_tick = 0, e_tick = 0;
-    uint64_t commit_stream_id;
-    
-    std::set<POSHandle*> async_commited_handles;
+    std::vector<std::pair<POSHandle*, pos_u64id_t>> ckpt_handles;
+    std::vector<std::thread*> lane_threads;
     typename std::set<POSHandle*>::iterator set_iter;
 
-    // todo: we need an interface to know how many D2H engine we have,
-    //      to decide whether we need this lock
-    static constexpr bool TMP_enable_mem_lock = false;
-
     POS_CHECK_POINTER(cmd = this->async_ckpt_cxt.cmd);
-    POS_ASSERT(this->_ckpt_stream_id != 0);
-
-    #if POS_CONF_EVAL_CkptEnablePipeline == 1
-        POS_ASSERT(this->_ckpt_commit_stream_id != 0);
-    #endif
 
+    // step 1: collect all stateful handles to be committed
     for(set_iter=cmd->stateful_handles.begin(); set_iter!=cmd->stateful_handles.end(); set_iter++){
         POSHandle *handle = *set_iter;
         POS_CHECK_POINTER(handle);
@@ -774,229 +904,282 @@ void POSWorker::__checkpoint_TH_async_thread() {
                     || handle->status == kPOS_HandleStatus_Create_Pending
                     || handle->status == kPOS_HandleStatus_Broken
         )){
-            goto membus_lock_check;
+            continue;
         }
 
-        if(unlikely(this->async_ckpt_cxt.checkpoint_version_map.count(handle) == 0)){
+        if(unlikely(!this->async_ckpt_cxt.checkpoint_version_map.contains(handle))){
             POS_WARN_C("failed to checkpoint handle, no checkpoint version provided: client_addr(%p)", handle->client_addr);
-            goto membus_lock_check;
+            continue;
         }
 
-        checkpoint_version = this->async_ckpt_cxt.checkpoint_version_map[handle];
+        checkpoint_version = this->async_ckpt_cxt.checkpoint_version_map.get(handle);
+        ckpt_handles.push_back({ handle, checkpoint_version });
+    }
+
+    // step 2: assign handles to commit lanes, the largest first to the least loaded lane,
+    //         so that the lanes (and hence the copy engines) finish at roughly the same time
+    std::sort(ckpt_handles.begin(), ckpt_handles.end(), [](const auto& a, const auto& b){
+        return a.first->state_size > b.first->state_size;
+    });
+    for(lane_id=0; lane_id<POS_CONF_EVAL_CkptCommitLanes; lane_id++){
+        this->async_ckpt_cxt.lanes[lane_id].reset();
+    }
+    for(auto& ckpt_handle : ckpt_handles){
+        auto& lane = *std::min_element(
+            this->async_ckpt_cxt.lanes, this->async_ckpt_cxt.lanes + POS_CONF_EVAL_CkptCommitLanes,
+            [](const auto& a, const auto& b){ return a.nb_bytes < b.nb_bytes; }
+        );
+        lane.handles.push_back(ckpt_handle);
+        lane.nb_bytes += ckpt_handle.first->state_size;
+    }
+
+    // step 3: commit and persist within all lanes, the first lane runs on this thread
+    this->async_ckpt_cxt.inflight_bytes = 0;
+    #if POS_CONF_RUNTIME_EnableTrace
+        this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::PERSIST_handle_ticks);
+    #endif
+    for(lane_id=1; lane_id<POS_CONF_EVAL_CkptCommitLanes; lane_id++){
+        if(this->async_ckpt_cxt.lanes[lane_id].handles.size() == 0){ continue; }
+        lane_threads.push_back(new std::thread(&POSWorker::__checkpoint_TH_commit_lane, this, lane_id));
+        POS_CHECK_POINTER(lane_threads.back());
+    }
+    this->__checkpoint_TH_commit_lane(0);
+    for(i=0; i<lane_threads.size(); i++){
+        lane_threads[i]->join();
+        delete lane_threads[i];
+    }
+    #if POS_CONF_RUNTIME_EnableTrace
+        this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_handle_ticks);
+    #endif
+
+    // step 4: collect results of all lanes
+    for(lane_id=0; lane_id<POS_CONF_EVAL_CkptCommitLanes; lane_id++){
+        auto& lane = this->async_ckpt_cxt.lanes[lane_id];
+        if(unlikely(lane.retval != POS_SUCCESS)){ dirty_retval = lane.retval; }
+        #if POS_CONF_RUNTIME_EnableTrace
+            for(auto& tick : lane.ticks){ this->async_ckpt_cxt.metric_tickers.add(tick.first, tick.second); }
+            for(auto& counter : lane.counters){ this->async_ckpt_cxt.metric_counters.add_counter(counter.first, counter.second); }
+            for(auto& reduce : lane.reduces){ this->async_ckpt_cxt.metric_reducers.reduce(reduce.first, reduce.second); }
+        #endif
+    }
+
+    // if this is a pre-dump command, we return the CQE here
+    if(cmd->type == kPOS_Command_Parser2Worker_PreDump){
+        // mark overlap ckpt stop immediately
+        this->async_ckpt_cxt.TH_actve = false;
+
+        // make sure all persisting raised by this command are finished
+        #if POS_CONF_RUNTIME_EnableTrace
+            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::PERSIST_handle_ticks);
+        #endif
+        if(unlikely(POS_SUCCESS != (retval = this->async_ckpt_cxt.persist_group.wait()))){
+            POS_WARN_C("failed to persist handles: retval(%d)", retval);
+            dirty_retval = retval;
+        }
+        #if POS_CONF_RUNTIME_EnableTrace
+            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_handle_ticks);
+            this->async_ckpt_cxt.metric_counters.add_counter(
+                checkpoint_async_cxt_t::PERSIST_handle_times, this->async_ckpt_cxt.persist_group.get_nb_done()
+            );
+        #endif
+
+        cmd->retval = dirty_retval;
+        retval = this->_client->template push_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_CQ>(cmd);
+        if(unlikely(retval != POS_SUCCESS)){
+            POS_WARN_C("failed to reply ckpt cmd cq to parser: retval(%u)", retval);
+        }
+
+        // print metrics
+        #if POS_CONF_RUNTIME_EnableTrace
+            this->async_ckpt_cxt.print_metrics();
+        #endif
+
+        goto exit;
+    }
+
+    // raise bottom-half of dumping (e.g., dirty-copy/recomputation, dump API contexts, etc.)
+    this->async_ckpt_cxt.BH_active = true;
+
+ exit:
+    ;
+}
+
+
+void POSWorker::__checkpoint_TH_commit_lane(uint64_t lane_id) {
+    pos_retval_t retval = POS_SUCCESS;
+    POSCommand_QE_t *cmd;
+    POSHandle *handle;
+    pos_u64id_t checkpoint_version;
+    uint64_t commit_stream_id, batch_bytes = 0;
+    std::vector<std::pair<POSHandle*, pos_u64id_t>> batch;
+    checkpoint_async_cxt_t::commit_lane_t *lane;
+
+    // committed handles are synchronized and persisted every this many bytes, so that small handles
+    // share a single synchronization, and persisting starts before all handles are committed
+    static constexpr uint64_t kCommitBatchBytes = MB(64);
+    static constexpr uint64_t kInflightBytes = MB(POS_CONF_EVAL_CkptInflightMb);
+
+    #if POS_CONF_RUNTIME_EnableTrace
+        uint64_t s_tick;
+    #endif
+
+    POS_ASSERT(lane_id < POS_CONF_EVAL_CkptCommitLanes);
+    POS_CHECK_POINTER(cmd = this->async_ckpt_cxt.cmd);
+    lane = &(this->async_ckpt_cxt.lanes[lane_id]);
+
+    POS_ASSERT(this->_ckpt_stream_ids[lane_id] != 0);
+    #if POS_CONF_EVAL_CkptEnablePipeline == 1
+        POS_ASSERT(this->_ckpt_commit_stream_ids[lane_id] != 0);
+        commit_stream_id = this->_ckpt_commit_stream_ids[lane_id];
+    #else
+        commit_stream_id = this->_ckpt_stream_ids[lane_id];
+    #endif
+
+    #if POS_CONF_RUNTIME_EnableTrace
+        auto __record_tick = [&](checkpoint_async_cxt_t::metrics_ticker_type_t index, uint64_t s_tick){
+            lane->ticks.push_back({ index, POSUtilTscTimer::get_tsc() - s_tick });
+        };
+    #endif
+
+    // synchronize the commit of the batch, then persist it asynchronously
+    auto __flush_batch = [&](){
+        #if POS_CONF_RUNTIME_EnableTrace
+            s_tick = POSUtilTscTimer::get_tsc();
+        #endif
+        if(unlikely(POS_SUCCESS != (retval = this->sync(commit_stream_id)))){
+            POS_WARN_C("failed to sync the commit within ckpt lane: lane_id(%lu)", lane_id);
+            lane->retval = retval;
+        }
+        #if POS_CONF_RUNTIME_EnableTrace
+            __record_tick(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread, s_tick);
+        #endif
+
+        for(auto& committed : batch){
+            retval = committed.first->checkpoint_persist_async(
+                /* ckpt_dir */ cmd->ckpt_dir,
+                /* with_state */ true,
+                /* version_id */ committed.second,
+                /* persist_pool */ this->_ws->persist_pool,
+                /* persist_group */ &this->async_ckpt_cxt.persist_group
+            );
+            if(unlikely(retval != POS_SUCCESS)){
+                POS_WARN(
+                    "failed to submit persisting: hid(%lu), ckpt_dir(%s) version_id(%lu)",
+                    committed.first->id, cmd->ckpt_dir.c_str(), committed.second
+                );
+                lane->retval = retval;
+                this->async_ckpt_cxt.inflight_bytes -= committed.first->state_size;
+                continue;
+            }
+            lane->persisting_handles.push_back(committed.first);
+        }
+
+        batch.clear();
+        batch_bytes = 0;
+    };
+
+    for(auto& ckpt_handle : lane->handles){
+        POS_CHECK_POINTER(handle = ckpt_handle.first);
+        checkpoint_version = ckpt_handle.second;
+
+        // bound the state committed but not yet persisted, by waiting persisting raised by this lane;
+        // a lane with nothing to wait goes ahead, so that lanes never wait on each other
+        while(this->async_ckpt_cxt.inflight_bytes + handle->state_size > kInflightBytes){
+            if(lane->persisting_handles.size() > 0){
+                POSHandle *persisting_handle = lane->persisting_handles.front();
+                lane->persisting_handles.pop_front();
+                if(unlikely(POS_SUCCESS != (retval = persisting_handle->sync_persist()))){
+                    POS_WARN_C("failed to persist handle: hid(%lu)", persisting_handle->id);
+                    lane->retval = retval;
+                }
+                this->async_ckpt_cxt.inflight_bytes -= persisting_handle->state_size;
+            } else if(batch.size() > 0){
+                __flush_batch();
+            } else {
+                break;
+            }
+        }
 
-        // step 1: add & commit of all stateful handles
     #if POS_CONF_EVAL_CkptEnablePipeline == 1
         /*!
          *  \brief  [phrase 1]  add the state of this handle from its origin buffer
          *  \note   the adding process is sync as it might disturbed by CoW
          */
         #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_ckpt_thread);
-            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_ckpt_thread);
+            s_tick = POSUtilTscTimer::get_tsc();
         #endif
         retval = handle->checkpoint_add(
             /* version_id */    checkpoint_version,
-            /* stream_id */     this->_ckpt_stream_id
+            /* stream_id */     this->_ckpt_stream_ids[lane_id]
         );
         POS_ASSERT(retval == POS_SUCCESS || retval == POS_WARN_ABANDONED || retval == POS_FAILED_ALREADY_EXIST);
         #if POS_CONF_RUNTIME_EnableTrace
             if(retval == POS_SUCCESS){
-                this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_ckpt_thread);
-                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_done_times_by_ckpt_thread);
-                this->async_ckpt_cxt.metric_reducers.reduce(
-                    /* index */ checkpoint_async_cxt_t::CKPT_cow_bytes_by_ckpt_thread,
-                    /* value */ handle->state_size
-                );
+                __record_tick(checkpoint_async_cxt_t::CKPT_cow_done_ticks_by_ckpt_thread, s_tick);
+                lane->counters.push_back({ checkpoint_async_cxt_t::CKPT_cow_done_times_by_ckpt_thread, 1 });
+                lane->reduces.push_back({ checkpoint_async_cxt_t::CKPT_cow_bytes_by_ckpt_thread, handle->state_size });
             } else if(retval == POS_WARN_ABANDONED){
-                this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_ckpt_thread);
-                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_cow_block_times_by_ckpt_thread);
+                __record_tick(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_ckpt_thread, s_tick);
+                lane->counters.push_back({ checkpoint_async_cxt_t::CKPT_cow_block_times_by_ckpt_thread, 1 });
             }
         #endif
 
         /*!
          *  \brief  [phrase 2]  commit the resource state from cache
          */
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread);
-        #endif
-
         retval = handle->checkpoint_commit_async(
             /* version_id */    checkpoint_version,
-            /* stream_id */     this->_ckpt_commit_stream_id
+            /* stream_id */     commit_stream_id
         );
         if(unlikely(retval != POS_SUCCESS)){
-            POS_WARN("failed to async commit the handle within ckpt thread: server_addr(%p), version_id(%lu)", handle->server_addr, checkpoint_version);
-            dirty_retval = retval;
-            goto membus_lock_check;
-        }
-        commit_stream_id = this->_ckpt_commit_stream_id;
-
-        if constexpr (TMP_enable_mem_lock == true){
-            /*!
-             *  \note   originally the commit process is async as it would never be disturbed by CoW, but we also need to prevent
-             *          ckpt memcpy conflict with normal memcpy, so we sync the execution here to check the memcpy flag
-             *  \todo   how many D2H engine do we have?
-             */
-            retval = this->sync(this->_ckpt_commit_stream_id);
-            if(unlikely(retval != POS_SUCCESS)){
-                POS_WARN("failed to sync the commit within ckpt thread: server_addr(%p), version_id(%lu)", handle->server_addr, checkpoint_version);
-                dirty_retval = retval;
-            }
-        } else {
-            async_commited_handles.insert(handle);
+            POS_WARN("failed to async commit the handle within ckpt lane: server_addr(%p), version_id(%lu)", handle->server_addr, checkpoint_version);
+            lane->retval = retval;
+            continue;
         }
-
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_reducers.reduce(
-                /* index */ checkpoint_async_cxt_t::CKPT_commit_bytes_by_ckpt_thread,
-                /* value */ handle->state_size
-            );
-            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_commit_times_by_ckpt_thread);
-            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread);
-        #endif
     #else
         /*!
          *  \brief  [phrase 1]  commit the resource state from origin buffer or CoW cache
          *  \note   if the CoW is ongoing or finished, it commit from cache; otherwise it commit from origin buffer
          */
+        bool is_blocked = false;
+
         #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread);
+            s_tick = POSUtilTscTimer::get_tsc();
         #endif
-    
         retval = handle->checkpoint_commit_async(
             /* version_id */    checkpoint_version,
-            /* stream_id */     this->_ckpt_stream_id
+            /* stream_id */     commit_stream_id,
+            /* is_blocked */    &is_blocked
         );
-        if(unlikely(retval != POS_SUCCESS && retval != POS_WARN_ABANDONED)){
-            POS_WARN("failed to async commit the handle within ckpt thread: server_addr(%p), version_id(%lu)", handle->server_addr, checkpoint_version);
-            dirty_retval = retval;
-            goto membus_lock_check;
-        }
-        commit_stream_id = this->_ckpt_stream_id;
-
-        if constexpr (TMP_enable_mem_lock == true){
-            // the sync would be done by persist below, we omit here
-            retval = this->sync(this->_ckpt_stream_id);
-            if(unlikely(retval != POS_SUCCESS)){
-                POS_WARN("failed to sync the commit within ckpt thread: server_addr(%p), version_id(%lu)", handle->server_addr, checkpoint_version);
-                dirty_retval = retval;
-            }
-        } else {
-            async_commited_handles.insert(handle);
-        }
-
         #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_reducers.reduce(
-                /* index */ checkpoint_async_cxt_t::CKPT_commit_bytes_by_ckpt_thread,
-                /* value */ handle->state_size
-            );
-            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_commit_times_by_ckpt_thread);
-            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread);
-        #endif
-    #endif
-
-    membus_lock_check:
-        if constexpr (TMP_enable_mem_lock == true){
-            /*!
-            *  \note   we need to avoid conflict between ckpt memcpy and normal memcpy, and we will stop once it occurs
-            *  \todo   we only need to enable this once we only have one DMA engine on-device,
-            *          we need an interface to get such information
-            */
-            while(this->async_ckpt_cxt.membus_lock == true && !this->_stop_flag){ /* block */ }
-        }
-    }
-
-    if constexpr (TMP_enable_mem_lock == false){
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread);
-        #endif
-    
-        #if POS_CONF_EVAL_CkptEnablePipeline == 1
-            this->sync(this->_ckpt_commit_stream_id);
-        #else
-            this->sync(this->_ckpt_stream_id);
-        #endif
-
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_commit_ticks_by_ckpt_thread);
+            if(is_blocked){
+                __record_tick(checkpoint_async_cxt_t::CKPT_cow_block_ticks_by_ckpt_thread, s_tick);
+                lane->counters.push_back({ checkpoint_async_cxt_t::CKPT_cow_block_times_by_ckpt_thread, 1 });
+            }
         #endif
-    }
-
-    // step 2: asynchronously persist all stateful handles
-    #if POS_CONF_RUNTIME_EnableTrace
-        this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::PERSIST_handle_ticks);
-    #endif
-    for(set_iter=async_commited_handles.begin(); set_iter!=async_commited_handles.end(); set_iter++){
-        POSHandle *handle = *set_iter;
-        POS_CHECK_POINTER(handle);
-        
-        checkpoint_version = this->async_ckpt_cxt.checkpoint_version_map[handle];
-
-        retval = handle->checkpoint_persist_async(
-            /* ckpt_dir */ cmd->ckpt_dir,
-            /* with_state */ true,
-            /* version_id */ checkpoint_version
-        );
-        if(unlikely(retval != POS_SUCCESS)){
-            POS_WARN(
-                "failed to async raise persist thread: hid(%lu), ckpt_dir(%s) version_id(%lu)",
-                handle->id,
-                cmd->ckpt_dir,
-                checkpoint_version
-            );
-            dirty_retval = retval;
+        if(unlikely(retval != POS_SUCCESS && retval != POS_WARN_ABANDONED)){
+            POS_WARN("failed to async commit the handle within ckpt lane: server_addr(%p), version_id(%lu)", handle->server_addr, checkpoint_version);
+            lane->retval = retval;
             continue;
         }
-        this->async_ckpt_cxt.persist_handles.insert(handle);
-    }
-    #if POS_CONF_RUNTIME_EnableTrace
-        this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_handle_ticks);
     #endif
 
-    // if this is a pre-dump command, we return the CQE here
-    if(cmd->type == kPOS_Command_Parser2Worker_PreDump){
-        // mark overlap ckpt stop immediately
-        this->async_ckpt_cxt.TH_actve = false;
-
-        // make sure all async persist thread are finished
         #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::PERSIST_handle_ticks);
-        #endif
-        for(set_iter=this->async_ckpt_cxt.persist_handles.begin(); set_iter!=this->async_ckpt_cxt.persist_handles.end(); set_iter++){
-            POSHandle *handle = *set_iter;
-            POS_CHECK_POINTER(handle);
-            if(unlikely(POS_SUCCESS != (retval = handle->sync_persist()))){
-                POS_WARN_C("failed to sync async persist thread of handle: hid(%lu)", handle->id);
-                dirty_retval = retval;
-                continue;
-            }
-            #if POS_CONF_RUNTIME_EnableTrace
-                this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::PERSIST_handle_times);
-            #endif
-        }
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_handle_ticks);
+            lane->reduces.push_back({ checkpoint_async_cxt_t::CKPT_commit_bytes_by_ckpt_thread, handle->state_size });
+            lane->counters.push_back({ checkpoint_async_cxt_t::CKPT_commit_times_by_ckpt_thread, 1 });
         #endif
 
-        cmd->retval = dirty_retval;
-        retval = this->_client->template push_q<kPOS_QueueDirection_Parser2Worker, kPOS_QueueType_Cmd_CQ>(cmd);
-        if(unlikely(retval != POS_SUCCESS)){
-            POS_WARN_C("failed to reply ckpt cmd cq to parser: retval(%u)", retval);
+        this->async_ckpt_cxt.inflight_bytes += handle->state_size;
+        batch.push_back(ckpt_handle);
+        batch_bytes += handle->state_size;
+        if(batch_bytes >= kCommitBatchBytes){
+            __flush_batch();
         }
-
-        // print metrics
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.print_metrics();
-        #endif
-
-        goto exit;
     }
 
-    // raise bottom-half of dumping (e.g., dirty-copy/recomputation, dump API contexts, etc.)
-    this->async_ckpt_cxt.BH_active = true;
-
- exit:
-    ;
+    if(batch.size() > 0){
+        __flush_batch();
+    }
 }
 
 
@@ -1005,14 +1188,16 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
     POSHandle *handle;
     pos_u64id_t max_wqe_id = 0;
     uint64_t nb_ckpt_handles = 0;
-    uint64_t i, nb_ckpt_wqes;
-    uint64_t nb_ckpt_dirty_handles = 0, dirty_ckpt_size = 0;
+    uint64_t i, nb_ckpt_wqes = 0, worker_ticks = 0, d2h_ticks = 0, copied_tick = 0;
+    uint64_t nb_ckpt_dirty_handles = 0, dirty_ckpt_size = 0, round_bytes = 0;
     typename std::set<POSHandle*>::iterator set_iter;
+    std::vector<POSHandle*> dirty_handles;
     POSAPIContext_QE *wqe;
     std::vector<POSAPIContext_QE*> wqes;
     POSCommand_QE_t *cmd;
     uint64_t s_tick, e_tick;
     bool do_dirty_copy = false;
+    POSCheckpointCostModel::estimation_t cost_est;
 
     POS_CHECK_POINTER(cmd = this->async_ckpt_cxt.cmd);
 
@@ -1076,15 +1261,16 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
         retval = handle->checkpoint_persist_async(
             /* ckpt_dir */ cmd->ckpt_dir,
             /* with_state */ false,
-            /* version_id */ 0
+            /* version_id */ 0,
+            /* persist_pool */ this->_ws->persist_pool,
+            /* persist_group */ &this->async_ckpt_cxt.persist_group
         );
         if(unlikely(retval != POS_SUCCESS)){
             POS_WARN(
-                "failed to async raise persist thread: hid(%lu), ckpt_dir(%s) version_id(%lu)", handle->id, cmd->ckpt_dir
+                "failed to submit persisting: hid(%lu), ckpt_dir(%s) version_id(%lu)", handle->id, cmd->ckpt_dir
             );
             goto sync_persist;
         }
-        this->async_ckpt_cxt.persist_handles.insert(handle);
         nb_ckpt_handles += 1;
     }
     #if POS_CONF_RUNTIME_EnableTrace
@@ -1094,29 +1280,51 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
 
     // step 3: decide either dump recomputation APIs (only if CoW is enabled) or do dirty copy
     if(cmd->do_cow == true){
-        if((this->async_ckpt_cxt.dirty_handle_state_size) >= GB(2)){
-            // case: too many dirty copies, we dump recomputation APIs
+        // collect APIs executed since the top-half, along with their recorded worker time
+        wqes.clear();
+        this->_client->template poll_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>(&wqes);
+        nb_ckpt_wqes = wqes.size();
+        for(i=0; i<nb_ckpt_wqes; i++){
+            POS_CHECK_POINTER(wqe = wqes[i]);
+            if(likely(wqe->worker_e_tick > wqe->worker_s_tick)){
+                worker_ticks += wqe->worker_e_tick - wqe->worker_s_tick;
+            }
+        }
+
+        cost_est = this->_ws->ckpt_cost_model.estimate(
+            /* dirty_bytes */ this->async_ckpt_cxt.dirty_handle_state_size,
+            /* nb_wqes */ nb_ckpt_wqes,
+            /* worker_us */ this->_ws->tsc_timer.tick_to_us(worker_ticks)
+        );
+        POS_LOG(
+            "[Dirty Behaviour] estimation: "
+            "dirty copy %.2f ms (dirty-copies(%s), d2h %.2f ms, persist %.2f ms), "
+            "recompute %.2f ms (#apis(%lu), dump %.2f ms, replay %.2f ms)",
+            cost_est.dirty_copy_us / 1000.0,
+            POSUtilSystem::format_byte_number(this->async_ckpt_cxt.dirty_handle_state_size).c_str(),
+            cost_est.d2h_us / 1000.0, cost_est.persist_us / 1000.0,
+            cost_est.recompute_us / 1000.0,
+            nb_ckpt_wqes, cost_est.wqe_persist_us / 1000.0, cost_est.replay_us / 1000.0
+        );
+
+        if(cmd->force_recompute == true){
+            // case: force-recompute is enabled
             do_dirty_copy = false;
-            POS_LOG(
-                "[Dirty Behaviour] potential dirty copies too large, do reompute: dirty-copies(%s)",
-                POSUtilSystem::format_byte_number(this->async_ckpt_cxt.dirty_handle_state_size).c_str()
-            );
+            POS_LOG("[Dirty Behaviour] force-recompute is enabled, do recompute");
+        } else if(cost_est.do_dirty_copy){
+            // case: copying dirty states is cheaper
+            do_dirty_copy = true;
+            POS_LOG("[Dirty Behaviour] dirty copy is cheaper, do dirty copy");
         } else {
-            if(cmd->force_recompute == true){
-                // case: not too many dirty copies, bot force-recompute is enabled
-                do_dirty_copy = false;
-                POS_LOG(
-                    "[Dirty Behaviour] potential dirty copies is acceptable, but force-recompute is enabled, do reompute: dirty-copies(%s)",
-                    POSUtilSystem::format_byte_number(this->async_ckpt_cxt.dirty_handle_state_size).c_str()
-                );
-            } else {
-                // case: not too many dirty copies, conduct dirty copy
-                do_dirty_copy = true;
-                POS_LOG(
-                    "[Dirty Behaviour] potential dirty copies is acceptable, do dirty copy: dirty-copies(%s)",
-                    POSUtilSystem::format_byte_number(this->async_ckpt_cxt.dirty_handle_state_size).c_str()
-                );
-            }
+            // case: dumping and replaying APIs is cheaper
+            do_dirty_copy = false;
+            POS_LOG("[Dirty Behaviour] recompute is cheaper, do recompute");
+        }
+
+        if(do_dirty_copy){
+            // drop the references held by the ckpt dag queue, as these APIs won't be dumped
+            for(i=0; i<nb_ckpt_wqes; i++){ wqes[i]->put_ref(); }
+            wqes.clear();
         }
     } else {
         do_dirty_copy = true;
@@ -1127,8 +1335,12 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
     }
 
     if(do_dirty_copy){ // do dirty copy
-        for(set_iter=this->async_ckpt_cxt.dirty_handles.begin(); set_iter!=this->async_ckpt_cxt.dirty_handles.end(); set_iter++){
-            handle = *set_iter;
+        dirty_handles.reserve(this->async_ckpt_cxt.dirty_handles.size());
+        this->async_ckpt_cxt.dirty_handles.for_each([&](POSHandle* dirty_handle, const bool&){
+            dirty_handles.push_back(dirty_handle);
+        });
+        for(i=0; i<dirty_handles.size(); i++){
+            handle = dirty_handles[i];
             POS_CHECK_POINTER(handle);
 
             if(unlikely(   handle->status == kPOS_HandleStatus_Deleted 
@@ -1138,10 +1350,13 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
                 continue;
             }
 
-            // step 1: commit the state
+            // step 1: commit the state, only those chunks modified since the top-half are copied
             #if POS_CONF_RUNTIME_EnableTrace
                 this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::CKPT_dirty_commit_ticks);
             #endif
+            s_tick = POSUtilTscTimer::get_tsc();
+            handle->begin_checkpoint_round();
+            round_bytes = handle->get_checkpoint_round_bytes();
             retval = handle->checkpoint_commit_sync(
                 /* version_id */ handle->latest_version,
                 /* stream_id */ 0
@@ -1151,12 +1366,13 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
                 retval = POS_FAILED;
                 goto sync_persist;
             }
+            d2h_ticks += POSUtilTscTimer::get_tsc() - s_tick;
             #if POS_CONF_RUNTIME_EnableTrace
                 this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::CKPT_dirty_commit_ticks);
                 this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_dirty_commit_times);
                 this->async_ckpt_cxt.metric_reducers.reduce(
                     /* index*/ checkpoint_async_cxt_t::CKPT_dirty_commit_bytes,
-                    /* value */ handle->state_size
+                    /* value */ round_bytes
                 );
             #endif
 
@@ -1167,25 +1383,26 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
             retval = handle->checkpoint_persist_async(
                 /* ckpt_dir */ cmd->ckpt_dir,
                 /* with_state */ true,
-                /* version_id */ handle->latest_version
+                /* version_id */ handle->latest_version,
+                /* persist_pool */ this->_ws->persist_pool,
+                /* persist_group */ &this->async_ckpt_cxt.persist_group
             );
             if(unlikely(retval != POS_SUCCESS)){
                 POS_WARN(
-                    "failed to async raise persist thread: hid(%lu), ckpt_dir(%s) version_id(%lu)", handle->id, cmd->ckpt_dir
+                    "failed to submit persisting: hid(%lu), ckpt_dir(%s) version_id(%lu)", handle->id, cmd->ckpt_dir
                 );
                 goto sync_persist;
             }
             #if POS_CONF_RUNTIME_EnableTrace
                 this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_handle_ticks);
             #endif
-            this->async_ckpt_cxt.persist_handles.insert(handle); // actually this is redundant
 
             nb_ckpt_dirty_handles += 1;
-            dirty_ckpt_size += handle->state_size;
+            dirty_ckpt_size += round_bytes;
         }
+        copied_tick = POSUtilTscTimer::get_tsc();
     } else { // do recomputation
-        wqes.clear();
-        this->_client->template poll_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>(&wqes);
+        s_tick = POSUtilTscTimer::get_tsc();
         for(i=0; i<wqes.size(); i++){
             POS_CHECK_POINTER(wqe = wqes[i]);
             POS_CHECK_POINTER(wqe->api_cxt);
@@ -1203,7 +1420,12 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
                 this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_wqe_ticks);
                 this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::CKPT_nb_recomputation_apis);
             #endif
+
+            // drop the reference held by the ckpt dag queue
+            wqe->put_ref();
         }
+        e_tick = POSUtilTscTimer::get_tsc();
+        this->_ws->ckpt_cost_model.record_recompute(nb_ckpt_wqes, this->_ws->tsc_timer.tick_to_us(e_tick - s_tick));
         POS_LOG_C("finished dumping recomputation APIs: nb_ckpt_wqes(%lu)", nb_ckpt_wqes);
     }
 
@@ -1235,25 +1457,31 @@ pos_retval_t POSWorker::__checkpoint_BH_sync() {
     }
  
  sync_persist:
-    // step 6: make sure all async persist thread are finished
+    // step 6: make sure all persisting raised by this command are finished
     #if POS_CONF_RUNTIME_EnableTrace
         this->async_ckpt_cxt.metric_tickers.start(checkpoint_async_cxt_t::PERSIST_handle_ticks);
     #endif
-    for(set_iter=this->async_ckpt_cxt.persist_handles.begin(); set_iter!=this->async_ckpt_cxt.persist_handles.end(); set_iter++){
-        POSHandle *handle = *set_iter;
-        POS_CHECK_POINTER(handle);
-        if(unlikely(POS_SUCCESS != (retval = handle->sync_persist()))){
-            POS_WARN_C("failed to sync async persist thread of handle: hid(%lu)", handle->id);
-            goto reply_parser;
-        }
-        #if POS_CONF_RUNTIME_EnableTrace
-            this->async_ckpt_cxt.metric_counters.add_counter(checkpoint_async_cxt_t::PERSIST_handle_times);
-        #endif
+    if(unlikely(POS_SUCCESS != (retval = this->async_ckpt_cxt.persist_group.wait()))){
+        POS_WARN_C("failed to persist handles: retval(%d)", retval);
+        goto reply_parser;
     }
     #if POS_CONF_RUNTIME_EnableTrace
         this->async_ckpt_cxt.metric_tickers.end(checkpoint_async_cxt_t::PERSIST_handle_ticks);
+        this->async_ckpt_cxt.metric_counters.add_counter(
+            checkpoint_async_cxt_t::PERSIST_handle_times, this->async_ckpt_cxt.persist_group.get_nb_done()
+        );
     #endif
 
+    // learn from the dirty copy of this round, persisting after all copies counts as its own cost
+    if(copied_tick > 0){
+        e_tick = POSUtilTscTimer::get_tsc();
+        this->_ws->ckpt_cost_model.record_dirty_copy(
+            /* bytes */ dirty_ckpt_size,
+            /* d2h_us */ this->_ws->tsc_timer.tick_to_us(d2h_ticks),
+            /* persist_us */ this->_ws->tsc_timer.tick_to_us(e_tick - copied_tick)
+        );
+    }
+
     // step 7: tear down all handles inside the client
     if(unlikely(POS_SUCCESS != (retval = this->_client->tear_down_all_handles()))){
         POS_WARN_C("failed to tear down handles while dumping");
@@ -1284,6 +1512,7 @@ pos_retval_t POSWorker::__process_cmd(POSCommand_QE_t *cmd){
     POSHandleManager<POSHandle>* hm;
     POSHandle *handle;
     uint64_t i;
+    std::vector<POSAPIContext_QE*> wqes;
     typename std::set<POSHandle*>::iterator handle_set_iter;
 
     POS_CHECK_POINTER(cmd);
@@ -1310,7 +1539,7 @@ pos_retval_t POSWorker::__process_cmd(POSCommand_QE_t *cmd){
         this->async_ckpt_cxt.cmd = cmd;
         this->async_ckpt_cxt.dirty_handles.clear();
         this->async_ckpt_cxt.dirty_handle_state_size = 0;
-        this->async_ckpt_cxt.persist_handles.clear();
+        this->async_ckpt_cxt.persist_group.reset();
 
         #if POS_CONF_RUNTIME_EnableTrace
             this->async_ckpt_cxt.metric_counters.reset_counters();
@@ -1325,8 +1554,16 @@ pos_retval_t POSWorker::__process_cmd(POSCommand_QE_t *cmd){
             delete this->async_ckpt_cxt.thread;
         }
 
-        // clear the ckpt dag queue
-        this->_client->clear_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>();
+        // clear the ckpt dag queue, and drop references held by the queue
+        wqes.clear();
+        this->_client->template poll_q<kPOS_QueueDirection_WorkerLocal, kPOS_QueueType_ApiCxt_CkptDag_WQ>(&wqes);
+        for(i=0; i<wqes.size(); i++){
+            POS_CHECK_POINTER(wqes[i]);
+            wqes[i]->put_ref();
+        }
+
+        // reference unchanged handles from the base image, if this is an incremental checkpoint
+        this->__checkpoint_reference_unchanged_handles(cmd);
 
         // reset checkpoint version map
         this->async_ckpt_cxt.checkpoint_version_map.clear();
@@ -1336,7 +1573,8 @@ pos_retval_t POSWorker::__process_cmd(POSCommand_QE_t *cmd){
         {
             POS_CHECK_POINTER(handle = *handle_set_iter);
             handle->reset_preserve_counter();
-            this->async_ckpt_cxt.checkpoint_version_map[handle] = handle->latest_version;
+            handle->begin_checkpoint_round();
+            this->async_ckpt_cxt.checkpoint_version_map.insert(handle, handle->latest_version);
         }
 
         // drain the device
@@ -1370,8 +1608,9 @@ exit:
 #endif // POS_CONF_EVAL_CkptOptLevel
 
 
-pos_retval_t POSWorker::__restore_broken_handles(POSAPIContext_QE* wqe, POSAPIMeta_t* api_meta){
+pos_retval_t POSWorker::__restore_broken_handles(POSAPIContext_QE* wqe, const POSAPIMeta_t* api_meta){
     pos_retval_t retval = POS_SUCCESS;
+    bool need_walk;
 
     #if POS_CONF_RUNTIME_EnableTrace
         uint64_t restore_ticks = 0, restore_state_ticks = 0;
@@ -1383,11 +1622,8 @@ pos_retval_t POSWorker::__restore_broken_handles(POSAPIContext_QE* wqe, POSAPIMe
     POS_CHECK_POINTER(api_meta);
 
     auto __restore_broken_hendles_per_direction = [&](std::vector<POSHandleView_t>& handle_view_vec, pos_edge_direction_t edge){
-        uint64_t i;
-        POSHandle::pos_broken_handle_list_t broken_handle_list;
+        uint64_t i, j, begin_id;
         POSHandle *broken_handle;
-        uint16_t nb_layers, layer_id_keeper;
-        uint64_t handle_id_keeper;
 
         // step 1: restore resource allocation
         for(i=0; i<handle_view_vec.size(); i++){
@@ -1400,27 +1636,21 @@ pos_retval_t POSWorker::__restore_broken_handles(POSAPIContext_QE* wqe, POSAPIMe
                 #endif
             #endif
 
-            broken_handle_list.reset();
-            handle_view_vec[i].handle->collect_broken_handles(&broken_handle_list);
-
-            nb_layers = broken_handle_list.get_nb_layers();
-            if(likely(nb_layers == 0)){
+            if(likely(!need_walk)){
                 continue;
             }
 
-            layer_id_keeper = nb_layers - 1;
-            handle_id_keeper = 0;
+            begin_id = this->_broken_handle_list.broken_handles.size();
+            handle_view_vec[i].handle->collect_broken_handles(&(this->_broken_handle_list));
 
-            while(1){
-                broken_handle = broken_handle_list.reverse_get_handle(layer_id_keeper, handle_id_keeper);
-                if(unlikely(broken_handle == nullptr)){
-                    break;
-                }
+            // parents are collected before their children
+            for(j=begin_id; j<this->_broken_handle_list.broken_handles.size(); j++){
+                POS_CHECK_POINTER(broken_handle = this->_broken_handle_list.broken_handles[j]);
 
                 /*!
                  *  \note   we don't need to restore the bottom handle while haven't create them yet
                  */
-                if(unlikely(api_meta->api_type == kPOS_API_Type_Create_Resource && layer_id_keeper == 0)){
+                if(unlikely(api_meta->api_type == kPOS_API_Type_Create_Resource && broken_handle == handle_view_vec[i].handle)){
                     if(likely(broken_handle->status == kPOS_HandleStatus_Create_Pending)){
                         continue;
                     }
@@ -1480,10 +1710,20 @@ pos_retval_t POSWorker::__restore_broken_handles(POSAPIContext_QE* wqe, POSAPIMe
                     }
                 }
 
-            } // while (1)
+            } // foreach broken handle
         } // foreach handle_view_vec
     };
 
+    /*!
+     *  \note   in the steady state no handle is pending to be created or broken, so we skip walking
+     *          the handle trees of this op; otherwise the walk is shared by all handle views of this
+     *          op, so that a broken parent is restored once
+     */
+    need_walk = this->_client->nb_nonactive_handles.load(std::memory_order_relaxed) != 0;
+    if(unlikely(need_walk)){
+        this->_broken_handle_list.reset();
+    }
+
     __restore_broken_hendles_per_direction(wqe->input_handle_views, kPOS_Edge_Direction_In);
     __restore_broken_hendles_per_direction(wqe->output_handle_views, kPOS_Edge_Direction_Out);
     __restore_broken_hendles_per_direction(wqe->inout_handle_views, kPOS_Edge_Direction_InOut);
@@ -1530,6 +1770,7 @@ exit:
             #endif
             { RESTORE_nb_ondemand_reload_handles, "# On-demand Reload Handles (by Worker Thread)" },
             { RESTORE_nb_ondemand_reload_state_handles, "# On-demand Reload Handles with State (by Worker Thread)" },
+            { DAEMON_nb_parks, "# Parks of Worker Thread" },
         };
 
         static std::unordered_map<metrics_ticker_type_t, std::string> ticker_names = {
@@ -1544,6 +1785,8 @@ exit:
             #endif
             { RESTORE_ondemand_reload_ticks, "On-demand Reload (by Worker Thread)" },
             { RESTORE_ondemand_reload_state_ticks, "On-demand Reload State (by Worker Thread)" },
+            { DAEMON_busy_ticks, "Busy Time of Worker Thread" },
+            { DAEMON_idle_ticks, "Idle Time of Worker Thread" },
         };
 
         static std::vector<std::pair<metrics_sequence_type_t, std::string>> sequence_name = {
@@ -18,8 +18,14 @@
 #include <string>
 #include <atomic>
 #include <filesystem>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <sched.h>
 #include "pos/include/common.h"
 #include "pos/include/workspace.h"
+#include "pos/include/utils/system.h"
+#include "pos/include/utils/size_class_pool.h"
 #include "pos/include/proto/handle.pb.h"
 #include "pos/include/proto/client.pb.h"
 
@@ -33,6 +39,7 @@ POSWorkspaceConf::POSWorkspaceConf(POSWorkspace *root_ws){
     this->_runtime_daemon_log_path = POS_CONF_RUNTIME_DefaultDaemonLogPath;
     this->_runtime_trace_resource = false;
     this->_runtime_trace_performance = false;
+    this->_runtime_ckpt_pool_prewarm = POS_CONF_RUNTIME_DefaultCkptPoolPrewarm;
 
     // evaluation configurations
     this->_eval_ckpt_interval_tick = this->_root_ws->tsc_timer.ms_to_tick(
@@ -45,6 +52,8 @@ pos_retval_t POSWorkspaceConf::set(ConfigType conf_type, std::string val){
     pos_retval_t retval = POS_SUCCESS;
     std::lock_guard<std::mutex> lock(this->_mutex);
     uint64_t _tmp;
+    std::vector<uint32_t> cpus;
+    std::vector<std::pair<uint64_t, uint64_t>> prewarm_blocks;
 
     POS_ASSERT(conf_type < ConfigType::kUnknown);
 
@@ -78,6 +87,24 @@ pos_retval_t POSWorkspaceConf::set(ConfigType conf_type, std::string val){
         this->_runtime_trace_dir = val;
         break;
 
+    case kRuntimeDaemonCpuList:
+        if(unlikely(POS_SUCCESS != (retval = POSUtilSystem::parse_cpu_list(val, cpus)))){
+            POS_WARN_C("failed to set daemon CPU list: %s", val.c_str());
+            goto exit;
+        }
+        this->_runtime_daemon_cpu_list = val;
+        POS_LOG_C("set daemon CPU list as %s", val.c_str());
+        break;
+
+    case kRuntimeCkptPoolPrewarm:
+        if(unlikely(POS_SUCCESS != (retval = POSUtilSizeClassPool::parse_prewarm_spec(val, prewarm_blocks)))){
+            POS_WARN_C("failed to set checkpoint pool prewarm specification: %s", val.c_str());
+            goto exit;
+        }
+        this->_runtime_ckpt_pool_prewarm = val;
+        POS_LOG_C("set checkpoint pool prewarm specification as %s", val.c_str());
+        break;
+
     case kEvalCkptIntervfalMs:
         try {
             _tmp = std::stoull(val);
@@ -129,6 +156,14 @@ pos_retval_t POSWorkspaceConf::get(ConfigType conf_type, std::string& val){
         val = this->_runtime_trace_dir;
         break;
 
+    case kRuntimeDaemonCpuList:
+        val = this->_runtime_daemon_cpu_list;
+        break;
+
+    case kRuntimeCkptPoolPrewarm:
+        val = this->_runtime_ckpt_pool_prewarm;
+        break;
+
     case kEvalCkptIntervfalMs:
         val = std::to_string(this->_eval_ckpt_interval_ms);
         break;
@@ -145,8 +180,15 @@ exit:
 
 POSWorkspace::POSWorkspace() :
     _current_max_uuid(0),
-    ws_conf(this)
+    _default_client(nullptr),
+    ws_conf(this),
+    _reclaimer(nullptr),
+    _reclaimer_stop_flag(false)
 {
+    for(auto& slot : this->_client_list){ slot.store(nullptr, std::memory_order_relaxed); }
+    this->daemon_pool = nullptr;
+    this->persist_pool = nullptr;
+
     // create out-of-band server
     _oob_server = new POSOobServer(
         /* ws */ this,
@@ -157,6 +199,7 @@ POSWorkspace::POSWorkspace() :
             {   kPOS_OOB_Msg_CLI_Ckpt_Dump,             oob_functions::cli_ckpt_dump::sv            },
             {   kPOS_OOB_Msg_CLI_Restore,               oob_functions::cli_restore::sv              },
             {   kPOS_OOB_Msg_CLI_Trace_Resource,        oob_functions::cli_trace_resource::sv       },
+            {   kPOS_OOB_Msg_CLI_Trace_Performance,     oob_functions::cli_trace_performance::sv    },
         },
         /* ip_str */ POS_OOB_SERVER_DEFAULT_IP,
         /* port */ POS_OOB_SERVER_DEFAULT_PORT
@@ -194,8 +237,36 @@ POSWorkspace::~POSWorkspace(){
 
 
 pos_retval_t POSWorkspace::init(){
+    pos_retval_t retval;
+    std::string conf;
+    std::vector<uint32_t> cpus;
+
     POS_DEBUG_C("initializing POS workspace...")
-    return this->__init();
+    if(unlikely(POS_SUCCESS != (retval = this->__init()))){
+        goto exit;
+    }
+
+    #if POS_CONF_RUNTIME_DaemonPoolSize > 0
+        // raise the shared daemon pool, pinned to the same CPUs as the daemons of each client
+        this->ws_conf.get(POSWorkspaceConf::ConfigType::kRuntimeDaemonCpuList, conf);
+        if(unlikely(POS_SUCCESS != POSUtilSystem::parse_cpu_list(conf, cpus))){
+            POS_WARN_C("failed to parse daemon CPU list, daemon pool won't be pinned: cpu_list(%s)", conf.c_str());
+            cpus.clear();
+        }
+        POS_CHECK_POINTER(
+            this->daemon_pool = new POSDaemonPool(&this->tsc_timer, POS_CONF_RUNTIME_DaemonPoolSize, cpus)
+        );
+    #endif
+
+    // raise the shared persist pool
+    POS_CHECK_POINTER(this->persist_pool = new POSPersistPool(POS_PERSIST_POOL_NB_THREADS));
+
+    // raise the background reclaimer
+    this->_reclaimer_stop_flag = false;
+    POS_CHECK_POINTER(this->_reclaimer = new std::thread(&POSWorkspace::__reclaim_daemon, this));
+
+exit:
+    return retval;
 }
 
 
@@ -211,10 +282,18 @@ pos_retval_t POSWorkspace::deinit(){
         delete _oob_server;
     }
 
+    if(likely(this->_reclaimer != nullptr)){
+        POS_DEBUG_C("shutdowning background reclaimer...");
+        this->_reclaimer_stop_flag = true;
+        if(this->_reclaimer->joinable()){ this->_reclaimer->join(); }
+        delete this->_reclaimer;
+        this->_reclaimer = nullptr;
+    }
+
     POS_DEBUG_C("cleaning all clients...");
     nb_clean_client = 0;
-    for(i=0; i<this->_client_list.size(); i++){
-        if(this->_client_list[i] != nullptr){
+    for(i=0; i<POS_WORKSPACE_MAX_NB_CLIENTS; i++){
+        if(this->get_client_by_uuid(i) != nullptr){
             this->remove_client(i);
             nb_clean_client += 1;
         }
@@ -222,6 +301,18 @@ pos_retval_t POSWorkspace::deinit(){
     POS_BACK_LINE;
     POS_DEBUG_C("cleaned clients: #clients(%lu)", nb_clean_client);
 
+    if(this->daemon_pool != nullptr){
+        POS_DEBUG_C("shutdowning daemon pool...");
+        delete this->daemon_pool;
+        this->daemon_pool = nullptr;
+    }
+
+    if(this->persist_pool != nullptr){
+        POS_DEBUG_C("shutdowning persist pool...");
+        delete this->persist_pool;
+        this->persist_pool = nullptr;
+    }
+
     POS_DEBUG_C("deinit platform-specific context...");
     retval = this->__deinit();
     if(likely(retval == POS_SUCCESS)){
@@ -235,10 +326,23 @@ pos_retval_t POSWorkspace::deinit(){
 
 pos_retval_t POSWorkspace::create_client(pos_create_client_param_t& param, POSClient** clnt){
     pos_retval_t retval = POS_SUCCESS;
-    uuid_t uuid;
+    std::lock_guard<std::mutex> lock(this->_client_mutex);
+    uint64_t i;
 
-    param.id = this->_current_max_uuid;
-    this->_current_max_uuid += 1;
+    /*!
+     *  \note  allocate the first free slot after the previously allocated one, so that
+     *         the uuid of a removed client isn't reused right away
+     */
+    for(i=0; i<POS_WORKSPACE_MAX_NB_CLIENTS; i++){
+        param.id = (this->_current_max_uuid + i) % POS_WORKSPACE_MAX_NB_CLIENTS;
+        if(this->get_client_by_uuid(param.id) == nullptr){ break; }
+    }
+    if(unlikely(i == POS_WORKSPACE_MAX_NB_CLIENTS)){
+        POS_WARN_C("failed to create client, too many clients: max(%u)", POS_WORKSPACE_MAX_NB_CLIENTS);
+        retval = POS_FAILED_DRAIN;
+        goto exit;
+    }
+    this->_current_max_uuid = param.id + 1;
     param.is_restoring = false;
 
     // create client
@@ -248,10 +352,12 @@ pos_retval_t POSWorkspace::create_client(pos_create_client_param_t& param, POSCl
         goto exit;
     }
 
-    this->_client_list.resize(this->_current_max_uuid);
-    this->_client_list[(*clnt)->id] = (*clnt);
+    // publish the client after it's fully initialized
+    this->_client_list[(*clnt)->id].store(*clnt, std::memory_order_release);
 
     this->_pid_client_map[param.pid] = (*clnt);
+    this->_clients_by_age.push_back(*clnt);
+    this->__update_default_client();
     POS_DEBUG_C("create client: addr(%p), uuid(%lu), pid(%d)", (*clnt), (*clnt)->id, param.pid);
 
 exit:
@@ -264,28 +370,34 @@ pos_retval_t POSWorkspace::remove_client(pos_client_uuid_t uuid){
     POSClient *clnt;
     typename std::map<__pid_t, POSClient*>::iterator pid_client_map_iter;
 
-    clnt = this->get_client_by_uuid(uuid);
-    if(unlikely(clnt == nullptr)){
-        POS_WARN_C("try to remove an non-exist client: uuid(%lu)", uuid);
-        retval = POS_FAILED_NOT_EXIST;
-        goto exit;
-    }
+    {
+        std::lock_guard<std::mutex> lock(this->_client_mutex);
 
-    // delete from pid map
-    for(pid_client_map_iter = this->_pid_client_map.begin();
-        pid_client_map_iter != this->_pid_client_map.end();
-        pid_client_map_iter ++
-    ){
-        if(pid_client_map_iter->second == clnt){
-            this->_pid_client_map.erase(pid_client_map_iter);
-            break;
+        clnt = this->get_client_by_uuid(uuid);
+        if(unlikely(clnt == nullptr)){
+            POS_WARN_C("try to remove an non-exist client: uuid(%lu)", uuid);
+            retval = POS_FAILED_NOT_EXIST;
+            goto exit;
         }
-    }
 
-    // erase from global map
-    this->_client_list[uuid] = nullptr;
+        // delete from pid map
+        for(pid_client_map_iter = this->_pid_client_map.begin();
+            pid_client_map_iter != this->_pid_client_map.end();
+            pid_client_map_iter ++
+        ){
+            if(pid_client_map_iter->second == clnt){
+                this->_pid_client_map.erase(pid_client_map_iter);
+                break;
+            }
+        }
+
+        // erase from global map, new calls with this uuid would be rejected from now on
+        this->_client_list[uuid].store(nullptr, std::memory_order_release);
+        this->_clients_by_age.erase(std::find(this->_clients_by_age.begin(), this->_clients_by_age.end(), clnt));
+        this->__update_default_client();
+    }
 
-    // delete client
+    // delete client, outside the lock as it waits for the daemon threads of the client
     retval = this->__destory_client(clnt);
     if(unlikely(retval != POS_SUCCESS)){
         POS_WARN_C("failed to destory client: uuid(%lu)", uuid);
@@ -308,6 +420,7 @@ pos_retval_t POSWorkspace::restore_client(std::string& ckpt_file, POSClient** cl
     pid_t client_pid;
     std::string client_job_name;
     POSClient *tmp_client;
+    std::unique_lock<std::mutex> lock;
 
     POS_CHECK_POINTER(clnt);
     
@@ -327,8 +440,17 @@ pos_retval_t POSWorkspace::restore_client(std::string& ckpt_file, POSClient** cl
     create_param.pid = client_binary.pid();
     create_param.job_name = client_binary.job_name();
     create_param.is_restoring = true;
+    create_param.is_daemon_dedicated = false;
+    create_param.daemon_weight = POS_DAEMON_POOL_DEFAULT_WEIGHT;
+
+    lock = std::unique_lock<std::mutex>(this->_client_mutex);
 
     // TODO: fix this logic later, reassign new client id
+    if(unlikely(create_param.id >= POS_WORKSPACE_MAX_NB_CLIENTS)){
+        POS_WARN_C("uuid of the restored client is out of range: uuid(%lu)", create_param.id);
+        retval = POS_FAILED_INVALID_INPUT;
+        goto exit;
+    }
     tmp_client = this->get_client_by_uuid(create_param.id);
     if(unlikely(tmp_client != nullptr)){
         POS_WARN_C("confliction of client uuid, %s", POS_BUG_REPORT);
@@ -350,11 +472,11 @@ pos_retval_t POSWorkspace::restore_client(std::string& ckpt_file, POSClient** cl
     POS_CHECK_POINTER(clnt);
     (*clnt)->_api_inst_pc = client_binary.api_inst_pc();
 
-    if(unlikely(this->_client_list.size() < (*clnt)->id))
-        this->_client_list.resize((*clnt)->id);
-    this->_client_list[(*clnt)->id] = (*clnt);
+    this->_client_list[(*clnt)->id].store(*clnt, std::memory_order_release);
 
     this->_pid_client_map[(*clnt)->pid] = (*clnt);
+    this->_clients_by_age.push_back(*clnt);
+    this->__update_default_client();
     POS_DEBUG_C("restore client: addr(%p), uuid(%lu), pid(%d)", (*clnt), (*clnt)->id, (*clnt)->pid);
 
 exit:
@@ -365,131 +487,388 @@ exit:
 
 POSClient* POSWorkspace::get_client_by_pid(__pid_t pid){
     POSClient *retval = nullptr;
+    std::lock_guard<std::mutex> lock(this->_client_mutex);
+    typename std::map<__pid_t, POSClient*>::iterator pid_client_map_iter;
 
-    if(unlikely(this->_pid_client_map.count(pid) > 0)){
-        retval = this->_pid_client_map[pid];
+    pid_client_map_iter = this->_pid_client_map.find(pid);
+    if(likely(pid_client_map_iter != this->_pid_client_map.end())){
+        retval = pid_client_map_iter->second;
     }
 
     return retval;
 }
 
 
+pos_retval_t POSWorkspace::dump_api_latency(const std::string& file_path){
+    pos_retval_t retval = POS_SUCCESS;
+    std::ofstream output_file;
+    std::vector<std::pair<std::string, POSClient*>> clients;
+    std::vector<std::pair<uint64_t, uint64_t>> sorted_apis;
+    pos_api_latency_table_t *merged, *overall;
+    const POSMetrics_Histogram *hist;
+    const POSAPIMeta_t *api_meta;
+    uint64_t i, api_id, nb_apis, sum_ticks;
+    uint64_t nb_live, nb_live_bytes, nb_reserved_bytes, sum_live = 0, sum_live_bytes = 0, sum_reserved_bytes = 0;
+    uint8_t stage;
+    char line[512];
+    int len;
+
+    static const char* stage_names[kPOS_APILatencyStage_Nb] = { "queueing", "parse", "worker", "e2e" };
+
+    auto __dump_table = [&](const std::string& title, pos_api_latency_table_t *table){
+        sorted_apis.clear();
+        sum_ticks = 0;
+        for(api_id=0; api_id<table->get_nb_rows(); api_id++){
+            if((hist = table->get(api_id, kPOS_APILatencyStage_EndToEnd)) == nullptr){ continue; }
+            sorted_apis.push_back({ api_id, hist->get_sum() });
+            sum_ticks += hist->get_sum();
+        }
+
+        // APIs that occupy most of the end-to-end time come first
+        std::sort(sorted_apis.begin(), sorted_apis.end(),
+            [](const std::pair<uint64_t, uint64_t>& a, const std::pair<uint64_t, uint64_t>& b){
+                return a.second > b.second;
+            }
+        );
+
+        output_file << "[" << title << "] #apis: " << sorted_apis.size()
+                    << ", e2e sum: " << this->tsc_timer.tick_to_ms(sum_ticks) << " ms" << std::endl;
+        output_file << "  api(id), count, e2e share";
+        for(stage=0; stage<kPOS_APILatencyStage_Nb; stage++){
+            output_file << ", " << stage_names[stage] << " p50/p99/max (us)";
+        }
+        output_file << std::endl;
+
+        for(auto& sorted_api : sorted_apis){
+            api_id = sorted_api.first;
+            api_meta = this->api_mgnr->get_api_meta(api_id);
+            hist = table->get(api_id, kPOS_APILatencyStage_EndToEnd);
+            POS_CHECK_POINTER(hist);
+
+            len = snprintf(
+                line, sizeof(line), "  %s(%lu), %lu, %.2f%%",
+                api_meta != nullptr ? api_meta->api_name : "unknown", api_id,
+                hist->get_count(),
+                sum_ticks > 0 ? (double)(sorted_api.second) / (double)(sum_ticks) * 100 : 0
+            );
+            for(stage=0; stage<kPOS_APILatencyStage_Nb && len<(int)sizeof(line); stage++){
+                hist = table->get(api_id, stage);
+                len += snprintf(
+                    line+len, sizeof(line)-len, ", %.2f/%.2f/%.2f",
+                    this->tsc_timer.tick_to_us(hist->get_percentile(50)),
+                    this->tsc_timer.tick_to_us(hist->get_percentile(99)),
+                    this->tsc_timer.tick_to_us(hist->get_max())
+                );
+            }
+            output_file << line << std::endl;
+        }
+        output_file << std::endl;
+    };
+
+    output_file.open(file_path.c_str(), std::fstream::out | std::fstream::trunc);
+    if(unlikely(!output_file.good())){
+        POS_WARN_C("failed to open api latency report file: path(%s)", file_path.c_str());
+        retval = POS_FAILED;
+        goto exit;
+    }
+
+    // clients are never freed, so their tables could be read after releasing the lock
+    this->_client_mutex.lock();
+    for(auto& pid_client : this->_pid_client_map){
+        POS_CHECK_POINTER(pid_client.second);
+        clients.push_back({
+            std::string("client ") + std::to_string(pid_client.second->id)
+                + std::string(", pid ") + std::to_string(pid_client.first),
+            pid_client.second
+        });
+    }
+    this->_client_mutex.unlock();
+
+    nb_apis = this->api_mgnr->api_metas.empty() ? 0 : this->api_mgnr->api_metas.rbegin()->first + 1;
+    POS_CHECK_POINTER(overall = new pos_api_latency_table_t(nb_apis));
+    for(i=0; i<clients.size(); i++){
+        POS_CHECK_POINTER(merged = new pos_api_latency_table_t(nb_apis));
+        merged->merge(*(clients[i].second->parser_api_latency));
+        merged->merge(*(clients[i].second->worker_api_latency));
+        overall->merge(*merged);
+
+        nb_live = clients[i].second->apicxt_arena.get_nb_live();
+        nb_live_bytes = clients[i].second->apicxt_arena.get_nb_live_bytes();
+        nb_reserved_bytes = clients[i].second->apicxt_arena.get_nb_reserved_bytes();
+        sum_live += nb_live;
+        sum_live_bytes += nb_live_bytes;
+        sum_reserved_bytes += nb_reserved_bytes;
+
+        __dump_table(
+            clients[i].first + std::string(", #live wqes: ") + std::to_string(nb_live)
+                + std::string(", live bytes: ") + std::to_string(nb_live_bytes)
+                + std::string(", arena bytes: ") + std::to_string(nb_reserved_bytes),
+            merged
+        );
+        delete merged;
+    }
+    __dump_table(
+        std::string("all clients, #live wqes: ") + std::to_string(sum_live)
+            + std::string(", live bytes: ") + std::to_string(sum_live_bytes)
+            + std::string(", arena bytes: ") + std::to_string(sum_reserved_bytes),
+        overall
+    );
+    delete overall;
+
+    output_file.close();
+    POS_LOG_C("dumped api latency report: path(%s), #clients(%lu)", file_path.c_str(), clients.size());
+
+exit:
+    return retval;
+}
+
+
 int POSWorkspace::pos_process(
-    uint64_t api_id, pos_client_uuid_t uuid, std::vector<POSAPIParamDesp_t> param_desps, void* ret_data, uint64_t ret_data_len
+    uint64_t api_id, pos_client_uuid_t uuid, const std::vector<POSAPIParamDesp_t>& param_desps, void* ret_data, uint64_t ret_data_len
 ){
-    uint64_t i;
-    int retval, prev_error_code = 0;
+    int retval;
+    pos_retval_t submit_retval;
     POSClient *client = nullptr;
-    POSAPIMeta_t api_meta;
-    bool has_prev_error = false;
+    const POSAPIMeta_t *api_meta;
     POSAPIContext_QE* wqe;
-    std::vector<POSAPIContext_QE*> cqes;
-    POSAPIContext_QE* cqe;
 
-    // TODO: comment out this once we enable piggyback support of uuid
-    //      in remoting framework
-    uuid = 0;
-    
-    // wait until client is ready
-    while(client == nullptr){
-        client = this->get_client_by_uuid(uuid);
-    }
-
-    // wait until client is ready
-    while(client->status != kPOS_ClientStatus_Active){}
+    api_meta = this->api_mgnr->get_api_meta(api_id);
 
     // check whether the metadata of the API was recorded
-    #if POS_CONF_RUNTIME_EnableDebugCheck
-        if(unlikely(this->api_mgnr->api_metas.count(api_id) == 0)){
-            POS_WARN_C_DETAIL(
-                "no api metadata was recorded in the api manager: api_id(%lu)", api_id
-            );
-            return POS_FAILED_NOT_EXIST;
-        }
-    #endif // POS_CONF_RUNTIME_EnableDebugCheck
+    if(unlikely(api_meta == nullptr)){
+        POS_WARN_C_DETAIL(
+            "no api metadata was recorded in the api manager: api_id(%lu)", api_id
+        );
+        return api_mgnr->cast_pos_retval(POS_FAILED_NOT_EXIST, api_mgnr->get_default_library_id());
+    }
 
-    api_meta = api_mgnr->api_metas[api_id];
+    // the uuid is piggybacked by the remoting framework, which is obtained during registration
+    client = this->__get_client_of_call(uuid);
+    if(unlikely(client == nullptr)){
+        POS_WARN_C("no client with the given uuid was registered: uuid(%lu), api_id(%lu)", uuid, api_id);
+        return api_mgnr->cast_pos_retval(POS_FAILED_NOT_EXIST, api_meta->library_id);
+    }
+
+    // wait until client is ready (e.g., under restoring)
+    while(client->status != kPOS_ClientStatus_Active){ pos_cpu_relax(); }
 
     // generate new work queue element
-    wqe = new POSAPIContext_QE(
+    POS_CHECK_POINTER(wqe = client->apicxt_arena.acquire());
+    wqe->load(
         /* api_id*/ api_id,
-        /* uuid */ uuid,
-        /* param_desps */ param_desps,
+        /* uuid */ client->id,
+        /* param_desps */ param_desps.data(),
+        /* nb_params */ param_desps.size(),
         /* id */ client->get_and_move_api_inst_pc(),
         /* retval_data */ ret_data,
         /* retval_size */ ret_data_len,
         /* pos_client */ client
     );
-    POS_CHECK_POINTER(wqe);
-
-    /*!
-     *  \brief  push to the work queue
-     */
-    client->push_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>(wqe);
+    wqe->is_sync = api_meta->is_sync;
 
     /*!
-     *  \note   if this is a sync call, we need to block until cqe is obtained
+     *  \note   if this is a sync call, we need to block until its completion is signaled
      */
-    if(unlikely(api_meta.is_sync)){
+    if(unlikely(api_meta->is_sync)){
         // mark the client is under sync call, so that the worker thread will make sure it will return back results
         // event though it's under dumping
         client->is_under_sync_call = true;
 
-        while(1){
-            #if POS_CONF_RUNTIME_EnableDebugCheck
-                if(unlikely(this->get_client_by_uuid(uuid) == nullptr)){
-                    POS_ERROR_DETAIL("client disappear during waiting of sync call, this is a bug: uuid(%lu)", uuid);
-                }
-            #endif
-
-            if(unlikely(
-                POS_SUCCESS != (client->template poll_q<kPOS_QueueDirection_Rpc2Parser,kPOS_QueueType_ApiCxt_CQ>(&cqes))
-            )){
-                POS_ERROR_C_DETAIL("failed to poll runtime cq");
-            }
+        // the rpc frontend keeps its reference during waiting, so the wqe is safe to touch after pushing
+        submit_retval = this->__submit_wqe(client, wqe);
+        if(unlikely(submit_retval != POS_SUCCESS)){
+            client->is_under_sync_call = false;
+            wqe->put_ref();
+            return api_mgnr->cast_pos_retval(submit_retval, api_meta->library_id);
+        }
+        retval = this->__wait_sync_call(client, wqe);
+    } else {
+        // we can't touch the wqe after pushing, as it might be retired by the completion
+        submit_retval = this->__submit_wqe(client, wqe);
+        if(unlikely(submit_retval != POS_SUCCESS)){
+            wqe->put_ref();
+            return api_mgnr->cast_pos_retval(submit_retval, api_meta->library_id);
+        }
 
-            if(unlikely(
-                POS_SUCCESS != (client->template poll_q<kPOS_QueueDirection_Rpc2Worker,kPOS_QueueType_ApiCxt_CQ>(&cqes))
-            )){
-                POS_ERROR_C_DETAIL("failed to poll worker cq");
-            }
+        // retire previously returned async calls
+        client->retire_apicxts();
 
-        #if POS_CONF_RUNTIME_EnableDebugCheck
-            if(cqes.size() > 0){
-                POS_DEBUG_C("polling completion queue, obtain %lu elements: uuid(%lu)", cqes.size(), uuid);
-            }
-        #endif
+        // if this is a async call, we directly return success
+        retval = api_mgnr->cast_pos_retval(POS_SUCCESS, api_meta->library_id);
+    }
 
-            for(i=0; i<cqes.size(); i++){
-                POS_CHECK_POINTER(cqe = cqes[i]);
+    return retval;
+}
 
-                // found the called sync api
-                if(cqe->id == wqe->id){
-                    // setup return code
-                    retval = has_prev_error ? prev_error_code : cqe->api_cxt->return_code;
 
-                    client->is_under_sync_call = false;
+pos_retval_t POSWorkspace::pos_process_batch(
+    pos_client_uuid_t uuid, const POSAPICallDesp_t* call_desps, uint64_t nb_calls, int* retvals
+){
+    pos_retval_t retval = POS_SUCCESS, submit_retval;
+    uint64_t i;
+    POSClient *client = nullptr;
+    const POSAPIMeta_t *api_meta;
+    const POSAPICallDesp_t *call_desp;
+    POSAPIContext_QE* wqe;
 
-                    goto exit;
-                }
+    POS_CHECK_POINTER(call_desps);
+    POS_CHECK_POINTER(retvals);
 
-                // record previous async error
-                if(unlikely(
-                    cqe->status == kPOS_API_Execute_Status_Parser_Failed
-                    || cqe->status == kPOS_API_Execute_Status_Worker_Failed
-                )){
-                    has_prev_error = true;
-                    prev_error_code = cqe->api_cxt->return_code;
-                }
-            }
+    if(unlikely(nb_calls == 0)){ goto exit; }
 
-            cqes.clear();
+    // resolve the client only once per batch
+    client = this->__get_client_of_call(uuid);
+    if(unlikely(client == nullptr)){
+        POS_WARN_C("no client with the given uuid was registered: uuid(%lu)", uuid);
+        for(i=0; i<nb_calls; i++){
+            api_meta = this->api_mgnr->get_api_meta(call_desps[i].api_id);
+            retvals[i] = this->api_mgnr->cast_pos_retval(
+                POS_FAILED_NOT_EXIST,
+                api_meta != nullptr ? api_meta->library_id : this->api_mgnr->get_default_library_id()
+            );
         }
-    } else {
-        // if this is a async call, we directly return success
-        retval = api_mgnr->cast_pos_retval(POS_SUCCESS, api_meta.library_id);
+        retval = POS_FAILED_NOT_EXIST;
+        goto exit;
     }
+    while(client->status != kPOS_ClientStatus_Active){ pos_cpu_relax(); }
+
+    for(i=0; i<nb_calls; i++){
+        call_desp = &(call_desps[i]);
+
+        api_meta = this->api_mgnr->get_api_meta(call_desp->api_id);
+        if(unlikely(api_meta == nullptr)){
+            POS_WARN_C_DETAIL(
+                "no api metadata was recorded in the api manager: api_id(%lu), batch_index(%lu)",
+                call_desp->api_id, i
+            );
+            retvals[i] = this->api_mgnr->cast_pos_retval(
+                POS_FAILED_NOT_EXIST, this->api_mgnr->get_default_library_id()
+            );
+            retval = POS_FAILED_INVALID_INPUT;
+            continue;
+        }
+
+        // the returned data would be written through the given buffer
+        if(unlikely(call_desp->ret_data == nullptr && call_desp->ret_data_len > 0)){
+            POS_WARN_C_DETAIL(
+                "no buffer is provided for the returned data: api_id(%lu), batch_index(%lu), ret_data_len(%lu)",
+                call_desp->api_id, i, call_desp->ret_data_len
+            );
+            retvals[i] = this->api_mgnr->cast_pos_retval(POS_FAILED_INVALID_INPUT, api_meta->library_id);
+            retval = POS_FAILED_INVALID_INPUT;
+            continue;
+        }
+
+        POS_CHECK_POINTER(wqe = client->apicxt_arena.acquire());
+        wqe->load(
+            /* api_id*/ call_desp->api_id,
+            /* uuid */ client->id,
+            /* param_desps */ call_desp->param_desps,
+            /* nb_params */ call_desp->nb_params,
+            /* id */ client->get_and_move_api_inst_pc(),
+            /* retval_data */ call_desp->ret_data,
+            /* retval_size */ call_desp->ret_data_len,
+            /* pos_client */ client
+        );
+        wqe->is_sync = api_meta->is_sync;
+
+        if(unlikely(api_meta->is_sync)){
+            client->is_under_sync_call = true;
+        }
+        if(unlikely(POS_SUCCESS != (submit_retval = this->__submit_wqe(client, wqe)))){
+            client->is_under_sync_call = false;
+            wqe->put_ref();
+            retvals[i] = this->api_mgnr->cast_pos_retval(submit_retval, api_meta->library_id);
+            retval = submit_retval;
+            continue;
+        }
+
+        if(unlikely(api_meta->is_sync)){
+            retvals[i] = this->__wait_sync_call(client, wqe);
+        } else {
+            retvals[i] = this->api_mgnr->cast_pos_retval(POS_SUCCESS, api_meta->library_id);
+        }
+    }
+
+    // retire previously returned async calls, once per batch
+    client->retire_apicxts();
 
 exit:
     return retval;
 }
+
+
+pos_retval_t POSWorkspace::__submit_wqe(POSClient *client, POSAPIContext_QE *wqe){
+    pos_retval_t retval;
+
+    POS_CHECK_POINTER(client);
+    POS_CHECK_POINTER(wqe);
+
+    while(unlikely(POS_FAILED_NOT_READY == (
+        retval = client->template push_q<kPOS_QueueDirection_Rpc2Parser, kPOS_QueueType_ApiCxt_WQ>(wqe)
+    ))){
+        // the parser falls behind, retire returned async calls while waiting it to consume the queue
+        client->retire_apicxts();
+        client->parser_doorbell.ring();
+        sched_yield();
+    }
+
+    if(unlikely(retval != POS_SUCCESS)){
+        POS_WARN_C("failed to submit wqe to parser: uuid(%lu), retval(%u)", client->id, retval);
+    }
+
+    return retval;
+}
+
+
+void POSWorkspace::__reclaim_daemon(){
+    uint64_t i;
+    POSClient *client;
+
+    while(!this->_reclaimer_stop_flag){
+        std::this_thread::sleep_for(std::chrono::milliseconds(POS_WORKSPACE_RECLAIM_INTERVAL_MS));
+
+        // clients are never freed, and retire_apicxts is a no-op once the client is deinited
+        for(i=0; i<POS_WORKSPACE_MAX_NB_CLIENTS; i++){
+            if((client = this->get_client_by_uuid(i)) == nullptr){ continue; }
+            if(unlikely(client->status != kPOS_ClientStatus_Active)){ continue; }
+            client->retire_apicxts();
+        }
+    }
+}
+
+
+int POSWorkspace::__wait_sync_call(POSClient *client, POSAPIContext_QE *wqe){
+    int retval;
+
+    POS_CHECK_POINTER(client);
+    POS_CHECK_POINTER(wqe);
+    POS_ASSERT(wqe->is_sync == true);
+
+    #if POS_CONF_RUNTIME_EnableDebugCheck
+        if(unlikely(this->get_client_by_uuid(client->id) == nullptr)){
+            POS_ERROR_DETAIL("client disappear during waiting of sync call, this is a bug: uuid(%lu)", client->id);
+        }
+    #endif
+
+    wqe->completion.wait(client->sync_spin_ticks, client->sync_spin_min_ticks, client->sync_spin_max_ticks);
+
+    // setup return code, previous async error takes priority
+    if(unlikely(client->has_async_error.exchange(false, std::memory_order_acquire) == true)){
+        retval = client->async_error_code.load(std::memory_order_relaxed);
+    } else {
+        retval = wqe->api_cxt->return_code;
+    }
+    client->is_under_sync_call = false;
+
+    // the worker might defer the checkpoint bottom half until the sync call ends
+    client->worker_doorbell.ring();
+
+    // the sync call is digested, drop the reference owned by the rpc frontend
+    wqe->put_ref();
+
+    // retire async calls that returned before this sync call
+    client->retire_apicxts();
+
+    return retval;
+}
@@ -106,14 +106,20 @@ type BuildConfigs struct {
 	RuntimeEnableHijackApiCheck uint8  `yaml:"runtime_enable_hijack_api_check"`
 	RuntimeEnableTrace          uint8  `yaml:"runtime_enable_trace"`
 	RuntimeEnableMemoryTrace  	uint8  `yaml:"runtime_enable_memory_trace"`
+	RuntimeDaemonPollPolicy     uint8  `yaml:"runtime_daemon_poll_policy"`
+	RuntimeDaemonPollSpinUs     uint32 `yaml:"runtime_daemon_poll_spin_us"`
+	RuntimeDaemonPoolSize       uint32 `yaml:"runtime_daemon_pool_size"`
 	RuntimeDefaultDaemonLogPath string `yaml:"runtime_default_daemon_log_path"`
 	RuntimeDefaultClientLogPath string `yaml:"runtime_default_client_log_path"`
+	RuntimeDefaultCkptPoolPrewarm string `yaml:"runtime_default_ckpt_pool_prewarm"`
 
 	// Evaluation Options
 	// checkpoint
 	EvalCkptOptLevel          uint8  `yaml:"eval_ckpt_opt_level"`
 	EvalCkptEnableIncremental uint8  `yaml:"eval_ckpt_enable_incremental"`
 	EvalCkptEnablePipeline    uint8  `yaml:"eval_ckpt_enable_pipeline"`
+	EvalCkptCommitLanes       uint32 `yaml:"eval_ckpt_commit_lanes"`
+	EvalCkptInflightMb        uint32 `yaml:"eval_ckpt_inflight_mb"`
 	EvalCkptDefaultIntervalMs uint32 `yaml:"eval_ckpt_interval_ms"`
 	// migration
 	EvalMigrOptLevel uint8 `yaml:"migr_interval_ms"`
@@ -144,12 +150,18 @@ func (buildConf *BuildConfigs) print(logger *log.Logger) {
 			- RuntimeEnableHijackApiCheck: %v
 			- RuntimeEnableTrace: %v
 			- RuntimeEnableMemoryTrace: %v
+			- RuntimeDaemonPollPolicy: %v
+			- RuntimeDaemonPollSpinUs: %v
+			- RuntimeDaemonPoolSize: %v
 			- RuntimeDaemonLogPath: %v
 			- RuntimeClientLogPath: %v
+			- RuntimeCkptPoolPrewarm: %v
 		> Evaluation Configs:
 			- EvalCkptOptLevel: %v
 			- EvalCkptEnableIncremental: %v
 			- EvalCkptEnablePipeline: %v
+			- EvalCkptCommitLanes: %v
+			- EvalCkptInflightMb: %v
 			- EvalCkptInteralMs: %v
 			- EvalMigrOptLevel: %v
 			- EvalRstEnableContextPool: %v
@@ -166,11 +178,17 @@ func (buildConf *BuildConfigs) print(logger *log.Logger) {
 		buildConf.RuntimeEnableHijackApiCheck,
 		buildConf.RuntimeEnableTrace,
 		buildConf.RuntimeEnableMemoryTrace,
+		buildConf.RuntimeDaemonPollPolicy,
+		buildConf.RuntimeDaemonPollSpinUs,
+		buildConf.RuntimeDaemonPoolSize,
 		buildConf.RuntimeDefaultDaemonLogPath,
 		buildConf.RuntimeDefaultClientLogPath,
+		buildConf.RuntimeDefaultCkptPoolPrewarm,
 		buildConf.EvalCkptOptLevel,
 		buildConf.EvalCkptEnableIncremental,
 		buildConf.EvalCkptEnablePipeline,
+		buildConf.EvalCkptCommitLanes,
+		buildConf.EvalCkptInflightMb,
 		buildConf.EvalCkptDefaultIntervalMs,
 		buildConf.EvalMigrOptLevel,
 		buildConf.EvalRstEnableContextPool,
@@ -196,13 +214,19 @@ func (buildConf *BuildConfigs) export_string() string {
 		export POS_BUILD_CONF_RuntimeEnableHijackApiCheck=%v
 		export POS_BUILD_CONF_RuntimeEnableTrace=%v
 		export POS_BUILD_CONF_RuntimeEnableMemoryTrace=%v
+		export POS_BUILD_CONF_RuntimeDaemonPollPolicy=%v
+		export POS_BUILD_CONF_RuntimeDaemonPollSpinUs=%v
+		export POS_BUILD_CONF_RuntimeDaemonPoolSize=%v
 		export POS_BUILD_CONF_RuntimeDefaultDaemonLogPath=%v
 		export POS_BUILD_CONF_RuntimeDefaultClientLogPath=%v
+		export POS_BUILD_CONF_RuntimeDefaultCkptPoolPrewarm=%v
 
 		# PhOS core build configs
 		export POS_BUILD_CONF_EvalCkptOptLevel=%v
 		export POS_BUILD_CONF_EvalCkptEnableIncremental=%v
 		export POS_BUILD_CONF_EvalCkptEnablePipeline=%v
+		export POS_BUILD_CONF_EvalCkptCommitLanes=%v
+		export POS_BUILD_CONF_EvalCkptInflightMb=%v
 		export POS_BUILD_CONF_EvalCkptDefaultIntervalMs=%v
 		export POS_BUILD_CONF_EvalMigrOptLevel=%v
 		export POS_BUILD_CONF_EvalRstEnableContextPool=%v
@@ -220,12 +244,18 @@ func (buildConf *BuildConfigs) export_string() string {
 		buildConf.RuntimeEnableHijackApiCheck,
 		buildConf.RuntimeEnableTrace,
 		buildConf.RuntimeEnableMemoryTrace,
+		buildConf.RuntimeDaemonPollPolicy,
+		buildConf.RuntimeDaemonPollSpinUs,
+		buildConf.RuntimeDaemonPoolSize,
 		buildConf.RuntimeDefaultDaemonLogPath,
 		buildConf.RuntimeDefaultClientLogPath,
+		buildConf.RuntimeDefaultCkptPoolPrewarm,
 
 		buildConf.EvalCkptOptLevel,
 		buildConf.EvalCkptEnableIncremental,
 		buildConf.EvalCkptEnablePipeline,
+		buildConf.EvalCkptCommitLanes,
+		buildConf.EvalCkptInflightMb,
 		buildConf.EvalCkptDefaultIntervalMs,
 		buildConf.EvalMigrOptLevel,
 		buildConf.EvalRstEnableContextPool,
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+#include "pos/include/common.h"
+#include "pos/include/checkpoint.h"
+
+
+/*!
+ *  \brief  host-memory stand-in of a memory handle, the device buffer is a host buffer, and
+ *          committing copies ranges with memcpy instead of cudaMemcpyAsync
+ */
+class PhOSCkptDirtyChunksTest : public ::testing::Test {
+ protected:
+    static constexpr uint64_t kStateSize = MB(64) + KB(4);  // not aligned to the chunk size on purpose
+    static constexpr uint64_t kChunkSize = POS_CKPT_CHUNK_SIZE;
+
+    void SetUp() override {
+        this->_dirty_chunks = new POSCheckpointDirtyChunks(kStateSize, kChunkSize);
+        this->_buffer = new uint8_t[kStateSize];
+        memset(this->_buffer, 0, kStateSize);
+        for(auto &slot : this->_slots){
+            slot = new POSCheckpointSlot(kStateSize, nullptr, nullptr, kPOS_CkptSlotPosition_Host, kPOS_CkptStateType_Device);
+            memset(slot->expose_pointer(), 0xff, kStateSize);
+        }
+    }
+
+    void TearDown() override {
+        delete this->_dirty_chunks;
+        delete[] this->_buffer;
+        for(auto &slot : this->_slots){ delete slot; }
+    }
+
+    // write [offset, offset+size) as a memset would, and mark the range as the worker does
+    void __write(uint64_t offset, uint64_t size, uint8_t value, uint64_t marked_size){
+        memset(this->_buffer + offset, value, size);
+        this->_dirty_chunks->mark(offset, marked_size);
+    }
+
+    // commit all chunks modified since last commit into the given slot, as POSHandle_CUDA_Memory::__commit
+    uint64_t __commit(POSCheckpointSlot *slot){
+        std::vector<pos_ckpt_chunk_range_t> ranges;
+        uint64_t nb_bytes = 0;
+
+        this->_dirty_chunks->begin_round();
+        this->_dirty_chunks->prepare_slot(slot);
+        this->_dirty_chunks->get_round_ranges(ranges);
+        for(auto &range : ranges){
+            memcpy((uint8_t*)(slot->expose_pointer()) + range.offset, this->_buffer + range.offset, range.size);
+            nb_bytes += range.size;
+        }
+        this->_dirty_chunks->finish_round(slot);
+
+        return nb_bytes;
+    }
+
+    bool __is_consistent(POSCheckpointSlot *slot){
+        return memcmp(slot->expose_pointer(), this->_buffer, kStateSize) == 0;
+    }
+
+    POSCheckpointDirtyChunks *_dirty_chunks;
+    uint8_t *_buffer;
+    POSCheckpointSlot *_slots[2];
+};
+
+
+TEST_F(PhOSCkptDirtyChunksTest, FirstRoundCopiesWholeState) {
+    this->__write(KB(4), KB(4), 0x1, KB(4));
+    EXPECT_EQ(kStateSize, this->__commit(this->_slots[0]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[0]));
+}
+
+
+TEST_F(PhOSCkptDirtyChunksTest, CommitOnlyDirtyChunks) {
+    this->__commit(this->_slots[0]);
+
+    // a write within a single chunk
+    this->__write(kChunkSize * 3 + 128, 256, 0x2, 256);
+    EXPECT_EQ(kChunkSize, this->__commit(this->_slots[0]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[0]));
+
+    // a write across the chunk boundary, and one on the last (partial) chunk
+    this->__write(kChunkSize * 5 - 8, 16, 0x3, 16);
+    this->__write(kStateSize - 16, 16, 0x4, 16);
+    EXPECT_EQ(2 * kChunkSize + KB(4), this->__commit(this->_slots[0]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[0]));
+
+    // nothing written
+    EXPECT_EQ(0ul, this->__commit(this->_slots[0]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[0]));
+}
+
+
+TEST_F(PhOSCkptDirtyChunksTest, UnknownSizeMarksFromOffset) {
+    this->__commit(this->_slots[0]);
+
+    // e.g., a kernel given a pointer into the state, with unknown access size
+    this->__write(kChunkSize * 30 + 64, kChunkSize, 0x5, /* marked_size */ 0);
+    EXPECT_EQ(kStateSize - kChunkSize * 30, this->__commit(this->_slots[0]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[0]));
+
+    // an offset beyond the state marks the whole state
+    this->_dirty_chunks->mark(kStateSize, 0);
+    EXPECT_EQ(kStateSize, this->__commit(this->_slots[0]));
+}
+
+
+TEST_F(PhOSCkptDirtyChunksTest, SwitchSlotCopiesWholeState) {
+    this->__write(0, KB(16), 0x6, KB(16));
+    this->__commit(this->_slots[0]);
+
+    // the checkpoint bag hands out another slot, which has never seen the base state
+    this->__write(kChunkSize * 7, KB(16), 0x7, KB(16));
+    EXPECT_EQ(kStateSize, this->__commit(this->_slots[1]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[1]));
+
+    // back to the same slot, only dirty chunks are copied
+    this->__write(kChunkSize * 9, KB(16), 0x8, KB(16));
+    EXPECT_EQ(kChunkSize, this->__commit(this->_slots[1]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[1]));
+
+    // failed round drops the base, so the next round copies the whole state
+    this->_dirty_chunks->reset();
+    EXPECT_EQ(kStateSize, this->__commit(this->_slots[1]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[1]));
+}
+
+
+TEST_F(PhOSCkptDirtyChunksTest, ReleasedSlotIsNeverBase) {
+    this->__commit(this->_slots[0]);
+
+    // the base slot is released (e.g., the checkpoint bag is cleared), and a new slot might be
+    // created at the same address, which doesn't store the base state
+    delete this->_slots[0];
+    this->_slots[0] = new POSCheckpointSlot(kStateSize, nullptr, nullptr, kPOS_CkptSlotPosition_Host, kPOS_CkptStateType_Device);
+    memset(this->_slots[0]->expose_pointer(), 0xff, kStateSize);
+
+    this->__write(KB(4), KB(4), 0x9, KB(4));
+    EXPECT_EQ(kStateSize, this->__commit(this->_slots[0]));
+    EXPECT_TRUE(this->__is_consistent(this->_slots[0]));
+}
+
+
+TEST_F(PhOSCkptDirtyChunksTest, RandomWritesStayConsistent) {
+    std::mt19937_64 rng(0);
+    std::uniform_int_distribution<uint64_t> offset_dist(0, kStateSize - 1);
+    uint64_t i, j, offset, size;
+
+    for(i=0; i<32; i++){
+        for(j=0; j<8; j++){
+            offset = offset_dist(rng);
+            size = std::min<uint64_t>(rng() % MB(4) + 1, kStateSize - offset);
+            this->__write(offset, size, (uint8_t)(rng()), size);
+        }
+        this->__commit(this->_slots[i % 3 == 2 ? 1 : 0]);
+        EXPECT_TRUE(this->__is_consistent(this->_slots[i % 3 == 2 ? 1 : 0])) << "round " << i;
+    }
+}
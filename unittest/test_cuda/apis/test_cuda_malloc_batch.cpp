@@ -0,0 +1,52 @@
+/*
+ * Copyright 2025 The PhoenixOS Authors. All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_cuda/test_cuda_common.h"
+
+TEST_F(PhOSCudaTest, cudaMallocBatch) {
+    uint64_t i;
+    pos_retval_t retval;
+
+    std::vector<size_t> mem_sizes({ 16, 512, KB(1), KB(2), KB(4), KB(8) });
+    std::vector<void*> mem_ptrs(mem_sizes.size(), nullptr);
+    std::vector<POSAPIParamDesp_t> param_desps(mem_sizes.size());
+    std::vector<POSAPICallDesp_t> call_desps(mem_sizes.size());
+    std::vector<int> retvals(mem_sizes.size(), -1);
+
+    for(i=0; i<mem_sizes.size(); i++){
+        param_desps[i] = { .value = &(mem_sizes[i]), .size = sizeof(size_t) };
+        call_desps[i] = {
+            .api_id = CUDA_MALLOC,
+            .param_desps = &(param_desps[i]),
+            .nb_params = 1,
+            .ret_data = &(mem_ptrs[i]),
+            .ret_data_len = sizeof(uint64_t)
+        };
+    }
+
+    retval = this->_ws->pos_process_batch(
+        /* uuid */ this->_clnt->id,
+        /* call_desps */ call_desps.data(),
+        /* nb_calls */ call_desps.size(),
+        /* retvals */ retvals.data()
+    );
+    EXPECT_EQ(POS_SUCCESS, retval);
+
+    for(i=0; i<mem_sizes.size(); i++){
+        EXPECT_EQ(cudaSuccess, (cudaError)retvals[i]);
+        EXPECT_NE(nullptr, mem_ptrs[i]);
+    }
+}
@@ -28,6 +28,8 @@ pos_retval_t PhOSCudaTest::__create_cuda_workspace_and_client(){
     this->_ws->init();
 
     create_param.job_name = "unit_test";
+    create_param.is_daemon_dedicated = false;
+    create_param.daemon_weight = POS_DAEMON_POOL_DEFAULT_WEIGHT;
     retval = (this->_ws)->create_client(create_param, &this->_clnt);
     if(unlikely(retval != POS_SUCCESS)){
         POS_WARN("failed to create client");